@@ -0,0 +1,94 @@
+# The engine without any widgets, shared by the user interface, the headless
+# engine and the tests. The sources live in ../mx2482 along with the widgets.
+QT += core network
+QT -= gui
+OBJECTS_DIR = obj
+MOC_DIR = moc
+DESTDIR = lib
+TARGET = mx2482engine
+TEMPLATE = lib
+CONFIG += staticlib
+QMAKE_CXXFLAGS -= -O2
+QMAKE_CXXFLAGS += -O3
+# Never fuse multiplies and adds, so all routing kernel variants produce the same buses
+QMAKE_CXXFLAGS += -ffp-contract=off
+CONFIG += flat
+
+# Sum the subgroups and main in double precision: qmake CONFIG+=double_buses
+double_buses: DEFINES += MX2482_DOUBLE_BUSES
+
+INCLUDEPATH += ../libqjackaudio \
+               ../mx2482 \
+               /usr/include/lilv-0
+
+SOURCES += \
+    ../mx2482/mixerstate.cpp \
+    ../mx2482/scratcharena.cpp \
+    ../mx2482/workerpool.cpp \
+    ../mx2482/mixeroptions.cpp \
+    ../mx2482/routingkernel.cpp \
+    ../mx2482/biquadequalizer.cpp \
+    ../mx2482/dynamicsbank.cpp \
+    ../mx2482/mixerengine.cpp \
+    ../mx2482/channelstrip.cpp \
+    ../mx2482/jackmixerports.cpp \
+    ../mx2482/buffermixerports.cpp \
+    ../mx2482/wavreader.cpp \
+    ../mx2482/wavwriter.cpp \
+    ../mx2482/offlinerenderer.cpp \
+    ../mx2482/meterbank.cpp \
+    ../mx2482/lv2host.cpp \
+    ../mx2482/lv2insert.cpp \
+    ../mx2482/scenebank.cpp \
+    ../mx2482/automationplayer.cpp \
+    ../mx2482/automationrecorder.cpp \
+    ../mx2482/mixercommand.cpp \
+    ../mx2482/oscserver.cpp \
+    ../mx2482/multitrackrecorder.cpp \
+    ../mx2482/multitrackplayer.cpp \
+    ../mx2482/stagetracer.cpp \
+    ../mx2482/cyclemonitor.cpp \
+    ../mx2482/enginesegment.cpp \
+    ../mx2482/enginecontroller.cpp \
+    ../mx2482/enginehost.cpp
+
+HEADERS += \
+    ../mx2482/mixerstate.h \
+    ../mx2482/triplebuffer.h \
+    ../mx2482/sampleops.h \
+    ../mx2482/scratcharena.h \
+    ../mx2482/workerpool.h \
+    ../mx2482/mixeroptions.h \
+    ../mx2482/routingkernel.h \
+    ../mx2482/biquadequalizer.h \
+    ../mx2482/dynamicsbank.h \
+    ../mx2482/mixerengine.h \
+    ../mx2482/mixerports.h \
+    ../mx2482/channelstrip.h \
+    ../mx2482/jackmixerports.h \
+    ../mx2482/buffermixerports.h \
+    ../mx2482/wavreader.h \
+    ../mx2482/wavwriter.h \
+    ../mx2482/offlinerenderer.h \
+    ../mx2482/meterring.h \
+    ../mx2482/meterbank.h \
+    ../mx2482/inserteffect.h \
+    ../mx2482/lv2host.h \
+    ../mx2482/lv2insert.h \
+    ../mx2482/scenebank.h \
+    ../mx2482/automationplayer.h \
+    ../mx2482/automationrecorder.h \
+    ../mx2482/waitfreering.h \
+    ../mx2482/realtimeswitch.h \
+    ../mx2482/waitfreequeue.h \
+    ../mx2482/mixercommand.h \
+    ../mx2482/oscserver.h \
+    ../mx2482/samplering.h \
+    ../mx2482/multitrackrecorder.h \
+    ../mx2482/multitrackplayer.h \
+    ../mx2482/wave64.h \
+    ../mx2482/stagetracer.h \
+    ../mx2482/cyclemonitor.h \
+    ../mx2482/enginesegment.h \
+    ../mx2482/enginecontroller.h \
+    ../mx2482/enginehost.h
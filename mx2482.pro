@@ -1,8 +1,20 @@
 TEMPLATE = subdirs
-SUBDIRS = mx2482 libqjackaudio
+SUBDIRS = mx2482 mx2482engine mx2482bench mx2482test libmx2482engine libqjackaudio
 
 mx2482.subdir = mx2482
-mx2482.depends = libqjackaudio
+mx2482.depends = libmx2482engine libqjackaudio
+
+mx2482engine.subdir = mx2482engine
+mx2482engine.depends = libmx2482engine libqjackaudio
+
+mx2482bench.subdir = mx2482bench
+mx2482bench.depends = libqjackaudio
+
+mx2482test.subdir = mx2482test
+mx2482test.depends = libmx2482engine libqjackaudio
+
+libmx2482engine.subdir = libmx2482engine
+libmx2482engine.depends = libqjackaudio
 
 libqjackaudio.subdir = libqjackaudio
 libqjackaudio.depends =
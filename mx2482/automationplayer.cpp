@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "automationplayer.h"
+#include "mixerstate.h"
+#include "sampleops.h"
+
+// Standard includes
+#include <algorithm>
+
+/** Orders events by frame, for sorting the lanes. */
+static bool eventLessThan(const AutomationEvent& a, const AutomationEvent& b)
+{
+    return a.frame < b.frame;
+}
+
+AutomationPlayer::AutomationPlayer(int channelCount, int subgroupCount) :
+    _channelCount(channelCount),
+    _subgroupCount(subgroupCount),
+    _lanes(channelCount * AutomationEvent::ChannelParameterCount + subgroupCount + MixerState::MainCount),
+    _playing(false),
+    _position(0)
+{
+    for(int i = 0; i < _lanes.size(); i++) {
+        Lane emptyLane = { 0, 0, 0 };
+        _lanes[i] = emptyLane;
+    }
+}
+
+void AutomationPlayer::setEvents(const QVector<AutomationEvent>& events)
+{
+    stop();
+
+    // Events of the same frame keep their order, so the last one wins
+    QVector<AutomationEvent> sortedEvents = events;
+    std::stable_sort(sortedEvents.begin(), sortedEvents.end(), eventLessThan);
+
+    // Count the points of each lane to lay them out one lane after the other
+    QVector<int> laneSizes(_lanes.size(), 0);
+    foreach(AutomationEvent event, sortedEvents) {
+        int i = lane(event.parameter, event.index);
+        if(i >= 0) {
+            laneSizes[i]++;
+        }
+    }
+
+    int begin = 0;
+    for(int i = 0; i < _lanes.size(); i++) {
+        Lane& currentLane = _lanes[i];
+        currentLane.begin = begin;
+        currentLane.end = begin;
+        currentLane.next = begin;
+        begin += laneSizes.at(i);
+    }
+
+    _points.resize(begin);
+    foreach(AutomationEvent event, sortedEvents) {
+        int i = lane(event.parameter, event.index);
+        if(i >= 0) {
+            Point point = { event.frame, event.value };
+            _points[_lanes[i].end++] = point;
+        }
+    }
+}
+
+void AutomationPlayer::start()
+{
+    for(int i = 0; i < _lanes.size(); i++) {
+        _lanes[i].next = _lanes.at(i).begin;
+    }
+    _position = 0;
+    _playing = true;
+}
+
+void AutomationPlayer::stop()
+{
+    _playing = false;
+}
+
+bool AutomationPlayer::isPlaying() const
+{
+    return _playing;
+}
+
+void AutomationPlayer::advance(int frames)
+{
+    if(_playing) {
+        _position += frames;
+    }
+}
+
+int AutomationPlayer::lane(AutomationEvent::Parameter parameter, int index) const
+{
+    switch(parameter) {
+    case AutomationEvent::ChannelInputGain:
+    case AutomationEvent::ChannelAuxSendGain:
+    case AutomationEvent::ChannelAuxReturnGain:
+    case AutomationEvent::ChannelFaderGain:
+        if(index < 0 || index >= _channelCount) {
+            return -1;
+        }
+        return index * AutomationEvent::ChannelParameterCount + parameter;
+    case AutomationEvent::SubgroupGain:
+        if(index < 0 || index >= _subgroupCount) {
+            return -1;
+        }
+        return _channelCount * AutomationEvent::ChannelParameterCount + index;
+    case AutomationEvent::MainGain:
+        if(index < 0 || index >= MixerState::MainCount) {
+            return -1;
+        }
+        return _channelCount * AutomationEvent::ChannelParameterCount + _subgroupCount + index;
+    }
+    return -1;
+}
+
+template <typename Sample>
+bool AutomationPlayer::applyGain(int laneIndex, Sample *samples, int frames, float& gain)
+{
+    if(!_playing) {
+        return false;
+    }
+
+    // A lane takes over with its first event
+    Lane& currentLane = _lanes[laneIndex];
+    const Point *points = _points.constData();
+    qint64 periodEnd = _position + frames;
+    if(currentLane.next == currentLane.end
+            ? currentLane.begin == currentLane.end
+            : currentLane.next == currentLane.begin && points[currentLane.next].frame >= periodEnd) {
+        return false;
+    }
+
+    // Apply each gain up to the frame of the next event. Events a stage has missed while it
+    // has been skipped are caught up at the start of the period.
+    int offset = 0;
+    while(currentLane.next < currentLane.end && points[currentLane.next].frame < periodEnd) {
+        const Point& point = points[currentLane.next++];
+        int eventOffset = (int)qMax((qint64)0, point.frame - _position);
+        ::applyGain(samples + offset, eventOffset - offset, gain);
+        gain = point.value;
+        offset = eventOffset;
+    }
+    ::applyGain(samples + offset, frames - offset, gain);
+    return true;
+}
+
+template bool AutomationPlayer::applyGain<float>(int laneIndex, float *samples, int frames, float& gain);
+template bool AutomationPlayer::applyGain<double>(int laneIndex, double *samples, int frames, float& gain);
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOMATIONPLAYER_H
+#define AUTOMATIONPLAYER_H
+
+// Qt includes
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * A timestamped change of an automated parameter.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct AutomationEvent
+{
+    /** Parameters that can be automated, all of them gains. */
+    enum Parameter {
+        ChannelInputGain,
+        ChannelAuxSendGain,
+        ChannelAuxReturnGain,
+        ChannelFaderGain,
+        SubgroupGain,
+        MainGain
+    };
+
+    enum {
+        /** Number of parameters each channel has. */
+        ChannelParameterCount = ChannelFaderGain + 1
+    };
+
+    /** Frame the value takes effect at, counted from the start of the automation. */
+    qint64 frame;
+    /** Parameter to change. */
+    Parameter parameter;
+    /** Channel, subgroup or main (0 is left, 1 is right) the parameter belongs to, starting at 0. */
+    int index;
+    /** New linear gain. */
+    float value;
+};
+
+/**
+ * Plays back automation on the realtime thread. The events are kept in
+ * preallocated lanes, one for each parameter, that are consumed period by
+ * period. Each gain stage applies the events of its lane at the exact
+ * frame they have been recorded for, independent of the user interface.
+ *
+ * A parameter follows its lane from the first event on and ignores the
+ * mixer state until playback stops. Each lane must only be consumed by
+ * one thread in a period. All methods except the lane methods must only
+ * be called between periods, by the realtime thread or while it does not
+ * use the player.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class AutomationPlayer
+{
+public:
+    /**
+     * Constructor.
+     * @param channelCount Number of channels.
+     * @param subgroupCount Number of subgroups.
+     */
+    AutomationPlayer(int channelCount, int subgroupCount);
+
+    /**
+     * Sorts the events into the lanes, replacing the previous ones. Events
+     * of parameters that do not exist are dropped. Stops playback.
+     */
+    void setEvents(const QVector<AutomationEvent>& events);
+
+    /** Starts playback from the first frame. */
+    void start();
+    /** Stops playback, all parameters follow the mixer state again. */
+    void stop();
+    /** @returns true, if the automation is being played back. */
+    bool isPlaying() const;
+
+    /** Moves on to the next period, after all lanes have been consumed. */
+    void advance(int frames);
+
+    /** @returns the lane of a parameter. */
+    int lane(AutomationEvent::Parameter parameter, int index) const;
+
+    /**
+     * Multiplies frames samples by the gain of a lane in the current
+     * period, changing it at the frames of the events.
+     * @param gain Gain at the start of the period, updated to the one at the end.
+     * @returns false, if the lane is not automated at all in this period.
+     * Nothing has been done then. Available for float and double samples.
+     */
+    template <typename Sample>
+    bool applyGain(int laneIndex, Sample *samples, int frames, float& gain);
+
+private:
+    /** A point on an automation lane. */
+    struct Point {
+        qint64 frame;
+        float value;
+    };
+
+    /** Range of the points of a lane. */
+    struct Lane {
+        int begin;
+        int end;
+        /** First point that has not been applied yet. */
+        int next;
+    };
+
+    int _channelCount;
+    int _subgroupCount;
+
+    /** Points of all lanes, each lane sorted by frame. */
+    QVector<Point> _points;
+    QVector<Lane> _lanes;
+
+    bool _playing;
+    /** Frame the current period starts at. */
+    qint64 _position;
+};
+
+#endif // AUTOMATIONPLAYER_H
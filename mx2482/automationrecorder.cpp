@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "automationrecorder.h"
+
+// Qt includes
+#include <QJsonObject>
+
+/** Names of the parameters in JSON, in the order of AutomationEvent::Parameter. */
+static const char *parameterNames[] = {
+    "inputGain",
+    "auxSendGain",
+    "auxReturnGain",
+    "faderGain",
+    "subgroupGain",
+    "mainGain"
+};
+
+AutomationRecorder::AutomationRecorder() :
+    _recording(false),
+    _startFrame(0)
+{
+}
+
+void AutomationRecorder::start(qint64 frame, const MixerState& mixerState)
+{
+    _events.clear();
+    _recording = true;
+    _startFrame = frame;
+    recordState(frame, mixerState, true);
+}
+
+void AutomationRecorder::record(qint64 frame, const MixerState& mixerState)
+{
+    if(_recording) {
+        recordState(frame, mixerState, false);
+    }
+}
+
+void AutomationRecorder::stop()
+{
+    _recording = false;
+}
+
+bool AutomationRecorder::isRecording() const
+{
+    return _recording;
+}
+
+const QVector<AutomationEvent>& AutomationRecorder::events() const
+{
+    return _events;
+}
+
+void AutomationRecorder::setEvents(const QVector<AutomationEvent>& events)
+{
+    _recording = false;
+    _events = events;
+}
+
+QJsonArray AutomationRecorder::toJson(const QVector<AutomationEvent>& events)
+{
+    QJsonArray jsonArray;
+    foreach(AutomationEvent event, events) {
+        QJsonObject jsonObject;
+        jsonObject.insert("frame", (double)event.frame);
+        jsonObject.insert("parameter", QString(parameterNames[event.parameter]));
+        jsonObject.insert("index", event.index);
+        jsonObject.insert("value", event.value);
+        jsonArray.append(jsonObject);
+    }
+    return jsonArray;
+}
+
+QVector<AutomationEvent> AutomationRecorder::fromJson(const QJsonArray& jsonArray)
+{
+    QVector<AutomationEvent> events;
+    foreach(QJsonValue jsonValue, jsonArray) {
+        QJsonObject jsonObject = jsonValue.toObject();
+        QString parameterName = jsonObject.value("parameter").toString();
+        int parameter = AutomationEvent::ChannelInputGain;
+        while(parameter <= AutomationEvent::MainGain && parameterName != parameterNames[parameter]) {
+            parameter++;
+        }
+        if(parameter > AutomationEvent::MainGain) {
+            continue;
+        }
+
+        AutomationEvent event;
+        event.frame = (qint64)jsonObject.value("frame").toDouble();
+        event.parameter = (AutomationEvent::Parameter)parameter;
+        event.index = jsonObject.value("index").toInt();
+        event.value = jsonObject.value("value").toDouble();
+        events.append(event);
+    }
+    return events;
+}
+
+void AutomationRecorder::recordValue(qint64 frame, AutomationEvent::Parameter parameter, int index,
+                                     float value, float lastValue, bool all)
+{
+    if(all || value != lastValue) {
+        AutomationEvent event = { frame - _startFrame, parameter, index, value };
+        _events.append(event);
+    }
+}
+
+void AutomationRecorder::recordState(qint64 frame, const MixerState& mixerState, bool all)
+{
+    // Snapshots of a different topology are recorded completely
+    all = all || mixerState.channelCount() != _lastState.channelCount()
+              || mixerState.subgroupCount() != _lastState.subgroupCount();
+
+    for(int i = 0; i < mixerState.channelCount(); i++) {
+        const ChannelState& channelState = mixerState.channels.at(i);
+        const ChannelState& lastChannelState = all ? channelState : _lastState.channels.at(i);
+        recordValue(frame, AutomationEvent::ChannelInputGain, i,
+                    channelState.inputGain, lastChannelState.inputGain, all);
+        recordValue(frame, AutomationEvent::ChannelAuxSendGain, i,
+                    channelState.auxSendGain, lastChannelState.auxSendGain, all);
+        recordValue(frame, AutomationEvent::ChannelAuxReturnGain, i,
+                    channelState.auxReturnGain, lastChannelState.auxReturnGain, all);
+        recordValue(frame, AutomationEvent::ChannelFaderGain, i,
+                    channelState.faderGain, lastChannelState.faderGain, all);
+    }
+
+    for(int i = 0; i < mixerState.subgroupCount(); i++) {
+        float lastGain = all ? 0.0f : _lastState.subgroups.at(i).gain;
+        recordValue(frame, AutomationEvent::SubgroupGain, i, mixerState.subgroups.at(i).gain, lastGain, all);
+    }
+
+    for(int i = 0; i < MixerState::MainCount; i++) {
+        recordValue(frame, AutomationEvent::MainGain, i, mixerState.mainGains[i], _lastState.mainGains[i], all);
+    }
+
+    _lastState = mixerState;
+}
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOMATIONRECORDER_H
+#define AUTOMATIONRECORDER_H
+
+// Qt includes
+#include <QVector>
+#include <QJsonArray>
+
+// Own includes
+#include "automationplayer.h"
+#include "mixerstate.h"
+
+/**
+ * Records automation from the mixer state snapshots published by the
+ * user interface. Each gain that differs from the previous snapshot
+ * becomes an event, timestamped with the frame time of the engine.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class AutomationRecorder
+{
+public:
+    AutomationRecorder();
+
+    /**
+     * Starts a new recording, discarding the previous one. The initial
+     * values of all gains are recorded at the first frame.
+     * @param frame Frame time of the engine the recording starts at.
+     */
+    void start(qint64 frame, const MixerState& mixerState);
+
+    /** Records all gains that have changed since the last snapshot. */
+    void record(qint64 frame, const MixerState& mixerState);
+
+    /** Stops recording, keeping the events. */
+    void stop();
+
+    /** @returns true, if recording. */
+    bool isRecording() const;
+
+    /** @returns the recorded events, ordered by frame. */
+    const QVector<AutomationEvent>& events() const;
+
+    /** Replaces the events, for example with loaded ones. Stops recording. */
+    void setEvents(const QVector<AutomationEvent>& events);
+
+    /** Transfers events into a JSON array. */
+    static QJsonArray toJson(const QVector<AutomationEvent>& events);
+
+    /** Reads events from a JSON array, skipping invalid ones. */
+    static QVector<AutomationEvent> fromJson(const QJsonArray& jsonArray);
+
+private:
+    /** Appends an event if value differs from lastValue or if all is set. */
+    void recordValue(qint64 frame, AutomationEvent::Parameter parameter, int index,
+                     float value, float lastValue, bool all);
+    /** Records the gains of a snapshot, either the changed ones or all of them. */
+    void recordState(qint64 frame, const MixerState& mixerState, bool all);
+
+    bool _recording;
+    /** Frame time of the engine the recording has started at. */
+    qint64 _startFrame;
+    /** Last recorded snapshot. */
+    MixerState _lastState;
+    QVector<AutomationEvent> _events;
+};
+
+#endif // AUTOMATIONRECORDER_H
@@ -0,0 +1,211 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "biquadequalizer.h"
+
+// Standard includes
+#include <cmath>
+#include <cstring>
+
+static BiquadCoefficients normalized(double b0, double b1, double b2, double a0, double a1, double a2)
+{
+    BiquadCoefficients coefficients;
+    coefficients.b0 = b0 / a0;
+    coefficients.b1 = b1 / a0;
+    coefficients.b2 = b2 / a0;
+    coefficients.a1 = a1 / a0;
+    coefficients.a2 = a2 / a0;
+    return coefficients;
+}
+
+/** Limits a frequency to the range the bilinear transform can represent. */
+static double clampedFrequency(double sampleRate, double frequency)
+{
+    return qBound(1.0, frequency, 0.49 * sampleRate);
+}
+
+BiquadCoefficients BiquadCoefficients::identity()
+{
+    return normalized(1.0, 0.0, 0.0, 1.0, 0.0, 0.0);
+}
+
+BiquadCoefficients BiquadCoefficients::lowShelf(double sampleRate, double frequency, double q, double gainDb)
+{
+    double a = std::pow(10.0, gainDb / 40.0);
+    double w0 = 2.0 * M_PI * clampedFrequency(sampleRate, frequency) / sampleRate;
+    double cosW0 = std::cos(w0);
+    double alpha = std::sin(w0) / (2.0 * q);
+    double twoSqrtAAlpha = 2.0 * std::sqrt(a) * alpha;
+
+    return normalized(
+        a * ((a + 1.0) - (a - 1.0) * cosW0 + twoSqrtAAlpha),
+        2.0 * a * ((a - 1.0) - (a + 1.0) * cosW0),
+        a * ((a + 1.0) - (a - 1.0) * cosW0 - twoSqrtAAlpha),
+        (a + 1.0) + (a - 1.0) * cosW0 + twoSqrtAAlpha,
+        -2.0 * ((a - 1.0) + (a + 1.0) * cosW0),
+        (a + 1.0) + (a - 1.0) * cosW0 - twoSqrtAAlpha);
+}
+
+BiquadCoefficients BiquadCoefficients::band(double sampleRate, double frequency, double bandwidth, double gainDb)
+{
+    frequency = clampedFrequency(sampleRate, frequency);
+    double a = std::pow(10.0, gainDb / 40.0);
+    double w0 = 2.0 * M_PI * frequency / sampleRate;
+    double cosW0 = std::cos(w0);
+    double alpha = std::sin(w0) / (2.0 * (frequency / bandwidth));
+
+    return normalized(
+        1.0 + alpha * a,
+        -2.0 * cosW0,
+        1.0 - alpha * a,
+        1.0 + alpha / a,
+        -2.0 * cosW0,
+        1.0 - alpha / a);
+}
+
+BiquadCoefficients BiquadCoefficients::highShelf(double sampleRate, double frequency, double q, double gainDb)
+{
+    double a = std::pow(10.0, gainDb / 40.0);
+    double w0 = 2.0 * M_PI * clampedFrequency(sampleRate, frequency) / sampleRate;
+    double cosW0 = std::cos(w0);
+    double alpha = std::sin(w0) / (2.0 * q);
+    double twoSqrtAAlpha = 2.0 * std::sqrt(a) * alpha;
+
+    return normalized(
+        a * ((a + 1.0) + (a - 1.0) * cosW0 + twoSqrtAAlpha),
+        -2.0 * a * ((a - 1.0) + (a + 1.0) * cosW0),
+        a * ((a + 1.0) + (a - 1.0) * cosW0 - twoSqrtAAlpha),
+        (a + 1.0) - (a - 1.0) * cosW0 + twoSqrtAAlpha,
+        2.0 * ((a - 1.0) - (a + 1.0) * cosW0),
+        (a + 1.0) - (a - 1.0) * cosW0 - twoSqrtAAlpha);
+}
+
+BiquadEqualizerBank::BiquadEqualizerBank(int laneCount) :
+    _laneCount(laneCount),
+    _b0(BandCount * laneCount),
+    _b1(BandCount * laneCount),
+    _b2(BandCount * laneCount),
+    _a1(BandCount * laneCount),
+    _a2(BandCount * laneCount),
+    _z1(BandCount * laneCount),
+    _z2(BandCount * laneCount),
+    _enabled(laneCount),
+    _block(BlockFrames * laneCount)
+{
+    for(int lane = 0; lane < laneCount; lane++) {
+        for(int band = 0; band < BandCount; band++) {
+            setCoefficients(lane, band, BiquadCoefficients::identity());
+        }
+        setEnabled(lane, false);
+    }
+    reset();
+}
+
+int BiquadEqualizerBank::laneCount() const
+{
+    return _laneCount;
+}
+
+void BiquadEqualizerBank::setCoefficients(int lane, int band, const BiquadCoefficients& coefficients)
+{
+    int index = band * _laneCount + lane;
+    _b0[index] = coefficients.b0;
+    _b1[index] = coefficients.b1;
+    _b2[index] = coefficients.b2;
+    _a1[index] = coefficients.a1;
+    _a2[index] = coefficients.a2;
+}
+
+void BiquadEqualizerBank::setEnabled(int lane, bool enabled)
+{
+    _enabled[lane] = enabled;
+}
+
+void BiquadEqualizerBank::reset()
+{
+    _z1.fill(0.0f);
+    _z2.fill(0.0f);
+}
+
+void BiquadEqualizerBank::reset(int firstLane, int laneCount)
+{
+    for(int band = 0; band < BandCount; band++) {
+        int index = band * _laneCount + firstLane;
+        memset(_z1.data() + index, 0, laneCount * sizeof(float));
+        memset(_z2.data() + index, 0, laneCount * sizeof(float));
+    }
+}
+
+void BiquadEqualizerBank::process(float *const *buffers, int frames, int firstLane, int laneCount)
+{
+    // Each lane group transposes into its own region, so groups never share cache lines
+    float *block = _block.data() + firstLane * BlockFrames;
+
+    for(int offset = 0; offset < frames; offset += BlockFrames) {
+        int blockFrames = qMin((int)BlockFrames, frames - offset);
+
+        // Transpose into frame-major order, so all lanes of one frame are adjacent
+        for(int lane = 0; lane < laneCount; lane++) {
+            const float *source = buffers[firstLane + lane] + offset;
+            for(int frame = 0; frame < blockFrames; frame++) {
+                block[frame * laneCount + lane] = source[frame];
+            }
+        }
+
+        // Run all bands on all lanes, transposed direct form II. The inner loop over
+        // the lanes is free of dependencies and gets vectorized by the compiler.
+        for(int band = 0; band < BandCount; band++) {
+            int index = band * _laneCount + firstLane;
+            const float * __restrict b0 = _b0.constData() + index;
+            const float * __restrict b1 = _b1.constData() + index;
+            const float * __restrict b2 = _b2.constData() + index;
+            const float * __restrict a1 = _a1.constData() + index;
+            const float * __restrict a2 = _a2.constData() + index;
+            float * __restrict z1 = _z1.data() + index;
+            float * __restrict z2 = _z2.data() + index;
+
+            for(int frame = 0; frame < blockFrames; frame++) {
+                float * __restrict samples = block + frame * laneCount;
+                for(int lane = 0; lane < laneCount; lane++) {
+                    float x = samples[lane];
+                    float y = b0[lane] * x + z1[lane];
+                    z1[lane] = b1[lane] * x - a1[lane] * y + z2[lane];
+                    z2[lane] = b2[lane] * x - a2[lane] * y;
+                    samples[lane] = y;
+                }
+            }
+        }
+
+        // Transpose back for all enabled lanes
+        for(int lane = 0; lane < laneCount; lane++) {
+            if(!_enabled[firstLane + lane]) {
+                continue;
+            }
+            float *target = buffers[firstLane + lane] + offset;
+            for(int frame = 0; frame < blockFrames; frame++) {
+                target[frame] = block[frame * laneCount + lane];
+            }
+        }
+    }
+}
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BIQUADEQUALIZER_H
+#define BIQUADEQUALIZER_H
+
+// Qt includes
+#include <QVector>
+
+/**
+ * Normalized coefficients of a biquad filter section, designed after the
+ * "Audio EQ Cookbook" by Robert Bristow-Johnson.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct BiquadCoefficients
+{
+    float b0, b1, b2, a1, a2;
+
+    /** @returns coefficients that pass the signal unaltered. */
+    static BiquadCoefficients identity();
+    /** @returns a low shelf at frequency (Hz) with the given Q and gain (dB). */
+    static BiquadCoefficients lowShelf(double sampleRate, double frequency, double q, double gainDb);
+    /** @returns a peaking band at frequency (Hz) with the given bandwidth (Hz) and gain (dB). */
+    static BiquadCoefficients band(double sampleRate, double frequency, double bandwidth, double gainDb);
+    /** @returns a high shelf at frequency (Hz) with the given Q and gain (dB). */
+    static BiquadCoefficients highShelf(double sampleRate, double frequency, double q, double gainDb);
+};
+
+/**
+ * Zero-latency equalizer that processes many channels at once. Each channel
+ * is a lane running three biquad sections in series (low shelf, band, high
+ * shelf). All coefficients and filter states are kept in a structure of
+ * arrays layout, so the inner loop runs across channels and each SIMD lane
+ * handles one channel.
+ *
+ * Lanes can be processed in independent groups, for example on different
+ * worker threads, as long as the groups do not overlap.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class BiquadEqualizerBank
+{
+public:
+    enum {
+        LowShelf = 0,
+        Band = 1,
+        HighShelf = 2,
+        BandCount = 3,
+        /** Number of frames transposed and filtered at once. */
+        BlockFrames = 64,
+        /** Lanes per group when splitting the work, a multiple of the widest SIMD register. */
+        LaneGroupSize = 16
+    };
+
+    /** Constructor */
+    explicit BiquadEqualizerBank(int laneCount);
+
+    /** @returns the number of lanes. */
+    int laneCount() const;
+
+    /** Sets the coefficients for a band of the given lane. Realtime safe. */
+    void setCoefficients(int lane, int band, const BiquadCoefficients& coefficients);
+
+    /**
+     * Enables or disables writing back the filtered signal of a lane. A
+     * disabled lane keeps filtering its input, so it can be switched on
+     * again without a transient. Realtime safe.
+     */
+    void setEnabled(int lane, bool enabled);
+
+    /** Clears the filter state of all lanes. */
+    void reset();
+
+    /** Clears the filter state of lanes firstLane to firstLane + laneCount - 1. Realtime safe. */
+    void reset(int firstLane, int laneCount);
+
+    /**
+     * Filters the buffers of lanes firstLane to firstLane + laneCount - 1 in place.
+     * @param buffers Buffer for each lane, indexed by lane.
+     * @param frames Number of frames in each buffer.
+     */
+    void process(float *const *buffers, int frames, int firstLane, int laneCount);
+
+private:
+    int _laneCount;
+
+    /** Coefficients, indexed by band * _laneCount + lane. */
+    QVector<float> _b0, _b1, _b2, _a1, _a2;
+    /** Filter states, indexed by band * _laneCount + lane. */
+    QVector<float> _z1, _z2;
+    /** Whether the result of a lane is written back. */
+    QVector<char> _enabled;
+    /** Transposed samples, lane group starting at lane n uses the region at n * BlockFrames. */
+    QVector<float> _block;
+};
+
+#endif // BIQUADEQUALIZER_H
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "buffermixerports.h"
+#include "sampleops.h"
+
+BufferMixerPorts::BufferMixerPorts(int channelCount, int subgroupCount, int frames) :
+    _channelCount(channelCount),
+    _subgroupCount(subgroupCount),
+    _buffers(3 * channelCount + subgroupCount + 2)
+{
+    _buffers.suspend();
+    _buffers.resize(frames);
+    _buffers.resume();
+}
+
+float *BufferMixerPorts::channelInput(int channel)
+{
+    return _buffers.buffer(channel);
+}
+
+float *BufferMixerPorts::auxBuffer(int channel)
+{
+    return _buffers.buffer(_channelCount + channel);
+}
+
+float *BufferMixerPorts::channelOutput(int channel)
+{
+    return _buffers.buffer(2 * _channelCount + channel);
+}
+
+float *BufferMixerPorts::subgroupOutput(int subgroup)
+{
+    return _buffers.buffer(3 * _channelCount + subgroup);
+}
+
+float *BufferMixerPorts::mainOutput(int main)
+{
+    return _buffers.buffer(3 * _channelCount + _subgroupCount + main);
+}
+
+void BufferMixerPorts::readChannelInput(int channel, float *target, int frames)
+{
+    memcpy(target, channelInput(channel), frames * sizeof(float));
+}
+
+void BufferMixerPorts::writeChannelOutput(int channel, const float *source, int frames)
+{
+    memcpy(channelOutput(channel), source, frames * sizeof(float));
+}
+
+float *BufferMixerPorts::channelOutputBuffer(int channel)
+{
+    return channelOutput(channel);
+}
+
+void BufferMixerPorts::writeAuxSend(int channel, const float *source, int frames)
+{
+    memcpy(auxBuffer(channel), source, frames * sizeof(float));
+}
+
+void BufferMixerPorts::readAuxReturn(int channel, float *target, int frames)
+{
+    memcpy(target, auxBuffer(channel), frames * sizeof(float));
+}
+
+void BufferMixerPorts::writeSubgroupOutput(int subgroup, const float *source, int frames)
+{
+    memcpy(subgroupOutput(subgroup), source, frames * sizeof(float));
+}
+
+void BufferMixerPorts::writeMainOutput(int main, const float *source, int frames)
+{
+    memcpy(mainOutput(main), source, frames * sizeof(float));
+}
+
+void BufferMixerPorts::clearChannelOutput(int channel, int frames)
+{
+    clearSamples(channelOutput(channel), frames);
+}
+
+void BufferMixerPorts::clearAuxSend(int channel, int frames)
+{
+    clearSamples(auxBuffer(channel), frames);
+}
+
+void BufferMixerPorts::clearSubgroupOutput(int subgroup, int frames)
+{
+    clearSamples(subgroupOutput(subgroup), frames);
+}
+
+void BufferMixerPorts::clearMainOutput(int main, int frames)
+{
+    clearSamples(mainOutput(main), frames);
+}
+
+void BufferMixerPorts::clearOutputs(int frames)
+{
+    for(int i = 0; i < _channelCount; i++) {
+        clearSamples(channelOutput(i), frames);
+    }
+    for(int i = 0; i < _subgroupCount; i++) {
+        clearSamples(subgroupOutput(i), frames);
+    }
+    clearSamples(mainOutput(0), frames);
+    clearSamples(mainOutput(1), frames);
+}
@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BUFFERMIXERPORTS_H
+#define BUFFERMIXERPORTS_H
+
+// Own includes
+#include "mixerports.h"
+#include "scratcharena.h"
+
+/**
+ * Mixer ports backed by plain memory, used to run the mixer engine without
+ * JACK. Inputs are filled and outputs are picked up between two periods by
+ * the owner. Aux sends are looped back to the aux returns, since there is no
+ * external effect to send to.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class BufferMixerPorts : public MixerPorts
+{
+public:
+    /** Allocates buffers of the given number of frames for all ports. */
+    BufferMixerPorts(int channelCount, int subgroupCount, int frames);
+
+    /** @returns the input buffer of a channel, to be filled before each period. */
+    float *channelInput(int channel);
+    /** @returns the direct out buffer of a channel. */
+    float *channelOutput(int channel);
+    /** @returns the output buffer of a subgroup. */
+    float *subgroupOutput(int subgroup);
+    /** @returns the buffer of a main output, 0 is left, 1 is right. */
+    float *mainOutput(int main);
+
+    /** @overload */
+    void readChannelInput(int channel, float *target, int frames);
+    /** @overload */
+    void writeChannelOutput(int channel, const float *source, int frames);
+    /** @overload */
+    float *channelOutputBuffer(int channel);
+    /** @overload */
+    void writeAuxSend(int channel, const float *source, int frames);
+    /** @overload */
+    void readAuxReturn(int channel, float *target, int frames);
+    /** @overload */
+    void writeSubgroupOutput(int subgroup, const float *source, int frames);
+    /** @overload */
+    void writeMainOutput(int main, const float *source, int frames);
+    /** @overload */
+    void clearChannelOutput(int channel, int frames);
+    /** @overload */
+    void clearAuxSend(int channel, int frames);
+    /** @overload */
+    void clearSubgroupOutput(int subgroup, int frames);
+    /** @overload */
+    void clearMainOutput(int main, int frames);
+    /** @overload */
+    void clearOutputs(int frames);
+
+private:
+    /** @returns the aux loopback buffer of a channel. */
+    float *auxBuffer(int channel);
+
+    int _channelCount;
+    int _subgroupCount;
+
+    /**
+     * Memory for all ports: channel inputs, aux loopbacks and channel
+     * outputs for each channel, followed by the subgroups and main left and
+     * right.
+     */
+    ScratchArena _buffers;
+};
+
+#endif // BUFFERMIXERPORTS_H
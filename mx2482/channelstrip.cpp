@@ -0,0 +1,467 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "channelstrip.h"
+#include "sampleops.h"
+
+ChannelStrip::ChannelStrip(int channel, MixerPorts *mixerPorts) :
+    _channel(channel),
+    _mixerPorts(mixerPorts),
+    _silenceThreshold(0.0f),
+    _silenceHoldPeriods(0),
+    _silentPeriods(0),
+    _inputSilent(false),
+    _inputGain(0.0f),
+    _auxSendGain(0.0f),
+    _auxReturnGain(0.0f),
+    _faderGain(0.0f),
+    _automationPlayer(0),
+    _recordRing(0),
+    _playbackRing(0),
+    _stageTracer(0),
+    _insertEffect(0),
+    _equalizer(0),
+    _equalizerBuffer(0),
+    _lowsEqControl(0),
+    _midsEqControl(0),
+    _highsEqControl(0),
+    _directOutTap(MixerOptions::PostFaderTap),
+    _scratch(0),
+    _buffer(0),
+    _busBuffer(0),
+    _inDirectOut(false),
+    _directOutWritten(false),
+    _foldsFader(false),
+    _configuration(0),
+    _variant(&_variants[0])
+{
+}
+
+ChannelStrip::~ChannelStrip()
+{
+    setFFTEqualizerEnabled(false, 0);
+    delete _insertEffect;
+}
+
+/** Variants of the strip, indexed by configuration. */
+#define CHANNELSTRIP_VARIANT(configuration) { \
+    &ChannelStrip::processVariant<configuration>, \
+    &ChannelStrip::processInputStages<configuration>, \
+    &ChannelStrip::processOutputStages<configuration> }
+
+const ChannelStrip::Variant ChannelStrip::_variants[ConfigurationCount] = {
+    CHANNELSTRIP_VARIANT(0),  CHANNELSTRIP_VARIANT(1),  CHANNELSTRIP_VARIANT(2),  CHANNELSTRIP_VARIANT(3),
+    CHANNELSTRIP_VARIANT(4),  CHANNELSTRIP_VARIANT(5),  CHANNELSTRIP_VARIANT(6),  CHANNELSTRIP_VARIANT(7),
+    CHANNELSTRIP_VARIANT(8),  CHANNELSTRIP_VARIANT(9),  CHANNELSTRIP_VARIANT(10), CHANNELSTRIP_VARIANT(11),
+    CHANNELSTRIP_VARIANT(12), CHANNELSTRIP_VARIANT(13), CHANNELSTRIP_VARIANT(14), CHANNELSTRIP_VARIANT(15),
+    CHANNELSTRIP_VARIANT(16), CHANNELSTRIP_VARIANT(17), CHANNELSTRIP_VARIANT(18), CHANNELSTRIP_VARIANT(19),
+    CHANNELSTRIP_VARIANT(20), CHANNELSTRIP_VARIANT(21), CHANNELSTRIP_VARIANT(22), CHANNELSTRIP_VARIANT(23),
+    CHANNELSTRIP_VARIANT(24), CHANNELSTRIP_VARIANT(25), CHANNELSTRIP_VARIANT(26), CHANNELSTRIP_VARIANT(27),
+    CHANNELSTRIP_VARIANT(28), CHANNELSTRIP_VARIANT(29), CHANNELSTRIP_VARIANT(30), CHANNELSTRIP_VARIANT(31)
+};
+
+#undef CHANNELSTRIP_VARIANT
+
+void ChannelStrip::process(float *scratch, int frames, const ChannelState& channelState,
+                           const CrossfadeStep& crossfadeStep)
+{
+    beginPeriod(scratch, channelState);
+    (this->*_variant->process)(_buffer, frames, channelState, crossfadeStep);
+}
+
+void ChannelStrip::processInput(float *scratch, int frames, const ChannelState& channelState,
+                                const CrossfadeStep& crossfadeStep)
+{
+    beginPeriod(scratch, channelState);
+    StageScope stageScope(_stageTracer, StageTracer::ChannelInput, _channel);
+    if(readInput(_buffer, frames)) {
+        (this->*_variant->processInputStages)(_buffer, frames, channelState, crossfadeStep);
+    }
+}
+
+void ChannelStrip::processEqualizer(float *buffer, int frames, const ChannelState& channelState)
+{
+    if(!_equalizer) {
+        return;
+    }
+
+    StageScope stageScope(_stageTracer, StageTracer::ChannelEqualizer, _channel);
+    updateEqualizerControls(channelState);
+    writeSamples(buffer, *_equalizerBuffer, frames);
+    _equalizer->process(*_equalizerBuffer);
+    readSamples(*_equalizerBuffer, buffer, frames);
+}
+
+void ChannelStrip::processOutput(int frames, const ChannelState& channelState, const CrossfadeStep& crossfadeStep)
+{
+    if(isIdle()) {
+        if(!processIdleOutput(_buffer, frames, channelState, crossfadeStep)) {
+            return;
+        }
+    } else {
+        (this->*_variant->processOutputStages)(_buffer, frames, channelState, crossfadeStep);
+    }
+    writeOutput(frames);
+}
+
+float *ChannelStrip::buffer() const
+{
+    return _buffer;
+}
+
+const float *ChannelStrip::busBuffer() const
+{
+    return _busBuffer;
+}
+
+bool ChannelStrip::foldsFader() const
+{
+    return _foldsFader;
+}
+
+int ChannelStrip::configuration() const
+{
+    return _configuration;
+}
+
+void ChannelStrip::beginPeriod(float *scratch, const ChannelState& channelState)
+{
+    _scratch = scratch;
+    float *directOut = _mixerPorts->channelOutputBuffer(_channel);
+    _inDirectOut = directOut != 0;
+    _buffer = _inDirectOut ? directOut : scratch;
+    _busBuffer = _buffer;
+    _directOutWritten = false;
+    selectVariant(channelState);
+}
+
+void ChannelStrip::selectVariant(const ChannelState& channelState)
+{
+    int configuration = 0;
+    if(channelState.equalizerOn && _equalizer) {
+        configuration |= EqualizerOn;
+    }
+    if(channelState.auxOn) {
+        configuration |= AuxOn;
+    }
+    if(channelState.insertOn && _insertEffect) {
+        configuration |= InsertOn;
+    }
+
+    // A gain stage that stays at unity does nothing. Automation may move it at any frame, though.
+    bool automated = _automationPlayer && _automationPlayer->isPlaying();
+    if(!automated && _inputGain == 1.0f && channelState.inputGain == 1.0f) {
+        configuration |= UnityInputGain;
+    }
+
+    // With the direct out before the fader, the routing applies the fader along with the bus
+    // gains, so the buses can be fed from the direct out as well
+    _foldsFader = _directOutTap == MixerOptions::PreFaderTap && !automated;
+    if(_foldsFader || (!automated && _faderGain == 1.0f && channelState.faderGain == 1.0f)) {
+        configuration |= UnityFaderGain;
+    }
+
+    if(configuration != _configuration) {
+        _configuration = configuration;
+        _variant = &_variants[configuration];
+    }
+}
+
+template <int Configuration>
+void ChannelStrip::processVariant(float *buffer, int frames, const ChannelState& channelState,
+                                  const CrossfadeStep& crossfadeStep)
+{
+    StageScope inputScope(_stageTracer, StageTracer::ChannelInput, _channel);
+    if(readInput(buffer, frames)) {
+        processInputStages<Configuration>(buffer, frames, channelState, crossfadeStep);
+        inputScope.finish();
+        if(Configuration & EqualizerOn) {
+            processEqualizer(buffer, frames, channelState);
+        }
+        processOutputStages<Configuration>(buffer, frames, channelState, crossfadeStep);
+    } else if(!processIdleOutput(buffer, frames, channelState, crossfadeStep)) {
+        return;
+    }
+    writeOutput(frames);
+}
+
+template <int Configuration>
+void ChannelStrip::processInputStages(float *buffer, int frames, const ChannelState& channelState,
+                                      const CrossfadeStep& crossfadeStep)
+{
+    // Process input stage
+    if(!(Configuration & UnityInputGain)) {
+        applyStageGain(buffer, frames, AutomationEvent::ChannelInputGain,
+                       _inputGain, channelState.inputGain, crossfadeStep);
+    }
+}
+
+template <int Configuration>
+void ChannelStrip::processOutputStages(float *buffer, int frames, const ChannelState& channelState,
+                                       const CrossfadeStep& crossfadeStep)
+{
+    // Run the insert effect inline, without any additional latency
+    if(Configuration & InsertOn) {
+        StageScope stageScope(_stageTracer, StageTracer::ChannelInsert, _channel);
+        _insertEffect->process(buffer, frames);
+    }
+
+    // Check if aux send/return is activated and process
+    if(Configuration & AuxOn) {
+        StageScope stageScope(_stageTracer, StageTracer::ChannelAux, _channel);
+        // Attenuate signal
+        applyStageGain(buffer, frames, AutomationEvent::ChannelAuxSendGain,
+                       _auxSendGain, channelState.auxSendGain, crossfadeStep);
+        // Send signal
+        _mixerPorts->writeAuxSend(_channel, buffer, frames);
+        // Take received signal
+        _mixerPorts->readAuxReturn(_channel, buffer, frames);
+        // Attenuate signal
+        applyStageGain(buffer, frames, AutomationEvent::ChannelAuxReturnGain,
+                       _auxReturnGain, channelState.auxReturnGain, crossfadeStep);
+    }
+
+    // Process fader stage
+    if(!(Configuration & UnityFaderGain)) {
+        processFader(frames, channelState, crossfadeStep);
+    }
+}
+
+void ChannelStrip::processFader(int frames, const ChannelState& channelState, const CrossfadeStep& crossfadeStep)
+{
+    StageScope stageScope(_stageTracer, StageTracer::ChannelFader, _channel);
+    // Tap the direct out before the fader. A strip working in its direct out fades a copy.
+    if(_directOutTap == MixerOptions::PreFaderTap) {
+        if(_inDirectOut) {
+            memcpy(_scratch, _buffer, frames * sizeof(float));
+            _busBuffer = _scratch;
+        } else {
+            _mixerPorts->writeChannelOutput(_channel, _buffer, frames);
+            _directOutWritten = true;
+        }
+    }
+    applyStageGain(_busBuffer, frames, AutomationEvent::ChannelFaderGain,
+                   _faderGain, channelState.faderGain, crossfadeStep);
+}
+
+bool ChannelStrip::readInput(float *buffer, int frames)
+{
+    // Copy the hardware input into the working buffer, so we do not alter the sample in the
+    // input buffer, which may effect other applications connected to the same input.
+    // During a virtual soundcheck the input comes from a recorded track instead.
+    if(_playbackRing) {
+        _playbackRing->read(buffer, frames);
+    } else {
+        _mixerPorts->readChannelInput(_channel, buffer, frames);
+    }
+    if(_recordRing) {
+        _recordRing->write(buffer, frames);
+    }
+
+    // Any signal on the input wakes the strip up
+    _inputSilent = _silenceHoldPeriods > 0 && isSilent(buffer, frames, _silenceThreshold);
+    if(!_inputSilent) {
+        _silentPeriods = 0;
+    }
+
+    // An idle strip passes on pure silence, so everything downstream can skip it
+    if(isIdle()) {
+        clearSamples(buffer, frames);
+        return false;
+    }
+    return true;
+}
+
+bool ChannelStrip::processIdleOutput(float *buffer, int frames, const ChannelState& channelState,
+                                     const CrossfadeStep& crossfadeStep)
+{
+    // There is nothing to send, but an external effect may still return its tail
+    if(channelState.auxOn) {
+        _mixerPorts->clearAuxSend(_channel, frames);
+        _mixerPorts->readAuxReturn(_channel, buffer, frames);
+    }
+    if(!channelState.auxOn || isSilent(buffer, frames, _silenceThreshold)) {
+        clearSamples(buffer, frames);
+        _mixerPorts->clearChannelOutput(_channel, frames);
+        return false;
+    }
+
+    // Wake up and continue with the returned signal
+    _silentPeriods = 0;
+    applyStageGain(buffer, frames, AutomationEvent::ChannelAuxReturnGain,
+                   _auxReturnGain, channelState.auxReturnGain, crossfadeStep);
+    if(!(_configuration & UnityFaderGain)) {
+        processFader(frames, channelState, crossfadeStep);
+    }
+    return true;
+}
+
+void ChannelStrip::writeOutput(int frames)
+{
+    // Transfer data to channel direct out, unless the strip has worked in it or tapped it already
+    if(!_inDirectOut && !_directOutWritten) {
+        _mixerPorts->writeChannelOutput(_channel, _buffer, frames);
+    }
+
+    // Count the periods both the input and the processed signal have been silent for, so
+    // equalizer and aux tails can decay before the strip goes idle
+    if(_inputSilent && isSilent(_busBuffer, frames, _silenceThreshold)) {
+        if(_silentPeriods < _silenceHoldPeriods) {
+            _silentPeriods++;
+        }
+    } else {
+        _silentPeriods = 0;
+    }
+}
+
+void ChannelStrip::setInsertEffect(InsertEffect *insertEffect)
+{
+    delete _insertEffect;
+    _insertEffect = insertEffect;
+}
+
+void ChannelStrip::setAutomationPlayer(AutomationPlayer *automationPlayer)
+{
+    _automationPlayer = automationPlayer;
+}
+
+void ChannelStrip::setRecordRing(SampleRing *recordRing)
+{
+    _recordRing = recordRing;
+}
+
+void ChannelStrip::setPlaybackRing(SampleRing *playbackRing)
+{
+    _playbackRing = playbackRing;
+}
+
+void ChannelStrip::setStageTracer(StageTracer *stageTracer)
+{
+    _stageTracer = stageTracer;
+}
+
+void ChannelStrip::setSilenceDetection(float threshold, int holdPeriods)
+{
+    _silenceThreshold = threshold;
+    _silenceHoldPeriods = holdPeriods;
+    _silentPeriods = 0;
+    _inputSilent = false;
+}
+
+void ChannelStrip::setDirectOutTap(MixerOptions::DirectOutTap directOutTap)
+{
+    _directOutTap = directOutTap;
+}
+
+bool ChannelStrip::isIdle() const
+{
+    return _silenceHoldPeriods > 0 && _silentPeriods >= _silenceHoldPeriods;
+}
+
+void ChannelStrip::setFFTEqualizerEnabled(bool enabled, int frames)
+{
+    if(!enabled) {
+        if(_equalizerBuffer) {
+            _equalizerBuffer->releaseMemoryBuffer();
+        }
+        delete _equalizerBuffer;
+        delete _equalizer;
+        _equalizerBuffer = 0;
+        _equalizer = 0;
+        _lowsEqControl = 0;
+        _midsEqControl = 0;
+        _highsEqControl = 0;
+        return;
+    }
+
+    if(_equalizer) {
+        return;
+    }
+
+    // Create equalizer
+    _equalizer = new QEqualizer(256, 128);
+    _equalizerBuffer = new QSampleBuffer(QSampleBuffer::createMemoryAudioBuffer(frames));
+
+    // Create equalizer controls
+    _equalizerState = ChannelState();
+
+    _lowsEqControl = _equalizer->createEqualizerControl(QEqualizerControl::LowShelf);
+    _lowsEqControl->setAmount(_equalizerState.lowAmount);
+    _lowsEqControl->setControlFrequency(_equalizerState.lowFrequency);
+    _lowsEqControl->setQ(ChannelState::LowShelfQ);
+
+    _midsEqControl = _equalizer->createEqualizerControl(QEqualizerControl::Band);
+    _midsEqControl->setAmount(_equalizerState.midAmount);
+    _midsEqControl->setControlFrequency(_equalizerState.midFrequency);
+    _midsEqControl->setBandwidth(ChannelState::MidBandwidth);
+
+    _highsEqControl = _equalizer->createEqualizerControl(QEqualizerControl::HighShelf);
+    _highsEqControl->setAmount(_equalizerState.highAmount);
+    _highsEqControl->setControlFrequency(ChannelState::HighShelfFrequency);
+    _highsEqControl->setQ(ChannelState::HighShelfQ);
+
+    _equalizer->update();
+}
+
+void ChannelStrip::resizeBuffers(int frames)
+{
+    if(_insertEffect) {
+        _insertEffect->resizeBuffers(frames);
+    }
+
+    if(_equalizerBuffer) {
+        _equalizerBuffer->releaseMemoryBuffer();
+        *_equalizerBuffer = QSampleBuffer::createMemoryAudioBuffer(frames);
+    }
+}
+
+void ChannelStrip::updateEqualizerControls(const ChannelState& channelState)
+{
+    if(channelState.lowAmount != _equalizerState.lowAmount) {
+        _lowsEqControl->setAmount(channelState.lowAmount);
+    }
+    if(channelState.lowFrequency != _equalizerState.lowFrequency) {
+        _lowsEqControl->setControlFrequency(channelState.lowFrequency);
+    }
+    if(channelState.midAmount != _equalizerState.midAmount) {
+        _midsEqControl->setAmount(channelState.midAmount);
+    }
+    if(channelState.midFrequency != _equalizerState.midFrequency) {
+        _midsEqControl->setControlFrequency(channelState.midFrequency);
+    }
+    if(channelState.highAmount != _equalizerState.highAmount) {
+        _highsEqControl->setAmount(channelState.highAmount);
+    }
+    _equalizerState = channelState;
+}
+
+void ChannelStrip::applyStageGain(float *buffer, int frames, AutomationEvent::Parameter parameter,
+                                  float& gain, float target, const CrossfadeStep& crossfadeStep)
+{
+    if(_automationPlayer
+            && _automationPlayer->applyGain(_automationPlayer->lane(parameter, _channel), buffer, frames, gain)) {
+        return;
+    }
+    crossfadeStep.applyGain(buffer, frames, gain, target);
+}
@@ -0,0 +1,333 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CHANNELSTRIP_H
+#define CHANNELSTRIP_H
+
+// QJackAudio includes
+#include <QEqualizer>
+#include <QEqualizerControl>
+#include <QSampleBuffer>
+
+// Own includes
+#include "mixerstate.h"
+#include "mixerports.h"
+#include "inserteffect.h"
+#include "sampleops.h"
+#include "automationplayer.h"
+#include "mixeroptions.h"
+#include "samplering.h"
+#include "stagetracer.h"
+
+/**
+ * Audio processing of a single channel mixer line: input stage, equalizer,
+ * insert effect, aux send/return, fader and direct out. This holds no widgets and can be
+ * used without a JACK server.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class ChannelStrip
+{
+public:
+    /**
+     * Switches and gain stages a variant of the strip is specialized for.
+     * Each combination has its own variant without any branches on these.
+     */
+    enum Configuration {
+        /** The FFT equalizer is on. */
+        EqualizerOn = 1,
+        /** Aux send and return are on. */
+        AuxOn = 2,
+        /** The insert slot is filled and on. */
+        InsertOn = 4,
+        /** Input gain is and stays at unity, so the stage is skipped. */
+        UnityInputGain = 8,
+        /**
+         * Fader gain is and stays at unity, or the routing applies it, so
+         * the stage is skipped.
+         */
+        UnityFaderGain = 16,
+        ConfigurationCount = 32
+    };
+
+    /**
+     * Constructor.
+     * @param channel Index of this channel on the mixer ports, starting at 0.
+     * @param mixerPorts Ports to read from and write to, not owned.
+     */
+    ChannelStrip(int channel, MixerPorts *mixerPorts);
+    /** Destructor */
+    ~ChannelStrip();
+
+    /**
+     * Process this channel mixer line. This is the same as calling
+     * processInput(), processEqualizer() if the equalizer is on and
+     * processOutput() in a row. The variant of the strip is selected from
+     * the configuration in channelState, whenever it changes.
+     *
+     * If the mixer ports provide the memory of the direct out, the strip
+     * is processed right in it and the buses are fed from there, see
+     * buffer() and busBuffer().
+     * @param scratch Working buffer provided by the mixer, used if the strip
+     * cannot work in its direct out or needs a copy for the fader.
+     * @param frames Number of frames in this period.
+     * @param channelState Parameters to be used for this period.
+     * @param crossfadeStep How far the gains move towards channelState in this period.
+     */
+    void process(float *scratch, int frames, const ChannelState& channelState, const CrossfadeStep& crossfadeStep);
+
+    /** Processes the stages before the equalizer: reads the input and applies the input gain. */
+    void processInput(float *scratch, int frames, const ChannelState& channelState, const CrossfadeStep& crossfadeStep);
+
+    /** Processes the FFT equalizer of this channel, which must have been enabled. */
+    void processEqualizer(float *buffer, int frames, const ChannelState& channelState);
+
+    /**
+     * Processes the stages after the equalizer: insert, aux, fader and
+     * direct out, in the buffer and with the variant selected by
+     * processInput().
+     */
+    void processOutput(int frames, const ChannelState& channelState, const CrossfadeStep& crossfadeStep);
+
+    /**
+     * @returns the buffer the strip works in during this period: its direct
+     * out or the scratch buffer. Valid after processInput().
+     */
+    float *buffer() const;
+
+    /**
+     * @returns the signal the buses are fed with. Valid after processOutput()
+     * and until the next period.
+     */
+    const float *busBuffer() const;
+
+    /**
+     * @returns true, if the fader has not been applied to busBuffer(), so
+     * the routing has to apply it. This is the case with the direct out
+     * tapped before the fader, unless automation is playing.
+     */
+    bool foldsFader() const;
+
+    /**
+     * Selects where the direct out is tapped. Must only be called while
+     * processing is suspended.
+     */
+    void setDirectOutTap(MixerOptions::DirectOutTap directOutTap);
+
+    /**
+     * Puts an effect into the insert slot, replacing and deleting the
+     * previous one. Must only be called while processing is suspended.
+     * @param insertEffect Effect to be owned by the strip, 0 to empty the slot.
+     */
+    void setInsertEffect(InsertEffect *insertEffect);
+
+    /**
+     * Lets the gain stages follow their automation lanes. Must only be
+     * called from the realtime thread between periods, or while processing
+     * is suspended.
+     * @param automationPlayer Player to be used, not owned. 0 for none.
+     */
+    void setAutomationPlayer(AutomationPlayer *automationPlayer);
+
+    /**
+     * Records the input, as it has been read before any processing, into
+     * a ring in each period. Must only be called from the realtime thread
+     * between periods, or while processing is suspended.
+     * @param recordRing Ring to be written, not owned. 0 to stop recording.
+     */
+    void setRecordRing(SampleRing *recordRing);
+
+    /**
+     * Reads the input from a ring instead of the mixer ports in each
+     * period, for a virtual soundcheck. Must only be called from the
+     * realtime thread between periods, or while processing is suspended.
+     * @param playbackRing Ring to be read, not owned. 0 for the live input.
+     */
+    void setPlaybackRing(SampleRing *playbackRing);
+
+    /**
+     * Records the time spent in each stage. Must only be called from the
+     * realtime thread between periods, or while processing is suspended.
+     * @param stageTracer Tracer, not owned. 0 to stop tracing.
+     */
+    void setStageTracer(StageTracer *stageTracer);
+
+    /**
+     * Configures the detection of silent inputs. Once the input and the
+     * processed signal have stayed at or below threshold for holdPeriods
+     * periods, the strip goes idle: all stages are skipped and the outputs
+     * are silenced. Checking the processed signal lets equalizer and aux
+     * tails decay first. The strip wakes up as soon as the input or, with
+     * aux on, the aux return exceeds threshold. Must only be called while
+     * processing is suspended.
+     * @param threshold Linear threshold, 0 for digital silence only.
+     * @param holdPeriods Number of periods before going idle, 0 to never go idle.
+     */
+    void setSilenceDetection(float threshold, int holdPeriods);
+
+    /**
+     * @returns true, if the strip is idle. Its buffer is silent then and
+     * does not need to be routed. Valid after processInput().
+     */
+    bool isIdle() const;
+
+    /**
+     * Creates or destroys the FFT equalizer. Must not be called from the
+     * realtime thread and only while processing is suspended.
+     */
+    void setFFTEqualizerEnabled(bool enabled, int frames);
+
+    /**
+     * Reallocates internal buffers for a new buffer size. Must not be called
+     * from the realtime thread and only while processing is suspended.
+     */
+    void resizeBuffers(int frames);
+
+    /** @returns the configuration the current variant is specialized for. */
+    int configuration() const;
+
+private:
+    /** Processing functions of one variant. */
+    struct Variant {
+        void (ChannelStrip::*process)(float*, int, const ChannelState&, const CrossfadeStep&);
+        void (ChannelStrip::*processInputStages)(float*, int, const ChannelState&, const CrossfadeStep&);
+        void (ChannelStrip::*processOutputStages)(float*, int, const ChannelState&, const CrossfadeStep&);
+    };
+
+    /** Selects the buffers of this period and the variant to process them with. */
+    void beginPeriod(float *scratch, const ChannelState& channelState);
+    /** Switches to the variant for the configuration of channelState, if it has changed. */
+    void selectVariant(const ChannelState& channelState);
+
+    /** Whole strip, specialized for a configuration. */
+    template <int Configuration>
+    void processVariant(float *buffer, int frames, const ChannelState& channelState,
+                        const CrossfadeStep& crossfadeStep);
+    /** Gain stages before the equalizer, specialized for a configuration. */
+    template <int Configuration>
+    void processInputStages(float *buffer, int frames, const ChannelState& channelState,
+                            const CrossfadeStep& crossfadeStep);
+    /** Stages after the equalizer up to the fader, specialized for a configuration. */
+    template <int Configuration>
+    void processOutputStages(float *buffer, int frames, const ChannelState& channelState,
+                             const CrossfadeStep& crossfadeStep);
+
+    /**
+     * Reads the input and checks it for silence.
+     * @returns false, if the strip is idle. buffer has been cleared then.
+     */
+    bool readInput(float *buffer, int frames);
+    /**
+     * Processes the output stages of an idle strip, which only passes on
+     * what the aux return still brings in.
+     * @returns false, if the strip stays idle. Its outputs have been cleared then.
+     */
+    bool processIdleOutput(float *buffer, int frames, const ChannelState& channelState,
+                           const CrossfadeStep& crossfadeStep);
+    /** Processes the fader stage, tapping the direct out before it if selected. */
+    void processFader(int frames, const ChannelState& channelState, const CrossfadeStep& crossfadeStep);
+    /** Writes the direct out, if not done yet, and counts the silent periods. */
+    void writeOutput(int frames);
+
+    /** Hands over changed equalizer parameters to the FFT equalizer controls. */
+    void updateEqualizerControls(const ChannelState& channelState);
+
+    /**
+     * Applies a gain stage. The gain follows the automation lane of the
+     * parameter if it is automated, the crossfade towards target otherwise.
+     */
+    void applyStageGain(float *buffer, int frames, AutomationEvent::Parameter parameter,
+                        float& gain, float target, const CrossfadeStep& crossfadeStep);
+
+    int _channel;
+    MixerPorts *_mixerPorts;
+
+    /** Level at or below which the input is considered silent. */
+    float _silenceThreshold;
+    /** Number of silent periods after which the strip goes idle, 0 if never. */
+    int _silenceHoldPeriods;
+    /** Number of consecutive silent periods, up to the hold periods. */
+    int _silentPeriods;
+    /** Whether the input has been silent in the current period. */
+    bool _inputSilent;
+
+    /**
+     * Gains that have actually been applied at the end of the last period.
+     * They follow the mixer state, in steps during crossfades.
+     */
+    float _inputGain;
+    float _auxSendGain;
+    float _auxReturnGain;
+    float _faderGain;
+
+    /** Plays back automation, if any. */
+    AutomationPlayer *_automationPlayer;
+
+    /** Ring the input is recorded into, if any. */
+    SampleRing *_recordRing;
+    /** Ring the input is played back from instead of the mixer ports, if any. */
+    SampleRing *_playbackRing;
+    /** Tracer the stages are recorded with, if any. */
+    StageTracer *_stageTracer;
+
+    /** Effect in the insert slot, if any. */
+    InsertEffect *_insertEffect;
+
+    /** FFT equalizer for this channel, if enabled. */
+    QEqualizer *_equalizer;
+    /** Preallocated buffer the FFT equalizer operates on. */
+    QSampleBuffer *_equalizerBuffer;
+
+    /** EQ control for low frequencies. */
+    QEqualizerControl *_lowsEqControl;
+    /** EQ control for mid frequencies. */
+    QEqualizerControl *_midsEqControl;
+    /** EQ control for high frequencies. */
+    QEqualizerControl *_highsEqControl;
+
+    /** Parameters the FFT equalizer controls have been set to. */
+    ChannelState _equalizerState;
+
+    /** Point the direct out is tapped at. */
+    MixerOptions::DirectOutTap _directOutTap;
+    /** Scratch buffer of this period. */
+    float *_scratch;
+    /** Buffer the strip works in during this period. */
+    float *_buffer;
+    /** Buffer the buses are fed from in this period. */
+    float *_busBuffer;
+    /** Whether _buffer is the memory of the direct out. */
+    bool _inDirectOut;
+    /** Whether the direct out has been written in this period already. */
+    bool _directOutWritten;
+    /** Whether the routing applies the fader in this period. */
+    bool _foldsFader;
+
+    /** Configuration of the selected variant. */
+    int _configuration;
+    /** Selected variant. */
+    const Variant *_variant;
+    /** All variants, indexed by configuration. */
+    static const Variant _variants[ConfigurationCount];
+};
+
+#endif // CHANNELSTRIP_H
@@ -25,9 +25,9 @@
 #include "channelwidget.h"
 #include "ui_channelwidget.h"
 
-// QJackAudio includes
-#include <QSampleBuffer>
-#include <QUnits>
+// Qt includes
+#include <QAbstractButton>
+#include <QAbstractSlider>
 
 ChannelWidget::ChannelWidget(int channelNumber, QWidget *parent) :
     QWidget(parent),
@@ -38,131 +38,44 @@ ChannelWidget::ChannelWidget(int channelNumber, QWidget *parent) :
     // Set channel number in UI
     ui->channelNumberLabel->setText(QString("%1").arg(channelNumber));
 
-    // Create JACK ports
-    QJackClient *jackClient = QJackClient::instance();
-    _channelIn  = jackClient->registerAudioInPort (QString("ch%1_in")       .arg(channelNumber));
-    _auxSend    = jackClient->registerAudioOutPort(QString("ch%1_aux_send") .arg(channelNumber));
-    _auxReturn  = jackClient->registerAudioInPort (QString("ch%1_aux_ret")  .arg(channelNumber));
-    _channelOut = jackClient->registerAudioOutPort(QString("ch%1_out")      .arg(channelNumber));
-
-    // Create input and fader stage amplifiers
-    _inputStage = new QAmplifier();
-    _inputStage->setGain(ui->gainDial->value());
-
-    _faderStage = new QAmplifier();
-    _faderStage->setGain(ui->volumeVerticalSlider->value());
-
-    // Create aux pre and post amplifiers
-    _auxPre = new QAmplifier();
-    _auxPre->setGain(ui->auxSendDial->value());
-    _auxPost = new QAmplifier();
-    _auxPost->setGain(ui->auxReturnDial->value());
-
-    // Create equalizer
-    _equalizer = new QEqualizer(256, 128);
-
-    // Create equalizer controls
-    _lowsEqControl = _equalizer->createEqualizerControl(QEqualizerControl::LowShelf);
-    _lowsEqControl->setAmount(ui->loDial->value());
-    _lowsEqControl->setControlFrequency(ui->loFreqDial->value());
-    _lowsEqControl->setQ(1.2);
-
-    _midsEqControl = _equalizer->createEqualizerControl(QEqualizerControl::Band);
-    _midsEqControl->setAmount(ui->midDial->value());
-    _midsEqControl->setControlFrequency(ui->midFreqDial->value());
-    _midsEqControl->setBandwidth(500.0);
-
-    _highsEqControl = _equalizer->createEqualizerControl(QEqualizerControl::HighShelf);
-    _highsEqControl->setAmount(ui->hiDial->value());
-    _highsEqControl->setControlFrequency(12000);
-    _highsEqControl->setQ(0.5);
-
-    _equalizer->update();
-
-    // Connect UI elements to widgets
-    connect(ui->gainDial, SIGNAL(valueChanged(int)), _inputStage, SLOT(setGain(int)));
-    connect(ui->volumeVerticalSlider, SIGNAL(valueChanged(int)), _faderStage, SLOT(setGain(int)));
-
-    connect(ui->loDial, SIGNAL(valueChanged(int)), _lowsEqControl, SLOT(setAmount(int)));
-    connect(ui->loFreqDial, SIGNAL(valueChanged(int)), _lowsEqControl, SLOT(setControlFrequency(int)));
-
-    connect(ui->midDial, SIGNAL(valueChanged(int)), _midsEqControl, SLOT(setAmount(int)));
-    connect(ui->midFreqDial, SIGNAL(valueChanged(int)), _midsEqControl, SLOT(setControlFrequency(int)));
-
-    connect(ui->hiDial, SIGNAL(valueChanged(int)), _highsEqControl, SLOT(setAmount(int)));
-}
-
-ChannelWidget::~ChannelWidget()
-{
-    delete ui;
-}
-
-void ChannelWidget::process(QSampleBuffer targetSampleBuffer)
-{
-    // Get the hardware input buffer for this channel input
-    QSampleBuffer inputSampleBuffer = _channelIn->sampleBuffer();
-
-    // Copy all data to a memory buffer
-    inputSampleBuffer.copyTo(targetSampleBuffer);
-
-    // Process input stage amplifier
-    _inputStage->process(targetSampleBuffer);
-
-    // Check if EQ is activated and process
-    if(ui->equalizerOnPushButton->isChecked()) {
-        _equalizer->process(targetSampleBuffer);
+    // Report any change of controls, so the mixer can publish a new snapshot
+    foreach(QAbstractButton *button, findChildren<QAbstractButton*>()) {
+        connect(button, SIGNAL(toggled(bool)), this, SIGNAL(controlsChanged()));
     }
-
-    // Check if aux send/return is activated and process
-    if(ui->auxOnPushButton->isChecked()) {
-        // Attenuate signal
-        _auxPre->process(targetSampleBuffer);
-        // Send signal
-        targetSampleBuffer.copyTo(_auxSend->sampleBuffer());
-        // Take received signal
-        _auxReturn->sampleBuffer().copyTo(targetSampleBuffer);
-        // Attenuate signal
-        _auxPost->process(targetSampleBuffer);
+    foreach(QAbstractSlider *slider, findChildren<QAbstractSlider*>()) {
+        connect(slider, SIGNAL(valueChanged(int)), this, SIGNAL(controlsChanged()));
     }
-
-    // Process fader stage amplifier
-    _faderStage->process(targetSampleBuffer);
-
-    // Determine peak and convert to dB.
-    _peakDb = QUnits::linearToDb(targetSampleBuffer.peak());
-
-    // Transfer data to channel direct out.
-    targetSampleBuffer.copyTo(_channelOut->sampleBuffer());
-}
-
-void ChannelWidget::updateInterface()
-{
-    ui->progressBar->setValue((int)_peakDb);
-}
-
-double ChannelWidget::panorama()
-{
-    return (double)ui->panDial->value() / 100.0;
 }
 
-bool ChannelWidget::isInSubGroup12()
+ChannelWidget::~ChannelWidget()
 {
-    return ui->subgroup12PushButton->isChecked();
+    delete ui;
 }
 
-bool ChannelWidget::isInSubGroup34()
+void ChannelWidget::updateInterface(const MeterReading& meterReading)
 {
-    return ui->subgroup34PushButton->isChecked();
+    ui->meterWidget->setReading(meterReading);
 }
 
-bool ChannelWidget::isInSubGroup56()
+void ChannelWidget::setProcessingLoad(const QVector<double>& stageLoads)
 {
-    return ui->subgroup56PushButton->isChecked();
-}
+    if(stageLoads.isEmpty()) {
+        ui->channelNumberLabel->setToolTip(QString());
+        return;
+    }
 
-bool ChannelWidget::isInSubGroup78()
-{
-    return ui->subgroup78PushButton->isChecked();
+    double load = 0.0;
+    QString stageText;
+    for(int stage = 0; stage < stageLoads.size(); stage++) {
+        load += stageLoads.at(stage);
+        if(stageLoads.at(stage) > 0.0) {
+            stageText += QString("<tr><td>%1:</td><td>%2 %</td></tr>")
+                    .arg(StageTracer::stageName((StageTracer::Stage)stage))
+                    .arg(stageLoads.at(stage), 0, 'f', 2);
+        }
+    }
+    ui->channelNumberLabel->setToolTip(QString("<table><tr><td><b>Load:</b></td><td><b>%1 %</b></td></tr>%2</table>")
+                                       .arg(load, 0, 'f', 2).arg(stageText));
 }
 
 bool ChannelWidget::isMuted()
@@ -180,11 +93,37 @@ bool ChannelWidget::isOnMain()
     return ui->mainPushButton->isChecked();
 }
 
+bool ChannelWidget::isInSubgroupPair(int pair)
+{
+    switch(pair) {
+    case 0: return ui->subgroup12PushButton->isChecked();
+    case 1: return ui->subgroup34PushButton->isChecked();
+    case 2: return ui->subgroup56PushButton->isChecked();
+    case 3: return ui->subgroup78PushButton->isChecked();
+    default: return false;
+    }
+}
+
+void ChannelWidget::setSubgroupPairCount(int subgroupPairCount)
+{
+    ui->subgroup12PushButton->setEnabled(subgroupPairCount > 0);
+    ui->subgroup34PushButton->setEnabled(subgroupPairCount > 1);
+    ui->subgroup56PushButton->setEnabled(subgroupPairCount > 2);
+    ui->subgroup78PushButton->setEnabled(subgroupPairCount > 3);
+}
+
 QJsonObject ChannelWidget::stateToJson()
 {
     QJsonObject jsonObject;
 
     jsonObject.insert("inputGain", ui->gainDial->value());
+    jsonObject.insert("panorama", ui->panDial->value());
+
+    jsonObject.insert("gateActive", ui->gateOnPushButton->isChecked());
+    jsonObject.insert("gateThreshold", ui->gateDial->value());
+    jsonObject.insert("compressorActive", ui->compressorOnPushButton->isChecked());
+    jsonObject.insert("compressorThreshold", ui->compressorThresholdDial->value());
+    jsonObject.insert("compressorRatio", ui->compressorRatioDial->value());
 
     jsonObject.insert("eqActive", ui->equalizerOnPushButton->isChecked());
     jsonObject.insert("highAmount", ui->hiDial->value());
@@ -215,12 +154,19 @@ QJsonObject ChannelWidget::stateToJson()
 void ChannelWidget::stateFromJson(QJsonObject jsonObject)
 {
     ui->gainDial->setValue(jsonObject.value("inputGain").toDouble());
+    ui->panDial->setValue(jsonObject.value("panorama").toDouble(50.0));
+
+    ui->gateOnPushButton->setChecked(jsonObject.value("gateActive").toBool());
+    ui->gateDial->setValue(jsonObject.value("gateThreshold").toDouble(-60.0));
+    ui->compressorOnPushButton->setChecked(jsonObject.value("compressorActive").toBool());
+    ui->compressorThresholdDial->setValue(jsonObject.value("compressorThreshold").toDouble(-20.0));
+    ui->compressorRatioDial->setValue(jsonObject.value("compressorRatio").toDouble(4.0));
 
     ui->equalizerOnPushButton->setChecked(jsonObject.value("eqActive").toBool());
     ui->hiDial->setValue(jsonObject.value("highAmount").toDouble());
-    ui->midFreqDial->setValue(jsonObject.value("midFrequency").toDouble());
+    ui->midFreqDial->setValue(jsonObject.value("midFrequency").toDouble(4000.0));
     ui->midDial->setValue(jsonObject.value("midAmount").toDouble());
-    ui->loFreqDial->setValue(jsonObject.value("lowFrequency").toDouble());
+    ui->loFreqDial->setValue(jsonObject.value("lowFrequency").toDouble(200.0));
     ui->loDial->setValue(jsonObject.value("lowAmount").toDouble());
 
     ui->auxOnPushButton->setChecked(jsonObject.value("auxActive").toBool());
@@ -243,6 +189,13 @@ void ChannelWidget::stateFromJson(QJsonObject jsonObject)
 void ChannelWidget::resetControls()
 {
     ui->gainDial->setValue(0);
+    ui->panDial->setValue(50);
+
+    ui->gateOnPushButton->setChecked(false);
+    ui->gateDial->setValue(-60);
+    ui->compressorOnPushButton->setChecked(false);
+    ui->compressorThresholdDial->setValue(-20);
+    ui->compressorRatioDial->setValue(4);
 
     ui->equalizerOnPushButton->setChecked(false);
     ui->hiDial->setValue(0);
@@ -28,19 +28,17 @@
 #include <QWidget>
 #include <QJsonObject>
 
-// QJackAudio includes
-#include <QJackClient>
-#include <QEqualizer>
-#include <QEqualizerControl>
-#include <QAmplifier>
-#include <QJackPort>
+// Own includes
+#include "meterbank.h"
+#include "stagetracer.h"
 
 namespace Ui {
 class ChannelWidget;
 }
 
 /**
- * Widget that represents a single audio channel mixer line.
+ * Widget that represents a single audio channel mixer line. The audio
+ * processing of the channel is done by a ChannelStrip.
  * @author Jacob Dawid ( jacob.dawid@omg-it.works )
  */
 class ChannelWidget : public QWidget
@@ -53,26 +51,18 @@ public:
     /** Destructor */
     ~ChannelWidget();
 
-    /** Process this channel mixer line, storing the result in targetSampleBuffer. */
-    void process(QSampleBuffer targetSampleBuffer);
+    /**
+     * Update all visual interface elements.
+     * @param meterReading Current level of the channel.
+     */
+    void updateInterface(const MeterReading& meterReading);
 
-    /** Update all visual interface elements. */
-    void updateInterface();
-
-    /** @returns the panorama setting. 0.0 means left-most, 1.0 indicates right-most position. */
-    double panorama();
-
-    /** @returns whether this channel is contained in subgroup 1 and 2. */
-    bool isInSubGroup12();
-
-    /** @returns whether this channel is contained in subgroup 3 and 4. */
-    bool isInSubGroup34();
-
-    /** @returns whether this channel is contained in subgroup 5 and 6. */
-    bool isInSubGroup56();
-
-    /** @returns whether this channel is contained in subgroup 7 and 8. */
-    bool isInSubGroup78();
+    /**
+     * Shows what the channel costs in the tooltip of its number.
+     * @param stageLoads Share of the time spent in each StageTracer::Stage,
+     * in percent. Empty to remove the tooltip.
+     */
+    void setProcessingLoad(const QVector<double>& stageLoads);
 
     /** @returns whether this channel has been muted. */
     bool isMuted();
@@ -83,6 +73,18 @@ public:
     /** @returns true, when this channel is routed on main. */
     bool isOnMain();
 
+    /**
+     * @returns whether this channel is contained in the given subgroup pair.
+     * @param pair 0 for subgroup 1 and 2, 1 for 3 and 4 and so on.
+     */
+    bool isInSubgroupPair(int pair);
+
+    /**
+     * Disables the routing buttons of subgroup pairs the mixer does not have.
+     * Pairs beyond the fourth have no button.
+     */
+    void setSubgroupPairCount(int subgroupPairCount);
+
     /** Transfers the current channel state into a JSON object. */
     QJsonObject stateToJson();
 
@@ -92,38 +94,12 @@ public:
     /** Resets all controls to their default positions. */
     void resetControls();
 
+signals:
+    /** Emitted whenever any control of this channel has been changed. */
+    void controlsChanged();
+
 private:
     Ui::ChannelWidget *ui;
-
-    /** Input stage amplifier ("Gain"). */
-    QAmplifier *_inputStage;
-    /** Fader stage amplifier ("Volume"). */
-    QAmplifier *_faderStage;
-    /** Attenuation stage before sending signal to aux. */
-    QAmplifier *_auxPre;
-    /** Attenuation stage after receiving signal from aux. */
-    QAmplifier *_auxPost;
-    /** Equalizer for this channel. */
-    QEqualizer *_equalizer;
-
-    /** EQ control for low frequencies. */
-    QEqualizerControl *_lowsEqControl;
-    /** EQ control for mid frequencies. */
-    QEqualizerControl *_midsEqControl;
-    /** EQ control for high frequencies. */
-    QEqualizerControl *_highsEqControl;
-
-    /** QJackAudio input port for this channel. */
-    QJackPort *_channelIn;
-    /** QJackAudio aux send output port for this channel. */
-    QJackPort *_auxSend;
-    /** QJackAudio aux receive input port for this channel. */
-    QJackPort *_auxReturn;
-    /** QJackAudio direct out output port for this channel. */
-    QJackPort *_channelOut;
-
-    /** Last peak value. */
-    double _peakDb;
 };
 
 #endif // CHANNELWIDGET_H
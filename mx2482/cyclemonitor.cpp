@@ -0,0 +1,281 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "cyclemonitor.h"
+#include "channelstrip.h"
+
+// Qt includes
+#include <QJsonArray>
+#include <QStringList>
+
+/** @returns the names of the stages a channel configuration has, "idle" for an idle channel. */
+static QString configurationName(int configuration)
+{
+    if(configuration < 0) {
+        return "idle";
+    }
+
+    QStringList stages;
+    if(configuration & ChannelStrip::EqualizerOn) {
+        stages.append("equalizer");
+    }
+    if(configuration & ChannelStrip::InsertOn) {
+        stages.append("insert");
+    }
+    if(configuration & ChannelStrip::AuxOn) {
+        stages.append("aux");
+    }
+    if(!(configuration & ChannelStrip::UnityInputGain)) {
+        stages.append("input gain");
+    }
+    if(!(configuration & ChannelStrip::UnityFaderGain)) {
+        stages.append("fader");
+    }
+    return stages.join(", ");
+}
+
+QJsonObject XrunSnapshot::toJson() const
+{
+    QJsonObject jsonObject;
+    jsonObject.insert("cause", cause == DeadlineMissed ? QString("deadline missed") : QString("callback late"));
+    jsonObject.insert("frameTime", (double)frameTime);
+    jsonObject.insert("deadline", deadline / 1000.0);
+
+    // Periods start relative to the one that has been too late
+    QJsonArray cyclesArray;
+    quint64 lastBegin = cycleCount > 0 ? cycles[cycleCount - 1].begin : 0;
+    for(int i = 0; i < cycleCount; i++) {
+        QJsonObject cycleObject;
+        cycleObject.insert("begin", ((qint64)cycles[i].begin - (qint64)lastBegin) / 1000.0);
+        cycleObject.insert("duration", cycles[i].duration / 1000.0);
+        cycleObject.insert("frames", (int)cycles[i].frames);
+        cyclesArray.append(cycleObject);
+    }
+    jsonObject.insert("cycles", cyclesArray);
+
+    QJsonObject configurationObject;
+    configurationObject.insert("channels", configuration.channelCount);
+    configurationObject.insert("activeChannels", configuration.activeChannelCount);
+    configurationObject.insert("subgroups", configuration.subgroupCount);
+    configurationObject.insert("equalizer", configuration.equalizerEngine == MixerOptions::FFTEqualizer
+                               ? QString("fft") : QString("biquad"));
+    configurationObject.insert("dynamics", configuration.dynamics);
+    configurationObject.insert("workers", configuration.workerThreadCount);
+    configurationObject.insert("recording", configuration.recording);
+    configurationObject.insert("soundcheck", configuration.soundcheck);
+    configurationObject.insert("tracing", configuration.tracing);
+    configurationObject.insert("automation", configuration.automationPlaying);
+    configurationObject.insert("crossfadeFrames", configuration.crossfadeFrames);
+    if(configuration.activeChannelCount >= 0) {
+        QJsonArray channelsArray;
+        int channelCount = qMin(configuration.channelCount, (int)MixerOptions::MaximumChannelCount);
+        for(int i = 0; i < channelCount; i++) {
+            channelsArray.append(configurationName(configuration.channelConfigurations[i]));
+        }
+        configurationObject.insert("channelStages", channelsArray);
+    }
+    jsonObject.insert("configuration", configurationObject);
+    return jsonObject;
+}
+
+CycleMonitor::CycleMonitor() :
+    _sampleRate(0),
+    _maximum(0),
+    _deadline(0),
+    _xrunCount(0),
+    _historyIndex(0),
+    _historyCount(0),
+    _previousLate(false),
+    _cause(XrunSnapshot::DeadlineMissed),
+    _xrunFrameTime(0),
+    _xrunQueue(XrunQueueCapacity)
+{
+    for(int i = 0; i < BucketCount; i++) {
+        _buckets[i].storeRelease(0);
+    }
+}
+
+void CycleMonitor::setSampleRate(int sampleRate)
+{
+    _sampleRate = sampleRate;
+    _historyCount = 0;
+    _previousLate = false;
+}
+
+bool CycleMonitor::record(quint64 begin, quint64 end, int frames, qint64 frameTime)
+{
+    quint64 duration = end - begin;
+    QAtomicInteger<quint64>& counter = _buckets[bucket(duration)];
+    counter.storeRelease(counter.loadAcquire() + 1);
+    if(duration > _maximum.loadAcquire()) {
+        _maximum.storeRelease(duration);
+    }
+
+    // Look at the previous period before it is overwritten
+    int previousIndex = (_historyIndex + XrunSnapshot::HistoryLength - 1) % XrunSnapshot::HistoryLength;
+    bool hasPrevious = _historyCount > 0;
+    quint64 previousBegin = _history[previousIndex].begin;
+
+    CycleTiming& cycleTiming = _history[_historyIndex];
+    cycleTiming.begin = begin;
+    cycleTiming.duration = (quint32)qMin(duration, (quint64)0xffffffffu);
+    cycleTiming.frames = frames;
+    _historyIndex = (_historyIndex + 1) % XrunSnapshot::HistoryLength;
+    _historyCount = qMin(_historyCount + 1, (int)XrunSnapshot::HistoryLength);
+
+    if(_sampleRate <= 0) {
+        return false;
+    }
+    quint64 deadline = (quint64)frames * 1000000000ULL / _sampleRate;
+    _deadline.storeRelease(deadline);
+
+    // A period after one that has missed its deadline starts late anyway
+    bool late = false;
+    if(duration > deadline) {
+        _cause = XrunSnapshot::DeadlineMissed;
+        late = true;
+    } else if(hasPrevious && !_previousLate && begin - previousBegin > deadline * 3 / 2) {
+        _cause = XrunSnapshot::CallbackLate;
+        late = true;
+    }
+    _previousLate = late;
+    if(late) {
+        _xrunCount.fetchAndAddOrdered(1);
+        _xrunFrameTime = frameTime;
+    }
+    return late;
+}
+
+void CycleMonitor::captureXrun(const CycleConfiguration& configuration)
+{
+    _xrunSnapshot.cause = _cause;
+    _xrunSnapshot.frameTime = _xrunFrameTime;
+    _xrunSnapshot.deadline = _deadline.loadAcquire();
+    _xrunSnapshot.cycleCount = _historyCount;
+    int first = (_historyIndex + XrunSnapshot::HistoryLength - _historyCount) % XrunSnapshot::HistoryLength;
+    for(int i = 0; i < _historyCount; i++) {
+        _xrunSnapshot.cycles[i] = _history[(first + i) % XrunSnapshot::HistoryLength];
+    }
+    _xrunSnapshot.configuration = configuration;
+    _xrunQueue.push(_xrunSnapshot);
+}
+
+bool CycleMonitor::takeXrun(XrunSnapshot& xrunSnapshot)
+{
+    return _xrunQueue.pop(xrunSnapshot);
+}
+
+CycleStatistics CycleMonitor::statistics() const
+{
+    quint64 counts[BucketCount];
+    quint64 total = 0;
+    for(int i = 0; i < BucketCount; i++) {
+        counts[i] = _buckets[i].loadAcquire();
+        total += counts[i];
+    }
+
+    CycleStatistics cycleStatistics;
+    cycleStatistics.cycleCount = total;
+    cycleStatistics.deadline = _deadline.loadAcquire();
+    cycleStatistics.maximum = _maximum.loadAcquire();
+    cycleStatistics.median = percentile(counts, total, 0.5);
+    cycleStatistics.p99 = percentile(counts, total, 0.99);
+    cycleStatistics.p999 = percentile(counts, total, 0.999);
+    cycleStatistics.xrunCount = _xrunCount.loadAcquire();
+    return cycleStatistics;
+}
+
+QJsonObject CycleMonitor::histogramToJson() const
+{
+    CycleStatistics cycleStatistics = statistics();
+    QJsonObject jsonObject;
+    jsonObject.insert("cycles", (double)cycleStatistics.cycleCount);
+    jsonObject.insert("deadline", cycleStatistics.deadline / 1000.0);
+    jsonObject.insert("median", cycleStatistics.median / 1000.0);
+    jsonObject.insert("p99", cycleStatistics.p99 / 1000.0);
+    jsonObject.insert("p999", cycleStatistics.p999 / 1000.0);
+    jsonObject.insert("maximum", cycleStatistics.maximum / 1000.0);
+    jsonObject.insert("xruns", (double)cycleStatistics.xrunCount);
+
+    QJsonArray bucketsArray;
+    for(int i = 0; i < BucketCount; i++) {
+        quint64 count = _buckets[i].loadAcquire();
+        if(count > 0) {
+            QJsonObject bucketObject;
+            bucketObject.insert("begin", bucketBegin(i) / 1000.0);
+            bucketObject.insert("end", bucketEnd(i) / 1000.0);
+            bucketObject.insert("count", (double)count);
+            bucketsArray.append(bucketObject);
+        }
+    }
+    jsonObject.insert("buckets", bucketsArray);
+    return jsonObject;
+}
+
+int CycleMonitor::bucket(quint64 duration)
+{
+    // Small durations get a bucket each, larger ones are split by their highest bits
+    if(duration < 2 * SubBucketCount) {
+        return (int)duration;
+    }
+    int highestBit = 63 - __builtin_clzll(duration);
+    int shift = highestBit - SubBucketBits;
+    return (shift + 1) * SubBucketCount + (int)((duration >> shift) & (SubBucketCount - 1));
+}
+
+quint64 CycleMonitor::bucketBegin(int bucket)
+{
+    if(bucket < 2 * SubBucketCount) {
+        return bucket;
+    }
+    int shift = bucket / SubBucketCount - 1;
+    return (quint64)(SubBucketCount + bucket % SubBucketCount) << shift;
+}
+
+quint64 CycleMonitor::bucketEnd(int bucket)
+{
+    if(bucket < 2 * SubBucketCount) {
+        return bucket;
+    }
+    int shift = bucket / SubBucketCount - 1;
+    return bucketBegin(bucket) + ((quint64)1 << shift) - 1;
+}
+
+quint64 CycleMonitor::percentile(const quint64 *counts, quint64 total, double share) const
+{
+    if(total == 0) {
+        return 0;
+    }
+
+    // The end of the bucket is an upper bound, no period has taken longer than the maximum, though
+    quint64 rank = (quint64)(share * total);
+    quint64 count = 0;
+    for(int i = 0; i < BucketCount; i++) {
+        count += counts[i];
+        if(count > rank) {
+            return qMin(bucketEnd(i), _maximum.loadAcquire());
+        }
+    }
+    return _maximum.loadAcquire();
+}
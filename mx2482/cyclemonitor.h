@@ -0,0 +1,216 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYCLEMONITOR_H
+#define CYCLEMONITOR_H
+
+// Qt includes
+#include <QAtomicInteger>
+#include <QJsonObject>
+
+// Own includes
+#include "mixeroptions.h"
+#include "waitfreequeue.h"
+
+/**
+ * Timing of a single period of the engine.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct CycleTiming
+{
+    /** Monotonic timestamp the period has started at, in nanoseconds. */
+    quint64 begin;
+    /** Time the period has taken, in nanoseconds. */
+    quint32 duration;
+    /** Frames processed in the period. */
+    quint32 frames;
+};
+
+/**
+ * What the engine has been doing when a period has been too late.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct CycleConfiguration
+{
+    int channelCount;
+    /** Channels that have not been idle, -1 if the engine has been reconfigured. */
+    int activeChannelCount;
+    int subgroupCount;
+    MixerOptions::EqualizerEngine equalizerEngine;
+    /** Whether the gate or compressor has run. */
+    bool dynamics;
+    int workerThreadCount;
+    bool recording;
+    bool soundcheck;
+    bool tracing;
+    bool automationPlaying;
+    /** Frames of a crossfade still to go. */
+    int crossfadeFrames;
+    /** ChannelStrip::Configuration of each channel, -1 for an idle one. */
+    qint8 channelConfigurations[MixerOptions::MaximumChannelCount];
+};
+
+/**
+ * Snapshot taken when a period has missed its deadline.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct XrunSnapshot
+{
+    enum {
+        /** Periods kept before the one that has been too late. */
+        HistoryLength = 64
+    };
+
+    enum Cause {
+        /** The period has taken longer than its own duration. */
+        DeadlineMissed,
+        /** The period has started well after the previous one, JACK must have skipped one. */
+        CallbackLate
+    };
+
+    Cause cause;
+    /** Frame time of the engine at the period. */
+    qint64 frameTime;
+    /** Duration of a period, in nanoseconds. */
+    quint64 deadline;
+    /** Number of valid entries in cycles. */
+    int cycleCount;
+    /** Periods up to and including the one that has been too late, oldest first. */
+    CycleTiming cycles[HistoryLength];
+    CycleConfiguration configuration;
+
+    /** Transfers the snapshot into a JSON object. Times are in microseconds. */
+    QJsonObject toJson() const;
+};
+
+/** Summary of the period durations measured so far. Durations are in nanoseconds. */
+struct CycleStatistics
+{
+    qint64 cycleCount;
+    /** Duration of a period, 0 if unknown. */
+    quint64 deadline;
+    quint64 median;
+    quint64 p99;
+    quint64 p999;
+    quint64 maximum;
+    qint64 xrunCount;
+};
+
+/**
+ * Measures how long the engine takes for each period, compared to the
+ * duration of the period. Durations go into a histogram with logarithmic
+ * buckets, each octave split into 1 << SubBucketBits buckets, so the
+ * percentiles are within 12.5 % of the exact value. The last periods are
+ * kept, so a snapshot can be taken whenever a period is too late.
+ *
+ * JACK's own xrun callback is not forwarded by QJackClient, so xruns
+ * are detected from the timestamps: a period that takes longer than its
+ * duration, or that starts more than one and a half periods after the
+ * previous one.
+ *
+ * record() and captureXrun() must be called from the realtime thread
+ * only. takeXrun() must be called from one other thread only.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class CycleMonitor
+{
+public:
+    enum {
+        SubBucketBits = 3,
+        SubBucketCount = 1 << SubBucketBits,
+        /** Enough buckets for any 64 bit duration. */
+        BucketCount = 64 * SubBucketCount,
+        /** Snapshots that can be pending for the user interface. */
+        XrunQueueCapacity = 8
+    };
+
+    CycleMonitor();
+
+    /**
+     * Sets the sample rate the deadline is derived from. 0 to not detect
+     * xruns, as when rendering offline. Must only be called while the
+     * engine does not process.
+     */
+    void setSampleRate(int sampleRate);
+
+    /**
+     * Records a period. Realtime safe.
+     * @param frameTime Frame time of the engine at the period.
+     * @returns true, if the period has been too late. captureXrun() is
+     * expected to be called then.
+     */
+    bool record(quint64 begin, quint64 end, int frames, qint64 frameTime);
+
+    /**
+     * Takes a snapshot of the last periods along with the configuration
+     * of the engine and hands it to takeXrun(). Realtime safe. The
+     * snapshot is lost, if too many are pending.
+     */
+    void captureXrun(const CycleConfiguration& configuration);
+
+    /**
+     * Takes the oldest pending snapshot.
+     * @returns false, if there is none.
+     */
+    bool takeXrun(XrunSnapshot& xrunSnapshot);
+
+    /** @returns the percentiles of all periods so far. Safe to call from any thread. */
+    CycleStatistics statistics() const;
+
+    /** Transfers the statistics and all non-empty buckets into a JSON object. */
+    QJsonObject histogramToJson() const;
+
+    /** @returns the bucket a duration is counted in. */
+    static int bucket(quint64 duration);
+    /** @returns the smallest duration counted in a bucket. */
+    static quint64 bucketBegin(int bucket);
+    /** @returns the largest duration counted in a bucket. */
+    static quint64 bucketEnd(int bucket);
+
+private:
+    /** @returns the duration at least the given share of all periods has stayed below. */
+    quint64 percentile(const quint64 *counts, quint64 total, double share) const;
+
+    int _sampleRate;
+
+    /** Number of periods in each bucket. Written by the realtime thread only. */
+    QAtomicInteger<quint64> _buckets[BucketCount];
+    QAtomicInteger<quint64> _maximum;
+    QAtomicInteger<quint64> _deadline;
+    QAtomicInteger<qint64> _xrunCount;
+
+    /** Last periods, as a ring. */
+    CycleTiming _history[XrunSnapshot::HistoryLength];
+    int _historyIndex;
+    int _historyCount;
+    /** Whether the previous period has been too late, so the next one is not blamed as well. */
+    bool _previousLate;
+    XrunSnapshot::Cause _cause;
+    qint64 _xrunFrameTime;
+
+    /** Snapshot under construction, preallocated like the queue. */
+    XrunSnapshot _xrunSnapshot;
+    WaitFreeQueue<XrunSnapshot> _xrunQueue;
+};
+
+#endif // CYCLEMONITOR_H
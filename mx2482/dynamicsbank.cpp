@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "dynamicsbank.h"
+
+// Standard includes
+#include <cmath>
+#include <cstring>
+
+/** Attenuation of a closed gate, -80 dB. */
+static const float GateFloor = 0.0001f;
+/** Difference at which the gate gain snaps to its target, as it would get stuck a step away from it. */
+static const float SettledDifference = 1e-6f;
+/** Lowest level the compressor detector reports, keeps the logarithm finite. */
+static const float MinimumLevel = 1e-10f;
+
+/** Time constants in seconds. */
+static const double GateReleaseTime = 0.05;
+static const double GateOpenTime = 0.0005;
+static const double GateCloseTime = 0.1;
+static const double CompressorAttackTime = 0.01;
+static const double CompressorReleaseTime = 0.15;
+
+/** @returns the one-pole coefficient that decays to 1/e in the given time. */
+static float smoothingCoefficient(double sampleRate, double seconds)
+{
+    return std::exp(-1.0 / (seconds * sampleRate));
+}
+
+/** Approximation of log2(x) for x > 0, within 0.01. */
+static inline float fastLog2(float x)
+{
+    qint32 bits;
+    memcpy(&bits, &x, sizeof(bits));
+    float exponent = (float)(((bits >> 23) & 255) - 128);
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    float mantissa;
+    memcpy(&mantissa, &bits, sizeof(mantissa));
+    return exponent + (-0.34484843f * mantissa + 2.02466578f) * mantissa - 0.67487759f;
+}
+
+/** Approximation of 2^x for -126 <= x <= 0, within 0.35 % (0.03 dB). */
+static inline float fastExp2(float x)
+{
+    float integer = (float)(int)x;
+    integer -= integer > x ? 1.0f : 0.0f;
+    float fraction = x - integer;
+    float result = 1.0f + fraction * (0.6565f + 0.3435f * fraction);
+    qint32 bits;
+    memcpy(&bits, &result, sizeof(bits));
+    bits += (qint32)integer << 23;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+DynamicsBank::DynamicsBank(int laneCount) :
+    _laneCount(laneCount),
+    _sampleRate(0.0),
+    _gateThreshold(laneCount),
+    _gateFloor(laneCount),
+    _compressorThreshold(laneCount),
+    _compressorSlope(laneCount),
+    _gateEnvelope(laneCount),
+    _gateGain(laneCount),
+    _compressorEnvelope(laneCount),
+    _compressorGain(laneCount),
+    _compressorTarget(laneCount),
+    _compressorStep(laneCount),
+    _block(BlockFrames * laneCount)
+{
+    setSampleRate(48000.0);
+    for(int lane = 0; lane < laneCount; lane++) {
+        setGate(lane, false, 0.0f);
+        setCompressor(lane, false, 1.0f, 1.0f);
+    }
+    reset();
+}
+
+int DynamicsBank::laneCount() const
+{
+    return _laneCount;
+}
+
+void DynamicsBank::setSampleRate(double sampleRate)
+{
+    if(sampleRate == _sampleRate || sampleRate <= 0.0) {
+        return;
+    }
+    _sampleRate = sampleRate;
+    _gateRelease = smoothingCoefficient(sampleRate, GateReleaseTime);
+    _gateOpen = smoothingCoefficient(sampleRate, GateOpenTime);
+    _gateClose = smoothingCoefficient(sampleRate, GateCloseTime);
+    _compressorAttack = smoothingCoefficient(sampleRate, CompressorAttackTime);
+    _compressorRelease = smoothingCoefficient(sampleRate, CompressorReleaseTime);
+}
+
+void DynamicsBank::setGate(int lane, bool on, float threshold)
+{
+    _gateThreshold[lane] = threshold;
+    _gateFloor[lane] = on ? GateFloor : 1.0f;
+}
+
+void DynamicsBank::setCompressor(int lane, bool on, float threshold, float ratio)
+{
+    _compressorThreshold[lane] = fastLog2(qMax(threshold, MinimumLevel));
+    _compressorSlope[lane] = on && ratio > 1.0f ? 1.0f - 1.0f / ratio : 0.0f;
+}
+
+bool DynamicsBank::isBypassed(int firstLane, int laneCount) const
+{
+    for(int lane = firstLane; lane < firstLane + laneCount; lane++) {
+        if(_gateFloor.at(lane) != 1.0f || _compressorSlope.at(lane) != 0.0f
+                || _gateGain.at(lane) != 1.0f || _compressorGain.at(lane) != 1.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DynamicsBank::reset()
+{
+    reset(0, _laneCount);
+}
+
+void DynamicsBank::reset(int firstLane, int laneCount)
+{
+    for(int lane = firstLane; lane < firstLane + laneCount; lane++) {
+        _gateEnvelope[lane] = 0.0f;
+        _gateGain[lane] = 1.0f;
+        _compressorEnvelope[lane] = 0.0f;
+        _compressorGain[lane] = 1.0f;
+        _compressorTarget[lane] = 1.0f;
+        _compressorStep[lane] = 0.0f;
+    }
+}
+
+void DynamicsBank::process(float *const *buffers, int frames, int firstLane, int laneCount)
+{
+    // Each lane group transposes into its own region, so groups never share cache lines
+    float *block = _block.data() + firstLane * BlockFrames;
+
+    const float * __restrict gateThreshold = _gateThreshold.constData() + firstLane;
+    const float * __restrict gateFloor = _gateFloor.constData() + firstLane;
+    const float * __restrict compressorThreshold = _compressorThreshold.constData() + firstLane;
+    const float * __restrict compressorSlope = _compressorSlope.constData() + firstLane;
+    float * __restrict gateEnvelope = _gateEnvelope.data() + firstLane;
+    float * __restrict gateGain = _gateGain.data() + firstLane;
+    float * __restrict compressorEnvelope = _compressorEnvelope.data() + firstLane;
+    float * __restrict compressorGain = _compressorGain.data() + firstLane;
+    float * __restrict compressorTarget = _compressorTarget.data() + firstLane;
+    float * __restrict compressorStep = _compressorStep.data() + firstLane;
+    float gateRelease = _gateRelease;
+    float gateOpen = _gateOpen;
+    float gateClose = _gateClose;
+    float compressorAttack = _compressorAttack;
+    float compressorRelease = _compressorRelease;
+
+    for(int offset = 0; offset < frames; offset += BlockFrames) {
+        int blockFrames = qMin((int)BlockFrames, frames - offset);
+
+        // Transpose into frame-major order, so all lanes of one frame are adjacent
+        for(int lane = 0; lane < laneCount; lane++) {
+            const float *source = buffers[firstLane + lane] + offset;
+            for(int frame = 0; frame < blockFrames; frame++) {
+                block[frame * laneCount + lane] = source[frame];
+            }
+        }
+
+        // Gate and compressor detector on all lanes. The inner loop over the lanes is free
+        // of dependencies and branches, and gets vectorized by the compiler.
+        for(int frame = 0; frame < blockFrames; frame++) {
+            float * __restrict samples = block + frame * laneCount;
+            for(int lane = 0; lane < laneCount; lane++) {
+                float x = samples[lane];
+                float level = std::fabs(x);
+
+                // The gate detector follows peaks at once and holds them with its release
+                float envelope = gateEnvelope[lane] * gateRelease;
+                envelope = level > envelope ? level : envelope;
+                gateEnvelope[lane] = envelope;
+                float target = gateFloor[lane];
+                target = envelope >= gateThreshold[lane] ? 1.0f : target;
+                float gain = gateGain[lane];
+                float coefficient = target > gain ? gateOpen : gateClose;
+                gain = target + (gain - target) * coefficient;
+                gain = std::fabs(gain - target) < SettledDifference ? target : gain;
+                gateGain[lane] = gain;
+                x *= gain;
+                samples[lane] = x;
+
+                // The compressor detector looks at the gated signal
+                level = std::fabs(x);
+                float compressorLevel = compressorEnvelope[lane];
+                coefficient = level > compressorLevel ? compressorAttack : compressorRelease;
+                compressorEnvelope[lane] = level + (compressorLevel - level) * coefficient;
+            }
+        }
+
+        // Gain computer, once per block: the level above the threshold is reduced by the ratio
+        for(int lane = 0; lane < laneCount; lane++) {
+            float over = fastLog2(qMax(compressorEnvelope[lane], MinimumLevel)) - compressorThreshold[lane];
+            float reduction = qMax(-126.0f, -qMax(0.0f, over) * compressorSlope[lane]);
+            compressorTarget[lane] = fastExp2(reduction);
+            compressorStep[lane] = (compressorTarget[lane] - compressorGain[lane]) / blockFrames;
+        }
+
+        // Ramp the compressor gain towards its target over the block
+        for(int frame = 0; frame < blockFrames; frame++) {
+            float * __restrict samples = block + frame * laneCount;
+            for(int lane = 0; lane < laneCount; lane++) {
+                compressorGain[lane] += compressorStep[lane];
+                samples[lane] *= compressorGain[lane];
+            }
+        }
+
+        // Land on the target exactly, so a released compressor gets back to unity
+        for(int lane = 0; lane < laneCount; lane++) {
+            compressorGain[lane] = compressorTarget[lane];
+        }
+
+        // Transpose back
+        for(int lane = 0; lane < laneCount; lane++) {
+            float *target = buffers[firstLane + lane] + offset;
+            for(int frame = 0; frame < blockFrames; frame++) {
+                target[frame] = block[frame * laneCount + lane];
+            }
+        }
+    }
+}
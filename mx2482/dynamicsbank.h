@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef DYNAMICSBANK_H
+#define DYNAMICSBANK_H
+
+// Qt includes
+#include <QVector>
+
+/**
+ * Gate and compressor that process many channels at once. Each channel is
+ * a lane running a gate followed by a feed-forward compressor. All
+ * parameters, envelope followers and gains are kept in a structure of
+ * arrays layout, so the inner loops run across channels and each SIMD
+ * lane handles one channel. The compressor computes its gain once per
+ * block and ramps towards it, which keeps the logarithms out of the
+ * per-sample loop.
+ *
+ * Lanes can be processed in independent groups, for example on different
+ * worker threads, as long as the groups do not overlap.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class DynamicsBank
+{
+public:
+    enum {
+        /** Number of frames transposed and processed at once, also the update interval of the compressor gain. */
+        BlockFrames = 64,
+        /** Lanes per group when splitting the work, a multiple of the widest SIMD register. */
+        LaneGroupSize = 16
+    };
+
+    /** Constructor */
+    explicit DynamicsBank(int laneCount);
+
+    /** @returns the number of lanes. */
+    int laneCount() const;
+
+    /**
+     * Computes the time constants for the given sample rate. Does nothing
+     * if it has not changed. Realtime safe.
+     */
+    void setSampleRate(double sampleRate);
+
+    /**
+     * Sets the gate of a lane. A gate that is switched off opens
+     * smoothly. Realtime safe.
+     * @param threshold Level below which the gate closes, linear.
+     */
+    void setGate(int lane, bool on, float threshold);
+
+    /**
+     * Sets the compressor of a lane. A compressor that is switched off
+     * releases smoothly. Realtime safe.
+     * @param threshold Level above which the gain is reduced, linear.
+     * @param ratio Ratio of the gain reduction, 1.0 or more.
+     */
+    void setCompressor(int lane, bool on, float threshold, float ratio);
+
+    /**
+     * @returns true, if lanes firstLane to firstLane + laneCount - 1 are
+     * all switched off and back at unity gain, so processing them would
+     * leave the signal unaltered.
+     */
+    bool isBypassed(int firstLane, int laneCount) const;
+
+    /** Clears the envelopes and gains of all lanes. */
+    void reset();
+
+    /** Clears the envelopes and gains of lanes firstLane to firstLane + laneCount - 1. Realtime safe. */
+    void reset(int firstLane, int laneCount);
+
+    /**
+     * Processes the buffers of lanes firstLane to firstLane + laneCount - 1 in place.
+     * @param buffers Buffer for each lane, indexed by lane.
+     * @param frames Number of frames in each buffer.
+     */
+    void process(float *const *buffers, int frames, int firstLane, int laneCount);
+
+private:
+    int _laneCount;
+    double _sampleRate;
+
+    /** Release of the gate detector, per sample. */
+    float _gateRelease;
+    /** Smoothing of the gate gain while opening and closing, per sample. */
+    float _gateOpen, _gateClose;
+    /** Attack and release of the compressor detector, per sample. */
+    float _compressorAttack, _compressorRelease;
+
+    /** Gate parameters, indexed by lane. The floor is 1.0 for a gate that is switched off. */
+    QVector<float> _gateThreshold, _gateFloor;
+    /** Compressor parameters, indexed by lane. The threshold is in log2, the slope 0.0 for a compressor that is switched off. */
+    QVector<float> _compressorThreshold, _compressorSlope;
+    /** Envelopes and gains, indexed by lane. */
+    QVector<float> _gateEnvelope, _gateGain, _compressorEnvelope, _compressorGain;
+    /** Compressor gain at the end of the current block and its step per frame, indexed by lane. */
+    QVector<float> _compressorTarget, _compressorStep;
+    /** Transposed samples, lane group starting at lane n uses the region at n * BlockFrames. */
+    QVector<float> _block;
+};
+
+#endif // DYNAMICSBANK_H
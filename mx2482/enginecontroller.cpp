@@ -0,0 +1,292 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Own includes
+#include "enginecontroller.h"
+
+// Qt includes
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStringList>
+
+EngineController::EngineController(const MixerOptions& mixerOptions, MixerEngine *mixerEngine,
+                                   EngineSegment *engineSegment, int sampleRate) :
+    _mixerOptions(mixerOptions),
+    _mixerEngine(mixerEngine),
+    _engineSegment(engineSegment),
+    _sampleRate(sampleRate),
+    _controlQueue(0),
+    _meterRecords(mixerEngine->meterRing().recordCount()),
+    _automationPlaying(false)
+{
+    for(int i = 0; i < _meterRecords.size(); i++) {
+        _meterRecords[i].clear();
+    }
+}
+
+void EngineController::setControlQueue(WaitFreeQueue<MixerCommand> *controlQueue)
+{
+    _controlQueue = controlQueue;
+}
+
+void EngineController::publishState()
+{
+    _mixerEngine->publishState(mixerState());
+}
+
+void EngineController::update(EngineStatus engineStatus)
+{
+    // Parsing happens here, so the user interface is not held up by large mixers
+    QJsonObject jsonObject;
+    int crossfadeFrames;
+    if(_engineSegment->takeState(jsonObject, crossfadeFrames)) {
+        _state = jsonObject;
+        MixerState mixerState = this->mixerState();
+        mixerState.crossfadeFrames = crossfadeFrames;
+        _automationRecorder.record(_mixerEngine->frameTime(), mixerState);
+        _mixerEngine->publishState(mixerState);
+    }
+
+    // Requests come after the state, so they see the controls as they have been when made
+    foreach(const EngineRequest& engineRequest, _engineSegment->takeRequests()) {
+        handleRequest(engineRequest);
+    }
+
+    // The engine has applied remote changes already, the state and the controls follow
+    if(_controlQueue) {
+        QList<MixerCommand> mixerCommands;
+        MixerCommand mixerCommand;
+        while(_controlQueue->pop(mixerCommand)) {
+            mixerCommand.apply(_state);
+            mixerCommands.append(mixerCommand);
+        }
+        if(!mixerCommands.isEmpty()) {
+            _engineSegment->updateState(_state, mixerCommands);
+        }
+    }
+
+    // Levels go into the segment even without a user interface, or the engine stops publishing them
+    MeterRing& meterRing = _mixerEngine->meterRing();
+    bool metered = false;
+    while(const MeterRecord *meterRecords = meterRing.peek()) {
+        for(int i = 0; i < _meterRecords.size(); i++) {
+            _meterRecords[i].accumulate(meterRecords[i]);
+        }
+        meterRing.release();
+        metered = true;
+    }
+    if(metered) {
+        _engineSegment->addMeters(_meterRecords.constData());
+        for(int i = 0; i < _meterRecords.size(); i++) {
+            _meterRecords[i].clear();
+        }
+    }
+
+    XrunSnapshot xrunSnapshot;
+    while(_mixerEngine->cycleMonitor().takeXrun(xrunSnapshot)) {
+        const CycleTiming& cycleTiming = xrunSnapshot.cycles[xrunSnapshot.cycleCount - 1];
+        qWarning("Xrun at frame %lld: %s, period took %.0f us of %.0f us, %d of %d channels active.",
+                 xrunSnapshot.frameTime,
+                 xrunSnapshot.cause == XrunSnapshot::DeadlineMissed ? "deadline missed" : "callback late",
+                 cycleTiming.duration / 1000.0, xrunSnapshot.deadline / 1000.0,
+                 xrunSnapshot.configuration.activeChannelCount, xrunSnapshot.configuration.channelCount);
+        _xrunSnapshots.append(xrunSnapshot);
+        if(_xrunSnapshots.size() > XrunSnapshotCount) {
+            _xrunSnapshots.removeFirst();
+        }
+    }
+
+    engineStatus.cycleStatistics = _mixerEngine->cycleMonitor().statistics();
+    const MultitrackRecorder& multitrackRecorder = _mixerEngine->multitrackRecorder();
+    const MultitrackPlayer& multitrackPlayer = _mixerEngine->multitrackPlayer();
+    engineStatus.automationRecording = _automationRecorder.isRecording();
+    engineStatus.automationPlaying = _automationPlaying;
+    engineStatus.recording = multitrackRecorder.isRecording();
+    engineStatus.recordingDroppedFrames = engineStatus.recording ? multitrackRecorder.droppedFrames() : 0;
+    engineStatus.recordingFailed = engineStatus.recording && multitrackRecorder.hasFailed();
+    engineStatus.soundcheck = multitrackPlayer.isPlaying();
+    engineStatus.soundcheckMissedFrames = engineStatus.soundcheck ? multitrackPlayer.missedFrames() : 0;
+    engineStatus.heartbeat = 0;
+    _engineSegment->setStatus(engineStatus);
+}
+
+void EngineController::handleRequest(const EngineRequest& engineRequest)
+{
+    QString fileName = QString::fromUtf8(engineRequest.fileName);
+    switch(engineRequest.type) {
+    case EngineRequest::ToggleAutomationRecording:
+        toggleAutomationRecording();
+        break;
+    case EngineRequest::ToggleAutomationPlayback:
+        toggleAutomationPlayback();
+        break;
+    case EngineRequest::ToggleRecording:
+        toggleRecording();
+        break;
+    case EngineRequest::ToggleSoundcheck:
+        toggleSoundcheck();
+        break;
+    case EngineRequest::ExportCycleStatistics:
+        exportCycleStatistics(fileName);
+        break;
+    case EngineRequest::SaveState:
+        saveState(fileName);
+        break;
+    case EngineRequest::LoadAutomation:
+        loadAutomation(fileName);
+        break;
+    default:
+        qWarning("Ignoring unknown request %d.", engineRequest.type);
+        break;
+    }
+}
+
+void EngineController::toggleAutomationRecording()
+{
+    if(_automationRecorder.isRecording()) {
+        _automationRecorder.stop();
+        _mixerEngine->setAutomation(_automationRecorder.events());
+        return;
+    }
+
+    // Recording while playing back would record the controls, not what is being heard
+    if(_automationPlaying) {
+        toggleAutomationPlayback();
+    }
+    _automationRecorder.start(_mixerEngine->frameTime(), mixerState());
+}
+
+void EngineController::toggleAutomationPlayback()
+{
+    if(_automationPlaying) {
+        _mixerEngine->stopAutomation();
+        _automationPlaying = false;
+    } else if(!_automationRecorder.isRecording()) {
+        _mixerEngine->startAutomation();
+        _automationPlaying = true;
+    }
+}
+
+void EngineController::toggleRecording()
+{
+    const MultitrackRecorder& multitrackRecorder = _mixerEngine->multitrackRecorder();
+    if(multitrackRecorder.isRecording()) {
+        _mixerEngine->stopRecording();
+        if(multitrackRecorder.hasFailed()) {
+            qWarning("%s", qPrintable(multitrackRecorder.errorString()));
+        }
+        return;
+    }
+
+    QString directory = QDir(_mixerOptions.recordDirectory).filePath(QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss"));
+    if(_mixerEngine->startRecording(directory, _sampleRate, _mixerOptions.recordFormat)) {
+        qDebug("Recording to %s.", qPrintable(directory));
+    } else {
+        qWarning("%s", qPrintable(multitrackRecorder.errorString()));
+    }
+}
+
+void EngineController::toggleSoundcheck()
+{
+    const MultitrackPlayer& multitrackPlayer = _mixerEngine->multitrackPlayer();
+    if(multitrackPlayer.isPlaying()) {
+        _mixerEngine->stopPlayback();
+        return;
+    }
+
+    // Recordings are named after the time they have been started, so the latest one sorts last
+    QString directory = _mixerOptions.soundcheckDirectory;
+    if(directory.isEmpty()) {
+        QStringList recordings = QDir(_mixerOptions.recordDirectory).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+        if(recordings.isEmpty()) {
+            qWarning("No recording found in %s", qPrintable(_mixerOptions.recordDirectory));
+            return;
+        }
+        directory = QDir(_mixerOptions.recordDirectory).filePath(recordings.last());
+    }
+
+    if(_mixerEngine->startPlayback(directory, _sampleRate, _mixerOptions.soundcheckChannels)) {
+        qDebug("Playing back %s.", qPrintable(directory));
+    } else {
+        qWarning("%s", qPrintable(multitrackPlayer.errorString()));
+    }
+}
+
+void EngineController::exportCycleStatistics(const QString& fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning("Could not open file for write: %s", qPrintable(fileName));
+        return;
+    }
+
+    QJsonArray xrunsArray;
+    foreach(const XrunSnapshot& xrunSnapshot, _xrunSnapshots) {
+        xrunsArray.append(xrunSnapshot.toJson());
+    }
+    QJsonObject jsonObject;
+    jsonObject.insert("histogram", _mixerEngine->cycleMonitor().histogramToJson());
+    jsonObject.insert("xruns", xrunsArray);
+    file.write(QJsonDocument(jsonObject).toJson());
+    file.close();
+}
+
+void EngineController::saveState(const QString& fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning("Could not open file for write: %s", qPrintable(fileName));
+        return;
+    }
+
+    QJsonObject jsonObject = _state;
+    if(!_automationRecorder.events().isEmpty()) {
+        jsonObject.insert("automation", AutomationRecorder::toJson(_automationRecorder.events()));
+    }
+    file.write(QJsonDocument(jsonObject).toJson());
+    file.close();
+}
+
+void EngineController::loadAutomation(const QString& fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        qWarning("Could not open file for read: %s", qPrintable(fileName));
+        return;
+    }
+    QJsonObject jsonObject = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    if(_automationPlaying) {
+        toggleAutomationPlayback();
+    }
+    _automationRecorder.setEvents(AutomationRecorder::fromJson(jsonObject.value("automation").toArray()));
+    _mixerEngine->setAutomation(_automationRecorder.events());
+}
+
+MixerState EngineController::mixerState() const
+{
+    return MixerState::fromJson(_state, _mixerOptions.channelCount, _mixerOptions.subgroupCount, _sampleRate);
+}
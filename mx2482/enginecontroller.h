@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef ENGINECONTROLLER_H
+#define ENGINECONTROLLER_H
+
+// Qt includes
+#include <QList>
+#include <QVector>
+#include <QJsonObject>
+
+// Own includes
+#include "mixeroptions.h"
+#include "mixerengine.h"
+#include "enginesegment.h"
+#include "waitfreequeue.h"
+#include "automationrecorder.h"
+
+/**
+ * Serves the engine segment of a headless engine. It hands the state
+ * published by the user interface to the engine, passes meters, remote
+ * changes and the status the other way, and does what the user interface
+ * requests: recording, the virtual soundcheck, automation and exporting the
+ * period statistics, with the directories given to the engine on the
+ * command line. It does not know where the audio comes from, so it serves
+ * an engine on BufferMixerPorts just like one on JACK.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class EngineController
+{
+public:
+    enum {
+        /** Xrun snapshots kept for exporting, older ones are discarded. */
+        XrunSnapshotCount = 32
+    };
+
+    /**
+     * Constructor.
+     * @param mixerEngine Engine to be controlled, not owned.
+     * @param engineSegment Segment created for the engine, not owned.
+     * @param sampleRate Sample rate the engine runs at.
+     */
+    EngineController(const MixerOptions& mixerOptions, MixerEngine *mixerEngine,
+                     EngineSegment *engineSegment, int sampleRate);
+
+    /**
+     * Passes the remote changes made over OSC on to the user interface.
+     * @param controlQueue Queue of the OSC control server, not owned. 0 for none.
+     */
+    void setControlQueue(WaitFreeQueue<MixerCommand> *controlQueue);
+
+    /**
+     * Hands the state to the engine. It is the default one, until a user
+     * interface attaches and publishes its controls.
+     */
+    void publishState();
+
+    /**
+     * Takes the state and the requests of the user interface, then passes
+     * meters, remote changes and the status the other way. Requests are
+     * handled after the state, so they see the controls as they have been
+     * when made. Failures are reported with qWarning().
+     * @param engineStatus Status of the audio backend: whether it runs in
+     * realtime, the buffer size, the CPU load and the sample rate. The rest
+     * is filled in here.
+     */
+    void update(EngineStatus engineStatus);
+
+private:
+    /** Does what the user interface has asked for. */
+    void handleRequest(const EngineRequest& engineRequest);
+
+    void toggleAutomationRecording();
+    void toggleAutomationPlayback();
+    void toggleRecording();
+    void toggleSoundcheck();
+    void exportCycleStatistics(const QString& fileName);
+    void saveState(const QString& fileName);
+    void loadAutomation(const QString& fileName);
+
+    /** @returns the state parsed for the engine. */
+    MixerState mixerState() const;
+
+    MixerOptions _mixerOptions;
+    MixerEngine *_mixerEngine;
+    EngineSegment *_engineSegment;
+    int _sampleRate;
+    /** Remote changes made over OSC, 0 if there is no OSC control server. */
+    WaitFreeQueue<MixerCommand> *_controlQueue;
+
+    /** State of the mixer, as published by the user interface and changed remotely. */
+    QJsonObject _state;
+    /** Levels collected from the meter ring since the last update. */
+    QVector<MeterRecord> _meterRecords;
+
+    /** Records the states published by the user interface. */
+    AutomationRecorder _automationRecorder;
+    /** Whether the engine plays back the recorded automation. */
+    bool _automationPlaying;
+    /** Snapshots of the last xruns, for exporting. */
+    QList<XrunSnapshot> _xrunSnapshots;
+};
+
+#endif // ENGINECONTROLLER_H
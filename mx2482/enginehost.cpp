@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "enginehost.h"
+#include "oscserver.h"
+
+// QJackAudio includes
+#include <QJackClient>
+
+// Qt includes
+#include <QCoreApplication>
+
+// Standard includes
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/** Pair of connected sockets, the signal handler writes to the first one. */
+static int signalSockets[2] = { -1, -1 };
+
+EngineHost::EngineHost(const MixerOptions& mixerOptions, QObject *parent) :
+    QObject(parent),
+    _mixerOptions(mixerOptions),
+    _engineSegment(mixerOptions.segmentName),
+    _mixerPorts(0),
+    _mixerEngine(0),
+    _lv2Host(0),
+    _engineController(0),
+    _oscThread(0),
+    _updateTimer(this),
+    _signalNotifier(0)
+{
+    connect(&_updateTimer, SIGNAL(timeout()), this, SLOT(updateSegment()));
+    _updateTimer.setInterval(UpdateInterval);
+    _updateTimer.setSingleShot(false);
+}
+
+EngineHost::~EngineHost()
+{
+    if(_mixerEngine) {
+        QJackClient::instance()->stopAudioProcessing();
+    }
+    // The server is deleted when its thread finishes, which has to happen before the engine goes
+    if(_oscThread) {
+        _oscThread->quit();
+        _oscThread->wait();
+    }
+    delete _engineController;
+    delete _mixerEngine;
+    delete _mixerPorts;
+    delete _lv2Host;
+}
+
+bool EngineHost::start()
+{
+    // The application cannot be quit from a signal handler directly, so it is told through a socket
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, signalSockets) == 0) {
+        _signalNotifier = new QSocketNotifier(signalSockets[1], QSocketNotifier::Read, this);
+        connect(_signalNotifier, SIGNAL(activated(int)), this, SLOT(handleSignal()));
+        signal(SIGINT, signalHandler);
+        signal(SIGTERM, signalHandler);
+    }
+
+    if(!_engineSegment.create(_mixerOptions.channelCount, _mixerOptions.subgroupCount)) {
+        qWarning("Could not create the engine segment \"%s\": %s",
+                 qPrintable(_mixerOptions.segmentName), qPrintable(_engineSegment.errorString()));
+        return false;
+    }
+
+    QJackClient* jackClient = QJackClient::instance();
+    if(!jackClient->connectToServer("MX2482")) {
+        qWarning("Could not connect to the JACK server.");
+        return false;
+    }
+    jackClient->setAudioProcessor(this);
+
+    // Setup audio processing
+    _mixerPorts = new JackMixerPorts(_mixerOptions.channelCount, _mixerOptions.subgroupCount);
+    _mixerEngine = new MixerEngine(_mixerPorts, _mixerOptions.channelCount, _mixerOptions.subgroupCount);
+    _mixerEngine->resizeBuffers(jackClient->bufferSize());
+    _mixerEngine->setEqualizerEngine(_mixerOptions.equalizerEngine);
+    _mixerEngine->setSilenceDetection(_mixerOptions.silenceThreshold, _mixerOptions.silenceHoldPeriods);
+    _mixerEngine->setDirectOutTap(_mixerOptions.directOutTap);
+    _mixerEngine->startWorkerPool(_mixerOptions.workerPool);
+    _mixerEngine->cycleMonitor().setSampleRate(jackClient->sampleRate());
+    if(!_mixerOptions.traceFile.isEmpty() && !_mixerEngine->startTracing(_mixerOptions.traceFile)) {
+        qWarning("%s", qPrintable(_mixerEngine->stageTracer().errorString()));
+    }
+    _engineController = new EngineController(_mixerOptions, _mixerEngine, &_engineSegment, jackClient->sampleRate());
+
+    // Load the insert effects, a plugin that fails to load leaves its slot empty
+    if(!_mixerOptions.inserts.isEmpty()) {
+        _lv2Host = new Lv2Host();
+    }
+    QMap<int, QString>::const_iterator insert;
+    for(insert = _mixerOptions.inserts.constBegin(); insert != _mixerOptions.inserts.constEnd(); ++insert) {
+        QString errorString;
+        Lv2Insert *lv2Insert = _lv2Host->createInsert(insert.value(), jackClient->sampleRate(), jackClient->bufferSize(), &errorString);
+        if(lv2Insert) {
+            _mixerEngine->setInsertEffect(insert.key(), lv2Insert);
+        } else {
+            qWarning("%s", qPrintable(errorString));
+        }
+    }
+
+    _engineController->publishState();
+    jackClient->startAudioProcessing();
+
+    if(_mixerOptions.oscPort > 0) {
+        OscServer *oscServer = new OscServer(_mixerEngine, QHostAddress(_mixerOptions.oscAddress), _mixerOptions.oscPort);
+        _engineController->setControlQueue(&oscServer->controlQueue());
+        _oscThread = new QThread(this);
+        oscServer->moveToThread(_oscThread);
+        connect(_oscThread, SIGNAL(started()), oscServer, SLOT(start()));
+        connect(_oscThread, SIGNAL(finished()), oscServer, SLOT(deleteLater()));
+        _oscThread->start();
+    }
+
+    updateSegment();
+    _updateTimer.start();
+    qDebug("Engine running in segment \"%s\".", qPrintable(_mixerOptions.segmentName));
+    return true;
+}
+
+void EngineHost::process()
+{
+    _mixerEngine->process(QJackClient::instance()->bufferSize());
+}
+
+void EngineHost::updateSegment()
+{
+    QJackClient *jackClient = QJackClient::instance();
+
+    // QJackClient does not forward JACK's buffer size callback, so we pick up
+    // a new buffer size here, outside of the realtime thread.
+    if(jackClient->bufferSize() != _mixerEngine->frames()) {
+        _mixerEngine->resizeBuffers(jackClient->bufferSize());
+    }
+
+    EngineStatus engineStatus;
+    engineStatus.realtime = jackClient->isRealtime();
+    engineStatus.bufferSize = jackClient->bufferSize();
+    engineStatus.cpuLoad = jackClient->cpuLoad();
+    engineStatus.sampleRate = jackClient->sampleRate();
+    _engineController->update(engineStatus);
+}
+
+void EngineHost::handleSignal()
+{
+    char signalNumber;
+    if(read(signalSockets[1], &signalNumber, 1) == 1) {
+        qDebug("Quitting after signal %d.", signalNumber);
+    }
+    QCoreApplication::quit();
+}
+
+void EngineHost::signalHandler(int signalNumber)
+{
+    // Only async-signal-safe calls are allowed here
+    char byte = (char)signalNumber;
+    ssize_t written = write(signalSockets[0], &byte, 1);
+    Q_UNUSED(written);
+}
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ENGINEHOST_H
+#define ENGINEHOST_H
+
+// Qt includes
+#include <QObject>
+#include <QTimer>
+#include <QThread>
+#include <QSocketNotifier>
+
+// QJackAudio includes
+#include <QAudioProcessor>
+
+// Own includes
+#include "mixeroptions.h"
+#include "mixerengine.h"
+#include "jackmixerports.h"
+#include "lv2host.h"
+#include "enginesegment.h"
+#include "enginecontroller.h"
+
+/**
+ * Runs the mixer engine without any widgets, in a process of its own. It
+ * owns the JACK client, the engine with all channel strips and the insert
+ * effects. A user interface started with --attach reads the meters and
+ * writes the controls through an EngineSegment, and may come and go while
+ * the audio keeps running. The segment is served by an EngineController,
+ * which also handles recording, the virtual soundcheck, automation and the
+ * period statistics on request of the user interface.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class EngineHost : public QObject, public QAudioProcessor
+{
+    Q_OBJECT
+
+public:
+    enum {
+        /** Interval the segment is updated in, in milliseconds. */
+        UpdateInterval = 20
+    };
+
+    /** Constructor */
+    explicit EngineHost(const MixerOptions& mixerOptions, QObject *parent = 0);
+    /** Destructor, stops the audio. */
+    ~EngineHost();
+
+    /**
+     * Creates the segment, connects to JACK and starts processing. Quits
+     * the application on SIGINT and SIGTERM.
+     * @returns true on success, failures are reported with qWarning().
+     */
+    bool start();
+
+    /** @overload */
+    void process();
+
+private slots:
+    /** Picks up a new buffer size and lets the controller update the segment. */
+    void updateSegment();
+
+    /** Quits the application after a signal. */
+    void handleSignal();
+
+private:
+    static void signalHandler(int signalNumber);
+
+    MixerOptions _mixerOptions;
+    EngineSegment _engineSegment;
+
+    /** JACK ports the mixer engine reads from and writes to. */
+    JackMixerPorts *_mixerPorts;
+    /** Engine doing the audio processing. */
+    MixerEngine *_mixerEngine;
+    /** Host for the insert effects, only created if there are any. */
+    Lv2Host *_lv2Host;
+    /** Serves the segment for the engine. */
+    EngineController *_engineController;
+    /** Thread the OSC control server runs in, only created if it is enabled. */
+    QThread *_oscThread;
+
+    QTimer _updateTimer;
+    /** Reports signals to the event loop, see signalHandler(). */
+    QSocketNotifier *_signalNotifier;
+};
+
+#endif // ENGINEHOST_H
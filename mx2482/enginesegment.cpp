@@ -0,0 +1,396 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "enginesegment.h"
+
+// Qt includes
+#include <QJsonDocument>
+
+// Standard includes
+#include <cstring>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+
+/** Identifies a segment of this application, "MX24". */
+static const quint32 SegmentMagic = 0x4d583234;
+/** Incremented whenever the layout of the segment or the mixer commands change. */
+static const quint32 SegmentVersion = 3;
+
+/**
+ * Start of the segment, followed by the meter records and the state.
+ * Only accessed with the lock held.
+ */
+struct EngineSegment::Header
+{
+    quint32 magic;
+    quint32 version;
+    qint32 channelCount;
+    qint32 subgroupCount;
+    /** Bytes available for the state. */
+    qint32 stateCapacity;
+
+    /** Process of the engine, 0 if it has detached. */
+    qint64 enginePid;
+    /** Process of the attached user interface, 0 if none. */
+    qint64 clientPid;
+
+    EngineStatus status;
+
+    /** Size of the serialized state, 0 if there has been none yet. */
+    qint32 stateSize;
+    /** Whether the user interface has published the state and the engine has not taken it yet. */
+    qint32 statePending;
+    /** Frames to crossfade to the published state over. */
+    qint32 crossfadeFrames;
+
+    /** Remote changes the user interface has not taken yet. */
+    qint32 controlCount;
+    MixerCommand controls[ControlCapacity];
+
+    /** Requests the engine has not taken yet. */
+    qint32 requestCount;
+    EngineRequest requests[RequestCapacity];
+};
+
+/** @returns true, if the process is still running. */
+static bool processExists(qint64 pid)
+{
+    return kill((pid_t)pid, 0) == 0 || errno == EPERM;
+}
+
+EngineSegment::EngineSegment(const QString& name) :
+    _sharedMemory(name),
+    _engine(false),
+    _channelCount(0),
+    _subgroupCount(0)
+{
+}
+
+EngineSegment::~EngineSegment()
+{
+    detach();
+}
+
+bool EngineSegment::create(int channelCount, int subgroupCount)
+{
+    // A segment left behind by an engine that has crashed goes away once the last process detaches
+    if(_sharedMemory.attach()) {
+        _sharedMemory.lock();
+        qint64 enginePid = header()->enginePid;
+        _sharedMemory.unlock();
+        _sharedMemory.detach();
+        if(enginePid != 0 && processExists(enginePid)) {
+            _errorString = QString("Another engine is running as process %1.").arg(enginePid);
+            return false;
+        }
+    }
+
+    _engine = true;
+    _channelCount = channelCount;
+    _subgroupCount = subgroupCount;
+    int stateCapacity = StateBytesPerStrip * (channelCount + subgroupCount + MixerState::MainCount);
+    int size = sizeof(Header) + meterCount() * sizeof(MeterRecord) + stateCapacity;
+    if(!_sharedMemory.create(size)) {
+        _errorString = _sharedMemory.errorString();
+        return false;
+    }
+
+    _sharedMemory.lock();
+    memset(_sharedMemory.data(), 0, size);
+    Header *segmentHeader = header();
+    segmentHeader->magic = SegmentMagic;
+    segmentHeader->version = SegmentVersion;
+    segmentHeader->channelCount = channelCount;
+    segmentHeader->subgroupCount = subgroupCount;
+    segmentHeader->stateCapacity = stateCapacity;
+    segmentHeader->enginePid = getpid();
+    _sharedMemory.unlock();
+    return true;
+}
+
+bool EngineSegment::attach()
+{
+    if(!_sharedMemory.attach()) {
+        _errorString = QString("No engine is running: %1").arg(_sharedMemory.errorString());
+        return false;
+    }
+
+    _sharedMemory.lock();
+    Header *segmentHeader = header();
+    if(segmentHeader->magic != SegmentMagic || segmentHeader->version != SegmentVersion) {
+        _sharedMemory.unlock();
+        _sharedMemory.detach();
+        _errorString = "The engine is of another version.";
+        return false;
+    }
+    if(segmentHeader->clientPid != 0 && processExists(segmentHeader->clientPid)) {
+        qint64 clientPid = segmentHeader->clientPid;
+        _sharedMemory.unlock();
+        _sharedMemory.detach();
+        _errorString = QString("Another user interface is attached as process %1.").arg(clientPid);
+        return false;
+    }
+
+    _engine = false;
+    _channelCount = segmentHeader->channelCount;
+    _subgroupCount = segmentHeader->subgroupCount;
+    segmentHeader->clientPid = getpid();
+
+    // Levels and changes that have piled up without a user interface are stale, the state has them all
+    memset(meterRecords(), 0, meterCount() * sizeof(MeterRecord));
+    segmentHeader->controlCount = 0;
+    _sharedMemory.unlock();
+    return true;
+}
+
+void EngineSegment::detach()
+{
+    if(!_sharedMemory.isAttached()) {
+        return;
+    }
+
+    _sharedMemory.lock();
+    if(_engine) {
+        header()->enginePid = 0;
+    } else {
+        header()->clientPid = 0;
+    }
+    _sharedMemory.unlock();
+    _sharedMemory.detach();
+}
+
+bool EngineSegment::isAttached() const
+{
+    return _sharedMemory.isAttached();
+}
+
+int EngineSegment::channelCount() const
+{
+    return _channelCount;
+}
+
+int EngineSegment::subgroupCount() const
+{
+    return _subgroupCount;
+}
+
+int EngineSegment::meterCount() const
+{
+    return _channelCount + _subgroupCount + MixerState::MainCount;
+}
+
+int EngineSegment::channelMeterIndex(int i) const
+{
+    return i;
+}
+
+int EngineSegment::subgroupMeterIndex(int i) const
+{
+    return _channelCount + i;
+}
+
+int EngineSegment::mainMeterIndex(int i) const
+{
+    return _channelCount + _subgroupCount + i;
+}
+
+void EngineSegment::setStatus(const EngineStatus& engineStatus)
+{
+    _sharedMemory.lock();
+    Header *segmentHeader = header();
+    quint32 heartbeat = segmentHeader->status.heartbeat + 1;
+    segmentHeader->status = engineStatus;
+    segmentHeader->status.heartbeat = heartbeat;
+    _sharedMemory.unlock();
+}
+
+EngineStatus EngineSegment::status()
+{
+    _sharedMemory.lock();
+    EngineStatus engineStatus = header()->status;
+    _sharedMemory.unlock();
+    return engineStatus;
+}
+
+void EngineSegment::addMeters(const MeterRecord *meterRecords)
+{
+    _sharedMemory.lock();
+    MeterRecord *segmentRecords = this->meterRecords();
+    for(int i = 0; i < meterCount(); i++) {
+        segmentRecords[i].accumulate(meterRecords[i]);
+    }
+    _sharedMemory.unlock();
+}
+
+void EngineSegment::takeMeters(MeterRecord *meterRecords)
+{
+    _sharedMemory.lock();
+    MeterRecord *segmentRecords = this->meterRecords();
+    memcpy(meterRecords, segmentRecords, meterCount() * sizeof(MeterRecord));
+    for(int i = 0; i < meterCount(); i++) {
+        segmentRecords[i].clear();
+    }
+    _sharedMemory.unlock();
+}
+
+bool EngineSegment::publishState(const QJsonObject& jsonObject, int crossfadeFrames)
+{
+    QByteArray stateBytes = QJsonDocument(jsonObject).toJson(QJsonDocument::Compact);
+
+    _sharedMemory.lock();
+    bool written = writeState(stateBytes);
+    if(written) {
+        header()->statePending = 1;
+        header()->crossfadeFrames = crossfadeFrames;
+    }
+    _sharedMemory.unlock();
+    return written;
+}
+
+bool EngineSegment::takeState(QJsonObject& jsonObject, int& crossfadeFrames)
+{
+    _sharedMemory.lock();
+    Header *segmentHeader = header();
+    if(!segmentHeader->statePending) {
+        _sharedMemory.unlock();
+        return false;
+    }
+    QByteArray stateBytes(stateData(), segmentHeader->stateSize);
+    crossfadeFrames = segmentHeader->crossfadeFrames;
+    segmentHeader->statePending = 0;
+    _sharedMemory.unlock();
+
+    jsonObject = QJsonDocument::fromJson(stateBytes).object();
+    return true;
+}
+
+void EngineSegment::updateState(const QJsonObject& jsonObject, const QList<MixerCommand>& mixerCommands)
+{
+    QByteArray stateBytes = QJsonDocument(jsonObject).toJson(QJsonDocument::Compact);
+
+    _sharedMemory.lock();
+    Header *segmentHeader = header();
+    if(!segmentHeader->statePending && !writeState(stateBytes)) {
+        qWarning("The state of %d bytes does not fit into the engine segment.", stateBytes.size());
+    }
+
+    // If the user interface does not keep up, its controls miss the change, but the audio does not
+    foreach(const MixerCommand& mixerCommand, mixerCommands) {
+        if(segmentHeader->controlCount == ControlCapacity) {
+            break;
+        }
+        segmentHeader->controls[segmentHeader->controlCount++] = mixerCommand;
+    }
+    _sharedMemory.unlock();
+}
+
+QJsonObject EngineSegment::state()
+{
+    _sharedMemory.lock();
+    QByteArray stateBytes(stateData(), header()->stateSize);
+    _sharedMemory.unlock();
+
+    if(stateBytes.isEmpty()) {
+        return QJsonObject();
+    }
+    return QJsonDocument::fromJson(stateBytes).object();
+}
+
+QList<MixerCommand> EngineSegment::takeControls()
+{
+    QList<MixerCommand> mixerCommands;
+    _sharedMemory.lock();
+    Header *segmentHeader = header();
+    for(int i = 0; i < segmentHeader->controlCount; i++) {
+        mixerCommands.append(segmentHeader->controls[i]);
+    }
+    segmentHeader->controlCount = 0;
+    _sharedMemory.unlock();
+    return mixerCommands;
+}
+
+bool EngineSegment::addRequest(EngineRequest::Type type, const QString& fileName)
+{
+    QByteArray fileNameBytes = fileName.toUtf8();
+    if(fileNameBytes.size() >= EngineRequest::FileNameCapacity) {
+        return false;
+    }
+
+    _sharedMemory.lock();
+    Header *segmentHeader = header();
+    if(segmentHeader->requestCount == RequestCapacity) {
+        _sharedMemory.unlock();
+        return false;
+    }
+    EngineRequest& engineRequest = segmentHeader->requests[segmentHeader->requestCount++];
+    engineRequest.type = type;
+    memcpy(engineRequest.fileName, fileNameBytes.constData(), fileNameBytes.size() + 1);
+    _sharedMemory.unlock();
+    return true;
+}
+
+QList<EngineRequest> EngineSegment::takeRequests()
+{
+    QList<EngineRequest> engineRequests;
+    _sharedMemory.lock();
+    Header *segmentHeader = header();
+    for(int i = 0; i < segmentHeader->requestCount; i++) {
+        engineRequests.append(segmentHeader->requests[i]);
+    }
+    segmentHeader->requestCount = 0;
+    _sharedMemory.unlock();
+    return engineRequests;
+}
+
+QString EngineSegment::errorString() const
+{
+    return _errorString;
+}
+
+EngineSegment::Header *EngineSegment::header()
+{
+    return static_cast<Header*>(_sharedMemory.data());
+}
+
+MeterRecord *EngineSegment::meterRecords()
+{
+    return reinterpret_cast<MeterRecord*>(static_cast<char*>(_sharedMemory.data()) + sizeof(Header));
+}
+
+char *EngineSegment::stateData()
+{
+    return reinterpret_cast<char*>(meterRecords() + meterCount());
+}
+
+bool EngineSegment::writeState(const QByteArray& stateBytes)
+{
+    Header *segmentHeader = header();
+    if(stateBytes.size() > segmentHeader->stateCapacity) {
+        return false;
+    }
+    memcpy(stateData(), stateBytes.constData(), stateBytes.size());
+    segmentHeader->stateSize = stateBytes.size();
+    return true;
+}
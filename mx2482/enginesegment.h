@@ -0,0 +1,235 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ENGINESEGMENT_H
+#define ENGINESEGMENT_H
+
+// Qt includes
+#include <QSharedMemory>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+// Own includes
+#include "meterring.h"
+#include "mixercommand.h"
+#include "cyclemonitor.h"
+
+/**
+ * What a headless engine reports about itself to the user interface.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct EngineStatus
+{
+    bool realtime;
+    int bufferSize;
+    /** JACK's CPU load in percent. */
+    float cpuLoad;
+    int sampleRate;
+    CycleStatistics cycleStatistics;
+    bool automationRecording;
+    bool automationPlaying;
+    bool recording;
+    qint64 recordingDroppedFrames;
+    bool recordingFailed;
+    bool soundcheck;
+    qint64 soundcheckMissedFrames;
+    /** Incremented by the engine each time it updates the status. */
+    quint32 heartbeat;
+};
+
+/**
+ * Asks a headless engine to do something besides changing the controls.
+ * Failures are reported in the log of the engine.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct EngineRequest
+{
+    enum {
+        /** Bytes available for the file name, including the terminating zero. */
+        FileNameCapacity = 1024
+    };
+
+    enum Type {
+        ToggleAutomationRecording,
+        ToggleAutomationPlayback,
+        ToggleRecording,
+        ToggleSoundcheck,
+        /** Writes the period statistics to fileName. */
+        ExportCycleStatistics,
+        /** Writes the state with the recorded automation to fileName. */
+        SaveState,
+        /** Replaces the automation with the one of the state in fileName. */
+        LoadAutomation
+    };
+
+    qint32 type;
+    /** UTF-8 encoded file for the requests that need one, empty otherwise. */
+    char fileName[FileNameCapacity];
+};
+
+/**
+ * Shared memory segment a headless engine and the user interface talk
+ * through, when they run in processes of their own. The engine creates it
+ * with its topology, a single user interface attaches to it.
+ *
+ * The user interface publishes the state of its controls as a whole, just
+ * like it publishes snapshots to an engine of its own, and the engine
+ * parses and hands it to the realtime thread. Changes made by the engine's
+ * remote control are passed back, so the controls can follow. The engine
+ * merges the meter records of all periods into the segment, the user
+ * interface takes them out, and the last state is kept there for a user
+ * interface that attaches later. Recording, the virtual soundcheck,
+ * automation and the period statistics are handled by the engine, which the
+ * user interface asks for with requests.
+ *
+ * Neither side is a realtime thread, so all of it is guarded by the lock of
+ * the segment. The audio is never held up by the user interface.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class EngineSegment
+{
+public:
+    enum {
+        /** Remote changes that may be pending for the user interface. */
+        ControlCapacity = 1024,
+        /** Requests that may be pending for the engine. */
+        RequestCapacity = 16,
+        /** Bytes reserved for the state of each strip. */
+        StateBytesPerStrip = 4096
+    };
+
+    /**
+     * Constructor.
+     * @param name Name of the segment, engine and user interface must agree on it.
+     */
+    explicit EngineSegment(const QString& name);
+    /** Destructor, detaches. */
+    ~EngineSegment();
+
+    /**
+     * Engine only. Creates the segment, replacing one left behind by an
+     * engine that has crashed.
+     * @returns true on success, otherwise errorString() tells why.
+     */
+    bool create(int channelCount, int subgroupCount);
+
+    /**
+     * User interface only. Attaches to the segment of a running engine.
+     * @returns true on success, otherwise errorString() tells why.
+     */
+    bool attach();
+
+    /** Detaches from the segment. It is removed when the last process detaches. */
+    void detach();
+
+    /** @returns true, if the segment has been created or attached to. */
+    bool isAttached() const;
+
+    /** @returns the number of channels of the engine. */
+    int channelCount() const;
+    /** @returns the number of subgroups of the engine. */
+    int subgroupCount() const;
+
+    /** @returns the number of meter records, laid out like MixerEngine::meterRing(). */
+    int meterCount() const;
+    /** @returns the meter record index of channel i (starting at 0). */
+    int channelMeterIndex(int i) const;
+    /** @returns the meter record index of subgroup i (starting at 0). */
+    int subgroupMeterIndex(int i) const;
+    /** @returns the meter record index of main i (0 is left, 1 is right). */
+    int mainMeterIndex(int i) const;
+
+    /** Engine only. Updates the status and the heartbeat. */
+    void setStatus(const EngineStatus& engineStatus);
+    /** @returns the status last set by the engine. */
+    EngineStatus status();
+
+    /** Engine only. Merges one slot of meter records, one for each meter. */
+    void addMeters(const MeterRecord *meterRecords);
+    /**
+     * User interface only. Takes all meter records merged since the last
+     * call, one for each meter.
+     */
+    void takeMeters(MeterRecord *meterRecords);
+
+    /**
+     * User interface only. Publishes the state of the controls.
+     * @param crossfadeFrames Frames to crossfade over, 0 to switch over at once.
+     * @returns false, if the state does not fit into the segment.
+     */
+    bool publishState(const QJsonObject& jsonObject, int crossfadeFrames);
+
+    /**
+     * Engine only. Takes the state the user interface has published since
+     * the last call.
+     * @returns false, if there is none.
+     */
+    bool takeState(QJsonObject& jsonObject, int& crossfadeFrames);
+
+    /**
+     * Engine only. Stores the state after remote changes, and passes these
+     * on to the user interface. The state is not stored, if the user
+     * interface has published one in the meantime, as it is taken next.
+     */
+    void updateState(const QJsonObject& jsonObject, const QList<MixerCommand>& mixerCommands);
+
+    /**
+     * User interface only. @returns the last state, empty if there has
+     * been none yet.
+     */
+    QJsonObject state();
+
+    /** User interface only. @returns the remote changes since the last call. */
+    QList<MixerCommand> takeControls();
+
+    /**
+     * User interface only. Asks the engine to do something, see EngineRequest.
+     * @returns false, if too many requests are pending or fileName is too long.
+     */
+    bool addRequest(EngineRequest::Type type, const QString& fileName = QString());
+
+    /** Engine only. @returns the requests since the last call, in the order they have been made. */
+    QList<EngineRequest> takeRequests();
+
+    /** @returns a description of the last error. */
+    QString errorString() const;
+
+private:
+    struct Header;
+
+    Header *header();
+    MeterRecord *meterRecords();
+    char *stateData();
+
+    /** Writes a serialized state, with the lock held. @returns false, if it does not fit. */
+    bool writeState(const QByteArray& stateBytes);
+
+    QSharedMemory _sharedMemory;
+    bool _engine;
+    int _channelCount;
+    int _subgroupCount;
+    QString _errorString;
+};
+
+#endif // ENGINESEGMENT_H
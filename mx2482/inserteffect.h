@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef INSERTEFFECT_H
+#define INSERTEFFECT_H
+
+/**
+ * Effect running inline in the insert slot of a channel strip, between
+ * equalizer and aux send. It processes the mono signal of the strip in
+ * place, in the realtime thread, so it adds no period of latency.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class InsertEffect
+{
+public:
+    virtual ~InsertEffect() { }
+
+    /** Processes frames samples of buffer in place. Called from the realtime thread. */
+    virtual void process(float *buffer, int frames) = 0;
+
+    /**
+     * Reallocates internal buffers for a new buffer size. Never called from
+     * the realtime thread and only while processing is suspended.
+     */
+    virtual void resizeBuffers(int frames) = 0;
+};
+
+#endif // INSERTEFFECT_H
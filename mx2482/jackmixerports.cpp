@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "jackmixerports.h"
+#include "sampleops.h"
+
+// QJackAudio includes
+#include <QJackClient>
+
+JackMixerPorts::JackMixerPorts(int channelCount, int subgroupCount)
+{
+    QJackClient *jackClient = QJackClient::instance();
+    for(int i = 1; i <= channelCount; i++) {
+        _channelIns.append (jackClient->registerAudioInPort (QString("ch%1_in")       .arg(i)));
+        _auxSends.append   (jackClient->registerAudioOutPort(QString("ch%1_aux_send") .arg(i)));
+        _auxReturns.append (jackClient->registerAudioInPort (QString("ch%1_aux_ret")  .arg(i)));
+        _channelOuts.append(jackClient->registerAudioOutPort(QString("ch%1_out")      .arg(i)));
+    }
+
+    for(int i = 1; i <= subgroupCount; i++) {
+        _subgroupOuts.append(jackClient->registerAudioOutPort(QString("subgroup%1_out").arg(i)));
+    }
+
+    _mainOuts.append(jackClient->registerAudioOutPort("main_out_1"));
+    _mainOuts.append(jackClient->registerAudioOutPort("main_out_2"));
+}
+
+void JackMixerPorts::readChannelInput(int channel, float *target, int frames)
+{
+    readSamples(_channelIns.at(channel)->sampleBuffer(), target, frames);
+}
+
+void JackMixerPorts::writeChannelOutput(int channel, const float *source, int frames)
+{
+    writeSamples(source, _channelOuts.at(channel)->sampleBuffer(), frames);
+}
+
+void JackMixerPorts::writeAuxSend(int channel, const float *source, int frames)
+{
+    writeSamples(source, _auxSends.at(channel)->sampleBuffer(), frames);
+}
+
+void JackMixerPorts::readAuxReturn(int channel, float *target, int frames)
+{
+    readSamples(_auxReturns.at(channel)->sampleBuffer(), target, frames);
+}
+
+void JackMixerPorts::writeSubgroupOutput(int subgroup, const float *source, int frames)
+{
+    writeSamples(source, _subgroupOuts.at(subgroup)->sampleBuffer(), frames);
+}
+
+void JackMixerPorts::writeMainOutput(int main, const float *source, int frames)
+{
+    writeSamples(source, _mainOuts.at(main)->sampleBuffer(), frames);
+}
+
+void JackMixerPorts::clearChannelOutput(int channel, int frames)
+{
+    Q_UNUSED(frames);
+    _channelOuts.at(channel)->sampleBuffer().clear();
+}
+
+void JackMixerPorts::clearAuxSend(int channel, int frames)
+{
+    Q_UNUSED(frames);
+    _auxSends.at(channel)->sampleBuffer().clear();
+}
+
+void JackMixerPorts::clearSubgroupOutput(int subgroup, int frames)
+{
+    Q_UNUSED(frames);
+    _subgroupOuts.at(subgroup)->sampleBuffer().clear();
+}
+
+void JackMixerPorts::clearMainOutput(int main, int frames)
+{
+    Q_UNUSED(frames);
+    _mainOuts.at(main)->sampleBuffer().clear();
+}
+
+void JackMixerPorts::clearOutputs(int frames)
+{
+    Q_UNUSED(frames);
+    for(int i = 0; i < _channelOuts.size(); i++) {
+        _auxSends.at(i)->sampleBuffer().clear();
+        _channelOuts.at(i)->sampleBuffer().clear();
+    }
+    for(int i = 0; i < _subgroupOuts.size(); i++) {
+        _subgroupOuts.at(i)->sampleBuffer().clear();
+    }
+    for(int i = 0; i < _mainOuts.size(); i++) {
+        _mainOuts.at(i)->sampleBuffer().clear();
+    }
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef JACKMIXERPORTS_H
+#define JACKMIXERPORTS_H
+
+// Qt includes
+#include <QVector>
+
+// QJackAudio includes
+#include <QJackPort>
+
+// Own includes
+#include "mixerports.h"
+
+/**
+ * Mixer ports backed by JACK ports of the QJackClient instance. QSampleBuffer
+ * does not expose the memory of a port, and QJackClient does not expose the
+ * JACK client to look the ports up with, so channelOutputBuffer() is not
+ * provided. Channel strips are processed in scratch memory and copied to
+ * their direct outs, one copy each on the way in and out.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class JackMixerPorts : public MixerPorts
+{
+public:
+    /** Registers all JACK ports for the given number of channels and subgroups. */
+    JackMixerPorts(int channelCount, int subgroupCount);
+
+    /** @overload */
+    void readChannelInput(int channel, float *target, int frames);
+    /** @overload */
+    void writeChannelOutput(int channel, const float *source, int frames);
+    /** @overload */
+    void writeAuxSend(int channel, const float *source, int frames);
+    /** @overload */
+    void readAuxReturn(int channel, float *target, int frames);
+    /** @overload */
+    void writeSubgroupOutput(int subgroup, const float *source, int frames);
+    /** @overload */
+    void writeMainOutput(int main, const float *source, int frames);
+    /** @overload */
+    void clearChannelOutput(int channel, int frames);
+    /** @overload */
+    void clearAuxSend(int channel, int frames);
+    /** @overload */
+    void clearSubgroupOutput(int subgroup, int frames);
+    /** @overload */
+    void clearMainOutput(int main, int frames);
+    /** @overload */
+    void clearOutputs(int frames);
+
+private:
+    /** Channel inputs. */
+    QVector<QJackPort*> _channelIns;
+    /** Aux send outputs. */
+    QVector<QJackPort*> _auxSends;
+    /** Aux return inputs. */
+    QVector<QJackPort*> _auxReturns;
+    /** Channel direct outs. */
+    QVector<QJackPort*> _channelOuts;
+    /** Subgroup direct outs. */
+    QVector<QJackPort*> _subgroupOuts;
+    /** Main outs, left and right. */
+    QVector<QJackPort*> _mainOuts;
+};
+
+#endif // JACKMIXERPORTS_H
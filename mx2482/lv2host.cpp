@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "lv2host.h"
+
+// Qt includes
+#include <QMutexLocker>
+
+// LV2 includes
+#include <lv2/lv2plug.in/ns/lv2core/lv2.h>
+
+// Standard includes
+#include <cmath>
+
+Lv2Host::Lv2Host()
+{
+    _world = lilv_world_new();
+    lilv_world_load_all(_world);
+
+    _uridMap.handle = this;
+    _uridMap.map = &Lv2Host::mapUri;
+    _uridMapFeature.URI = LV2_URID__map;
+    _uridMapFeature.data = &_uridMap;
+    _features[0] = &_uridMapFeature;
+    _features[1] = 0;
+}
+
+Lv2Host::~Lv2Host()
+{
+    lilv_world_free(_world);
+}
+
+Lv2Insert *Lv2Host::createInsert(const QString& uri, double sampleRate, int frames, QString *errorString)
+{
+    LilvNode *pluginUri = lilv_new_uri(_world, uri.toUtf8().constData());
+    const LilvPlugin *plugin = lilv_plugins_get_by_uri(lilv_world_get_all_plugins(_world), pluginUri);
+    lilv_node_free(pluginUri);
+    if(!plugin) {
+        *errorString = QString("Plugin %1 is not installed.").arg(uri);
+        return 0;
+    }
+
+    // Make sure we can provide all features the plugin requires
+    LilvNodes *requiredFeatures = lilv_plugin_get_required_features(plugin);
+    QString missingFeature;
+    LILV_FOREACH(nodes, iterator, requiredFeatures) {
+        QString feature = lilv_node_as_uri(lilv_nodes_get(requiredFeatures, iterator));
+        if(feature != LV2_URID__map) {
+            missingFeature = feature;
+        }
+    }
+    lilv_nodes_free(requiredFeatures);
+    if(!missingFeature.isEmpty()) {
+        *errorString = QString("Plugin %1 requires the unsupported feature %2.").arg(uri).arg(missingFeature);
+        return 0;
+    }
+
+    LilvNode *audioPortClass = lilv_new_uri(_world, LILV_URI_AUDIO_PORT);
+    LilvNode *controlPortClass = lilv_new_uri(_world, LILV_URI_CONTROL_PORT);
+    LilvNode *inputPortClass = lilv_new_uri(_world, LILV_URI_INPUT_PORT);
+    LilvNode *connectionOptional = lilv_new_uri(_world, LV2_CORE__connectionOptional);
+
+    // Sort out the ports and pick the default of each control input
+    int portCount = lilv_plugin_get_num_ports(plugin);
+    QVector<Lv2Insert::PortType> portTypes(portCount);
+    QVector<float> defaultValues(portCount);
+    lilv_plugin_get_port_ranges_float(plugin, 0, 0, defaultValues.data());
+    int audioInputs = 0;
+    int audioOutputs = 0;
+    QString unsupportedPort;
+    for(int i = 0; i < portCount; i++) {
+        const LilvPort *port = lilv_plugin_get_port_by_index(plugin, i);
+        bool input = lilv_port_is_a(plugin, port, inputPortClass);
+        if(lilv_port_is_a(plugin, port, audioPortClass)) {
+            if(input) {
+                portTypes[i] = Lv2Insert::AudioInputPort;
+                audioInputs++;
+            } else {
+                portTypes[i] = Lv2Insert::AudioOutputPort;
+                audioOutputs++;
+            }
+        } else if(lilv_port_is_a(plugin, port, controlPortClass)) {
+            portTypes[i] = input ? Lv2Insert::ControlInputPort : Lv2Insert::ControlOutputPort;
+            if(std::isnan(defaultValues.at(i))) {
+                defaultValues[i] = 0.0f;
+            }
+        } else if(lilv_port_has_property(plugin, port, connectionOptional)) {
+            portTypes[i] = Lv2Insert::UnconnectedPort;
+        } else {
+            unsupportedPort = QString::fromUtf8(lilv_node_as_string(lilv_port_get_symbol(plugin, port)));
+        }
+    }
+
+    lilv_node_free(audioPortClass);
+    lilv_node_free(controlPortClass);
+    lilv_node_free(inputPortClass);
+    lilv_node_free(connectionOptional);
+
+    if(!unsupportedPort.isEmpty()) {
+        *errorString = QString("Plugin %1 has the port %2 of an unsupported type.").arg(uri).arg(unsupportedPort);
+        return 0;
+    }
+    if(audioInputs == 0 || audioOutputs == 0) {
+        *errorString = QString("Plugin %1 has no audio input or output.").arg(uri);
+        return 0;
+    }
+
+    LilvInstance *instance = lilv_plugin_instantiate(plugin, sampleRate, _features);
+    if(!instance) {
+        *errorString = QString("Plugin %1 could not be instantiated.").arg(uri);
+        return 0;
+    }
+
+    LilvNode *name = lilv_plugin_get_name(plugin);
+    QString pluginName = name ? QString::fromUtf8(lilv_node_as_string(name)) : uri;
+    lilv_node_free(name);
+
+    return new Lv2Insert(pluginName, instance, portTypes, defaultValues, frames);
+}
+
+LV2_URID Lv2Host::mapUri(LV2_URID_Map_Handle handle, const char *uri)
+{
+    Lv2Host *lv2Host = static_cast<Lv2Host*>(handle);
+    QMutexLocker locker(&lv2Host->_uridMutex);
+    QByteArray key(uri);
+    if(!lv2Host->_urids.contains(key)) {
+        // Ids start at 1, 0 is reserved
+        lv2Host->_urids.insert(key, lv2Host->_urids.size() + 1);
+    }
+    return lv2Host->_urids.value(key);
+}
@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef LV2HOST_H
+#define LV2HOST_H
+
+// Qt includes
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+
+// LV2 includes
+#include <lilv/lilv.h>
+#include <lv2/lv2plug.in/ns/ext/urid/urid.h>
+
+// Own includes
+#include "lv2insert.h"
+
+/**
+ * Local host for LV2 plugins that are run as insert effects. It loads the
+ * installed plugins once and instantiates them by URI. The host must
+ * outlive all inserts it has created.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class Lv2Host
+{
+public:
+    /** Constructor. Discovers all installed plugins, which may take a while. */
+    Lv2Host();
+    /** Destructor */
+    ~Lv2Host();
+
+    /**
+     * Instantiates a plugin as an insert effect. The plugin needs at least
+     * one audio input and one audio output and must not require any
+     * features besides URID mapping.
+     * @param uri URI of the plugin.
+     * @param sampleRate Sample rate the plugin runs at.
+     * @param frames Initial buffer size.
+     * @param errorString Receives the reason, if the plugin cannot be used.
+     * @returns the insert, or 0 on error. Ownership goes to the caller.
+     */
+    Lv2Insert *createInsert(const QString& uri, double sampleRate, int frames, QString *errorString);
+
+private:
+    /** Implementation of the URID map feature. */
+    static LV2_URID mapUri(LV2_URID_Map_Handle handle, const char *uri);
+
+    LilvWorld *_world;
+
+    /** Ids handed out by the URID map feature. */
+    QHash<QByteArray, LV2_URID> _urids;
+    /** Plugins may map URIs from any thread. */
+    QMutex _uridMutex;
+
+    LV2_URID_Map _uridMap;
+    LV2_Feature _uridMapFeature;
+    /** Null terminated list of supported features. */
+    const LV2_Feature *_features[2];
+};
+
+#endif // LV2HOST_H
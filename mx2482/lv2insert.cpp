@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "lv2insert.h"
+
+// Standard includes
+#include <cstring>
+
+Lv2Insert::Lv2Insert(const QString& name, LilvInstance *instance, const QVector<PortType>& portTypes,
+                     const QVector<float>& controlValues, int frames) :
+    _name(name),
+    _instance(instance),
+    _portTypes(portTypes),
+    _controlValues(controlValues)
+{
+    resizeBuffers(frames);
+    lilv_instance_activate(_instance);
+}
+
+Lv2Insert::~Lv2Insert()
+{
+    lilv_instance_deactivate(_instance);
+    lilv_instance_free(_instance);
+}
+
+QString Lv2Insert::name() const
+{
+    return _name;
+}
+
+void Lv2Insert::process(float *buffer, int frames)
+{
+    // Plugins may not be able to process in place, so the signal goes through separate buffers
+    memcpy(_inputBuffer.data(), buffer, frames * sizeof(float));
+    lilv_instance_run(_instance, frames);
+    memcpy(buffer, _outputBuffer.constData(), frames * sizeof(float));
+}
+
+void Lv2Insert::resizeBuffers(int frames)
+{
+    _inputBuffer.fill(0.0f, frames);
+    _outputBuffer.fill(0.0f, frames);
+    _discardBuffer.fill(0.0f, frames);
+    connectPorts();
+}
+
+void Lv2Insert::connectPorts()
+{
+    bool firstOutput = true;
+    for(int i = 0; i < _portTypes.size(); i++) {
+        void *location = 0;
+        switch(_portTypes.at(i)) {
+        case AudioInputPort:
+            location = _inputBuffer.data();
+            break;
+        case AudioOutputPort:
+            location = firstOutput ? _outputBuffer.data() : _discardBuffer.data();
+            firstOutput = false;
+            break;
+        case ControlInputPort:
+        case ControlOutputPort:
+            location = &_controlValues[i];
+            break;
+        case UnconnectedPort:
+            break;
+        }
+        lilv_instance_connect_port(_instance, i, location);
+    }
+}
@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef LV2INSERT_H
+#define LV2INSERT_H
+
+// Qt includes
+#include <QVector>
+#include <QString>
+
+// LV2 includes
+#include <lilv/lilv.h>
+
+// Own includes
+#include "inserteffect.h"
+
+/**
+ * An LV2 plugin instance running as insert effect. The strip signal is fed
+ * to all audio inputs of the plugin, the first audio output is returned to
+ * the strip. Control inputs are set to their defaults. Instances are
+ * created by Lv2Host.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class Lv2Insert : public InsertEffect
+{
+public:
+    /** Destructor. Deactivates and frees the instance. */
+    ~Lv2Insert();
+
+    /** @returns the name of the plugin. */
+    QString name() const;
+
+    /** @overload */
+    void process(float *buffer, int frames);
+    /** @overload */
+    void resizeBuffers(int frames);
+
+private:
+    friend class Lv2Host;
+
+    /** Kind of a plugin port, as far as the insert is concerned. */
+    enum PortType {
+        AudioInputPort,
+        AudioOutputPort,
+        ControlInputPort,
+        ControlOutputPort,
+        /** Optional port of another type, left unconnected. */
+        UnconnectedPort
+    };
+
+    /**
+     * Constructor.
+     * @param instance Activated plugin instance, owned from now on.
+     * @param portTypes Type of each port of the plugin.
+     * @param controlValues Initial value of each port, only used for control inputs.
+     */
+    Lv2Insert(const QString& name, LilvInstance *instance, const QVector<PortType>& portTypes,
+              const QVector<float>& controlValues, int frames);
+
+    /** Connects all ports to the current buffers. */
+    void connectPorts();
+
+    QString _name;
+    LilvInstance *_instance;
+    QVector<PortType> _portTypes;
+
+    /** Value of each control port, indexed by port. */
+    QVector<float> _controlValues;
+    /** Input buffer, shared by all audio inputs. */
+    QVector<float> _inputBuffer;
+    /** Output buffer of the first audio output. */
+    QVector<float> _outputBuffer;
+    /** Output buffer of the remaining audio outputs, discarded. */
+    QVector<float> _discardBuffer;
+};
+
+#endif // LV2INSERT_H
@@ -22,12 +22,50 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <QApplication>
+#include <QCoreApplication>
 #include "mainwindow.h"
+#include "mixeroptions.h"
+#include "offlinerenderer.h"
+#include "enginehost.h"
+#include "enginesegment.h"
 
 int main(int argc, char *argv[])
 {
+    // Rendering offline needs neither JACK nor a display
+    for(int i = 1; i < argc; i++) {
+        QString argument(argv[i]);
+        if(argument == "--render" || argument.startsWith("--render=")) {
+            QCoreApplication a(argc, argv);
+            OfflineRenderer offlineRenderer(MixerOptions::fromArguments(a.arguments()));
+            return offlineRenderer.render() ? 0 : 1;
+        }
+        // A headless engine needs JACK, but no display
+        if(argument == "--headless") {
+            QCoreApplication a(argc, argv);
+            EngineHost engineHost(MixerOptions::fromArguments(a.arguments()));
+            if(!engineHost.start()) {
+                return 1;
+            }
+            return a.exec();
+        }
+    }
+
     QApplication a(argc, argv);
-    MainWindow w;
+    MixerOptions mixerOptions = MixerOptions::fromArguments(a.arguments());
+    EngineSegment engineSegment(mixerOptions.segmentName);
+    if(mixerOptions.attach && !engineSegment.attach()) {
+        qWarning("Could not attach to the engine segment \"%s\": %s",
+                 qPrintable(mixerOptions.segmentName), qPrintable(engineSegment.errorString()));
+        return 1;
+    }
+    int subgroupCount = mixerOptions.attach ? engineSegment.subgroupCount() : mixerOptions.subgroupCount;
+    if(subgroupCount > MainWindow::MaximumSubgroupCount) {
+        qWarning("The mixer window shows at most %d subgroups, but the mixer has %d. "
+                 "Run larger mixers with --headless or --render.",
+                 (int)MainWindow::MaximumSubgroupCount, subgroupCount);
+        return 1;
+    }
+    MainWindow w(mixerOptions, mixerOptions.attach ? &engineSegment : 0);
     w.show();
     return a.exec();
 }
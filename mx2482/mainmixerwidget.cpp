@@ -26,16 +26,46 @@
 #include "ui_mainmixerwidget.h"
 #include "aboutdialog.h"
 
+// QJackAudio includes
+#include <QJackClient>
+
 // Qt includes
 #include <QFontDatabase>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QStandardPaths>
 #include <QJsonDocument>
+#include <QJsonArray>
+#include <QAbstractButton>
+#include <QAbstractSlider>
+#include <QShortcut>
+#include <QDir>
+#include <QDateTime>
+
+MainMixerWidget::MainMixerWidget(MixerEngine *mixerEngine, QWidget *parent) :
+    MainMixerWidget(mixerEngine, 0, parent)
+{
+}
+
+MainMixerWidget::MainMixerWidget(EngineSegment *engineSegment, QWidget *parent) :
+    MainMixerWidget(0, engineSegment, parent)
+{
+}
 
-MainMixerWidget::MainMixerWidget(QWidget *parent) :
+MainMixerWidget::MainMixerWidget(MixerEngine *mixerEngine, EngineSegment *engineSegment, QWidget *parent) :
     QWidget(parent),
-    ui(new Ui::MainMixerWidget)
+    ui(new Ui::MainMixerWidget),
+    _mixerEngine(mixerEngine),
+    _engineSegment(engineSegment),
+    _engineHeartbeat(0),
+    _meterBank(mixerEngine ? mixerEngine->meterRing().recordCount() : engineSegment->meterCount()),
+    _sceneBank(channelCount(), subgroupCount()),
+    _currentScene(-1),
+    _crossfadeTime(0.0),
+    _automationPlaying(false),
+    _recordDirectory("."),
+    _recordFormat(WavWriter::Wave64),
+    _controlQueue(0)
 {
     ui->setupUi(this);
 
@@ -43,59 +73,98 @@ MainMixerWidget::MainMixerWidget(QWidget *parent) :
     _updateTimer.setInterval(20);
     _updateTimer.setSingleShot(false);
     _updateTimer.start();
+    _meterTimer.start();
+    _engineHeartbeatTimer.start();
+    if(_engineSegment) {
+        _engineMeterRecords.resize(_engineSegment->meterCount());
+    }
+
+    // Invalid values, so the display is filled on the first update
+    _displayValues.realtime = false;
+    _displayValues.bufferSize = -1;
+    _displayValues.cpuLoad = -1;
+    _displayValues.sampleRate = -1;
+    _displayValues.cycleMedian = -2;
+    _displayValues.cycleP99 = -2;
+    _displayValues.cycleP999 = -2;
+    _displayValues.cycleMaximum = -2;
+    _displayValues.xrunCount = -1;
+    _displayValues.scene = -2;
+    _displayValues.automationRecording = false;
+    _displayValues.automationPlaying = false;
+    _displayValues.recording = false;
+    _displayValues.recordingDroppedFrames = 0;
+    _displayValues.recordingFailed = false;
+    _displayValues.soundcheck = false;
+    _displayValues.soundcheckMissedFrames = 0;
+    _displayValues.tracing = false;
+    _displayValues.traceDroppedEvents = 0;
+    _displayValues.engineResponding = false;
+
+    connect(&_publishTimer, SIGNAL(timeout()), this, SLOT(publishState()));
+    _publishTimer.setInterval(0);
+    _publishTimer.setSingleShot(true);
 
     QFontDatabase::addApplicationFont(":/fonts/FreePixel.ttf");
     QFont font("Free Pixel", 24);
     font.setStyleStrategy(QFont::NoAntialias);
     ui->displayLabel->setFont(font);
 
-    QJackClient *jackClient = QJackClient::instance();
-    _subGroup1Out = jackClient->registerAudioOutPort("subgroup1_out");
-    _subGroup2Out = jackClient->registerAudioOutPort("subgroup2_out");
-    _subGroup3Out = jackClient->registerAudioOutPort("subgroup3_out");
-    _subGroup4Out = jackClient->registerAudioOutPort("subgroup4_out");
-    _subGroup5Out = jackClient->registerAudioOutPort("subgroup5_out");
-    _subGroup6Out = jackClient->registerAudioOutPort("subgroup6_out");
-    _subGroup7Out = jackClient->registerAudioOutPort("subgroup7_out");
-    _subGroup8Out = jackClient->registerAudioOutPort("subgroup8_out");
-
-    _mainLeftOut = jackClient->registerAudioOutPort("main_out_1");
-    _mainRightOut = jackClient->registerAudioOutPort("main_out_2");
-
-    _subgroup1FaderStage = new QAmplifier();
-    _subgroup2FaderStage = new QAmplifier();
-    _subgroup3FaderStage = new QAmplifier();
-    _subgroup4FaderStage = new QAmplifier();
-    _subgroup5FaderStage = new QAmplifier();
-    _subgroup6FaderStage = new QAmplifier();
-    _subgroup7FaderStage = new QAmplifier();
-    _subgroup8FaderStage = new QAmplifier();
-    _main1FaderStage = new QAmplifier();
-    _main2FaderStage = new QAmplifier();
-
-    _subgroup1FaderStage->setGain(ui->subgroup1VolumeVerticalSlider->value());
-    _subgroup2FaderStage->setGain(ui->subgroup2VolumeVerticalSlider->value());
-    _subgroup3FaderStage->setGain(ui->subgroup3VolumeVerticalSlider->value());
-    _subgroup4FaderStage->setGain(ui->subgroup4VolumeVerticalSlider->value());
-    _subgroup5FaderStage->setGain(ui->subgroup5VolumeVerticalSlider->value());
-    _subgroup6FaderStage->setGain(ui->subgroup6VolumeVerticalSlider->value());
-    _subgroup7FaderStage->setGain(ui->subgroup7VolumeVerticalSlider->value());
-    _subgroup8FaderStage->setGain(ui->subgroup8VolumeVerticalSlider->value());
-
-    _main1FaderStage->setGain(ui->main1VolumeVerticalSlider->value());
-    _main2FaderStage->setGain(ui->main2VolumeVerticalSlider->value());
-
-    connect(ui->subgroup1VolumeVerticalSlider, SIGNAL(valueChanged(int)), _subgroup1FaderStage, SLOT(setGain(int)));
-    connect(ui->subgroup2VolumeVerticalSlider, SIGNAL(valueChanged(int)), _subgroup2FaderStage, SLOT(setGain(int)));
-    connect(ui->subgroup3VolumeVerticalSlider, SIGNAL(valueChanged(int)), _subgroup3FaderStage, SLOT(setGain(int)));
-    connect(ui->subgroup4VolumeVerticalSlider, SIGNAL(valueChanged(int)), _subgroup4FaderStage, SLOT(setGain(int)));
-    connect(ui->subgroup5VolumeVerticalSlider, SIGNAL(valueChanged(int)), _subgroup5FaderStage, SLOT(setGain(int)));
-    connect(ui->subgroup6VolumeVerticalSlider, SIGNAL(valueChanged(int)), _subgroup6FaderStage, SLOT(setGain(int)));
-    connect(ui->subgroup7VolumeVerticalSlider, SIGNAL(valueChanged(int)), _subgroup7FaderStage, SLOT(setGain(int)));
-    connect(ui->subgroup8VolumeVerticalSlider, SIGNAL(valueChanged(int)), _subgroup8FaderStage, SLOT(setGain(int)));
-
-    connect(ui->main1VolumeVerticalSlider, SIGNAL(valueChanged(int)), _main1FaderStage, SLOT(setGain(int)));
-    connect(ui->main2VolumeVerticalSlider, SIGNAL(valueChanged(int)), _main2FaderStage, SLOT(setGain(int)));
+    // The front panel has controls for eight subgroups, disable those the engine does not have
+    MeterWidget *subgroupMeterWidgets[] = {
+        ui->subgroup1MeterWidget, ui->subgroup2MeterWidget, ui->subgroup3MeterWidget, ui->subgroup4MeterWidget,
+        ui->subgroup5MeterWidget, ui->subgroup6MeterWidget, ui->subgroup7MeterWidget, ui->subgroup8MeterWidget
+    };
+    QWidget *subgroupControls[][4] = {
+        { ui->subgroup1VolumeVerticalSlider, ui->subgroup1MutePushButton, ui->subgroup1SoloPushButton, ui->subgroup1MainPushButton },
+        { ui->subgroup2VolumeVerticalSlider, ui->subgroup2MutePushButton, ui->subgroup2SoloPushButton, ui->subgroup2MainPushButton },
+        { ui->subgroup3VolumeVerticalSlider, ui->subgroup3MutePushButton, ui->subgroup3SoloPushButton, ui->subgroup3MainPushButton },
+        { ui->subgroup4VolumeVerticalSlider, ui->subgroup4MutePushButton, ui->subgroup4SoloPushButton, ui->subgroup4MainPushButton },
+        { ui->subgroup5VolumeVerticalSlider, ui->subgroup5MutePushButton, ui->subgroup5SoloPushButton, ui->subgroup5MainPushButton },
+        { ui->subgroup6VolumeVerticalSlider, ui->subgroup6MutePushButton, ui->subgroup6SoloPushButton, ui->subgroup6MainPushButton },
+        { ui->subgroup7VolumeVerticalSlider, ui->subgroup7MutePushButton, ui->subgroup7SoloPushButton, ui->subgroup7MainPushButton },
+        { ui->subgroup8VolumeVerticalSlider, ui->subgroup8MutePushButton, ui->subgroup8SoloPushButton, ui->subgroup8MainPushButton }
+    };
+    for(int i = 0; i < MixerState::DefaultSubgroupCount; i++) {
+        bool exists = i < subgroupCount();
+        if(exists) {
+            _subgroupMeterWidgets.append(subgroupMeterWidgets[i]);
+        }
+        subgroupMeterWidgets[i]->setEnabled(exists);
+        for(int j = 0; j < 4; j++) {
+            subgroupControls[i][j]->setEnabled(exists);
+        }
+    }
+
+    // Publish a new snapshot whenever any of the controls changes
+    foreach(QAbstractButton *button, findChildren<QAbstractButton*>()) {
+        if(button->isCheckable()) {
+            connect(button, SIGNAL(toggled(bool)), &_publishTimer, SLOT(start()));
+        }
+    }
+    foreach(QAbstractSlider *slider, findChildren<QAbstractSlider*>()) {
+        connect(slider, SIGNAL(valueChanged(int)), &_publishTimer, SLOT(start()));
+    }
+
+    // Step through the scenes
+    new QShortcut(QKeySequence(Qt::Key_PageDown), this, SLOT(recallNextScene()));
+    new QShortcut(QKeySequence(Qt::Key_PageUp), this, SLOT(recallPreviousScene()));
+
+    // Record and play back automation
+    new QShortcut(QKeySequence(Qt::Key_F9), this, SLOT(toggleAutomationRecording()));
+    new QShortcut(QKeySequence(Qt::Key_F10), this, SLOT(toggleAutomationPlayback()));
+
+    // Record all inputs and outputs
+    new QShortcut(QKeySequence(Qt::Key_F8), this, SLOT(toggleRecording()));
+    new QShortcut(QKeySequence(Qt::Key_F7), this, SLOT(toggleSoundcheck()));
+
+    // Save the period durations for tracking down xruns
+    new QShortcut(QKeySequence(Qt::Key_F6), this, SLOT(exportCycleStatistics()));
+
+    // A headless engine keeps its state until the controls have taken it over
+    if(_mixerEngine) {
+        publishState();
+    }
 }
 
 MainMixerWidget::~MainMixerWidget()
@@ -106,166 +175,201 @@ MainMixerWidget::~MainMixerWidget()
 
 void MainMixerWidget::registerChannel(int i, ChannelWidget *channelWidget)
 {
+    // A strip built after the controls have been reset or recalled takes over what the engine has
+    QJsonObject channelObject = _recalledState.value(QString("channel%1").arg(i)).toObject();
+    if(channelObject.isEmpty()) {
+        channelWidget->resetControls();
+    } else {
+        channelWidget->stateFromJson(channelObject);
+    }
+
     _registeredChannels.insert(i, channelWidget);
+    connect(channelWidget, SIGNAL(controlsChanged()), &_publishTimer, SLOT(start()));
+    _publishTimer.start();
 }
 
-void MainMixerWidget::process()
-{
-    // Obtaining sample buffers
-    QSampleBuffer subgroup1SampleBuffer = _subGroup1Out->sampleBuffer();
-    QSampleBuffer subgroup2SampleBuffer = _subGroup2Out->sampleBuffer();
-    QSampleBuffer subgroup3SampleBuffer = _subGroup3Out->sampleBuffer();
-    QSampleBuffer subgroup4SampleBuffer = _subGroup4Out->sampleBuffer();
-    QSampleBuffer subgroup5SampleBuffer = _subGroup5Out->sampleBuffer();
-    QSampleBuffer subgroup6SampleBuffer = _subGroup6Out->sampleBuffer();
-    QSampleBuffer subgroup7SampleBuffer = _subGroup7Out->sampleBuffer();
-    QSampleBuffer subgroup8SampleBuffer = _subGroup8Out->sampleBuffer();
-
-    QSampleBuffer main1SampleBuffer = _mainLeftOut->sampleBuffer();
-    QSampleBuffer main2SampleBuffer = _mainRightOut->sampleBuffer();
-
-    // Clearing buffers (since we are going to sum up signals
-    subgroup1SampleBuffer.clear();
-    subgroup2SampleBuffer.clear();
-    subgroup3SampleBuffer.clear();
-    subgroup4SampleBuffer.clear();
-    subgroup5SampleBuffer.clear();
-    subgroup6SampleBuffer.clear();
-    subgroup7SampleBuffer.clear();
-    subgroup8SampleBuffer.clear();
-
-    main1SampleBuffer.clear();
-    main2SampleBuffer.clear();
-
-    // Find out whether any of the channels is soloed
-    bool soloActive = false;
-    foreach(ChannelWidget *channelWidget, _registeredChannels) {
-        if(channelWidget->isSoloed()) {
-            soloActive = true;
-        }
-    }
+void MainMixerWidget::publishState()
+{
+    _publishTimer.stop();
 
-    // Find out whether any of the subgroups are soloed
-    bool subgroupSoloActive = false;
-    if(ui->subgroup1SoloPushButton->isChecked()
-    || ui->subgroup2SoloPushButton->isChecked()
-    || ui->subgroup3SoloPushButton->isChecked()
-    || ui->subgroup4SoloPushButton->isChecked()
-    || ui->subgroup5SoloPushButton->isChecked()
-    || ui->subgroup6SoloPushButton->isChecked()
-    || ui->subgroup7SoloPushButton->isChecked()
-    || ui->subgroup8SoloPushButton->isChecked()) {
-        subgroupSoloActive = true;
+    // A headless engine parses the state itself
+    if(_engineSegment) {
+        if(!_engineSegment->publishState(stateToJson(), 0)) {
+            qWarning("The state does not fit into the engine segment.");
+        }
+        return;
     }
 
-    // Routing channels to subgroups and main
-    foreach(ChannelWidget *channelWidget, _registeredChannels) {
-        // Create a temporary memory buffer, so we do not alter the sample in the input buffer,
-        // which may effect other applications connected to the same input.
-        QSampleBuffer sampleBuffer = QSampleBuffer::createMemoryAudioBuffer(QJackClient::instance()->bufferSize());
-
-        // Do the processing for the channel
-        channelWidget->process(sampleBuffer);
-
-        // If the channel is not muted, apply to subgroups and main.
-        if(!channelWidget->isMuted() && (!soloActive || channelWidget->isSoloed())) {
-            double panorama = channelWidget->panorama();
-            if(channelWidget->isInSubGroup12()) {
-                sampleBuffer.addTo(subgroup1SampleBuffer, 1.0 - panorama);
-                sampleBuffer.addTo(subgroup2SampleBuffer,       panorama);
-            }
-
-            if(channelWidget->isInSubGroup34()) {
-                sampleBuffer.addTo(subgroup3SampleBuffer, 1.0 - panorama);
-                sampleBuffer.addTo(subgroup4SampleBuffer,       panorama);
-            }
-
-            if(channelWidget->isInSubGroup56()) {
-                sampleBuffer.addTo(subgroup5SampleBuffer, 1.0 - panorama);
-                sampleBuffer.addTo(subgroup6SampleBuffer,       panorama);
-            }
+    MixerState mixerState = MixerState::fromJson(stateToJson(),
+                                                 _mixerEngine->channelCount(),
+                                                 _mixerEngine->subgroupCount(),
+                                                 QJackClient::instance()->sampleRate());
+    _automationRecorder.record(_mixerEngine->frameTime(), mixerState);
+    _mixerEngine->publishState(mixerState);
+}
 
-            if(channelWidget->isInSubGroup78()) {
-                sampleBuffer.addTo(subgroup7SampleBuffer, 1.0 - panorama);
-                sampleBuffer.addTo(subgroup8SampleBuffer,       panorama);
-            }
+void MainMixerWidget::toggleAutomationRecording()
+{
+    if(_engineSegment) {
+        requestFromEngine(EngineRequest::ToggleAutomationRecording);
+        return;
+    }
 
-            if(channelWidget->isOnMain()) {
-                sampleBuffer.addTo(main1SampleBuffer, 1.0 - panorama);
-                sampleBuffer.addTo(main2SampleBuffer,       panorama);
-            }
-        }
+    if(_automationRecorder.isRecording()) {
+        _automationRecorder.stop();
+        _mixerEngine->setAutomation(_automationRecorder.events());
+        return;
+    }
 
-        sampleBuffer.releaseMemoryBuffer();
+    // Recording while playing back would record the controls, not what is being heard
+    if(_automationPlaying) {
+        toggleAutomationPlayback();
     }
+    _automationRecorder.start(_mixerEngine->frameTime(),
+                              MixerState::fromJson(stateToJson(),
+                                                   _mixerEngine->channelCount(),
+                                                   _mixerEngine->subgroupCount(),
+                                                   QJackClient::instance()->sampleRate()));
+}
 
-    // Route subgroups through faders
-    _subgroup1FaderStage->process(subgroup1SampleBuffer);
-    _subgroup2FaderStage->process(subgroup2SampleBuffer);
-    _subgroup3FaderStage->process(subgroup3SampleBuffer);
-    _subgroup4FaderStage->process(subgroup4SampleBuffer);
-    _subgroup5FaderStage->process(subgroup5SampleBuffer);
-    _subgroup6FaderStage->process(subgroup6SampleBuffer);
-    _subgroup7FaderStage->process(subgroup7SampleBuffer);
-    _subgroup8FaderStage->process(subgroup8SampleBuffer);
+void MainMixerWidget::toggleAutomationPlayback()
+{
+    if(_engineSegment) {
+        requestFromEngine(EngineRequest::ToggleAutomationPlayback);
+        return;
+    }
 
-    // Routing subgroups to main
+    if(_automationPlaying) {
+        _mixerEngine->stopAutomation();
+        _automationPlaying = false;
+    } else if(!_automationRecorder.isRecording()) {
+        _mixerEngine->startAutomation();
+        _automationPlaying = true;
+    }
+}
 
-    if(!ui->subgroup1MutePushButton->isChecked() && ui->subgroup1MainPushButton->isChecked() && (!subgroupSoloActive || ui->subgroup1SoloPushButton->isChecked())) {
-        subgroup1SampleBuffer.addTo(main1SampleBuffer);
+void MainMixerWidget::toggleRecording()
+{
+    // A headless engine records to the directory it has been started with
+    if(_engineSegment) {
+        requestFromEngine(EngineRequest::ToggleRecording);
+        return;
     }
-    if(!ui->subgroup2MutePushButton->isChecked() && ui->subgroup2MainPushButton->isChecked() && (!subgroupSoloActive || ui->subgroup2SoloPushButton->isChecked())) {
-        subgroup2SampleBuffer.addTo(main2SampleBuffer);
+
+    const MultitrackRecorder& multitrackRecorder = _mixerEngine->multitrackRecorder();
+    if(multitrackRecorder.isRecording()) {
+        _mixerEngine->stopRecording();
+        if(multitrackRecorder.hasFailed()) {
+            QMessageBox::warning(this, tr("Recording"), multitrackRecorder.errorString());
+        }
+        return;
     }
-    if(!ui->subgroup3MutePushButton->isChecked() && ui->subgroup3MainPushButton->isChecked() && (!subgroupSoloActive || ui->subgroup3SoloPushButton->isChecked())) {
-        subgroup3SampleBuffer.addTo(main1SampleBuffer);
+
+    QString directory = QDir(_recordDirectory).filePath(QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss"));
+    if(!_mixerEngine->startRecording(directory, QJackClient::instance()->sampleRate(), _recordFormat)) {
+        QMessageBox::warning(this, tr("Recording"), multitrackRecorder.errorString());
     }
-    if(!ui->subgroup4MutePushButton->isChecked() && ui->subgroup4MainPushButton->isChecked() && (!subgroupSoloActive || ui->subgroup4SoloPushButton->isChecked())) {
-        subgroup4SampleBuffer.addTo(main2SampleBuffer);
+}
+
+void MainMixerWidget::toggleSoundcheck()
+{
+    if(_engineSegment) {
+        requestFromEngine(EngineRequest::ToggleSoundcheck);
+        return;
     }
-    if(!ui->subgroup5MutePushButton->isChecked() && ui->subgroup5MainPushButton->isChecked() && (!subgroupSoloActive || ui->subgroup5SoloPushButton->isChecked())) {
-        subgroup5SampleBuffer.addTo(main1SampleBuffer);
+
+    const MultitrackPlayer& multitrackPlayer = _mixerEngine->multitrackPlayer();
+    if(multitrackPlayer.isPlaying()) {
+        _mixerEngine->stopPlayback();
+        return;
     }
-    if(!ui->subgroup6MutePushButton->isChecked() && ui->subgroup6MainPushButton->isChecked() && (!subgroupSoloActive || ui->subgroup6SoloPushButton->isChecked())) {
-        subgroup6SampleBuffer.addTo(main2SampleBuffer);
+
+    // Recordings are named after the time they have been started, so the latest one sorts last
+    QString directory = _soundcheckDirectory;
+    if(directory.isEmpty()) {
+        QStringList recordings = QDir(_recordDirectory).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+        if(recordings.isEmpty()) {
+            QMessageBox::warning(this, tr("Soundcheck"), tr("No recording found in %1").arg(_recordDirectory));
+            return;
+        }
+        directory = QDir(_recordDirectory).filePath(recordings.last());
     }
-    if(!ui->subgroup7MutePushButton->isChecked() && ui->subgroup7MainPushButton->isChecked() && (!subgroupSoloActive || ui->subgroup7SoloPushButton->isChecked())) {
-        subgroup7SampleBuffer.addTo(main1SampleBuffer);
+
+    if(!_mixerEngine->startPlayback(directory, QJackClient::instance()->sampleRate(), _soundcheckChannels)) {
+        QMessageBox::warning(this, tr("Soundcheck"), multitrackPlayer.errorString());
     }
-    if(!ui->subgroup8MutePushButton->isChecked() && ui->subgroup8MainPushButton->isChecked() && (!subgroupSoloActive || ui->subgroup8SoloPushButton->isChecked())) {
-        subgroup8SampleBuffer.addTo(main2SampleBuffer);
+}
+
+void MainMixerWidget::recallScene(int i)
+{
+    if(i < 0 || i >= _sceneBank.sceneCount()) {
+        return;
     }
 
-    // Peak detection    
-    _subgroupPeak1 = QUnits::linearToDb(subgroup1SampleBuffer.peak());
-    _subgroupPeak2 = QUnits::linearToDb(subgroup2SampleBuffer.peak());
-    _subgroupPeak3 = QUnits::linearToDb(subgroup3SampleBuffer.peak());
-    _subgroupPeak4 = QUnits::linearToDb(subgroup4SampleBuffer.peak());
-    _subgroupPeak5 = QUnits::linearToDb(subgroup5SampleBuffer.peak());
-    _subgroupPeak6 = QUnits::linearToDb(subgroup6SampleBuffer.peak());
-    _subgroupPeak7 = QUnits::linearToDb(subgroup7SampleBuffer.peak());
-    _subgroupPeak8 = QUnits::linearToDb(subgroup8SampleBuffer.peak());
+    const SceneBank::Scene& scene = _sceneBank.scene(i);
+    recallState(scene.jsonObject, scene.mixerState);
+    _currentScene = i;
+}
 
-    // Check if main is muted, and clear signal if necessary
-    if(ui->main1MutePushButton->isChecked()) {
-        main1SampleBuffer.clear();
-    } else {
-        _main1FaderStage->process(main1SampleBuffer);
-    }
+void MainMixerWidget::recallNextScene()
+{
+    recallScene(qMin(_currentScene + 1, _sceneBank.sceneCount() - 1));
+}
 
-    if(ui->main2MutePushButton->isChecked()) {
-        main2SampleBuffer.clear();
+void MainMixerWidget::recallPreviousScene()
+{
+    recallScene(qMax(_currentScene - 1, 0));
+}
+
+void MainMixerWidget::recallState(const QJsonObject& jsonObject, const MixerState& mixerState)
+{
+    int crossfadeFrames = (int)(_crossfadeTime * sampleRate() / 1000.0);
+    if(_engineSegment) {
+        if(!_engineSegment->publishState(jsonObject, crossfadeFrames)) {
+            qWarning("The state does not fit into the engine segment.");
+        }
     } else {
-        _main2FaderStage->process(main2SampleBuffer);
+        // Publishing shares the parsed snapshot, so this does not depend on the size of the mixer
+        MixerState recalledState = mixerState;
+        recalledState.crossfadeFrames = crossfadeFrames;
+        _mixerEngine->publishState(recalledState);
     }
 
-    _mainPeak1 = QUnits::linearToDb(main1SampleBuffer.peak());
-    _mainPeak2 = QUnits::linearToDb(main2SampleBuffer.peak());
+    // Updating the controls would publish their state again and cut the crossfade short
+    stateFromJson(jsonObject);
+    _publishTimer.stop();
+}
+
+int MainMixerWidget::loadScenes(const QString& path)
+{
+    return _sceneBank.loadDirectory(path, sampleRate());
+}
+
+void MainMixerWidget::setCrossfadeTime(double milliseconds)
+{
+    _crossfadeTime = milliseconds;
+}
+
+void MainMixerWidget::setRecordDirectory(const QString& directory, WavWriter::Format format)
+{
+    _recordDirectory = directory;
+    _recordFormat = format;
+}
+
+void MainMixerWidget::setSoundcheck(const QString& directory, const QList<int>& channels)
+{
+    _soundcheckDirectory = directory;
+    _soundcheckChannels = channels;
+}
+
+void MainMixerWidget::setControlQueue(WaitFreeQueue<MixerCommand> *controlQueue)
+{
+    _controlQueue = controlQueue;
 }
 
 QJsonObject MainMixerWidget::stateToJson()
 {
-    QJsonObject jsonObject;
+    QJsonObject jsonObject = _recalledState;
 
     jsonObject.insert("subgroup1Gain", ui->subgroup1VolumeVerticalSlider->value());
     jsonObject.insert("subgroup2Gain", ui->subgroup2VolumeVerticalSlider->value());
@@ -311,7 +415,16 @@ QJsonObject MainMixerWidget::stateToJson()
 
     foreach(ChannelWidget *channelWidget, _registeredChannels) {
         int channelNumber = _registeredChannels.key(channelWidget);
-        jsonObject.insert(QString("channel%1").arg(channelNumber), channelWidget->stateToJson());
+        QString key = QString("channel%1").arg(channelNumber);
+
+        // Keep routings to subgroups the channel has no button for
+        QJsonObject channelObject = _recalledState.value(key).toObject();
+        QJsonObject channelControls = channelWidget->stateToJson();
+        for(QJsonObject::const_iterator iterator = channelControls.constBegin();
+            iterator != channelControls.constEnd(); ++iterator) {
+            channelObject.insert(iterator.key(), iterator.value());
+        }
+        jsonObject.insert(key, channelObject);
     }
 
     return jsonObject;
@@ -319,6 +432,8 @@ QJsonObject MainMixerWidget::stateToJson()
 
 void MainMixerWidget::stateFromJson(QJsonObject jsonObject)
 {
+    _recalledState = jsonObject;
+
     ui->subgroup1VolumeVerticalSlider->setValue(jsonObject.value("subgroup1Gain").toDouble());
     ui->subgroup2VolumeVerticalSlider->setValue(jsonObject.value("subgroup2Gain").toDouble());
     ui->subgroup3VolumeVerticalSlider->setValue(jsonObject.value("subgroup3Gain").toDouble());
@@ -369,30 +484,279 @@ void MainMixerWidget::stateFromJson(QJsonObject jsonObject)
 
 void MainMixerWidget::updateInterface()
 {
-    QJackClient *jackClient = QJackClient::instance();
-    QString displayText;
-    displayText += QString("<table width=\"100%\"><tr><td><b>JACK Client</b></td><td></td></tr>");
-    displayText += QString("<tr><td>RT processing:</td><td>%1</td></tr>").arg(jackClient->isRealtime() ? "Yes" : "No");
-    displayText += QString("<tr><td>Buffers.:</td><td>%1 Samples</td></tr>").arg(jackClient->bufferSize());
-    displayText += QString("<tr><td>CPU load:</td><td>%1</td></tr>").arg(jackClient->cpuLoad() < 1.0 ? "Idle" : QString("%1 %").arg((int)jackClient->cpuLoad()));
-    displayText += QString("<tr><td>Samplerate:</td><td>%1 Hz</td></tr></table>").arg(jackClient->sampleRate());
-    ui->displayLabel->setText(displayText);
+    // Rebuild the display only if any of the values shown has changed
+    DisplayValues displayValues;
+    CycleStatistics cycleStatistics;
+    if(_mixerEngine) {
+        QJackClient *jackClient = QJackClient::instance();
+
+        // QJackClient does not forward JACK's buffer size callback, so we pick up
+        // a new buffer size here, outside of the realtime thread.
+        if(jackClient->bufferSize() != _mixerEngine->frames()) {
+            _mixerEngine->resizeBuffers(jackClient->bufferSize());
+        }
 
-    foreach(ChannelWidget *channelWidget, _registeredChannels) {
-        channelWidget->updateInterface();
+        displayValues.realtime = jackClient->isRealtime();
+        displayValues.bufferSize = jackClient->bufferSize();
+        displayValues.cpuLoad = jackClient->cpuLoad() < 1.0 ? 0 : (int)jackClient->cpuLoad();
+        displayValues.sampleRate = jackClient->sampleRate();
+        cycleStatistics = _mixerEngine->cycleMonitor().statistics();
+        displayValues.engineResponding = true;
+        displayValues.automationRecording = _automationRecorder.isRecording();
+        displayValues.automationPlaying = _automationPlaying;
+        const MultitrackRecorder& multitrackRecorder = _mixerEngine->multitrackRecorder();
+        displayValues.recording = multitrackRecorder.isRecording();
+        displayValues.recordingDroppedFrames = displayValues.recording ? multitrackRecorder.droppedFrames() : 0;
+        displayValues.recordingFailed = displayValues.recording && multitrackRecorder.hasFailed();
+        const MultitrackPlayer& multitrackPlayer = _mixerEngine->multitrackPlayer();
+        displayValues.soundcheck = multitrackPlayer.isPlaying();
+        displayValues.soundcheckMissedFrames = displayValues.soundcheck ? multitrackPlayer.missedFrames() : 0;
+    } else {
+        EngineStatus engineStatus = _engineSegment->status();
+        displayValues.realtime = engineStatus.realtime;
+        displayValues.bufferSize = engineStatus.bufferSize;
+        displayValues.cpuLoad = engineStatus.cpuLoad < 1.0f ? 0 : (int)engineStatus.cpuLoad;
+        displayValues.sampleRate = engineStatus.sampleRate;
+        cycleStatistics = engineStatus.cycleStatistics;
+        displayValues.automationRecording = engineStatus.automationRecording;
+        displayValues.automationPlaying = engineStatus.automationPlaying;
+        displayValues.recording = engineStatus.recording;
+        displayValues.recordingDroppedFrames = engineStatus.recordingDroppedFrames;
+        displayValues.recordingFailed = engineStatus.recordingFailed;
+        displayValues.soundcheck = engineStatus.soundcheck;
+        displayValues.soundcheckMissedFrames = engineStatus.soundcheckMissedFrames;
+
+        if(engineStatus.heartbeat != _engineHeartbeat) {
+            _engineHeartbeat = engineStatus.heartbeat;
+            _engineHeartbeatTimer.restart();
+        }
+        displayValues.engineResponding = _engineHeartbeatTimer.elapsed() < EngineTimeout;
+    }
+
+    // Period durations are shown relative to the deadline, rounded up so a late period shows more than 100 %
+    if(cycleStatistics.deadline > 0 && cycleStatistics.cycleCount > 0) {
+        quint64 deadline = cycleStatistics.deadline;
+        displayValues.cycleMedian = (int)((cycleStatistics.median * 100 + deadline - 1) / deadline);
+        displayValues.cycleP99 = (int)((cycleStatistics.p99 * 100 + deadline - 1) / deadline);
+        displayValues.cycleP999 = (int)((cycleStatistics.p999 * 100 + deadline - 1) / deadline);
+        displayValues.cycleMaximum = (int)((cycleStatistics.maximum * 100 + deadline - 1) / deadline);
+    } else {
+        displayValues.cycleMedian = -1;
+        displayValues.cycleP99 = -1;
+        displayValues.cycleP999 = -1;
+        displayValues.cycleMaximum = -1;
+    }
+    displayValues.xrunCount = cycleStatistics.xrunCount;
+
+    // Keep the snapshots of the last xruns for exporting
+    XrunSnapshot xrunSnapshot;
+    while(_mixerEngine && _mixerEngine->cycleMonitor().takeXrun(xrunSnapshot)) {
+        const CycleTiming& cycleTiming = xrunSnapshot.cycles[xrunSnapshot.cycleCount - 1];
+        qWarning("Xrun at frame %lld: %s, period took %.0f us of %.0f us, %d of %d channels active.",
+                 xrunSnapshot.frameTime,
+                 xrunSnapshot.cause == XrunSnapshot::DeadlineMissed ? "deadline missed" : "callback late",
+                 cycleTiming.duration / 1000.0, xrunSnapshot.deadline / 1000.0,
+                 xrunSnapshot.configuration.activeChannelCount, xrunSnapshot.configuration.channelCount);
+        _xrunSnapshots.append(xrunSnapshot);
+        if(_xrunSnapshots.size() > XrunSnapshotCount) {
+            _xrunSnapshots.removeFirst();
+        }
+    }
+
+    displayValues.scene = _currentScene;
+    displayValues.tracing = _mixerEngine && _mixerEngine->stageTracer().isTracing();
+    displayValues.traceDroppedEvents = displayValues.tracing ? _mixerEngine->stageTracer().droppedEvents() : 0;
+    bool wasTracing = _displayValues.tracing;
+    if(displayValues != _displayValues) {
+        _displayValues = displayValues;
+
+        QString displayText;
+        displayText += QString("<table width=\"100%\"><tr><td><b>JACK Client</b></td><td></td></tr>");
+        if(!displayValues.engineResponding) {
+            displayText += QString("<tr><td>Engine:</td><td>Not responding</td></tr>");
+        }
+        displayText += QString("<tr><td>RT processing:</td><td>%1</td></tr>").arg(displayValues.realtime ? "Yes" : "No");
+        displayText += QString("<tr><td>Buffers.:</td><td>%1 Samples</td></tr>").arg(displayValues.bufferSize);
+        displayText += QString("<tr><td>CPU load:</td><td>%1</td></tr>").arg(displayValues.cpuLoad == 0 ? "Idle" : QString("%1 %").arg(displayValues.cpuLoad));
+        displayText += QString("<tr><td>Samplerate:</td><td>%1 Hz</td></tr>").arg(displayValues.sampleRate);
+        if(displayValues.cycleMedian >= 0) {
+            displayText += QString("<tr><td>Period p50/p99:</td><td>%1 / %2 %</td></tr>")
+                    .arg(displayValues.cycleMedian).arg(displayValues.cycleP99);
+            displayText += QString("<tr><td>Period p99.9/max:</td><td>%1 / %2 %</td></tr>")
+                    .arg(displayValues.cycleP999).arg(displayValues.cycleMaximum);
+        }
+        if(displayValues.xrunCount > 0) {
+            displayText += QString("<tr><td>Xruns:</td><td>%1</td></tr>").arg(displayValues.xrunCount);
+        }
+        if(displayValues.scene >= 0) {
+            displayText += QString("<tr><td>Scene:</td><td>%1</td></tr>").arg(_sceneBank.scene(displayValues.scene).name);
+        }
+        if(displayValues.automationRecording || displayValues.automationPlaying) {
+            displayText += QString("<tr><td>Automation:</td><td>%1</td></tr>")
+                    .arg(displayValues.automationRecording ? "Recording" : "Playing");
+        }
+        if(displayValues.recording) {
+            QString recordingState = "Yes";
+            if(displayValues.recordingFailed) {
+                recordingState = "Disk error";
+            } else if(displayValues.recordingDroppedFrames > 0) {
+                recordingState = QString("%1 Samples lost").arg(displayValues.recordingDroppedFrames);
+            }
+            displayText += QString("<tr><td>Recording:</td><td>%1</td></tr>").arg(recordingState);
+        }
+        if(displayValues.soundcheck) {
+            displayText += QString("<tr><td>Soundcheck:</td><td>%1</td></tr>")
+                    .arg(displayValues.soundcheckMissedFrames > 0
+                         ? QString("%1 Samples lost").arg(displayValues.soundcheckMissedFrames) : QString("Yes"));
+        }
+        if(displayValues.tracing) {
+            displayText += QString("<tr><td>Tracing:</td><td>%1</td></tr>")
+                    .arg(displayValues.traceDroppedEvents > 0
+                         ? QString("%1 Events lost").arg(displayValues.traceDroppedEvents) : QString("Yes"));
+        }
+        displayText += QString("</table>");
+        ui->displayLabel->setText(displayText);
+    }
+
+    // Move the controls to what has been changed remotely. The snapshot that is
+    // published afterwards only repeats values the engine already has.
+    if(_controlQueue) {
+        MixerCommand mixerCommand;
+        if(_controlQueue->pop(mixerCommand)) {
+            QJsonObject jsonObject = stateToJson();
+            do {
+                mixerCommand.apply(jsonObject);
+            } while(_controlQueue->pop(mixerCommand));
+            stateFromJson(jsonObject);
+        }
+    }
+    if(_engineSegment) {
+        QList<MixerCommand> mixerCommands = _engineSegment->takeControls();
+        if(!mixerCommands.isEmpty()) {
+            QJsonObject jsonObject = stateToJson();
+            foreach(const MixerCommand& mixerCommand, mixerCommands) {
+                mixerCommand.apply(jsonObject);
+            }
+            stateFromJson(jsonObject);
+        }
+    }
+
+    // Collect all levels the engine has published since the last update
+    if(_engineSegment) {
+        _engineSegment->takeMeters(_engineMeterRecords.data());
+        _meterBank.accumulate(_engineMeterRecords.constData());
+    } else {
+        MeterRing& meterRing = _mixerEngine->meterRing();
+        while(const MeterRecord *meterRecords = meterRing.peek()) {
+            _meterBank.accumulate(meterRecords);
+            meterRing.release();
+        }
+    }
+    qint64 elapsed = _meterTimer.restart();
+    _meterBank.update(elapsed / 1000.0);
+
+    // While tracing, each channel shows the share of time it has taken since the last update
+    if(displayValues.tracing && !wasTracing) {
+        _channelTimes.fill(0, channelCount() * StageTracer::StageCount);
+    }
+
+    QMap<int, ChannelWidget*>::const_iterator iterator;
+    for(iterator = _registeredChannels.constBegin(); iterator != _registeredChannels.constEnd(); ++iterator) {
+        if(iterator.key() >= 1 && iterator.key() <= channelCount()) {
+            int channel = iterator.key() - 1;
+            iterator.value()->updateInterface(_meterBank.reading(channelMeterIndex(channel)));
+
+            if(displayValues.tracing && elapsed > 0) {
+                QVector<double> stageLoads(StageTracer::StageCount);
+                for(int stage = 0; stage < StageTracer::StageCount; stage++) {
+                    quint64 channelTime = _mixerEngine->stageTracer().channelTime(channel, (StageTracer::Stage)stage);
+                    quint64& lastChannelTime = _channelTimes[channel * StageTracer::StageCount + stage];
+                    stageLoads[stage] = (channelTime - lastChannelTime) / (elapsed * 10000.0);
+                    lastChannelTime = channelTime;
+                }
+                iterator.value()->setProcessingLoad(stageLoads);
+            } else if(wasTracing && !displayValues.tracing) {
+                iterator.value()->setProcessingLoad(QVector<double>());
+            }
+        }
+    }
+
+    for(int i = 0; i < _subgroupMeterWidgets.size(); i++) {
+        _subgroupMeterWidgets.at(i)->setReading(_meterBank.reading(subgroupMeterIndex(i)));
+    }
+
+    ui->main1MeterWidget->setReading(_meterBank.reading(mainMeterIndex(0)));
+    ui->main2MeterWidget->setReading(_meterBank.reading(mainMeterIndex(1)));
+}
+
+bool MainMixerWidget::DisplayValues::operator!=(const DisplayValues& other) const
+{
+    return realtime != other.realtime
+        || bufferSize != other.bufferSize
+        || cpuLoad != other.cpuLoad
+        || sampleRate != other.sampleRate
+        || cycleMedian != other.cycleMedian
+        || cycleP99 != other.cycleP99
+        || cycleP999 != other.cycleP999
+        || cycleMaximum != other.cycleMaximum
+        || xrunCount != other.xrunCount
+        || scene != other.scene
+        || automationRecording != other.automationRecording
+        || automationPlaying != other.automationPlaying
+        || recording != other.recording
+        || recordingDroppedFrames != other.recordingDroppedFrames
+        || recordingFailed != other.recordingFailed
+        || soundcheck != other.soundcheck
+        || soundcheckMissedFrames != other.soundcheckMissedFrames
+        || tracing != other.tracing
+        || traceDroppedEvents != other.traceDroppedEvents
+        || engineResponding != other.engineResponding;
+}
+
+void MainMixerWidget::exportCycleStatistics()
+{
+    QStringList homeLocations = QStandardPaths::standardLocations(QStandardPaths::HomeLocation);
+    QString targetFileName = QFileDialog::getSaveFileName(this,
+                                                      tr("Export period statistics"),
+                                                      homeLocations.at(0),
+                                                      tr("JSON (*.json)"));
+    if(targetFileName.isEmpty()) {
+        return;
+    }
+    if(!targetFileName.endsWith(".json")) {
+        targetFileName.append(".json");
+    }
+
+    // The histogram and the xrun snapshots stay in the engine process, so it writes the file
+    if(_engineSegment) {
+        requestFromEngine(EngineRequest::ExportCycleStatistics, targetFileName);
+        return;
     }
 
-    ui->subgroup1ProgressBar->setValue((int)_subgroupPeak1);
-    ui->subgroup2ProgressBar->setValue((int)_subgroupPeak2);
-    ui->subgroup3ProgressBar->setValue((int)_subgroupPeak3);
-    ui->subgroup4ProgressBar->setValue((int)_subgroupPeak4);
-    ui->subgroup5ProgressBar->setValue((int)_subgroupPeak5);
-    ui->subgroup6ProgressBar->setValue((int)_subgroupPeak6);
-    ui->subgroup7ProgressBar->setValue((int)_subgroupPeak7);
-    ui->subgroup8ProgressBar->setValue((int)_subgroupPeak8);
+    QFile file(targetFileName);
+    if(!file.open(QIODevice::WriteOnly)) {
+        QMessageBox::critical(this,
+                              tr("Could not export period statistics"),
+                              QString(tr("Could not open file for write: %1")).arg(targetFileName));
+        return;
+    }
 
-    ui->main1ProgressBar->setValue((int)_mainPeak1);
-    ui->main2ProgressBar->setValue((int)_mainPeak2);
+    QJsonArray xrunsArray;
+    foreach(const XrunSnapshot& xrunSnapshot, _xrunSnapshots) {
+        xrunsArray.append(xrunSnapshot.toJson());
+    }
+    QJsonObject jsonObject;
+    jsonObject.insert("histogram", _mixerEngine->cycleMonitor().histogramToJson());
+    jsonObject.insert("xruns", xrunsArray);
+    file.write(QJsonDocument(jsonObject).toJson());
+    file.close();
+}
+
+void MainMixerWidget::requestFromEngine(EngineRequest::Type type, const QString& fileName)
+{
+    if(!_engineSegment->addRequest(type, fileName)) {
+        QMessageBox::warning(this, tr("Engine"), tr("The engine could not take the request. Either too many are pending or the file name is too long."));
+    }
 }
 
 void MainMixerWidget::on_clearPushButton_clicked()
@@ -417,10 +781,21 @@ void MainMixerWidget::on_saveStatePushButton_clicked()
             targetFileName.append(".mx2482");
         }
 
+        // A headless engine has the recorded automation, so it saves the state once it has the latest one
+        if(_engineSegment) {
+            publishState();
+            requestFromEngine(EngineRequest::SaveState, targetFileName);
+            return;
+        }
+
         QFile file(targetFileName);
 
         if(file.open(QIODevice::WriteOnly)) {
-            QJsonDocument jsonDocument(stateToJson());
+            QJsonObject jsonObject = stateToJson();
+            if(!_automationRecorder.events().isEmpty()) {
+                jsonObject.insert("automation", AutomationRecorder::toJson(_automationRecorder.events()));
+            }
+            QJsonDocument jsonDocument(jsonObject);
             file.write(jsonDocument.toJson());
             file.close();
         } else {
@@ -444,7 +819,24 @@ void MainMixerWidget::on_loadStatePushButton_clicked()
         if(file.open(QIODevice::ReadOnly)) {
             QJsonDocument jsonDocument = QJsonDocument::fromJson(file.readAll());
             file.close();
-            stateFromJson(jsonDocument.object());
+            QJsonObject jsonObject = jsonDocument.object();
+
+            // Automation is kept apart from the controls and replaces the recorded one
+            if(jsonObject.contains("automation")) {
+                if(_automationPlaying) {
+                    toggleAutomationPlayback();
+                }
+                if(_mixerEngine) {
+                    _automationRecorder.setEvents(AutomationRecorder::fromJson(jsonObject.value("automation").toArray()));
+                    _mixerEngine->setAutomation(_automationRecorder.events());
+                } else {
+                    requestFromEngine(EngineRequest::LoadAutomation, targetFileName);
+                }
+                jsonObject.remove("automation");
+            }
+
+            recallState(jsonObject, MixerState::fromJson(jsonObject, channelCount(), subgroupCount(), sampleRate()));
+            _currentScene = -1;
         } else {
             QMessageBox::critical(this,
                                   tr("Could not load state"),
@@ -461,6 +853,12 @@ void MainMixerWidget::on_aboutPushButton_clicked()
 
 void MainMixerWidget::resetControls()
 {
+    // Subgroups without controls on the front panel default to main, like all others
+    _recalledState = QJsonObject();
+    for(int i = MixerState::DefaultSubgroupCount; i < subgroupCount(); i++) {
+        _recalledState.insert(QString("subgroup%1OnMain").arg(i + 1), true);
+    }
+
     ui->subgroup1VolumeVerticalSlider->setValue(0);
     ui->subgroup2VolumeVerticalSlider->setValue(0);
     ui->subgroup3VolumeVerticalSlider->setValue(0);
@@ -507,3 +905,48 @@ void MainMixerWidget::resetControls()
         channelWidget->resetControls();
     }
 }
+
+void MainMixerWidget::recallEngineState()
+{
+    QJsonObject engineState = _engineSegment->state();
+    if(engineState.isEmpty()) {
+        return;
+    }
+
+    // Before a user interface has published its controls, the engine only knows what has been changed remotely
+    QJsonObject jsonObject = stateToJson();
+    for(QJsonObject::const_iterator iterator = engineState.constBegin(); iterator != engineState.constEnd(); ++iterator) {
+        jsonObject.insert(iterator.key(), iterator.value());
+    }
+    stateFromJson(jsonObject);
+}
+
+int MainMixerWidget::channelCount() const
+{
+    return _mixerEngine ? _mixerEngine->channelCount() : _engineSegment->channelCount();
+}
+
+int MainMixerWidget::subgroupCount() const
+{
+    return _mixerEngine ? _mixerEngine->subgroupCount() : _engineSegment->subgroupCount();
+}
+
+int MainMixerWidget::sampleRate() const
+{
+    return _mixerEngine ? QJackClient::instance()->sampleRate() : _engineSegment->status().sampleRate;
+}
+
+int MainMixerWidget::channelMeterIndex(int i) const
+{
+    return _mixerEngine ? _mixerEngine->channelMeterIndex(i) : _engineSegment->channelMeterIndex(i);
+}
+
+int MainMixerWidget::subgroupMeterIndex(int i) const
+{
+    return _mixerEngine ? _mixerEngine->subgroupMeterIndex(i) : _engineSegment->subgroupMeterIndex(i);
+}
+
+int MainMixerWidget::mainMeterIndex(int i) const
+{
+    return _mixerEngine ? _mixerEngine->mainMeterIndex(i) : _engineSegment->mainMeterIndex(i);
+}
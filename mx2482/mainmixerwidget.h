@@ -28,12 +28,19 @@
 #include <QWidget>
 #include <QMap>
 #include <QTimer>
-
-// QJackAudio includes
-#include <QJackClient>
+#include <QList>
+#include <QElapsedTimer>
 
 // Own includes
 #include "channelwidget.h"
+#include "mixerengine.h"
+#include "meterbank.h"
+#include "meterwidget.h"
+#include "scenebank.h"
+#include "automationrecorder.h"
+#include "mixercommand.h"
+#include "waitfreequeue.h"
+#include "enginesegment.h"
 
 namespace Ui {
 class MainMixerWidget;
@@ -48,22 +55,36 @@ class MainMixerWidget : public QWidget
     Q_OBJECT
 
 public:
-    /** Constructor */
-    explicit MainMixerWidget(QWidget *parent = 0);
+    /**
+     * Constructor.
+     * @param mixerEngine Engine the controls are published to, not owned.
+     */
+    explicit MainMixerWidget(MixerEngine *mixerEngine, QWidget *parent = 0);
+    /**
+     * Constructor for a user interface attached to a headless engine.
+     * Recording, the virtual soundcheck, automation and the period
+     * statistics are requested from the engine process, which uses the
+     * directories it has been started with. Tracing is left to it.
+     * @param engineSegment Segment of the engine, not owned.
+     */
+    explicit MainMixerWidget(EngineSegment *engineSegment, QWidget *parent = 0);
     /** Destructor */
     ~MainMixerWidget();
 
     /**
-     * Registers a a new channel widget to the main mixer widget.
+     * Registers a a new channel widget to the main mixer widget. Its
+     * controls are set to the current state of the channel, so strips
+     * can be built any time.
      * @param i The channel number.
      * @param channelWidget The channel widget.
      */
     void registerChannel(int i, ChannelWidget *channelWidget);
 
-    /** Performs all that is necessary to process the channel signal. */
-    void process();
-
-    /** Transfers the mixer state into a JSON object. */
+    /**
+     * Transfers the mixer state into a JSON object. Parameters without a
+     * control on the front panel, like subgroups beyond the eighth, are
+     * kept as they have been recalled.
+     */
     QJsonObject stateToJson();
 
     /** Recalls the state from a JSON object. */
@@ -72,89 +93,215 @@ public:
     /** Resets all controls to their default positions. */
     void resetControls();
 
+    /**
+     * Moves the controls to the state of the attached headless engine.
+     * Parameters the engine has no state for are left as they are.
+     */
+    void recallEngineState();
+
+    /**
+     * Loads all state files of a directory as scenes.
+     * @returns the number of scenes that have been loaded.
+     */
+    int loadScenes(const QString& path);
+
+    /** Sets the time recalled scenes and states crossfade over, 0 to switch over at once. */
+    void setCrossfadeTime(double milliseconds);
+
+    /**
+     * Sets where multitrack recordings go. Each recording gets a
+     * subdirectory named after the time it has been started.
+     */
+    void setRecordDirectory(const QString& directory, WavWriter::Format format);
+
+    /**
+     * Sets what the virtual soundcheck plays back.
+     * @param directory Recording to play back, empty for the latest one in the record directory.
+     * @param channels Channels to play back, starting at 0. Empty for all.
+     */
+    void setSoundcheck(const QString& directory, const QList<int>& channels);
+
+    /**
+     * Sets the queue of remote changes the controls follow. The engine has
+     * applied them already.
+     * @param controlQueue Queue to consume, not owned. 0 to detach.
+     */
+    void setControlQueue(WaitFreeQueue<MixerCommand> *controlQueue);
+
 public slots:
     /** Update the visual interface. */
     void updateInterface();
 
+    /**
+     * Takes a snapshot of all controls and publishes it to the mixer engine.
+     * Changes of controls are coalesced, so this runs once per event loop
+     * iteration at most.
+     */
+    void publishState();
+
+    /**
+     * Recalls scene i (starting at 0) of the loaded scenes. The engine
+     * takes over the parsed snapshot at the next period boundary, the
+     * controls follow afterwards.
+     */
+    void recallScene(int i);
+    /** Recalls the scene after the current one. */
+    void recallNextScene();
+    /** Recalls the scene before the current one. */
+    void recallPreviousScene();
+
+    /**
+     * Starts recording automation from the controls, or stops and loads
+     * the recording into the engine for playback.
+     */
+    void toggleAutomationRecording();
+    /** Starts or stops playing back the recorded automation. */
+    void toggleAutomationPlayback();
+
+    /** Starts or stops recording all inputs and outputs. */
+    void toggleRecording();
+    /** Switches the channel inputs between their ports and the recording for a virtual soundcheck. */
+    void toggleSoundcheck();
+
+    /** Saves the histogram of the period durations and the snapshots of the last xruns to a file. */
+    void exportCycleStatistics();
+
     void on_clearPushButton_clicked();
     void on_saveStatePushButton_clicked();
     void on_loadStatePushButton_clicked();
     void on_aboutPushButton_clicked();
 
 private:
+    enum {
+        /** Xrun snapshots kept for exporting, older ones are discarded. */
+        XrunSnapshotCount = 32,
+        /** Time after which a headless engine that has not updated its status is considered gone, in milliseconds. */
+        EngineTimeout = 1000
+    };
+
+    /** JACK values shown on the display. */
+    struct DisplayValues {
+        bool realtime;
+        int bufferSize;
+        /** CPU load in percent, 0 when idle. */
+        int cpuLoad;
+        int sampleRate;
+        /** Period durations in percent of the deadline, -1 if unknown. */
+        int cycleMedian;
+        int cycleP99;
+        int cycleP999;
+        int cycleMaximum;
+        qint64 xrunCount;
+        /** Index of the recalled scene, -1 if none. */
+        int scene;
+        bool automationRecording;
+        bool automationPlaying;
+        bool recording;
+        /** Frames the recording has lost, because the disk could not keep up. */
+        qint64 recordingDroppedFrames;
+        bool recordingFailed;
+        bool soundcheck;
+        /** Frames the virtual soundcheck has missed, because the disk could not keep up. */
+        qint64 soundcheckMissedFrames;
+        bool tracing;
+        /** Trace events that have been dropped, because the dump thread could not keep up. */
+        qint64 traceDroppedEvents;
+        /** Whether the headless engine updates its status, always true for an engine of our own. */
+        bool engineResponding;
+
+        bool operator!=(const DisplayValues& other) const;
+    };
+
+    /**
+     * Hands over a parsed snapshot to the engine with the crossfade time,
+     * then updates the controls to the same state.
+     */
+    void recallState(const QJsonObject& jsonObject, const MixerState& mixerState);
+
+    /** Constructor, exactly one of mixerEngine and engineSegment is given. */
+    MainMixerWidget(MixerEngine *mixerEngine, EngineSegment *engineSegment, QWidget *parent);
+
+    /** @returns the number of channels of the engine. */
+    int channelCount() const;
+    /** @returns the number of subgroups of the engine. */
+    int subgroupCount() const;
+    /** @returns the sample rate the engine runs at. */
+    int sampleRate() const;
+    /** @returns the meter record index of channel i (starting at 0). */
+    int channelMeterIndex(int i) const;
+    /** @returns the meter record index of subgroup i (starting at 0). */
+    int subgroupMeterIndex(int i) const;
+    /** @returns the meter record index of main i (0 is left, 1 is right). */
+    int mainMeterIndex(int i) const;
+
+    /** Asks the headless engine to do something, warning if it cannot take the request. */
+    void requestFromEngine(EngineRequest::Type type, const QString& fileName = QString());
+
     Ui::MainMixerWidget *ui;
 
     /** Update timer used to update the visual interface periodically. */
     QTimer _updateTimer;
 
+    /** Zero interval timer used to coalesce changes of controls before publishing. */
+    QTimer _publishTimer;
+
     /** Stores all registered channels. */
     QMap<int, ChannelWidget*> _registeredChannels;
 
-    /** Used to store calculated peak for subgroup 1. */
-    double _subgroupPeak1;
-    /** Used to store calculated peak for subgroup 2. */
-    double _subgroupPeak2;
-    /** Used to store calculated peak for subgroup 3. */
-    double _subgroupPeak3;
-    /** Used to store calculated peak for subgroup 4. */
-    double _subgroupPeak4;
-    /** Used to store calculated peak for subgroup 5. */
-    double _subgroupPeak5;
-    /** Used to store calculated peak for subgroup 6. */
-    double _subgroupPeak6;
-    /** Used to store calculated peak for subgroup 7. */
-    double _subgroupPeak7;
-    /** Used to store calculated peak for subgroup 8. */
-    double _subgroupPeak8;
-
-    /** Used to store calculated peak for main 1 (left). */
-    double _mainPeak1;
-    /** Used to store calculated peak for main 2 (right). */
-    double _mainPeak2;
-
-    /** Subgroup 1 fader stage. */
-    QAmplifier *_subgroup1FaderStage;
-    /** Subgroup 2 fader stage. */
-    QAmplifier *_subgroup2FaderStage;
-    /** Subgroup 3 fader stage. */
-    QAmplifier *_subgroup3FaderStage;
-    /** Subgroup 4 fader stage. */
-    QAmplifier *_subgroup4FaderStage;
-    /** Subgroup 5 fader stage. */
-    QAmplifier *_subgroup5FaderStage;
-    /** Subgroup 6 fader stage. */
-    QAmplifier *_subgroup6FaderStage;
-    /** Subgroup 7 fader stage. */
-    QAmplifier *_subgroup7FaderStage;
-    /** Subgroup 8 fader stage. */
-    QAmplifier *_subgroup8FaderStage;
-
-    /** Main 1 fader stage. */
-    QAmplifier *_main1FaderStage;
-    /** Main 2 fader stage. */
-    QAmplifier *_main2FaderStage;
-
-    /** Subgroup 1 direct out. */
-    QJackPort *_subGroup1Out;
-    /** Subgroup 2 direct out. */
-    QJackPort *_subGroup2Out;
-    /** Subgroup 3 direct out. */
-    QJackPort *_subGroup3Out;
-    /** Subgroup 4 direct out. */
-    QJackPort *_subGroup4Out;
-    /** Subgroup 5 direct out. */
-    QJackPort *_subGroup5Out;
-    /** Subgroup 6 direct out. */
-    QJackPort *_subGroup6Out;
-    /** Subgroup 7 direct out. */
-    QJackPort *_subGroup7Out;
-    /** Subgroup 8 direct out. */
-    QJackPort *_subGroup8Out;
-
-    /** Main 1 direct out. */
-    QJackPort *_mainLeftOut;
-    /** Main 2 direct out. */
-    QJackPort *_mainRightOut;
+    /** Engine doing the audio processing, 0 if attached to a headless engine. */
+    MixerEngine *_mixerEngine;
+    /** Segment of the headless engine, 0 if the engine runs in this process. */
+    EngineSegment *_engineSegment;
+    /** Meter records taken from the segment. */
+    QVector<MeterRecord> _engineMeterRecords;
+    /** Last heartbeat of the headless engine. */
+    quint32 _engineHeartbeat;
+    /** Measures the time since the heartbeat of the headless engine has changed. */
+    QElapsedTimer _engineHeartbeatTimer;
+
+    /** Meters of the subgroups on the front panel that exist in the engine. */
+    QList<MeterWidget*> _subgroupMeterWidgets;
+
+    /** Last recalled state, for parameters without a control on the front panel. */
+    QJsonObject _recalledState;
+
+    /** Ballistics of all meters, fed from the meter ring of the engine. */
+    MeterBank _meterBank;
+    /** Measures the time between two meter updates. */
+    QElapsedTimer _meterTimer;
+
+    /** Scenes loaded at startup. */
+    SceneBank _sceneBank;
+    /** Index of the recalled scene, -1 if none. */
+    int _currentScene;
+    /** Time recalled scenes and states crossfade over, in milliseconds. */
+    double _crossfadeTime;
+
+    /** Records automation from the published snapshots, a headless engine records its own. */
+    AutomationRecorder _automationRecorder;
+    /** Whether the engine plays back the recorded automation. */
+    bool _automationPlaying;
+
+    /** Directory multitrack recordings are written to. */
+    QString _recordDirectory;
+    /** File format of multitrack recordings. */
+    WavWriter::Format _recordFormat;
+    /** Recording the virtual soundcheck plays back, empty for the latest one. */
+    QString _soundcheckDirectory;
+    /** Channels the virtual soundcheck plays back, empty for all. */
+    QList<int> _soundcheckChannels;
+
+    /** Time each channel has spent in each stage up to the last update, while tracing. */
+    QVector<quint64> _channelTimes;
+
+    /** Snapshots of the last xruns. */
+    QList<XrunSnapshot> _xrunSnapshots;
+
+    /** Remote changes the controls follow, 0 if there is no remote control. */
+    WaitFreeQueue<MixerCommand> *_controlQueue;
+
+    /** Values currently shown on the display. */
+    DisplayValues _displayValues;
 };
 
 #endif // MAINMIXERWIDGET_H
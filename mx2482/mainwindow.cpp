@@ -32,18 +32,34 @@
 
 // Qt includes
 #include <QHBoxLayout>
+#include <QScrollArea>
 
-MainWindow::MainWindow(QWidget *parent) :
+MainWindow::MainWindow(const MixerOptions& mixerOptions, EngineSegment *engineSegment, QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    _mixerPorts(0),
+    _mixerEngine(0),
+    _lv2Host(0),
+    _oscThread(0),
+    _channelLayout(0),
+    _channelCount(engineSegment ? engineSegment->channelCount() : mixerOptions.channelCount),
+    _subgroupCount(engineSegment ? engineSegment->subgroupCount() : mixerOptions.subgroupCount),
+    _builtChannelCount(0)
 {
+    _startupTimer.start();
+
     // Setup UI
     ui->setupUi(this);
 
-    // Setup QJackAudio
-    QJackClient* jackClient = QJackClient::instance();
-    if(jackClient->connectToServer("MX2482")) {
-        jackClient->setAudioProcessor(this);
+    if(engineSegment) {
+        // The headless engine is running already, the controls take over its state
+        _mainMixerWidget = new MainMixerWidget(engineSegment);
+        _mainMixerWidget->setCrossfadeTime(mixerOptions.crossfadeTime);
+        _mainMixerWidget->resetControls();
+        _mainMixerWidget->recallEngineState();
+        _mainMixerWidget->publishState();
+    } else {
+        setupEngine(mixerOptions);
     }
 
     QHBoxLayout *hBoxLayout = new QHBoxLayout();
@@ -61,40 +77,139 @@ MainWindow::MainWindow(QWidget *parent) :
     rightBorderWidget->setStyleSheet("background: url(:/images/border-right.png);");
 
     hBoxLayout->addWidget(leftBorderWidget);
-    _mainMixerWidget = new MainMixerWidget();
-    for(int i = 0; i < 24; i++) {
-        ChannelWidget *channelWidget = new ChannelWidget(i + 1);
-        _mainMixerWidget->registerChannel(i + 1, channelWidget);
-        hBoxLayout->addWidget(channelWidget);
-    }
     hBoxLayout->addWidget(_mainMixerWidget);
     hBoxLayout->addWidget(rightBorderWidget);
+    _channelLayout = hBoxLayout;
 
     QWidget *widget = new QWidget();
     widget->setStyleSheet("background-color: rgb(120, 120, 120);");
     widget->setLayout(hBoxLayout);
-    setCentralWidget(widget);
+
+    // Large consoles do not fit on the screen, so they can be scrolled
+    QScrollArea *scrollArea = new QScrollArea();
+    scrollArea->setWidget(widget);
+    scrollArea->setWidgetResizable(true);
+    scrollArea->setFrameShape(QFrame::NoFrame);
+    setCentralWidget(scrollArea);
+
+    // The first bank is there when the window shows up, the others follow
+    buildChannelBank();
+
+    // Scenes are parsed once up front, so recalling them is instant
+    if(!mixerOptions.sceneDirectory.isEmpty()) {
+        if(_mainMixerWidget->loadScenes(mixerOptions.sceneDirectory) == 0) {
+            qWarning("No scenes found in %s", qPrintable(mixerOptions.sceneDirectory));
+        }
+    }
+}
+
+void MainWindow::setupEngine(const MixerOptions& mixerOptions)
+{
+    // Setup QJackAudio
+    QJackClient* jackClient = QJackClient::instance();
+    if(jackClient->connectToServer("MX2482")) {
+        jackClient->setAudioProcessor(this);
+    }
+
+    // Setup audio processing
+    _mixerPorts = new JackMixerPorts(mixerOptions.channelCount, mixerOptions.subgroupCount);
+    _mixerEngine = new MixerEngine(_mixerPorts, mixerOptions.channelCount, mixerOptions.subgroupCount);
+    _mixerEngine->resizeBuffers(jackClient->bufferSize());
+    _mixerEngine->setEqualizerEngine(mixerOptions.equalizerEngine);
+    _mixerEngine->setSilenceDetection(mixerOptions.silenceThreshold, mixerOptions.silenceHoldPeriods);
+    _mixerEngine->setDirectOutTap(mixerOptions.directOutTap);
+    _mixerEngine->startWorkerPool(mixerOptions.workerPool);
+    _mixerEngine->cycleMonitor().setSampleRate(jackClient->sampleRate());
+    if(!mixerOptions.traceFile.isEmpty() && !_mixerEngine->startTracing(mixerOptions.traceFile)) {
+        qWarning("%s", qPrintable(_mixerEngine->stageTracer().errorString()));
+    }
+
+    // Load the insert effects, a plugin that fails to load leaves its slot empty
+    if(!mixerOptions.inserts.isEmpty()) {
+        _lv2Host = new Lv2Host();
+    }
+    QMap<int, QString>::const_iterator insert;
+    for(insert = mixerOptions.inserts.constBegin(); insert != mixerOptions.inserts.constEnd(); ++insert) {
+        QString errorString;
+        Lv2Insert *lv2Insert = _lv2Host->createInsert(insert.value(), jackClient->sampleRate(), jackClient->bufferSize(), &errorString);
+        if(lv2Insert) {
+            _mixerEngine->setInsertEffect(insert.key(), lv2Insert);
+        } else {
+            qWarning("%s", qPrintable(errorString));
+        }
+    }
+
+    // Start processing with the controls in their default positions before any channel strip is
+    // built, so audio passes right away. Strips built later take over the state the engine has.
+    _mainMixerWidget = new MainMixerWidget(_mixerEngine);
+    _mainMixerWidget->setCrossfadeTime(mixerOptions.crossfadeTime);
+    _mainMixerWidget->setRecordDirectory(mixerOptions.recordDirectory, mixerOptions.recordFormat);
+    _mainMixerWidget->setSoundcheck(mixerOptions.soundcheckDirectory, mixerOptions.soundcheckChannels);
+    _mainMixerWidget->resetControls();
+    _mainMixerWidget->publishState();
 
     // Take off!
     jackClient->startAudioProcessing();
+    qDebug("Audio running after %lld ms.", _startupTimer.elapsed());
+
+    // Remote control has a thread of its own, so the user interface cannot hold it up
+    if(mixerOptions.oscPort > 0) {
+        OscServer *oscServer = new OscServer(_mixerEngine, QHostAddress(mixerOptions.oscAddress), mixerOptions.oscPort);
+        _mainMixerWidget->setControlQueue(&oscServer->controlQueue());
+        _oscThread = new QThread(this);
+        oscServer->moveToThread(_oscThread);
+        connect(_oscThread, SIGNAL(started()), oscServer, SLOT(start()));
+        connect(_oscThread, SIGNAL(finished()), oscServer, SLOT(deleteLater()));
+        _oscThread->start();
+    }
+}
 
-    // Reset controls to default values
-    _mainMixerWidget->resetControls();
+void MainWindow::buildChannelBank()
+{
+    int end = qMin(_builtChannelCount + (int)ChannelBankSize, _channelCount);
+    for(int i = _builtChannelCount; i < end; i++) {
+        ChannelWidget *channelWidget = new ChannelWidget(i + 1);
+        channelWidget->setSubgroupPairCount(_subgroupCount / 2);
+        _mainMixerWidget->registerChannel(i + 1, channelWidget);
+        _channelLayout->insertWidget(_channelLayout->indexOf(_mainMixerWidget), channelWidget);
+    }
+    _builtChannelCount = end;
+
+    if(_builtChannelCount < _channelCount) {
+        QTimer::singleShot(0, this, SLOT(buildChannelBank()));
+    } else {
+        qDebug("Built %d channel strips after %lld ms.", _channelCount, _startupTimer.elapsed());
+    }
 }
 
 void MainWindow::process()
 {
-    _mainMixerWidget->process();
+    _mixerEngine->process(QJackClient::instance()->bufferSize());
 }
 
 MainWindow::~MainWindow()
 {
+    if(_mixerEngine) {
+        QJackClient::instance()->stopAudioProcessing();
+    }
+    // The server is deleted when its thread finishes, which has to happen before the engine goes
+    if(_oscThread) {
+        _mainMixerWidget->setControlQueue(0);
+        _oscThread->quit();
+        _oscThread->wait();
+    }
     delete ui;
+    delete _mixerEngine;
+    delete _mixerPorts;
+    delete _lv2Host;
 }
 
 void MainWindow::closeEvent(QCloseEvent *closeEvent)
 {
-    QJackClient::instance()->stopAudioProcessing();
+    // A headless engine keeps running without the user interface
+    if(_mixerEngine) {
+        QJackClient::instance()->stopAudioProcessing();
+    }
     QMainWindow::closeEvent(closeEvent);
 }
 
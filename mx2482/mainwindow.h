@@ -27,12 +27,23 @@
 // Qt includes
 #include <QMainWindow>
 #include <QTimer>
+#include <QHBoxLayout>
+#include <QElapsedTimer>
 
 // QJackClient includes
 #include <QAudioProcessor>
 
 // Own includes
 #include "mainmixerwidget.h"
+#include "mixeroptions.h"
+#include "mixerengine.h"
+#include "jackmixerports.h"
+#include "lv2host.h"
+#include "oscserver.h"
+#include "enginesegment.h"
+
+// Qt includes
+#include <QThread>
 
 namespace Ui {
 class MainWindow;
@@ -47,7 +58,21 @@ class MainWindow : public QMainWindow, public QAudioProcessor
     Q_OBJECT
 
 public:
-    explicit MainWindow(QWidget *parent = 0);
+    enum {
+        /**
+         * Subgroups the main mixer panel has faders and meters for, and
+         * the channel strips have routing buttons for. Larger mixers run
+         * headless or offline only.
+         */
+        MaximumSubgroupCount = 8
+    };
+
+    /**
+     * Constructor.
+     * @param engineSegment Segment of a headless engine the user interface is
+     * attached to, not owned. 0 to run an engine in this process.
+     */
+    MainWindow(const MixerOptions& mixerOptions, EngineSegment *engineSegment = 0, QWidget *parent = 0);
     ~MainWindow();
 
     /** @overload */
@@ -57,11 +82,47 @@ protected:
     /** @overload */
     void closeEvent(QCloseEvent *closeEvent);
 
+private slots:
+    /**
+     * Builds the next bank of channel strips, and schedules the bank after
+     * it, so the user interface stays responsive until all are built.
+     */
+    void buildChannelBank();
+
 private:
+    /**
+     * Connects to JACK, sets up the engine and the main mixer widget,
+     * starts processing and the OSC control server.
+     */
+    void setupEngine(const MixerOptions& mixerOptions);
+
+    enum {
+        /** Channel strips built at once. */
+        ChannelBankSize = 8
+    };
+
     Ui::MainWindow *ui;
 
     /** The main mixer widget. */
     MainMixerWidget *_mainMixerWidget;
+
+    /** JACK ports the mixer engine reads from and writes to, 0 if attached to a headless engine. */
+    JackMixerPorts *_mixerPorts;
+    /** Engine doing the audio processing, 0 if attached to a headless engine. */
+    MixerEngine *_mixerEngine;
+    /** Host for the insert effects, only created if there are any. */
+    Lv2Host *_lv2Host;
+    /** Thread the OSC control server runs in, only created if it is enabled. */
+    QThread *_oscThread;
+
+    /** Layout the channel strips are inserted into, left of the main mixer. */
+    QHBoxLayout *_channelLayout;
+    int _channelCount;
+    int _subgroupCount;
+    /** Number of channel strips built so far. */
+    int _builtChannelCount;
+    /** Measures the time since the window has been created. */
+    QElapsedTimer _startupTimer;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "meterbank.h"
+
+// QJackAudio includes
+#include <QUnits>
+
+// Standard includes
+#include <cmath>
+
+/** Fall back of the displayed peak, in dB per second. */
+static const double PeakFallDbPerSecond = 20.0;
+/** How long the highest peak is held, in seconds. */
+static const double PeakHoldSeconds = 1.5;
+/** Time constant of the RMS average, in seconds. */
+static const double RmsTimeConstant = 0.3;
+/** How long the clip indicator stays lit, in seconds. */
+static const double ClipHoldSeconds = 2.0;
+
+MeterBank::MeterBank(int meterCount) :
+    _meters(meterCount),
+    _readings(meterCount)
+{
+    for(int i = 0; i < meterCount; i++) {
+        Meter& meter = _meters[i];
+        meter.pending.clear();
+        meter.peak = 0.0;
+        meter.meanSquare = 0.0;
+        meter.hold = 0.0;
+        meter.holdTimeLeft = 0.0;
+        meter.clipTimeLeft = 0.0;
+
+        MeterReading& reading = _readings[i];
+        reading.peakDb = reading.rmsDb = reading.holdDb = QUnits::linearToDb(0.0);
+        reading.clipped = false;
+    }
+}
+
+int MeterBank::meterCount() const
+{
+    return _meters.size();
+}
+
+void MeterBank::accumulate(const MeterRecord *meterRecords)
+{
+    for(int i = 0; i < _meters.size(); i++) {
+        _meters[i].pending.accumulate(meterRecords[i]);
+    }
+}
+
+void MeterBank::update(double elapsedSeconds)
+{
+    double peakFall = QUnits::dbToLinear(-PeakFallDbPerSecond * elapsedSeconds);
+    double rmsCoefficient = 1.0 - std::exp(-elapsedSeconds / RmsTimeConstant);
+
+    for(int i = 0; i < _meters.size(); i++) {
+        Meter& meter = _meters[i];
+        MeterRecord& pending = meter.pending;
+
+        // Instant attack, constant fall back in dB
+        meter.peak *= peakFall;
+        if(pending.peak > meter.peak) {
+            meter.peak = pending.peak;
+        }
+
+        meter.holdTimeLeft -= elapsedSeconds;
+        if(pending.peak >= meter.hold || meter.holdTimeLeft <= 0.0) {
+            meter.hold = meter.peak;
+            meter.holdTimeLeft = PeakHoldSeconds;
+        }
+
+        // Without new samples, the average decays to silence
+        double meanSquare = pending.frames > 0 ? pending.energy / pending.frames : 0.0;
+        meter.meanSquare += rmsCoefficient * (meanSquare - meter.meanSquare);
+
+        meter.clipTimeLeft -= elapsedSeconds;
+        if(pending.clips > 0) {
+            meter.clipTimeLeft = ClipHoldSeconds;
+        }
+
+        MeterReading& reading = _readings[i];
+        reading.peakDb = QUnits::linearToDb(meter.peak);
+        reading.rmsDb = QUnits::linearToDb(std::sqrt(meter.meanSquare));
+        reading.holdDb = QUnits::linearToDb(meter.hold);
+        reading.clipped = meter.clipTimeLeft > 0.0;
+
+        pending.clear();
+    }
+}
+
+const MeterReading& MeterBank::reading(int i) const
+{
+    return _readings.at(i);
+}
@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef METERBANK_H
+#define METERBANK_H
+
+// Qt includes
+#include <QVector>
+
+// Own includes
+#include "meterring.h"
+
+/**
+ * Level of one meter as it is to be displayed, all values in dB.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct MeterReading
+{
+    /** Peak with instant attack and a constant fall back. */
+    double peakDb;
+    /** RMS level, averaged exponentially. */
+    double rmsDb;
+    /** Highest peak of the last hold time. */
+    double holdDb;
+    /** Whether a sample at or above full scale has been seen recently. */
+    bool clipped;
+};
+
+/**
+ * Meter ballistics for a number of strips. The meter records published by
+ * the realtime thread are merged in by accumulate(), update() advances the
+ * ballistics by the time that has passed since. Runs in the thread that
+ * reads the meter ring only.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class MeterBank
+{
+public:
+    /** Constructor. */
+    MeterBank(int meterCount);
+
+    /** @returns the number of meters. */
+    int meterCount() const;
+
+    /** Merges one slot of meter records, one for each meter. */
+    void accumulate(const MeterRecord *meterRecords);
+
+    /**
+     * Applies all levels accumulated since the last call.
+     * @param elapsedSeconds Time since the last call.
+     */
+    void update(double elapsedSeconds);
+
+    /** @returns the reading of meter i. */
+    const MeterReading& reading(int i) const;
+
+private:
+    struct Meter {
+        /** Levels accumulated since the last update. */
+        MeterRecord pending;
+        /** Displayed peak, linear. */
+        double peak;
+        /** Averaged square of the samples. */
+        double meanSquare;
+        /** Held peak, linear. */
+        double hold;
+        /** Time left until the held peak is released. */
+        double holdTimeLeft;
+        /** Time left until the clip indicator is released. */
+        double clipTimeLeft;
+    };
+
+    QVector<Meter> _meters;
+    QVector<MeterReading> _readings;
+};
+
+#endif // METERBANK_H
@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef METERRING_H
+#define METERRING_H
+
+// Own includes
+#include "waitfreering.h"
+
+// Standard includes
+#include <cstring>
+
+/**
+ * Level of one strip, accumulated over one or more periods by the realtime
+ * thread. Peak and energy are linear, conversion to dB is left to the
+ * reader.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct MeterRecord
+{
+    /** Absolute peak. */
+    float peak;
+    /** Sum of the squares of all samples, for RMS. */
+    float energy;
+    /** Number of samples energy has been summed over. */
+    quint32 frames;
+    /** Number of samples at or above full scale. */
+    quint32 clips;
+
+    /** Resets all values, so the record can be accumulated into again. */
+    void clear() {
+        peak = 0.0f;
+        energy = 0.0f;
+        frames = 0;
+        clips = 0;
+    }
+
+    /** Merges the levels of another record into this one. */
+    void accumulate(const MeterRecord& other) {
+        if(other.peak > peak) {
+            peak = other.peak;
+        }
+        energy += other.energy;
+        frames += other.frames;
+        clips += other.clips;
+    }
+};
+
+/**
+ * Wait-free single producer, single consumer ring of meter snapshots. Each
+ * slot holds one MeterRecord for every strip. The realtime thread writes,
+ * the GUI thread reads, neither of them ever blocks. When the ring is full,
+ * the writer keeps accumulating and tries again in the next period, so no
+ * peak is ever lost.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class MeterRing
+{
+public:
+    /**
+     * Constructor.
+     * @param recordCount Number of records in each slot, one per strip.
+     * @param slotCount Number of slots, must be a power of two.
+     */
+    MeterRing(int recordCount, int slotCount) :
+        _ring(slotCount, recordCount) {
+    }
+
+    /** @returns the number of records in each slot. */
+    int recordCount() const {
+        return _ring.slotSize();
+    }
+
+    /** Writer only. @returns true, if there is no free slot. */
+    bool isFull() const {
+        return _ring.writeAvailable() == 0;
+    }
+
+    /**
+     * Writer only. Copies records into the next free slot.
+     * @returns false, if the ring is full.
+     */
+    bool write(const MeterRecord *records) {
+        if(isFull()) {
+            return false;
+        }
+        memcpy(_ring.writeSlot(), records, recordCount() * sizeof(MeterRecord));
+        _ring.commitWrite(1);
+        return true;
+    }
+
+    /**
+     * Reader only.
+     * @returns the oldest unread slot, or 0 if there is none. The slot stays
+     * valid until release() is called.
+     */
+    const MeterRecord *peek() {
+        if(_ring.readAvailable() == 0) {
+            return 0;
+        }
+        return _ring.readSlot();
+    }
+
+    /** Reader only. Hands the slot returned by peek() back to the writer. */
+    void release() {
+        _ring.commitRead(1);
+    }
+
+private:
+    WaitFreeRing<MeterRecord> _ring;
+};
+
+#endif // METERRING_H
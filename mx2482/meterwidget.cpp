@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "meterwidget.h"
+
+// Qt includes
+#include <QPainter>
+#include <QPaintEvent>
+#include <QLinearGradient>
+#include <QPixmapCache>
+
+// Standard includes
+#include <cmath>
+
+MeterWidget::MeterWidget(QWidget *parent) :
+    QWidget(parent),
+    _peakRow(0),
+    _rmsRow(0),
+    _holdRow(0),
+    _clipped(false)
+{
+    // Every pixel is painted in paintEvent(), so there is no need to erase the background
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Expanding);
+    _peakRow = _rmsRow = _holdRow = barRect().bottom() + 1;
+    renderPixmaps();
+}
+
+void MeterWidget::setReading(const MeterReading& meterReading)
+{
+    int peakRow = levelToRow(meterReading.peakDb);
+    int rmsRow = levelToRow(qMin(meterReading.rmsDb, meterReading.peakDb));
+    int holdRow = levelToRow(meterReading.holdDb);
+
+    if(peakRow != _peakRow) {
+        updateRows(peakRow, _peakRow);
+        _peakRow = peakRow;
+    }
+    if(rmsRow != _rmsRow) {
+        updateRows(rmsRow, _rmsRow);
+        _rmsRow = rmsRow;
+    }
+    if(holdRow != _holdRow) {
+        updateRows(holdRow, holdRow);
+        updateRows(_holdRow, _holdRow);
+        _holdRow = holdRow;
+    }
+    if(meterReading.clipped != _clipped) {
+        update(clipIndicatorRect());
+        _clipped = meterReading.clipped;
+    }
+}
+
+QSize MeterWidget::sizeHint() const
+{
+    return QSize(18, 120);
+}
+
+QSize MeterWidget::minimumSizeHint() const
+{
+    return QSize(6, 40);
+}
+
+void MeterWidget::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    QRect damagedRect = event->rect();
+    QRect bar = barRect();
+
+    // Blit the three sections of the bar, as far as they have been damaged
+    QRect sections[] = {
+        QRect(bar.left(), bar.top(), bar.width(), _peakRow - bar.top()),
+        QRect(bar.left(), _peakRow,  bar.width(), _rmsRow - _peakRow),
+        QRect(bar.left(), _rmsRow,   bar.width(), bar.bottom() + 1 - _rmsRow)
+    };
+    const QPixmap *pixmaps[] = { &_unlitPixmap, &_peakPixmap, &_rmsPixmap };
+    for(int i = 0; i < 3; i++) {
+        QRect section = sections[i].intersected(damagedRect);
+        if(!section.isEmpty()) {
+            painter.drawPixmap(section.topLeft(), *pixmaps[i], section.translated(-bar.topLeft()));
+        }
+    }
+
+    // The held peak is a single lit row above the bar
+    if(_holdRow < _peakRow && _holdRow <= bar.bottom()) {
+        QRect holdRect = QRect(bar.left(), _holdRow, bar.width(), 1).intersected(damagedRect);
+        if(!holdRect.isEmpty()) {
+            painter.drawPixmap(holdRect.topLeft(), _rmsPixmap, holdRect.translated(-bar.topLeft()));
+        }
+    }
+
+    QRect clipRect = clipIndicatorRect();
+    if(clipRect.intersects(damagedRect)) {
+        painter.fillRect(clipRect, _clipped ? QColor(255, 40, 40) : QColor(50, 0, 0));
+    }
+}
+
+void MeterWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    _peakRow = _rmsRow = _holdRow = barRect().bottom() + 1;
+    renderPixmaps();
+}
+
+QRect MeterWidget::barRect() const
+{
+    return QRect(0, ClipIndicatorHeight + 1, width(), qMax(0, height() - ClipIndicatorHeight - 1));
+}
+
+QRect MeterWidget::clipIndicatorRect() const
+{
+    return QRect(0, 0, width(), ClipIndicatorHeight + 1);
+}
+
+int MeterWidget::levelToRow(double levelDb) const
+{
+    QRect bar = barRect();
+
+    // Also catches -inf and NaN of silence
+    if(!(levelDb > MinimumDb)) {
+        return bar.bottom() + 1;
+    }
+
+    double fraction = qMin(1.0, (levelDb - MinimumDb) / (MaximumDb - MinimumDb));
+    return bar.bottom() + 1 - (int)std::floor(fraction * bar.height() + 0.5);
+}
+
+void MeterWidget::renderPixmaps()
+{
+    QSize size = barRect().size();
+    if(size.isEmpty()) {
+        size = QSize(1, 1);
+    }
+
+    // All meters of the same size look the same, so they share their pixmaps
+    QString key = QString("MeterWidget:%1x%2:").arg(size.width()).arg(size.height());
+    if(QPixmapCache::find(key + "unlit", &_unlitPixmap)
+            && QPixmapCache::find(key + "rms", &_rmsPixmap)
+            && QPixmapCache::find(key + "peak", &_peakPixmap)) {
+        update();
+        return;
+    }
+
+    _unlitPixmap = QPixmap(size);
+    _unlitPixmap.fill(Qt::black);
+
+    // Same look as the progress bars used before: a horizontal gradient in segments of one
+    // pixel row, with a black frame of two pixels left and right.
+    QLinearGradient gradient(0, 0, size.width() / 2.0, 0);
+    gradient.setSpread(QGradient::ReflectSpread);
+    gradient.setColorAt(0.0, QColor(106, 199, 255));
+    gradient.setColorAt(1.0, QColor(224, 242, 255));
+
+    _rmsPixmap = QPixmap(size);
+    _rmsPixmap.fill(Qt::black);
+    QPainter rmsPainter(&_rmsPixmap);
+    for(int row = size.height() - 1; row >= 0; row -= 2) {
+        rmsPainter.fillRect(QRect(2, row, size.width() - 4, 1), gradient);
+    }
+    rmsPainter.end();
+
+    // Between RMS and peak, the bar is dimmed
+    _peakPixmap = _rmsPixmap;
+    QPainter peakPainter(&_peakPixmap);
+    peakPainter.fillRect(_peakPixmap.rect(), QColor(0, 0, 0, 128));
+    peakPainter.end();
+
+    QPixmapCache::insert(key + "unlit", _unlitPixmap);
+    QPixmapCache::insert(key + "rms", _rmsPixmap);
+    QPixmapCache::insert(key + "peak", _peakPixmap);
+    update();
+}
+
+void MeterWidget::updateRows(int firstRow, int secondRow)
+{
+    int top = qMin(firstRow, secondRow);
+    int bottom = qMax(firstRow, secondRow);
+    update(QRect(0, top, width(), bottom - top + 1));
+}
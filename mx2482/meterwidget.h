@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef METERWIDGET_H
+#define METERWIDGET_H
+
+// Qt includes
+#include <QWidget>
+#include <QPixmap>
+
+// Own includes
+#include "meterbank.h"
+
+/**
+ * Vertical level meter showing peak, RMS, peak hold and a clip indicator.
+ * The bar is blitted from pixmaps that are only rendered on resize, and a
+ * new reading only repaints the rows that actually changed.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class MeterWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /** Constructor */
+    explicit MeterWidget(QWidget *parent = 0);
+
+    /** Shows a new reading. Schedules a repaint only if a visible value changed. */
+    void setReading(const MeterReading& meterReading);
+
+    /** @overload */
+    QSize sizeHint() const;
+    /** @overload */
+    QSize minimumSizeHint() const;
+
+protected:
+    /** @overload */
+    void paintEvent(QPaintEvent *event);
+    /** @overload */
+    void resizeEvent(QResizeEvent *event);
+
+private:
+    enum {
+        /** Level at the bottom of the bar, in dB. */
+        MinimumDb = -60,
+        /** Level at the top of the bar, in dB. */
+        MaximumDb = 10,
+        /** Height of the clip indicator on top of the bar, in pixels. */
+        ClipIndicatorHeight = 4
+    };
+
+    /** @returns the area of the bar, below the clip indicator. */
+    QRect barRect() const;
+    /** @returns the area of the clip indicator. */
+    QRect clipIndicatorRect() const;
+    /** @returns the topmost row of the bar lit at the given level. */
+    int levelToRow(double levelDb) const;
+    /** Renders the pixmaps for the current size, or takes them over from a meter of the same size. */
+    void renderPixmaps();
+    /** Schedules a repaint of the bar rows between two rows. */
+    void updateRows(int firstRow, int secondRow);
+
+    /** Bar where it is not lit. */
+    QPixmap _unlitPixmap;
+    /** Bar between RMS and peak. */
+    QPixmap _peakPixmap;
+    /** Bar below RMS. */
+    QPixmap _rmsPixmap;
+
+    /** Topmost lit row of the peak. */
+    int _peakRow;
+    /** Topmost lit row of the RMS. */
+    int _rmsRow;
+    /** Row of the held peak. */
+    int _holdRow;
+    /** Whether the clip indicator is lit. */
+    bool _clipped;
+};
+
+#endif // METERWIDGET_H
@@ -0,0 +1,230 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "mixercommand.h"
+
+// QJackAudio includes
+#include <QUnits>
+
+// Qt includes
+#include <QtNumeric>
+
+/** Keys of the channel parameters in the state, in the order of MixerCommand::Type. */
+static const char *channelKeys[] = {
+    "inputGain",
+    "auxSendGain",
+    "auxReturnGain",
+    "faderGain",
+    "panorama",
+    "lowFrequency",
+    "lowAmount",
+    "midFrequency",
+    "midAmount",
+    "highAmount",
+    "gateThreshold",
+    "compressorThreshold",
+    "compressorRatio",
+    "eqActive",
+    "auxActive",
+    "insertActive",
+    "muted",
+    "soloed",
+    "onMain",
+    "gateActive",
+    "compressorActive"
+};
+
+bool MixerCommand::isValid(int channelCount, int subgroupCount) const
+{
+    if(!qIsFinite(value)) {
+        return false;
+    }
+
+    switch(type) {
+    case ChannelInSubgroupPair:
+        return index >= 0 && index < channelCount && pair >= 0 && pair < subgroupCount / 2;
+    case SubgroupGain:
+    case SubgroupMuted:
+    case SubgroupSoloed:
+    case SubgroupOnMain:
+        return index >= 0 && index < subgroupCount;
+    case MainGain:
+    case MainMuted:
+        return index >= 0 && index < MixerState::MainCount;
+    default:
+        return index >= 0 && index < channelCount;
+    }
+}
+
+void MixerCommand::clampValue()
+{
+    switch(type) {
+    case ChannelInputGain:
+    case ChannelLowAmount:
+    case ChannelMidAmount:
+    case ChannelHighAmount:
+        value = qBound(-50.0f, value, 50.0f);
+        return;
+    case ChannelAuxSendGain:
+    case ChannelAuxReturnGain:
+        value = qBound(-144.0f, value, 0.0f);
+        return;
+    case ChannelFaderGain:
+    case SubgroupGain:
+    case MainGain:
+        value = qBound(-144.0f, value, 10.0f);
+        return;
+    case ChannelPanorama:
+        value = qBound(0.0f, value, 100.0f);
+        return;
+    case ChannelLowFrequency:
+        value = qBound(20.0f, value, 200.0f);
+        return;
+    case ChannelMidFrequency:
+        value = qBound(200.0f, value, 12000.0f);
+        return;
+    case ChannelGateThreshold:
+        value = qBound(-80.0f, value, 0.0f);
+        return;
+    case ChannelCompressorThreshold:
+        value = qBound(-40.0f, value, 0.0f);
+        return;
+    case ChannelCompressorRatio:
+        value = qBound(1.0f, value, 20.0f);
+        return;
+    default:
+        value = value != 0.0f ? 1.0f : 0.0f;
+        return;
+    }
+}
+
+void MixerCommand::apply(MixerState& mixerState) const
+{
+    switch(type) {
+    case SubgroupGain:
+        mixerState.subgroups[index].gain = QUnits::dbToLinear(value);
+        return;
+    case SubgroupMuted:
+        mixerState.subgroups[index].muted = value != 0.0f;
+        return;
+    case SubgroupSoloed:
+        mixerState.subgroups[index].soloed = value != 0.0f;
+        mixerState.updateSoloState();
+        return;
+    case SubgroupOnMain:
+        mixerState.subgroups[index].onMain = value != 0.0f;
+        return;
+    case MainGain:
+        mixerState.mainGains[index] = QUnits::dbToLinear(value);
+        return;
+    case MainMuted:
+        mixerState.mainMuted[index] = value != 0.0f;
+        return;
+    default:
+        break;
+    }
+
+    ChannelState& channelState = mixerState.channels[index];
+    switch(type) {
+    case ChannelInputGain:      channelState.inputGain = QUnits::dbToLinear(value); break;
+    case ChannelAuxSendGain:    channelState.auxSendGain = QUnits::dbToLinear(value); break;
+    case ChannelAuxReturnGain:  channelState.auxReturnGain = QUnits::dbToLinear(value); break;
+    case ChannelFaderGain:      channelState.faderGain = QUnits::dbToLinear(value); break;
+    case ChannelPanorama:       channelState.panorama = value / 100.0f; break;
+    case ChannelLowFrequency:   channelState.lowFrequency = (int)value; break;
+    case ChannelLowAmount:      channelState.lowAmount = (int)value; break;
+    case ChannelMidFrequency:   channelState.midFrequency = (int)value; break;
+    case ChannelMidAmount:      channelState.midAmount = (int)value; break;
+    case ChannelHighAmount:     channelState.highAmount = (int)value; break;
+    case ChannelGateThreshold:  channelState.gateThreshold = QUnits::dbToLinear(value); break;
+    case ChannelCompressorThreshold: channelState.compressorThreshold = QUnits::dbToLinear(value); break;
+    case ChannelCompressorRatio: channelState.compressorRatio = qMax(1.0f, value); break;
+    case ChannelEqualizerOn:    channelState.equalizerOn = value != 0.0f; break;
+    case ChannelAuxOn:          channelState.auxOn = value != 0.0f; break;
+    case ChannelInsertOn:       channelState.insertOn = value != 0.0f; break;
+    case ChannelMuted:          channelState.muted = value != 0.0f; break;
+    case ChannelSoloed:         channelState.soloed = value != 0.0f; break;
+    case ChannelOnMain:         channelState.onMain = value != 0.0f; break;
+    case ChannelGateOn:         channelState.gateOn = value != 0.0f; break;
+    case ChannelCompressorOn:   channelState.compressorOn = value != 0.0f; break;
+    case ChannelInSubgroupPair:
+        if(value != 0.0f) {
+            channelState.subgroupPairs |= Q_UINT64_C(1) << pair;
+        } else {
+            channelState.subgroupPairs &= ~(Q_UINT64_C(1) << pair);
+        }
+        break;
+    default:
+        break;
+    }
+
+    // Only the band whose parameter has changed is computed
+    if(type == ChannelLowFrequency || type == ChannelLowAmount) {
+        channelState.updateEqualizerBand(BiquadEqualizerBank::LowShelf, mixerState.sampleRate);
+    } else if(type == ChannelMidFrequency || type == ChannelMidAmount) {
+        channelState.updateEqualizerBand(BiquadEqualizerBank::Band, mixerState.sampleRate);
+    } else if(type == ChannelHighAmount) {
+        channelState.updateEqualizerBand(BiquadEqualizerBank::HighShelf, mixerState.sampleRate);
+    } else if(type == ChannelSoloed) {
+        mixerState.updateSoloState();
+    }
+}
+
+void MixerCommand::apply(QJsonObject& jsonObject) const
+{
+    bool switchValue = value != 0.0f;
+    switch(type) {
+    case SubgroupGain:
+        jsonObject.insert(QString("subgroup%1Gain").arg(index + 1), value);
+        return;
+    case SubgroupMuted:
+        jsonObject.insert(QString("subgroup%1Muted").arg(index + 1), switchValue);
+        return;
+    case SubgroupSoloed:
+        jsonObject.insert(QString("subgroup%1Soloed").arg(index + 1), switchValue);
+        return;
+    case SubgroupOnMain:
+        jsonObject.insert(QString("subgroup%1OnMain").arg(index + 1), switchValue);
+        return;
+    case MainGain:
+        jsonObject.insert(QString("main%1Gain").arg(index + 1), value);
+        return;
+    case MainMuted:
+        jsonObject.insert(QString("main%1Muted").arg(index + 1), switchValue);
+        return;
+    default:
+        break;
+    }
+
+    QString channelKey = QString("channel%1").arg(index + 1);
+    QJsonObject channelObject = jsonObject.value(channelKey).toObject();
+    if(type == ChannelInSubgroupPair) {
+        channelObject.insert(QString("inSubgroup%1%2").arg(2 * pair + 1).arg(2 * pair + 2), switchValue);
+    } else if(type >= ChannelEqualizerOn) {
+        channelObject.insert(channelKeys[type], switchValue);
+    } else {
+        channelObject.insert(channelKeys[type], value);
+    }
+    jsonObject.insert(channelKey, channelObject);
+}
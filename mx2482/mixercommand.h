@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MIXERCOMMAND_H
+#define MIXERCOMMAND_H
+
+// Qt includes
+#include <QJsonObject>
+
+// Own includes
+#include "mixerstate.h"
+
+/**
+ * Change of a single parameter from a remote control. Values are given
+ * in the units of the front panel and the state files: gains in dB,
+ * panorama from 0 to 100, equalizer settings and compressor ratios as on
+ * the dials, thresholds in dB and switches as 0 or 1.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct MixerCommand
+{
+    enum Type {
+        ChannelInputGain,
+        ChannelAuxSendGain,
+        ChannelAuxReturnGain,
+        ChannelFaderGain,
+        ChannelPanorama,
+        ChannelLowFrequency,
+        ChannelLowAmount,
+        ChannelMidFrequency,
+        ChannelMidAmount,
+        ChannelHighAmount,
+        ChannelGateThreshold,
+        ChannelCompressorThreshold,
+        ChannelCompressorRatio,
+        ChannelEqualizerOn,
+        ChannelAuxOn,
+        ChannelInsertOn,
+        ChannelMuted,
+        ChannelSoloed,
+        ChannelOnMain,
+        ChannelGateOn,
+        ChannelCompressorOn,
+        ChannelInSubgroupPair,
+        SubgroupGain,
+        SubgroupMuted,
+        SubgroupSoloed,
+        SubgroupOnMain,
+        MainGain,
+        MainMuted
+    };
+
+    /** Parameter to change. */
+    Type type;
+    /** Channel, subgroup or main (0 is left, 1 is right), starting at 0. */
+    int index;
+    /** Subgroup pair for ChannelInSubgroupPair, starting at 0. */
+    int pair;
+    /** New value. */
+    float value;
+
+    /**
+     * @returns true, if the parameter exists in a mixer of the given
+     * topology and the value is finite.
+     */
+    bool isValid(int channelCount, int subgroupCount) const;
+
+    /**
+     * Limits a finite value to the range of the control of the parameter
+     * on the front panel, and switches to 0 or 1.
+     */
+    void clampValue();
+
+    /**
+     * Applies the change to a snapshot owned by the realtime thread.
+     * Never allocates, as long as the snapshot is not shared.
+     */
+    void apply(MixerState& mixerState) const;
+
+    /** Applies the change to a state as written by MainMixerWidget::stateToJson(). */
+    void apply(QJsonObject& jsonObject) const;
+};
+
+#endif // MIXERCOMMAND_H
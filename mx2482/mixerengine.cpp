@@ -0,0 +1,786 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "mixerengine.h"
+#include "sampleops.h"
+
+// QJackAudio includes
+#include <QUnits>
+
+MixerEngine::MixerEngine(MixerPorts *mixerPorts, int channelCount, int subgroupCount) :
+    _mixerPorts(mixerPorts),
+    _channelCount(channelCount),
+    _subgroupCount(subgroupCount),
+    _publishCount(0),
+    _crossfadeSerial(0),
+    _crossfadeFrames(0),
+    _commandQueue(CommandQueueCapacity),
+    _liveState(channelCount, subgroupCount),
+    _mergedState(channelCount, subgroupCount),
+    _scratchArena(channelCount + 1, subgroupCount + MixerState::MainCount),
+    _equalizerEngine(MixerOptions::BiquadEqualizer),
+    _biquadEqualizer(channelCount),
+    _dynamics(channelCount),
+    _dynamicsActive(false),
+    _laneBuffers(channelCount),
+    _cycleMixerState(0),
+    _cycleFrames(0),
+    _routingKernel(RoutingKernel<float, BusSample>::function()),
+    _busRoutingKernel(RoutingKernel<BusSample, BusSample>::function()),
+    _routingTargets(subgroupCount + MixerState::MainCount),
+    _routingGains(channelCount * (subgroupCount + MixerState::MainCount), 0.0f),
+    _subgroupGains(subgroupCount, 0.0f),
+    _subgroupMainGains(subgroupCount, 0.0f),
+    _meterRecords(channelCount + subgroupCount + MixerState::MainCount),
+    _meterRing(channelCount + subgroupCount + MixerState::MainCount, MeterSlotCount),
+    _remoteMeterRing(channelCount + subgroupCount + MixerState::MainCount, MeterSlotCount),
+    _remoteMeteringEnabled(0),
+    _firstAutomationPlayer(channelCount, subgroupCount),
+    _secondAutomationPlayer(channelCount, subgroupCount),
+    _loadedAutomationPlayer(&_firstAutomationPlayer),
+    _automationPlayer(&_firstAutomationPlayer),
+    _multitrackRecorder(channelCount, subgroupCount),
+    _recording(false),
+    _multitrackPlayer(channelCount),
+    _soundcheck(false),
+    _stageTracer(channelCount),
+    _activeStageTracer(0),
+    _frameTime(0)
+{
+    for(int i = 0; i < channelCount; i++) {
+        ChannelStrip *channelStrip = new ChannelStrip(i, mixerPorts);
+        channelStrip->setAutomationPlayer(_automationPlayer);
+        _channelStrips.append(channelStrip);
+    }
+    for(int i = 0; i < _meterRecords.size(); i++) {
+        _meterRecords[i].clear();
+    }
+    for(int i = 0; i < MixerState::MainCount; i++) {
+        _mainGains[i] = 0.0f;
+    }
+
+    // The realtime thread must never see a snapshot of a different topology
+    publishState(MixerState(channelCount, subgroupCount));
+}
+
+MixerEngine::~MixerEngine()
+{
+    stopRecording();
+    stopPlayback();
+    stopTracing();
+    _workerPool.stop();
+    qDeleteAll(_channelStrips);
+}
+
+void MixerEngine::publishState(const MixerState& mixerState)
+{
+    MixerState& writeBuffer = _mixerState.writeBuffer();
+    writeBuffer = mixerState;
+    if(writeBuffer.channelCount() != _channelCount || writeBuffer.subgroupCount() != _subgroupCount) {
+        writeBuffer.resize(_channelCount, _subgroupCount);
+    }
+    writeBuffer.serial = ++_publishCount;
+    _mixerState.publish();
+}
+
+bool MixerEngine::pushCommand(const MixerCommand& mixerCommand)
+{
+    if(!mixerCommand.isValid(_channelCount, _subgroupCount)) {
+        return false;
+    }
+    return _commandQueue.push(mixerCommand);
+}
+
+void MixerEngine::process(int frames)
+{
+    enableFlushToZero();
+    quint64 cycleBegin = StageTracer::timestamp();
+
+    // Obtain the most recently published mixer state
+    const MixerState& publishedState = _mixerState.read();
+    _frameTime.storeRelease(_frameTime.loadAcquire() + frames);
+
+    // Skip this period if the buffers are being resized
+    if(!_scratchArena.beginCycle(frames)) {
+        _mixerPorts->clearOutputs(frames);
+        monitorCycle(cycleBegin, frames, false);
+        return;
+    }
+
+    // A new snapshot starts its crossfade at this period boundary, interrupting a running one.
+    // Only what it changes is taken over, so remote commands are not undone by an unrelated change.
+    if(publishedState.serial != _crossfadeSerial) {
+        _liveState.mergeChanges(_mergedState, publishedState);
+        _mergedState.copyFrom(publishedState);
+        _crossfadeSerial = publishedState.serial;
+        _crossfadeFrames = publishedState.crossfadeFrames;
+    }
+    MixerCommand mixerCommand;
+    while(_commandQueue.pop(mixerCommand)) {
+        mixerCommand.apply(_liveState);
+    }
+    const MixerState& mixerState = _liveState;
+
+    // Take over automation that has been loaded, started or stopped since the last period. The
+    // switch is read first, so a start always applies to the automation loaded before it.
+    bool automationSwitched = _automationSwitch.pickUp();
+    AutomationPlayer *automationPlayer = _loadedAutomationPlayer.loadAcquire();
+    if(automationPlayer != _automationPlayer) {
+        _automationPlayer = automationPlayer;
+        foreach(ChannelStrip *channelStrip, _channelStrips) {
+            channelStrip->setAutomationPlayer(automationPlayer);
+        }
+    }
+    if(automationSwitched) {
+        if(_automationSwitch.isOn()) {
+            _automationPlayer->start();
+        } else {
+            _automationPlayer->stop();
+        }
+    }
+
+    // Take over a recording that has been started or stopped since the last period
+    if(_recordingSwitch.pickUp()) {
+        _recording = _recordingSwitch.isOn();
+        for(int i = 0; i < _channelCount; i++) {
+            _channelStrips.at(i)->setRecordRing(_recording ? _multitrackRecorder.channelRing(i) : 0);
+        }
+    }
+
+    // Same for tracing. The worker threads only look at the tracer inside the cycle.
+    if(_tracingSwitch.pickUp()) {
+        _activeStageTracer = _tracingSwitch.isOn() ? &_stageTracer : 0;
+        foreach(ChannelStrip *channelStrip, _channelStrips) {
+            channelStrip->setStageTracer(_activeStageTracer);
+        }
+    }
+
+    // Same for a virtual soundcheck
+    if(_soundcheckSwitch.pickUp()) {
+        _soundcheck = _soundcheckSwitch.isOn();
+        for(int i = 0; i < _channelCount; i++) {
+            _channelStrips.at(i)->setPlaybackRing(_soundcheck ? _multitrackPlayer.channelRing(i) : 0);
+        }
+    }
+    CrossfadeStep crossfadeStep;
+    crossfadeStep.remainingFrames = _crossfadeFrames;
+    crossfadeStep.frames = qMin(_crossfadeFrames, frames);
+    _crossfadeFrames -= crossfadeStep.frames;
+
+    // Buses nothing is fed to in this period stay inactive and are never touched
+    bool busActive[MixerState::MaximumSubgroupCount + MixerState::MainCount];
+    for(int i = 0; i < _subgroupCount + MixerState::MainCount; i++) {
+        busActive[i] = false;
+    }
+    int mainBus = _subgroupCount;
+
+    StageTracer *stageTracer = _activeStageTracer;
+
+    // Process all channel strips, spread across the worker pool
+    _cycleMixerState = &mixerState;
+    _cycleFrames = frames;
+    _cycleCrossfadeStep = crossfadeStep;
+
+    // Dynamics run as long as any channel has them on, or has not settled back to unity gain
+    _dynamics.setSampleRate(mixerState.sampleRate);
+    _dynamicsActive = !_dynamics.isBypassed(0, _channelCount);
+    for(int i = 0; !_dynamicsActive && i < _channelCount; i++) {
+        const ChannelState& channelState = mixerState.channels.at(i);
+        _dynamicsActive = channelState.gateOn || channelState.compressorOn;
+    }
+
+    if(_equalizerEngine == MixerOptions::BiquadEqualizer || _dynamicsActive) {
+        // Dynamics and the biquad equalizer process all channels at once, so they run between the other stages
+        _workerPool.run(&MixerEngine::processChannelInputTask, this, _channelCount);
+        if(_dynamicsActive) {
+            int laneGroups = (_channelCount + DynamicsBank::LaneGroupSize - 1) / DynamicsBank::LaneGroupSize;
+            _workerPool.run(&MixerEngine::processDynamicsTask, this, laneGroups);
+        }
+        if(_equalizerEngine == MixerOptions::BiquadEqualizer) {
+            int laneGroups = (_channelCount + BiquadEqualizerBank::LaneGroupSize - 1)
+                    / BiquadEqualizerBank::LaneGroupSize;
+            _workerPool.run(&MixerEngine::processEqualizerTask, this, laneGroups);
+        }
+        _workerPool.run(&MixerEngine::processChannelOutputTask, this, _channelCount);
+    } else {
+        _workerPool.run(&MixerEngine::processChannelTask, this, _channelCount);
+    }
+
+    // Routing channels to subgroups and main. This is always done in ascending channel order,
+    // so the result is the same no matter how the strips have been processed. Each channel
+    // is read only once to feed all of its buses and to meter it. Idle channels are silent
+    // and skipped altogether.
+    RoutingTarget<BusSample> *targets = _routingTargets.data();
+    MeterRecord *meterRecords = _meterRecords.data();
+    int subgroupPairCount = _subgroupCount / 2;
+    int busCount = _subgroupCount + MixerState::MainCount;
+    for(int i = 0; i < _channelCount; i++) {
+        if(_channelStrips.at(i)->isIdle()) {
+            meterRecords[channelMeterIndex(i)].frames += frames;
+            continue;
+        }
+
+        StageScope stageScope(stageTracer, StageTracer::ChannelRouting, i);
+        const ChannelState& channelState = mixerState.channels.at(i);
+        const ChannelStrip *channelStrip = _channelStrips.at(i);
+
+        // If the channel is not muted, apply to subgroups and main.
+        float busGains[MixerState::MaximumSubgroupCount + MixerState::MainCount];
+        for(int bus = 0; bus < busCount; bus++) {
+            busGains[bus] = 0.0f;
+        }
+        if(mixerState.isChannelAudible(i)) {
+            // A strip tapping its direct out before the fader leaves the fader to the routing
+            float faderGain = channelStrip->foldsFader() ? channelState.faderGain : 1.0f;
+            float panorama = channelState.panorama;
+            quint64 subgroupPairs = channelState.subgroupPairs;
+            for(int pair = 0; subgroupPairs && pair < subgroupPairCount; pair++, subgroupPairs >>= 1) {
+                if(subgroupPairs & 1) {
+                    busGains[2 * pair]     = (1.0f - panorama) * faderGain;
+                    busGains[2 * pair + 1] =         panorama  * faderGain;
+                }
+            }
+
+            if(channelState.onMain) {
+                busGains[mainBus]     = (1.0f - panorama) * faderGain;
+                busGains[mainBus + 1] =         panorama  * faderGain;
+            }
+        }
+
+        // Feed all buses the channel is or has been audible on during the crossfade
+        float *routingGains = _routingGains.data() + i * busCount;
+        int targetCount = 0;
+        for(int bus = 0; bus < busCount; bus++) {
+            float nextGain = crossfadeStep.advance(routingGains[bus], busGains[bus]);
+            float gain = crossfadeStep.frames > 0 ? routingGains[bus] : nextGain;
+            routingGains[bus] = nextGain;
+            if(gain != 0.0f || nextGain != 0.0f) {
+                RoutingTarget<BusSample> target = {
+                    activateBus(bus, busActive, frames), gain,
+                    crossfadeStep.frames > 0 ? (nextGain - gain) / crossfadeStep.frames : 0.0f
+                };
+                targets[targetCount++] = target;
+            }
+        }
+
+        route(_routingKernel, channelStrip->busBuffer(), targets, targetCount, frames, crossfadeStep.frames,
+              &meterRecords[channelMeterIndex(i)]);
+    }
+
+    // Route subgroups through faders, then to main. Odd subgroups go left, even subgroups go right.
+    // Inactive subgroups are silent and only need their outputs cleared. Buses are converted
+    // to float only for the outputs.
+    float *outputBuffer = _scratchArena.buffer(_channelCount);
+    for(int i = 0; i < _subgroupCount; i++) {
+        if(!busActive[i]) {
+            meterRecords[subgroupMeterIndex(i)].frames += frames;
+            _mixerPorts->clearSubgroupOutput(i, frames);
+            if(_recording) {
+                _multitrackRecorder.subgroupRing(i)->write(0, frames);
+            }
+            continue;
+        }
+
+        StageScope stageScope(stageTracer, StageTracer::SubgroupBus, i);
+        BusSample *subgroupBuffer = _scratchArena.busBuffer(i);
+        if(!_automationPlayer->applyGain(_automationPlayer->lane(AutomationEvent::SubgroupGain, i),
+                                        subgroupBuffer, frames, _subgroupGains[i])) {
+            crossfadeStep.applyGain(subgroupBuffer, frames, _subgroupGains[i], mixerState.subgroups.at(i).gain);
+        }
+
+        int targetCount = 0;
+        float mainGain = _subgroupMainGains.at(i);
+        float nextMainGain = crossfadeStep.advance(mainGain, mixerState.isSubgroupOnMain(i) ? 1.0f : 0.0f);
+        if(crossfadeStep.frames == 0) {
+            mainGain = nextMainGain;
+        }
+        _subgroupMainGains[i] = nextMainGain;
+        RoutingTarget<BusSample> mainTarget = {
+            0, mainGain, crossfadeStep.frames > 0 ? (nextMainGain - mainGain) / crossfadeStep.frames : 0.0f
+        };
+        if(mainGain != 0.0f || nextMainGain != 0.0f) {
+            mainTarget.buffer = activateBus(mainBus + i % 2, busActive, frames);
+            targetCount = 1;
+        }
+        route(_busRoutingKernel, subgroupBuffer, &mainTarget, targetCount, frames, crossfadeStep.frames,
+              &meterRecords[subgroupMeterIndex(i)]);
+        const float *subgroupOutput = floatSamples(subgroupBuffer, outputBuffer, frames);
+        _mixerPorts->writeSubgroupOutput(i, subgroupOutput, frames);
+        if(_recording) {
+            _multitrackRecorder.subgroupRing(i)->write(subgroupOutput, frames);
+        }
+    }
+
+    // Check if main is muted, and clear signal if necessary. Muting fades out during a crossfade.
+    for(int i = 0; i < MixerState::MainCount; i++) {
+        float mainGain = mixerState.mainMuted[i] ? 0.0f : mixerState.mainGains[i];
+        bool muted = mixerState.mainMuted[i] && (_mainGains[i] == 0.0f || crossfadeStep.frames == 0);
+        if(!busActive[mainBus + i] || muted) {
+            _mainGains[i] = crossfadeStep.advance(_mainGains[i], mainGain);
+            meterRecords[mainMeterIndex(i)].frames += frames;
+            _mixerPorts->clearMainOutput(i, frames);
+            if(_recording) {
+                _multitrackRecorder.mainRing(i)->write(0, frames);
+            }
+            continue;
+        }
+
+        StageScope stageScope(stageTracer, StageTracer::MainBus, i);
+        BusSample *mainBuffer = _scratchArena.busBuffer(mainBus + i);
+        if(mixerState.mainMuted[i]
+                || !_automationPlayer->applyGain(_automationPlayer->lane(AutomationEvent::MainGain, i),
+                                                mainBuffer, frames, _mainGains[i])) {
+            crossfadeStep.applyGain(mainBuffer, frames, _mainGains[i], mainGain);
+        }
+        _busRoutingKernel(mainBuffer, 0, 0, frames, &meterRecords[mainMeterIndex(i)]);
+        const float *mainOutput = floatSamples(mainBuffer, outputBuffer, frames);
+        _mixerPorts->writeMainOutput(i, mainOutput, frames);
+        if(_recording) {
+            _multitrackRecorder.mainRing(i)->write(mainOutput, frames);
+        }
+    }
+
+    // Publish the levels. If a reader lags behind, keep accumulating, so no peak gets lost.
+    bool remoteMeteringEnabled = _remoteMeteringEnabled.loadAcquire();
+    if(!_meterRing.isFull() && !(remoteMeteringEnabled && _remoteMeterRing.isFull())) {
+        _meterRing.write(meterRecords);
+        if(remoteMeteringEnabled) {
+            _remoteMeterRing.write(meterRecords);
+        }
+        for(int i = 0; i < _meterRecords.size(); i++) {
+            meterRecords[i].clear();
+        }
+    }
+
+    _automationPlayer->advance(frames);
+    if(stageTracer) {
+        stageTracer->record(StageTracer::Cycle, -1, cycleBegin);
+    }
+    monitorCycle(cycleBegin, frames, true);
+    _scratchArena.endCycle();
+}
+
+BusSample *MixerEngine::activateBus(int i, bool *busActive, int frames)
+{
+    BusSample *buffer = _scratchArena.busBuffer(i);
+    if(!busActive[i]) {
+        clearSamples(buffer, frames);
+        busActive[i] = true;
+    }
+    return buffer;
+}
+
+void MixerEngine::monitorCycle(quint64 cycleBegin, int frames, bool processed)
+{
+    if(!_cycleMonitor.record(cycleBegin, StageTracer::timestamp(), frames, _frameTime.loadAcquire())) {
+        return;
+    }
+
+    // While the engine is being reconfigured, only what belongs to the realtime thread may be looked at
+    CycleConfiguration configuration;
+    configuration.channelCount = _channelCount;
+    configuration.activeChannelCount = -1;
+    configuration.subgroupCount = _subgroupCount;
+    configuration.equalizerEngine = MixerOptions::BiquadEqualizer;
+    configuration.dynamics = false;
+    configuration.workerThreadCount = 0;
+    configuration.recording = false;
+    configuration.soundcheck = false;
+    configuration.tracing = false;
+    configuration.automationPlaying = false;
+    configuration.crossfadeFrames = _crossfadeFrames;
+    if(processed) {
+        configuration.activeChannelCount = 0;
+        configuration.equalizerEngine = _equalizerEngine;
+        configuration.dynamics = _dynamicsActive;
+        configuration.workerThreadCount = _workerPool.threadCount();
+        configuration.recording = _recording;
+        configuration.soundcheck = _soundcheck;
+        configuration.tracing = _activeStageTracer != 0;
+        configuration.automationPlaying = _automationPlayer->isPlaying();
+        int channelCount = qMin(_channelCount, (int)MixerOptions::MaximumChannelCount);
+        for(int i = 0; i < channelCount; i++) {
+            const ChannelStrip *channelStrip = _channelStrips.at(i);
+            if(channelStrip->isIdle()) {
+                configuration.channelConfigurations[i] = -1;
+            } else {
+                configuration.channelConfigurations[i] = channelStrip->configuration();
+                configuration.activeChannelCount++;
+            }
+        }
+    }
+    _cycleMonitor.captureXrun(configuration);
+}
+
+template <typename Source>
+void MixerEngine::route(typename RoutingKernel<Source, BusSample>::Function routingKernel, const Source *source,
+                        RoutingTarget<BusSample> *targets, int targetCount, int frames, int rampFrames,
+                        MeterRecord *meterRecord)
+{
+    if(rampFrames <= 0 || rampFrames >= frames) {
+        routingKernel(source, targets, targetCount, frames, meterRecord);
+        return;
+    }
+
+    // The crossfade ends within this period, route the rest with constant gains
+    routingKernel(source, targets, targetCount, rampFrames, meterRecord);
+    for(int t = 0; t < targetCount; t++) {
+        targets[t].buffer += rampFrames;
+        targets[t].gain += targets[t].gainStep * rampFrames;
+        targets[t].gainStep = 0.0f;
+    }
+    routingKernel(source + rampFrames, targets, targetCount, frames - rampFrames, meterRecord);
+}
+
+void MixerEngine::processChannelTask(void *context, int index)
+{
+    MixerEngine *mixerEngine = static_cast<MixerEngine*>(context);
+    mixerEngine->_channelStrips.at(index)->process(
+        mixerEngine->_scratchArena.buffer(index),
+        mixerEngine->_cycleFrames,
+        mixerEngine->_cycleMixerState->channels.at(index),
+        mixerEngine->_cycleCrossfadeStep);
+}
+
+void MixerEngine::processChannelInputTask(void *context, int index)
+{
+    MixerEngine *mixerEngine = static_cast<MixerEngine*>(context);
+    mixerEngine->_channelStrips.at(index)->processInput(
+        mixerEngine->_scratchArena.buffer(index),
+        mixerEngine->_cycleFrames,
+        mixerEngine->_cycleMixerState->channels.at(index),
+        mixerEngine->_cycleCrossfadeStep);
+}
+
+void MixerEngine::processDynamicsTask(void *context, int index)
+{
+    MixerEngine *mixerEngine = static_cast<MixerEngine*>(context);
+    DynamicsBank& dynamics = mixerEngine->_dynamics;
+    const MixerState *mixerState = mixerEngine->_cycleMixerState;
+
+    int firstLane = index * DynamicsBank::LaneGroupSize;
+    int laneCount = qMin((int)DynamicsBank::LaneGroupSize, dynamics.laneCount() - firstLane);
+
+    // Take over the parameters of this cycle for all lanes of this group
+    bool groupIdle = true;
+    for(int lane = firstLane; lane < firstLane + laneCount; lane++) {
+        const ChannelState& channelState = mixerState->channels.at(lane);
+        dynamics.setGate(lane, channelState.gateOn, channelState.gateThreshold);
+        dynamics.setCompressor(lane, channelState.compressorOn, channelState.compressorThreshold,
+                               channelState.compressorRatio);
+        groupIdle = groupIdle && mixerEngine->_channelStrips.at(lane)->isIdle();
+    }
+
+    // Skip groups of idle channels. Their envelopes are cleared, so a channel waking up starts
+    // with the gate open, instead of cutting off the first transient.
+    if(groupIdle) {
+        dynamics.reset(firstLane, laneCount);
+        return;
+    }
+    if(dynamics.isBypassed(firstLane, laneCount)) {
+        return;
+    }
+
+    StageScope stageScope(mixerEngine->_activeStageTracer, StageTracer::Dynamics, index);
+    for(int lane = firstLane; lane < firstLane + laneCount; lane++) {
+        mixerEngine->_laneBuffers[lane] = mixerEngine->_channelStrips.at(lane)->buffer();
+    }
+    dynamics.process(mixerEngine->_laneBuffers.constData(), mixerEngine->_cycleFrames, firstLane, laneCount);
+}
+
+void MixerEngine::processEqualizerTask(void *context, int index)
+{
+    MixerEngine *mixerEngine = static_cast<MixerEngine*>(context);
+    BiquadEqualizerBank& equalizer = mixerEngine->_biquadEqualizer;
+    const MixerState *mixerState = mixerEngine->_cycleMixerState;
+
+    int firstLane = index * BiquadEqualizerBank::LaneGroupSize;
+    int laneCount = qMin((int)BiquadEqualizerBank::LaneGroupSize, equalizer.laneCount() - firstLane);
+
+    // Skip groups of idle channels. Their tails have decayed already, so the filter states
+    // are just cleared for the next time a channel wakes up.
+    bool groupIdle = true;
+    for(int lane = firstLane; groupIdle && lane < firstLane + laneCount; lane++) {
+        groupIdle = mixerEngine->_channelStrips.at(lane)->isIdle();
+    }
+    if(groupIdle) {
+        equalizer.reset(firstLane, laneCount);
+        return;
+    }
+
+    // Take over the parameters and the buffers of this cycle for all lanes of this group
+    StageScope stageScope(mixerEngine->_activeStageTracer, StageTracer::BiquadEqualizer, index);
+    for(int lane = firstLane; lane < firstLane + laneCount; lane++) {
+        const ChannelState& channelState = mixerState->channels.at(lane);
+        mixerEngine->_laneBuffers[lane] = mixerEngine->_channelStrips.at(lane)->buffer();
+        for(int band = 0; band < BiquadEqualizerBank::BandCount; band++) {
+            equalizer.setCoefficients(lane, band, channelState.equalizerBands[band]);
+        }
+        equalizer.setEnabled(lane, channelState.equalizerOn);
+    }
+
+    equalizer.process(mixerEngine->_laneBuffers.constData(), mixerEngine->_cycleFrames, firstLane, laneCount);
+}
+
+void MixerEngine::processChannelOutputTask(void *context, int index)
+{
+    MixerEngine *mixerEngine = static_cast<MixerEngine*>(context);
+    ChannelStrip *channelStrip = mixerEngine->_channelStrips.at(index);
+    const ChannelState& channelState = mixerEngine->_cycleMixerState->channels.at(index);
+
+    // With the FFT equalizer, the strip is only split up for the dynamics
+    if(channelState.equalizerOn && !channelStrip->isIdle()) {
+        channelStrip->processEqualizer(channelStrip->buffer(), mixerEngine->_cycleFrames, channelState);
+    }
+    channelStrip->processOutput(mixerEngine->_cycleFrames, channelState, mixerEngine->_cycleCrossfadeStep);
+}
+
+void MixerEngine::resizeBuffers(int frames)
+{
+    _scratchArena.suspend();
+    _scratchArena.resize(frames);
+    foreach(ChannelStrip *channelStrip, _channelStrips) {
+        channelStrip->resizeBuffers(frames);
+    }
+    _scratchArena.resume();
+}
+
+int MixerEngine::frames() const
+{
+    return _scratchArena.frames();
+}
+
+int MixerEngine::channelCount() const
+{
+    return _channelCount;
+}
+
+int MixerEngine::subgroupCount() const
+{
+    return _subgroupCount;
+}
+
+void MixerEngine::startWorkerPool(const WorkerPool::Configuration& configuration)
+{
+    _scratchArena.suspend();
+    _workerPool.start(configuration);
+    _scratchArena.resume();
+}
+
+int MixerEngine::workerThreadCount() const
+{
+    return _workerPool.threadCount();
+}
+
+void MixerEngine::setInsertEffect(int channel, InsertEffect *insertEffect)
+{
+    _scratchArena.suspend();
+    if(insertEffect) {
+        insertEffect->resizeBuffers(_scratchArena.frames());
+    }
+    _channelStrips.at(channel)->setInsertEffect(insertEffect);
+    _scratchArena.resume();
+}
+
+void MixerEngine::setSilenceDetection(double thresholdDb, int holdPeriods)
+{
+    _scratchArena.suspend();
+    foreach(ChannelStrip *channelStrip, _channelStrips) {
+        channelStrip->setSilenceDetection(QUnits::dbToLinear(thresholdDb), holdPeriods);
+    }
+    _scratchArena.resume();
+}
+
+void MixerEngine::setDirectOutTap(MixerOptions::DirectOutTap directOutTap)
+{
+    _scratchArena.suspend();
+    foreach(ChannelStrip *channelStrip, _channelStrips) {
+        channelStrip->setDirectOutTap(directOutTap);
+    }
+    _scratchArena.resume();
+}
+
+void MixerEngine::setEqualizerEngine(MixerOptions::EqualizerEngine equalizerEngine)
+{
+    _scratchArena.suspend();
+    _equalizerEngine = equalizerEngine;
+    _biquadEqualizer.reset();
+    _dynamics.reset();
+    foreach(ChannelStrip *channelStrip, _channelStrips) {
+        channelStrip->setFFTEqualizerEnabled(equalizerEngine == MixerOptions::FFTEqualizer, _scratchArena.frames());
+    }
+    _scratchArena.resume();
+}
+
+void MixerEngine::setAutomation(const QVector<AutomationEvent>& events)
+{
+    // Once the running period has finished, the realtime thread only takes the loaded player,
+    // so the other one is free to be loaded
+    AutomationPlayer *loadedAutomationPlayer = _loadedAutomationPlayer.loadAcquire();
+    AutomationPlayer *automationPlayer = loadedAutomationPlayer == &_firstAutomationPlayer
+            ? &_secondAutomationPlayer : &_firstAutomationPlayer;
+    _automationSwitch.switchOff();
+    automationPlayer->setEvents(events);
+    _loadedAutomationPlayer.fetchAndStoreOrdered(automationPlayer);
+    _scratchArena.waitForCycle();
+}
+
+void MixerEngine::startAutomation()
+{
+    _automationSwitch.switchOn();
+}
+
+void MixerEngine::stopAutomation()
+{
+    _automationSwitch.switchOff();
+}
+
+bool MixerEngine::startRecording(const QString& directory, int sampleRate, WavWriter::Format format)
+{
+    stopRecording();
+    if(!_multitrackRecorder.start(directory, sampleRate, format)) {
+        return false;
+    }
+
+    _recordingSwitch.switchOn();
+    return true;
+}
+
+void MixerEngine::stopRecording()
+{
+    if(!_recordingSwitch.isRequested()) {
+        return;
+    }
+
+    // The realtime thread lets go of the rings at the next period, so once the running one
+    // has finished, the recorder may write out the rest and delete them
+    _recordingSwitch.switchOff();
+    _scratchArena.waitForCycle();
+    _multitrackRecorder.stop();
+}
+
+const MultitrackRecorder& MixerEngine::multitrackRecorder() const
+{
+    return _multitrackRecorder;
+}
+
+bool MixerEngine::startPlayback(const QString& directory, int sampleRate, const QList<int>& channels)
+{
+    stopPlayback();
+    if(!_multitrackPlayer.start(directory, sampleRate, channels)) {
+        return false;
+    }
+
+    _soundcheckSwitch.switchOn();
+    return true;
+}
+
+void MixerEngine::stopPlayback()
+{
+    if(!_soundcheckSwitch.isRequested()) {
+        return;
+    }
+
+    // The realtime thread lets go of the rings at the next period, so once the running one
+    // has finished, the player may delete them
+    _soundcheckSwitch.switchOff();
+    _scratchArena.waitForCycle();
+    _multitrackPlayer.stop();
+}
+
+const MultitrackPlayer& MixerEngine::multitrackPlayer() const
+{
+    return _multitrackPlayer;
+}
+
+bool MixerEngine::startTracing(const QString& fileName)
+{
+    stopTracing();
+    if(!_stageTracer.start(fileName)) {
+        return false;
+    }
+
+    _tracingSwitch.switchOn();
+    return true;
+}
+
+void MixerEngine::stopTracing()
+{
+    if(!_tracingSwitch.isRequested()) {
+        return;
+    }
+
+    // No thread may record anymore when the tracer writes out the rest. Threads only
+    // record within a cycle, and the next one runs without the tracer.
+    _tracingSwitch.switchOff();
+    _scratchArena.waitForCycle();
+    _stageTracer.stop();
+}
+
+const StageTracer& MixerEngine::stageTracer() const
+{
+    return _stageTracer;
+}
+
+CycleMonitor& MixerEngine::cycleMonitor()
+{
+    return _cycleMonitor;
+}
+
+qint64 MixerEngine::frameTime() const
+{
+    return _frameTime.loadAcquire();
+}
+
+MeterRing& MixerEngine::meterRing()
+{
+    return _meterRing;
+}
+
+void MixerEngine::setRemoteMeteringEnabled(bool enabled)
+{
+    // The remote reader runs on a thread of its own, so this must not suspend the arena
+    // while the user interface may be reconfiguring it
+    _remoteMeteringEnabled.storeRelease(enabled ? 1 : 0);
+}
+
+MeterRing& MixerEngine::remoteMeterRing()
+{
+    return _remoteMeterRing;
+}
+
+int MixerEngine::channelMeterIndex(int i) const
+{
+    return i;
+}
+
+int MixerEngine::subgroupMeterIndex(int i) const
+{
+    return _channelCount + i;
+}
+
+int MixerEngine::mainMeterIndex(int i) const
+{
+    return _channelCount + _subgroupCount + i;
+}
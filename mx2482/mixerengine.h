@@ -0,0 +1,423 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MIXERENGINE_H
+#define MIXERENGINE_H
+
+// Qt includes
+#include <QVector>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+
+// Own includes
+#include "mixerstate.h"
+#include "mixerports.h"
+#include "mixeroptions.h"
+#include "triplebuffer.h"
+#include "scratcharena.h"
+#include "workerpool.h"
+#include "routingkernel.h"
+#include "meterring.h"
+#include "biquadequalizer.h"
+#include "dynamicsbank.h"
+#include "channelstrip.h"
+#include "automationplayer.h"
+#include "mixercommand.h"
+#include "waitfreequeue.h"
+#include "realtimeswitch.h"
+#include "multitrackrecorder.h"
+#include "multitrackplayer.h"
+#include "stagetracer.h"
+#include "cyclemonitor.h"
+
+/**
+ * The audio processing of the whole mixer: all channel strips, subgroups
+ * and main. The engine holds no widgets and does not depend on a JACK
+ * server, all audio goes through the given mixer ports. Parameters are
+ * handed over as mixer state snapshots.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class MixerEngine
+{
+public:
+    /**
+     * Constructor.
+     * @param mixerPorts Ports to read from and write to, not owned. They
+     * must provide at least the given number of channels and subgroups.
+     * @param channelCount Number of channels.
+     * @param subgroupCount Number of subgroups, must be even.
+     */
+    MixerEngine(MixerPorts *mixerPorts, int channelCount, int subgroupCount);
+    /** Destructor */
+    ~MixerEngine();
+
+    /**
+     * Hands over a new parameter snapshot to the processing. Must always be
+     * called from the same thread. Snapshots with a different topology are
+     * adjusted to the one of the engine. The snapshot takes effect at the
+     * next period boundary. Gains, panorama, routing, mute and solo then
+     * crossfade over MixerState::crossfadeFrames, the other parameters
+     * switch over immediately. Only parameters that differ from the
+     * previous snapshot are taken over, so changes made with
+     * pushCommand() in the meantime are kept.
+     */
+    void publishState(const MixerState& mixerState);
+
+    /**
+     * Hands over the change of a single parameter to the processing. It
+     * takes effect at the next period boundary. Must always be called from
+     * the same thread, which may differ from the one publishing snapshots.
+     * @returns false, if too many commands are pending. The command has
+     * been dropped then.
+     */
+    bool pushCommand(const MixerCommand& mixerCommand);
+
+    /**
+     * Processes one period. This is called from the realtime thread and
+     * only reads the most recently published mixer state.
+     */
+    void process(int frames);
+
+    /**
+     * Reallocates all processing buffers for a new buffer size. This waits
+     * for a running cycle to finish and must not be called from the
+     * realtime thread.
+     */
+    void resizeBuffers(int frames);
+
+    /** @returns the number of frames the buffers are sized for. */
+    int frames() const;
+
+    /** @returns the number of channels. */
+    int channelCount() const;
+    /** @returns the number of subgroups. */
+    int subgroupCount() const;
+
+    /**
+     * (Re)starts the worker threads the channel strips are processed on.
+     * Waits for a running cycle to finish.
+     */
+    void startWorkerPool(const WorkerPool::Configuration& configuration);
+
+    /** @returns the number of worker threads, 0 if the channel strips are processed serially. */
+    int workerThreadCount() const;
+
+    /** Selects the equalizer implementation. Waits for a running cycle to finish. */
+    void setEqualizerEngine(MixerOptions::EqualizerEngine equalizerEngine);
+
+    /**
+     * Puts an effect into the insert slot of a channel, see
+     * ChannelStrip::setInsertEffect(). Waits for a running cycle to finish.
+     * @param channel Channel, starting at 0.
+     * @param insertEffect Effect to be owned by the engine, 0 to empty the slot.
+     */
+    void setInsertEffect(int channel, InsertEffect *insertEffect);
+
+    /**
+     * Configures when channel strips go idle, see
+     * ChannelStrip::setSilenceDetection(). Idle channels and the buses
+     * nothing is fed to are skipped. Waits for a running cycle to finish.
+     * @param thresholdDb Level at or below which an input is silent, in dB.
+     * @param holdPeriods Silent periods before a strip goes idle, 0 to never skip.
+     */
+    void setSilenceDetection(double thresholdDb, int holdPeriods);
+
+    /**
+     * Selects where the direct outs of all channels are tapped, see
+     * ChannelStrip::setDirectOutTap(). Waits for a running cycle to finish.
+     */
+    void setDirectOutTap(MixerOptions::DirectOutTap directOutTap);
+
+    /**
+     * Loads automation to be played back, see AutomationPlayer. Stops a
+     * running playback. The automation is loaded into a spare player that
+     * the realtime thread takes over at the next period. Waits for a
+     * running cycle to finish, so the player it replaces can be reused,
+     * without skipping one.
+     */
+    void setAutomation(const QVector<AutomationEvent>& events);
+    /** Starts playing back the automation from its first frame at the next period. */
+    void startAutomation();
+    /** Stops playing back the automation at the next period. */
+    void stopAutomation();
+
+    /**
+     * Starts recording all channel inputs, subgroups and main left and
+     * right into a file each, see MultitrackRecorder. Stops a running
+     * recording first. The realtime thread starts feeding the recorder at
+     * the next period, no period is skipped.
+     * @returns false, if the files could not be created. The recorder tells why.
+     */
+    bool startRecording(const QString& directory, int sampleRate, WavWriter::Format format);
+    /**
+     * Stops recording and finishes the files. Waits for a running cycle to
+     * finish before the recorder is released, without skipping one.
+     */
+    void stopRecording();
+    /** @returns the recorder, to check on a recording. */
+    const MultitrackRecorder& multitrackRecorder() const;
+
+    /**
+     * Starts a virtual soundcheck: the channels play back their inputs
+     * from a multitrack recording instead of their ports, see
+     * MultitrackPlayer. Stops a running playback first. The realtime
+     * thread switches over at the next period, no period is skipped.
+     * @param channels Channels to play back, starting at 0. Empty for all
+     * that have a track in directory.
+     * @returns false, if no track could be opened. The player tells why.
+     */
+    bool startPlayback(const QString& directory, int sampleRate, const QList<int>& channels);
+    /**
+     * Switches all channels back to their ports. Waits for a running cycle
+     * to finish before the player is released, without skipping one.
+     */
+    void stopPlayback();
+    /** @returns the player, to check on a virtual soundcheck. */
+    const MultitrackPlayer& multitrackPlayer() const;
+
+    /**
+     * Starts tracing the processing stages of all threads into a Chrome
+     * trace file, see StageTracer. Stops a running trace first. Tracing
+     * begins with the next period, no period is skipped.
+     * @returns false, if the file could not be created. The tracer tells why.
+     */
+    bool startTracing(const QString& fileName);
+    /**
+     * Stops tracing and finishes the file. Waits for a running cycle to
+     * finish before the tracer writes out the rest, without skipping one.
+     */
+    void stopTracing();
+    /** @returns the tracer, to check on the time spent in each channel. */
+    const StageTracer& stageTracer() const;
+
+    /**
+     * @returns the monitor of the period durations. Its xrun snapshots
+     * must be taken from one thread only.
+     */
+    CycleMonitor& cycleMonitor();
+
+    /**
+     * @returns the number of frames processed since the engine has been
+     * created, to timestamp recorded automation with.
+     */
+    qint64 frameTime() const;
+
+    /**
+     * @returns the ring the levels of all strips are published over. It
+     * must be read from one thread only. Each slot holds the channels,
+     * followed by the subgroups and main left and right, see the meter
+     * index methods.
+     */
+    MeterRing& meterRing();
+
+    /**
+     * Enables a second meter ring with the same layout, for a reader on
+     * another thread than the one of meterRing(). Both rings are written in
+     * the same periods, so each of them must be read continuously while
+     * enabled. Takes effect at the next period and may be called from any
+     * thread.
+     */
+    void setRemoteMeteringEnabled(bool enabled);
+    /** @returns the second meter ring, see setRemoteMeteringEnabled(). */
+    MeterRing& remoteMeterRing();
+
+    /** @returns the meter record index of channel i (starting at 0). */
+    int channelMeterIndex(int i) const;
+    /** @returns the meter record index of subgroup i (starting at 0). */
+    int subgroupMeterIndex(int i) const;
+    /** @returns the meter record index of main i (0 is left, 1 is right). */
+    int mainMeterIndex(int i) const;
+
+private:
+    enum {
+        /**
+         * Slots of the meter ring. Enough to bridge a few missed updates of
+         * the user interface even at the shortest periods.
+         */
+        MeterSlotCount = 64,
+        /** Commands that may be pending at once. */
+        CommandQueueCapacity = 1024
+    };
+
+    /** Worker pool task that processes the channel strip with the given index. */
+    static void processChannelTask(void *context, int index);
+    /** Worker pool task that processes the stages before the equalizer of a channel strip. */
+    static void processChannelInputTask(void *context, int index);
+    /** Worker pool task that processes a group of lanes of the gate and compressor. */
+    static void processDynamicsTask(void *context, int index);
+    /** Worker pool task that processes a group of lanes of the biquad equalizer. */
+    static void processEqualizerTask(void *context, int index);
+    /** Worker pool task that processes the FFT equalizer, if on, and the stages after the equalizer of a channel strip. */
+    static void processChannelOutputTask(void *context, int index);
+
+    /**
+     * @returns the buffer of bus i: subgroups first, then main left and
+     * right. The bus is cleared when it is fed for the first time in a
+     * period, which is tracked in busActive.
+     */
+    BusSample *activateBus(int i, bool *busActive, int frames);
+
+    /**
+     * Hands the duration of a period to the cycle monitor, along with a
+     * snapshot of the configuration if it has been too late.
+     * @param processed false, if the period has been skipped, because the
+     * engine is being reconfigured. The channel strips must not be looked
+     * at then.
+     */
+    void monitorCycle(quint64 cycleBegin, int frames, bool processed);
+
+    /**
+     * Routes source with a routing kernel. If the gains of the targets
+     * ramp for fewer than frames, the rest is routed with the gains they
+     * have arrived at.
+     */
+    template <typename Source>
+    void route(typename RoutingKernel<Source, BusSample>::Function routingKernel, const Source *source,
+               RoutingTarget<BusSample> *targets, int targetCount, int frames, int rampFrames,
+               MeterRecord *meterRecord);
+
+    MixerPorts *_mixerPorts;
+    int _channelCount;
+    int _subgroupCount;
+
+    /** Hands over mixer state snapshots to the realtime thread. */
+    TripleBuffer<MixerState> _mixerState;
+    /** Number of published snapshots, to tell them apart on the realtime thread. */
+    quint32 _publishCount;
+    /** Serial of the snapshot the realtime thread has last started a crossfade for. */
+    quint32 _crossfadeSerial;
+    /** Frames left in the running crossfade. */
+    int _crossfadeFrames;
+    /** Hands over commands to the realtime thread. */
+    WaitFreeQueue<MixerCommand> _commandQueue;
+    /**
+     * Parameters the realtime thread processes with: the published
+     * snapshots merged with the commands. Never shared, so it can be
+     * modified without allocating.
+     */
+    MixerState _liveState;
+    /** Copy of the snapshot last merged into the live state. */
+    MixerState _mergedState;
+
+    /**
+     * Scratch buffers for the processing, all in one contiguous, cache
+     * aligned block: one for each channel and one to convert bus samples
+     * for the outputs, followed by the bus buffers, one for each subgroup
+     * and finally main left and right. Buses are only valid in a period in
+     * which they are active.
+     */
+    ScratchArena _scratchArena;
+
+    /** Worker threads the channel strips are processed on. */
+    WorkerPool _workerPool;
+
+    /** Channel strips, index i holds channel i + 1. */
+    QVector<ChannelStrip*> _channelStrips;
+
+    /** Equalizer implementation in use. */
+    MixerOptions::EqualizerEngine _equalizerEngine;
+    /** Biquad equalizer for all channels, lane i is channel i + 1. */
+    BiquadEqualizerBank _biquadEqualizer;
+    /** Gate and compressor for all channels, lane i is channel i + 1. */
+    DynamicsBank _dynamics;
+    /** Whether the gate or compressor runs in the current cycle. */
+    bool _dynamicsActive;
+    /** Working buffer of each channel for the banks, taken over from the strip in each cycle. */
+    QVector<float*> _laneBuffers;
+
+    /** Mixer state of the current cycle, for the worker pool tasks. */
+    const MixerState *_cycleMixerState;
+    /** Number of frames in the current cycle, for the worker pool tasks. */
+    int _cycleFrames;
+    /** Crossfade progress in the current cycle, for the worker pool tasks. */
+    CrossfadeStep _cycleCrossfadeStep;
+
+    /** Fused routing and peak detection kernel for this CPU, from channels to buses. */
+    RoutingKernel<float, BusSample>::Function _routingKernel;
+    /** Same as _routingKernel, from buses to buses. */
+    RoutingKernel<BusSample, BusSample>::Function _busRoutingKernel;
+    /** Preallocated routing targets of one channel: all subgroups and main. */
+    QVector<RoutingTarget<BusSample> > _routingTargets;
+
+    /**
+     * Gains applied at the end of the last period, which follow the mixer
+     * state in steps during crossfades. For each channel, the gains on all
+     * subgroups and main, including panorama, mute and solo.
+     */
+    QVector<float> _routingGains;
+    /** Applied gain of each subgroup. */
+    QVector<float> _subgroupGains;
+    /** Applied gain of each subgroup on main, 0 or 1 outside of crossfades. */
+    QVector<float> _subgroupMainGains;
+    /** Applied gain of main left and right, including mute. */
+    float _mainGains[MixerState::MainCount];
+
+    /**
+     * Levels accumulated by the realtime thread since they have last been
+     * published, in the same order as in the meter ring.
+     */
+    QVector<MeterRecord> _meterRecords;
+    /** Publishes the levels to the user interface. */
+    MeterRing _meterRing;
+    /** Publishes the levels to a remote reader, if enabled. */
+    MeterRing _remoteMeterRing;
+    /** Whether the remote meter ring is written, toggled from the thread of the remote reader. */
+    QAtomicInt _remoteMeteringEnabled;
+
+    /** Players of the automation, one can be loaded while the other is played back. */
+    AutomationPlayer _firstAutomationPlayer;
+    AutomationPlayer _secondAutomationPlayer;
+    /** Player with the most recently loaded automation, handed to the realtime thread. */
+    QAtomicPointer<AutomationPlayer> _loadedAutomationPlayer;
+    /** Starts and stops playing back the automation on the realtime thread. */
+    RealtimeSwitch _automationSwitch;
+    /** Plays back automation in the gain stages of the current cycle. */
+    AutomationPlayer *_automationPlayer;
+    /** Records the inputs and outputs. The channel strips feed their inputs themselves. */
+    MultitrackRecorder _multitrackRecorder;
+    /** Switches the realtime thread to feeding the recorder and back. */
+    RealtimeSwitch _recordingSwitch;
+    /** Whether the realtime thread feeds the recorder in the current cycle. */
+    bool _recording;
+    /** Plays back the channel inputs. The channel strips read from it themselves. */
+    MultitrackPlayer _multitrackPlayer;
+    /** Switches the channel strips to playing back from the player and back. */
+    RealtimeSwitch _soundcheckSwitch;
+    /** Whether the channel strips play back from the player in the current cycle. */
+    bool _soundcheck;
+    /** Traces the processing stages. */
+    StageTracer _stageTracer;
+    /** Switches tracing on the realtime thread and the worker threads on and off. */
+    RealtimeSwitch _tracingSwitch;
+    /**
+     * The tracer while tracing in the current cycle, otherwise null. Handed
+     * to the channel strips as well.
+     */
+    StageTracer *_activeStageTracer;
+    /** Measures the duration of each period and catches xruns. */
+    CycleMonitor _cycleMonitor;
+    /** Number of frames processed so far. */
+    QAtomicInteger<qint64> _frameTime;
+};
+
+#endif // MIXERENGINE_H
@@ -0,0 +1,274 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "mixeroptions.h"
+
+// Qt includes
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+MixerOptions::MixerOptions() :
+    channelCount(MixerState::DefaultChannelCount),
+    subgroupCount(MixerState::DefaultSubgroupCount),
+    equalizerEngine(FFTEqualizer),
+    directOutTap(PostFaderTap),
+    silenceThreshold(-120.0),
+    silenceHoldPeriods(16),
+    crossfadeTime(0.0),
+    oscAddress("0.0.0.0"),
+    oscPort(0),
+    recordDirectory("."),
+    recordFormat(WavWriter::Wave64),
+    headless(false),
+    attach(false),
+    segmentName("mx2482"),
+    renderOutputDirectory("."),
+    renderBlockSize(1024),
+    renderSampleRate(48000),
+    renderVerifyWorkers(false)
+{
+}
+
+MixerOptions MixerOptions::fromArguments(const QStringList& arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MX2482 - 24 channel JACK mixer");
+    parser.addHelpOption();
+
+    QCommandLineOption channelsOption("channels",
+        "Number of <channels> of the mixer.",
+        "channels", QString::number(MixerState::DefaultChannelCount));
+    QCommandLineOption subgroupsOption("subgroups",
+        "Number of <subgroups> of the mixer, rounded up to an even number. "
+        "The mixer window shows at most 8, more run headless or offline only.",
+        "subgroups", QString::number(MixerState::DefaultSubgroupCount));
+    QCommandLineOption workersOption("workers",
+        "Process channel strips on <count> realtime worker threads in addition to the JACK thread.",
+        "count", "0");
+    QCommandLineOption workerCpusOption("worker-cpus",
+        "Pin the worker threads to the given comma separated <cpus>.",
+        "cpus");
+    QCommandLineOption workerPriorityOption("worker-priority",
+        "SCHED_FIFO <priority> of the worker threads, 0 for default scheduling.",
+        "priority", "10");
+    QCommandLineOption equalizerOption("equalizer",
+        "Equalizer <engine> for the channel strips, either \"fft\" or \"biquad\".",
+        "engine", "fft");
+    QCommandLineOption directOutOption("direct-out",
+        "Tap the channel direct outs at <point>, either \"post\" or \"pre\" fader.",
+        "point", "post");
+    QCommandLineOption silenceThresholdOption("silence-threshold",
+        "Consider channel inputs at or below <dB> as silent.",
+        "dB", "-120");
+    QCommandLineOption silencePeriodsOption("silence-periods",
+        "Skip channels that have been silent for <periods>, 0 to process all channels always.",
+        "periods", "16");
+    QCommandLineOption insertOption("insert",
+        "Load an LV2 plugin into the insert slot of a channel, given as <channel:uri>. May be repeated.",
+        "channel:uri");
+    QCommandLineOption scenesOption("scenes",
+        "Load all state files in <directory> as scenes, to be recalled with page up and page down.",
+        "directory");
+    QCommandLineOption crossfadeOption("crossfade",
+        "Crossfade over <ms> when recalling a scene or state, 0 to switch over at once.",
+        "ms", "0");
+    QCommandLineOption oscOption("osc",
+        "Accept OSC control messages on UDP, given as <[address:]port>.",
+        "[address:]port");
+    QCommandLineOption recordDirectoryOption("record-directory",
+        "Write multitrack recordings, started and stopped with F8, to <directory>.",
+        "directory", ".");
+    QCommandLineOption recordFormatOption("record-format",
+        "File <format> of multitrack recordings, either \"w64\" or \"wav\" (up to 4 GiB per track).",
+        "format", "w64");
+    QCommandLineOption soundcheckOption("soundcheck",
+        "Play back the channel inputs of the recording in <directory> for a virtual soundcheck, toggled with F7. "
+        "Defaults to the latest recording.",
+        "directory");
+    QCommandLineOption soundcheckChannelsOption("soundcheck-channels",
+        "Play back only the given comma separated <channels> for a virtual soundcheck.",
+        "channels");
+    QCommandLineOption traceOption("trace",
+        "Trace the processing stages into <file>, to be opened with chrome://tracing or Perfetto.",
+        "file");
+    QCommandLineOption headlessOption("headless",
+        "Run the engine without a user interface, for one started with --attach to control it. "
+        "It records, plays back the soundcheck and writes exported files with its own options.");
+    QCommandLineOption attachOption("attach",
+        "Start the user interface only and attach it to a running headless engine. "
+        "The topology of the engine is used, engine options are ignored.");
+    QCommandLineOption segmentOption("segment",
+        "<name> of the shared memory segment a headless engine and the user interface talk through.",
+        "name", "mx2482");
+
+    QCommandLineOption renderOption("render",
+        "Render the mixer <state> file offline instead of starting a live session.",
+        "state");
+    QCommandLineOption outputDirectoryOption("output-directory",
+        "Write the rendered outputs to <directory>.",
+        "directory", ".");
+    QCommandLineOption blockSizeOption("block-size",
+        "Render in blocks of <frames>.",
+        "frames", "1024");
+    QCommandLineOption sampleRateOption("sample-rate",
+        "Render at <rate> Hz if no input file is given.",
+        "rate", "48000");
+    QCommandLineOption verifyWorkersOption("verify-workers",
+        "Render serially and with worker threads in lockstep and fail if any output differs.");
+    parser.addPositionalArgument("inputs",
+        "Input files of channel 1 to 24 for rendering, \"-\" for a silent channel.",
+        "[inputs...]");
+
+    parser.addOption(channelsOption);
+    parser.addOption(subgroupsOption);
+    parser.addOption(workersOption);
+    parser.addOption(workerCpusOption);
+    parser.addOption(workerPriorityOption);
+    parser.addOption(equalizerOption);
+    parser.addOption(directOutOption);
+    parser.addOption(silenceThresholdOption);
+    parser.addOption(silencePeriodsOption);
+    parser.addOption(insertOption);
+    parser.addOption(scenesOption);
+    parser.addOption(crossfadeOption);
+    parser.addOption(oscOption);
+    parser.addOption(recordDirectoryOption);
+    parser.addOption(recordFormatOption);
+    parser.addOption(soundcheckOption);
+    parser.addOption(soundcheckChannelsOption);
+    parser.addOption(traceOption);
+    parser.addOption(headlessOption);
+    parser.addOption(attachOption);
+    parser.addOption(segmentOption);
+    parser.addOption(renderOption);
+    parser.addOption(outputDirectoryOption);
+    parser.addOption(blockSizeOption);
+    parser.addOption(sampleRateOption);
+    parser.addOption(verifyWorkersOption);
+    parser.process(arguments);
+
+    MixerOptions mixerOptions;
+    mixerOptions.channelCount = qBound(1, parser.value(channelsOption).toInt(), (int)MaximumChannelCount);
+    mixerOptions.subgroupCount = qBound(0, parser.value(subgroupsOption).toInt(), (int)MixerState::MaximumSubgroupCount);
+    mixerOptions.subgroupCount += mixerOptions.subgroupCount % 2;
+    mixerOptions.workerPool.threadCount = qMax(0, parser.value(workersOption).toInt());
+    mixerOptions.workerPool.priority = qMax(0, parser.value(workerPriorityOption).toInt());
+    foreach(QString cpu, parser.value(workerCpusOption).split(',', QString::SkipEmptyParts)) {
+        bool ok;
+        int cpuIndex = cpu.trimmed().toInt(&ok);
+        if(ok && cpuIndex >= 0) {
+            mixerOptions.workerPool.cpus.append(cpuIndex);
+        }
+    }
+
+    QString equalizer = parser.value(equalizerOption);
+    if(equalizer == "fft") {
+        mixerOptions.equalizerEngine = FFTEqualizer;
+    } else if(equalizer == "biquad") {
+        mixerOptions.equalizerEngine = BiquadEqualizer;
+    } else {
+        qWarning("Unknown equalizer engine \"%s\", using fft.", qPrintable(equalizer));
+    }
+
+    QString directOut = parser.value(directOutOption);
+    if(directOut == "pre") {
+        mixerOptions.directOutTap = PreFaderTap;
+    } else if(directOut == "post") {
+        mixerOptions.directOutTap = PostFaderTap;
+    } else {
+        qWarning("Unknown direct out tap \"%s\", using post fader.", qPrintable(directOut));
+    }
+
+    mixerOptions.silenceThreshold = parser.value(silenceThresholdOption).toDouble();
+    mixerOptions.silenceHoldPeriods = qMax(0, parser.value(silencePeriodsOption).toInt());
+
+    foreach(QString insert, parser.values(insertOption)) {
+        int separator = insert.indexOf(':');
+        bool ok;
+        int channel = insert.left(separator).toInt(&ok);
+        if(separator < 0 || !ok || channel < 1 || channel > mixerOptions.channelCount) {
+            qWarning("Invalid insert \"%s\", expected <channel:uri>.", qPrintable(insert));
+            continue;
+        }
+        mixerOptions.inserts.insert(channel - 1, insert.mid(separator + 1));
+    }
+
+    mixerOptions.sceneDirectory = parser.value(scenesOption);
+    mixerOptions.crossfadeTime = qMax(0.0, parser.value(crossfadeOption).toDouble());
+
+    if(parser.isSet(oscOption)) {
+        QString osc = parser.value(oscOption);
+        int separator = osc.lastIndexOf(':');
+        bool ok;
+        int port = osc.mid(separator + 1).toInt(&ok);
+        if(ok && port > 0 && port < 65536) {
+            if(separator > 0) {
+                mixerOptions.oscAddress = osc.left(separator);
+            }
+            mixerOptions.oscPort = port;
+        } else {
+            qWarning("Invalid OSC port \"%s\", expected <[address:]port>.", qPrintable(osc));
+        }
+    }
+
+    mixerOptions.recordDirectory = parser.value(recordDirectoryOption);
+    QString recordFormat = parser.value(recordFormatOption);
+    if(recordFormat == "wav") {
+        mixerOptions.recordFormat = WavWriter::Wave;
+    } else if(recordFormat == "w64") {
+        mixerOptions.recordFormat = WavWriter::Wave64;
+    } else {
+        qWarning("Unknown record format \"%s\", using w64.", qPrintable(recordFormat));
+    }
+
+    mixerOptions.soundcheckDirectory = parser.value(soundcheckOption);
+    foreach(QString channel, parser.value(soundcheckChannelsOption).split(',', QString::SkipEmptyParts)) {
+        bool ok;
+        int channelIndex = channel.trimmed().toInt(&ok);
+        if(ok && channelIndex >= 1 && channelIndex <= mixerOptions.channelCount) {
+            mixerOptions.soundcheckChannels.append(channelIndex - 1);
+        } else {
+            qWarning("Invalid soundcheck channel \"%s\".", qPrintable(channel));
+        }
+    }
+
+    mixerOptions.traceFile = parser.value(traceOption);
+
+    mixerOptions.headless = parser.isSet(headlessOption);
+    mixerOptions.attach = parser.isSet(attachOption);
+    mixerOptions.segmentName = parser.value(segmentOption);
+    if(mixerOptions.headless && mixerOptions.attach) {
+        qWarning("--headless and --attach exclude each other, running headless.");
+        mixerOptions.attach = false;
+    }
+
+    mixerOptions.renderStateFile = parser.value(renderOption);
+    mixerOptions.renderInputFiles = parser.positionalArguments();
+    mixerOptions.renderOutputDirectory = parser.value(outputDirectoryOption);
+    mixerOptions.renderBlockSize = qMax(1, parser.value(blockSizeOption).toInt());
+    mixerOptions.renderSampleRate = qMax(1, parser.value(sampleRateOption).toInt());
+    mixerOptions.renderVerifyWorkers = parser.isSet(verifyWorkersOption);
+
+    return mixerOptions;
+}
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MIXEROPTIONS_H
+#define MIXEROPTIONS_H
+
+// Qt includes
+#include <QStringList>
+#include <QMap>
+
+// Own includes
+#include "workerpool.h"
+#include "mixerstate.h"
+#include "wavwriter.h"
+
+/**
+ * Startup options of the mixer, as given on the command line.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct MixerOptions
+{
+    /** Available equalizer implementations. */
+    enum EqualizerEngine {
+        /** FFT based QEqualizer of QJackAudio, one per channel. */
+        FFTEqualizer,
+        /** Zero-latency biquad equalizer processing all channels at once. */
+        BiquadEqualizer
+    };
+
+    /** Points in the channel strip the direct outs can be tapped at. */
+    enum DirectOutTap {
+        /** After the fader, what the channel contributes to the mix. */
+        PostFaderTap,
+        /** Before the fader, after insert and aux. */
+        PreFaderTap
+    };
+
+    enum {
+        /** Upper limit for the number of channels. */
+        MaximumChannelCount = 1024
+    };
+
+    MixerOptions();
+
+    /** Parses the command line, exits the application on invalid arguments. */
+    static MixerOptions fromArguments(const QStringList& arguments);
+
+    /** Number of channels. */
+    int channelCount;
+    /** Number of subgroups, always even. */
+    int subgroupCount;
+
+    /** Worker threads used to process the channel strips. */
+    WorkerPool::Configuration workerPool;
+
+    /** Equalizer implementation used for the channel strips. */
+    EqualizerEngine equalizerEngine;
+
+    /** Point the direct outs of all channels are tapped at. */
+    DirectOutTap directOutTap;
+
+    /** Level at or below which a channel input is considered silent, in dB. */
+    double silenceThreshold;
+    /** Number of silent periods before a channel strip is skipped, 0 to never skip. */
+    int silenceHoldPeriods;
+
+    /** URIs of the LV2 plugins to load into the insert slots, by channel starting at 0. */
+    QMap<int, QString> inserts;
+
+    /** Directory with the state files that are loaded as scenes, empty for none. */
+    QString sceneDirectory;
+    /** Time recalled scenes crossfade over, in milliseconds. 0 to switch over at once. */
+    double crossfadeTime;
+
+    /** Address the OSC control server binds to, if oscPort is not 0. */
+    QString oscAddress;
+    /** UDP port of the OSC control server, 0 to not start it. */
+    int oscPort;
+
+    /** Directory each multitrack recording gets a subdirectory in. */
+    QString recordDirectory;
+    /** File format of multitrack recordings. */
+    WavWriter::Format recordFormat;
+
+    /** Recording the virtual soundcheck plays back, empty for the latest one in recordDirectory. */
+    QString soundcheckDirectory;
+    /** Channels the virtual soundcheck plays back, starting at 0. Empty for all. */
+    QList<int> soundcheckChannels;
+
+    /** File the processing stages are traced into, empty to not trace. */
+    QString traceFile;
+
+    /** Whether to run the engine without a user interface, for one to attach to later. */
+    bool headless;
+    /** Whether to attach the user interface to a headless engine instead of running one. */
+    bool attach;
+    /** Name of the shared memory segment a headless engine and the user interface talk through. */
+    QString segmentName;
+
+    /** State file to render offline, without JACK and widgets. Empty for a live session. */
+    QString renderStateFile;
+    /** Input files of the channels for rendering offline, "-" for a silent channel. */
+    QStringList renderInputFiles;
+    /** Directory the rendered outputs are written to. */
+    QString renderOutputDirectory;
+    /** Number of frames processed at once when rendering offline. */
+    int renderBlockSize;
+    /** Sample rate for rendering offline, if there are no input files to take it from. */
+    int renderSampleRate;
+    /**
+     * Whether to render with and without the worker pool in lockstep and
+     * fail on the first output that differs.
+     */
+    bool renderVerifyWorkers;
+};
+
+#endif // MIXEROPTIONS_H
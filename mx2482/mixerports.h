@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MIXERPORTS_H
+#define MIXERPORTS_H
+
+// Qt includes
+#include <QtGlobal>
+
+/**
+ * Audio inputs and outputs of the mixer engine. Implementations connect the
+ * engine to JACK or to files. Channels and subgroups are counted from 0.
+ *
+ * All methods are called from the realtime thread. Methods taking a channel
+ * may be called concurrently for different channels.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class MixerPorts
+{
+public:
+    virtual ~MixerPorts() { }
+
+    /** Reads the input of a channel. */
+    virtual void readChannelInput(int channel, float *target, int frames) = 0;
+    /** Writes the direct out of a channel. */
+    virtual void writeChannelOutput(int channel, const float *source, int frames) = 0;
+    /**
+     * @returns the memory of the direct out of a channel for the current
+     * period, so a channel strip can be processed right in it, or 0 if the
+     * ports cannot provide it. Writing the direct out from that memory is
+     * not necessary then. Only BufferMixerPorts provides it, so the strips
+     * of the offline renderer and the benchmark run in their direct outs,
+     * while those of a JACK session run in scratch memory and are copied.
+     */
+    virtual float *channelOutputBuffer(int channel) { Q_UNUSED(channel); return 0; }
+    /** Writes the aux send of a channel. */
+    virtual void writeAuxSend(int channel, const float *source, int frames) = 0;
+    /** Reads the aux return of a channel. */
+    virtual void readAuxReturn(int channel, float *target, int frames) = 0;
+
+    /** Writes the output of a subgroup. */
+    virtual void writeSubgroupOutput(int subgroup, const float *source, int frames) = 0;
+    /** Writes a main output, 0 is left, 1 is right. */
+    virtual void writeMainOutput(int main, const float *source, int frames) = 0;
+
+    /** Silences the direct out of a channel. */
+    virtual void clearChannelOutput(int channel, int frames) = 0;
+    /** Silences the aux send of a channel. */
+    virtual void clearAuxSend(int channel, int frames) = 0;
+    /** Silences the output of a subgroup. */
+    virtual void clearSubgroupOutput(int subgroup, int frames) = 0;
+    /** Silences a main output, 0 is left, 1 is right. */
+    virtual void clearMainOutput(int main, int frames) = 0;
+
+    /** Silences all outputs, used when a period cannot be processed. */
+    virtual void clearOutputs(int frames) = 0;
+};
+
+#endif // MIXERPORTS_H
@@ -0,0 +1,311 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "mixerstate.h"
+
+// QJackAudio includes
+#include <QUnits>
+
+const double ChannelState::LowShelfQ = 1.2;
+const double ChannelState::MidBandwidth = 500.0;
+const double ChannelState::HighShelfFrequency = 12000.0;
+const double ChannelState::HighShelfQ = 0.5;
+
+ChannelState::ChannelState() :
+    inputGain(0.0f),
+    auxSendGain(0.0f),
+    auxReturnGain(0.0f),
+    faderGain(0.0f),
+    panorama(0.5f),
+    lowFrequency(200),
+    lowAmount(0),
+    midFrequency(4000),
+    midAmount(0),
+    highAmount(0),
+    equalizerOn(false),
+    auxOn(false),
+    insertOn(true),
+    gateOn(false),
+    gateThreshold(0.001f),
+    compressorOn(false),
+    compressorThreshold(0.1f),
+    compressorRatio(4.0f),
+    muted(false),
+    soloed(false),
+    onMain(false),
+    subgroupPairs(0)
+{
+    for(int i = 0; i < BiquadEqualizerBank::BandCount; i++) {
+        equalizerBands[i] = BiquadCoefficients::identity();
+    }
+}
+
+ChannelState ChannelState::fromJson(const QJsonObject& jsonObject, double sampleRate)
+{
+    ChannelState channelState;
+    channelState.inputGain      = QUnits::dbToLinear(jsonObject.value("inputGain").toDouble());
+    channelState.auxSendGain    = QUnits::dbToLinear(jsonObject.value("auxSendGain").toDouble());
+    channelState.auxReturnGain  = QUnits::dbToLinear(jsonObject.value("auxReturnGain").toDouble());
+    channelState.faderGain      = QUnits::dbToLinear(jsonObject.value("faderGain").toDouble());
+    channelState.panorama       = jsonObject.value("panorama").toDouble(50.0) / 100.0;
+    channelState.equalizerOn    = jsonObject.value("eqActive").toBool();
+    channelState.auxOn          = jsonObject.value("auxActive").toBool();
+    channelState.insertOn       = jsonObject.value("insertActive").toBool(true);
+    channelState.gateOn         = jsonObject.value("gateActive").toBool();
+    channelState.gateThreshold  = QUnits::dbToLinear(jsonObject.value("gateThreshold").toDouble(-60.0));
+    channelState.compressorOn   = jsonObject.value("compressorActive").toBool();
+    channelState.compressorThreshold = QUnits::dbToLinear(jsonObject.value("compressorThreshold").toDouble(-20.0));
+    channelState.compressorRatio = qMax(1.0, jsonObject.value("compressorRatio").toDouble(4.0));
+    channelState.muted          = jsonObject.value("muted").toBool();
+    channelState.soloed         = jsonObject.value("soloed").toBool();
+    channelState.onMain         = jsonObject.value("onMain").toBool();
+
+    channelState.lowFrequency   = jsonObject.value("lowFrequency").toDouble(200.0);
+    channelState.lowAmount      = jsonObject.value("lowAmount").toDouble();
+    channelState.midFrequency   = jsonObject.value("midFrequency").toDouble(4000.0);
+    channelState.midAmount      = jsonObject.value("midAmount").toDouble();
+    channelState.highAmount     = jsonObject.value("highAmount").toDouble();
+
+    channelState.updateEqualizerBands(sampleRate);
+    return channelState;
+}
+
+void ChannelState::updateEqualizerBands(double sampleRate)
+{
+    for(int band = 0; band < BiquadEqualizerBank::BandCount; band++) {
+        updateEqualizerBand(band, sampleRate);
+    }
+}
+
+void ChannelState::updateEqualizerBand(int band, double sampleRate)
+{
+    switch(band) {
+    case BiquadEqualizerBank::LowShelf:
+        equalizerBands[band] = BiquadCoefficients::lowShelf(sampleRate, lowFrequency, LowShelfQ, lowAmount);
+        break;
+    case BiquadEqualizerBank::Band:
+        equalizerBands[band] = BiquadCoefficients::band(sampleRate, midFrequency, MidBandwidth, midAmount);
+        break;
+    case BiquadEqualizerBank::HighShelf:
+        equalizerBands[band] = BiquadCoefficients::highShelf(sampleRate, HighShelfFrequency, HighShelfQ, highAmount);
+        break;
+    default:
+        break;
+    }
+}
+
+/** Sets value to current if it differs from previous. @returns true, if it did. */
+template <typename T>
+static inline bool mergeValue(T& value, const T& previous, const T& current)
+{
+    if(current != previous) {
+        value = current;
+        return true;
+    }
+    return false;
+}
+
+void ChannelState::mergeChanges(const ChannelState& previous, const ChannelState& current, double sampleRate, bool resampled)
+{
+    mergeValue(inputGain, previous.inputGain, current.inputGain);
+    mergeValue(auxSendGain, previous.auxSendGain, current.auxSendGain);
+    mergeValue(auxReturnGain, previous.auxReturnGain, current.auxReturnGain);
+    mergeValue(faderGain, previous.faderGain, current.faderGain);
+    mergeValue(panorama, previous.panorama, current.panorama);
+
+    bool bandChanged[BiquadEqualizerBank::BandCount];
+    bandChanged[BiquadEqualizerBank::LowShelf] = mergeValue(lowFrequency, previous.lowFrequency, current.lowFrequency);
+    bandChanged[BiquadEqualizerBank::LowShelf] |= mergeValue(lowAmount, previous.lowAmount, current.lowAmount);
+    bandChanged[BiquadEqualizerBank::Band] = mergeValue(midFrequency, previous.midFrequency, current.midFrequency);
+    bandChanged[BiquadEqualizerBank::Band] |= mergeValue(midAmount, previous.midAmount, current.midAmount);
+    bandChanged[BiquadEqualizerBank::HighShelf] = mergeValue(highAmount, previous.highAmount, current.highAmount);
+
+    // Current has its coefficients computed off the realtime thread already, so they are taken over
+    bool bandMatches[BiquadEqualizerBank::BandCount];
+    bandMatches[BiquadEqualizerBank::LowShelf] = lowFrequency == current.lowFrequency && lowAmount == current.lowAmount;
+    bandMatches[BiquadEqualizerBank::Band] = midFrequency == current.midFrequency && midAmount == current.midAmount;
+    bandMatches[BiquadEqualizerBank::HighShelf] = highAmount == current.highAmount;
+    for(int band = 0; band < BiquadEqualizerBank::BandCount; band++) {
+        if(!bandChanged[band] && !resampled) {
+            continue;
+        }
+        if(bandMatches[band]) {
+            equalizerBands[band] = current.equalizerBands[band];
+        } else {
+            updateEqualizerBand(band, sampleRate);
+        }
+    }
+
+    mergeValue(equalizerOn, previous.equalizerOn, current.equalizerOn);
+    mergeValue(auxOn, previous.auxOn, current.auxOn);
+    mergeValue(insertOn, previous.insertOn, current.insertOn);
+    mergeValue(gateOn, previous.gateOn, current.gateOn);
+    mergeValue(gateThreshold, previous.gateThreshold, current.gateThreshold);
+    mergeValue(compressorOn, previous.compressorOn, current.compressorOn);
+    mergeValue(compressorThreshold, previous.compressorThreshold, current.compressorThreshold);
+    mergeValue(compressorRatio, previous.compressorRatio, current.compressorRatio);
+    mergeValue(muted, previous.muted, current.muted);
+    mergeValue(soloed, previous.soloed, current.soloed);
+    mergeValue(onMain, previous.onMain, current.onMain);
+
+    // Each subgroup pair is a switch of its own
+    quint64 changedPairs = previous.subgroupPairs ^ current.subgroupPairs;
+    subgroupPairs = (subgroupPairs & ~changedPairs) | (current.subgroupPairs & changedPairs);
+}
+
+SubgroupState::SubgroupState() :
+    gain(0.0f),
+    muted(false),
+    soloed(false),
+    onMain(false)
+{
+}
+
+void SubgroupState::mergeChanges(const SubgroupState& previous, const SubgroupState& current)
+{
+    mergeValue(gain, previous.gain, current.gain);
+    mergeValue(muted, previous.muted, current.muted);
+    mergeValue(soloed, previous.soloed, current.soloed);
+    mergeValue(onMain, previous.onMain, current.onMain);
+}
+
+MixerState::MixerState(int channelCount, int subgroupCount) :
+    channels(channelCount),
+    subgroups(subgroupCount),
+    sampleRate(48000.0),
+    soloedChannelCount(0),
+    soloedSubgroupCount(0),
+    crossfadeFrames(0),
+    serial(0)
+{
+    for(int i = 0; i < MainCount; i++) {
+        mainGains[i] = 0.0f;
+        mainMuted[i] = false;
+    }
+}
+
+MixerState MixerState::fromJson(const QJsonObject& jsonObject, int channelCount, int subgroupCount, double sampleRate)
+{
+    MixerState mixerState(channelCount, subgroupCount);
+    mixerState.sampleRate = sampleRate;
+
+    for(int i = 0; i < channelCount; i++) {
+        QJsonObject channelObject = jsonObject.value(QString("channel%1").arg(i + 1)).toObject();
+        ChannelState& channelState = mixerState.channels[i];
+        channelState = ChannelState::fromJson(channelObject, sampleRate);
+
+        for(int pair = 0; pair < mixerState.subgroupPairCount(); pair++) {
+            QString key = QString("inSubgroup%1%2").arg(2 * pair + 1).arg(2 * pair + 2);
+            if(channelObject.value(key).toBool()) {
+                channelState.subgroupPairs |= Q_UINT64_C(1) << pair;
+            }
+        }
+    }
+
+    for(int i = 0; i < subgroupCount; i++) {
+        SubgroupState& subgroupState = mixerState.subgroups[i];
+        subgroupState.gain   = QUnits::dbToLinear(jsonObject.value(QString("subgroup%1Gain").arg(i + 1)).toDouble());
+        subgroupState.muted  = jsonObject.value(QString("subgroup%1Muted").arg(i + 1)).toBool();
+        subgroupState.soloed = jsonObject.value(QString("subgroup%1Soloed").arg(i + 1)).toBool();
+        subgroupState.onMain = jsonObject.value(QString("subgroup%1OnMain").arg(i + 1)).toBool();
+    }
+
+    for(int i = 0; i < MainCount; i++) {
+        mixerState.mainGains[i] = QUnits::dbToLinear(jsonObject.value(QString("main%1Gain").arg(i + 1)).toDouble());
+        mixerState.mainMuted[i] = jsonObject.value(QString("main%1Muted").arg(i + 1)).toBool();
+    }
+
+    mixerState.updateSoloState();
+    return mixerState;
+}
+
+void MixerState::resize(int channelCount, int subgroupCount)
+{
+    channels.resize(channelCount);
+    subgroups.resize(subgroupCount);
+
+    // Drop routings to subgroup pairs that do not exist anymore
+    quint64 pairMask = subgroupCount / 2 >= 64 ? ~Q_UINT64_C(0) : (Q_UINT64_C(1) << (subgroupCount / 2)) - 1;
+    for(int i = 0; i < channelCount; i++) {
+        channels[i].subgroupPairs &= pairMask;
+    }
+
+    updateSoloState();
+}
+
+void MixerState::updateSoloState()
+{
+    soloedChannelCount = 0;
+    for(int i = 0; i < channels.size(); i++) {
+        if(channels.at(i).soloed) {
+            soloedChannelCount++;
+        }
+    }
+
+    soloedSubgroupCount = 0;
+    for(int i = 0; i < subgroups.size(); i++) {
+        if(subgroups.at(i).soloed) {
+            soloedSubgroupCount++;
+        }
+    }
+}
+
+void MixerState::copyFrom(const MixerState& other)
+{
+    for(int i = 0; i < channels.size(); i++) {
+        channels[i] = other.channels.at(i);
+    }
+    for(int i = 0; i < subgroups.size(); i++) {
+        subgroups[i] = other.subgroups.at(i);
+    }
+    for(int i = 0; i < MainCount; i++) {
+        mainGains[i] = other.mainGains[i];
+        mainMuted[i] = other.mainMuted[i];
+    }
+    sampleRate = other.sampleRate;
+    soloedChannelCount = other.soloedChannelCount;
+    soloedSubgroupCount = other.soloedSubgroupCount;
+    crossfadeFrames = other.crossfadeFrames;
+    serial = other.serial;
+}
+
+void MixerState::mergeChanges(const MixerState& previous, const MixerState& current)
+{
+    // A new sample rate invalidates all equalizer coefficients
+    bool resampled = mergeValue(sampleRate, previous.sampleRate, current.sampleRate);
+    for(int i = 0; i < channels.size(); i++) {
+        channels[i].mergeChanges(previous.channels.at(i), current.channels.at(i), sampleRate, resampled);
+    }
+    for(int i = 0; i < subgroups.size(); i++) {
+        subgroups[i].mergeChanges(previous.subgroups.at(i), current.subgroups.at(i));
+    }
+    for(int i = 0; i < MainCount; i++) {
+        mergeValue(mainGains[i], previous.mainGains[i], current.mainGains[i]);
+        mergeValue(mainMuted[i], previous.mainMuted[i], current.mainMuted[i]);
+    }
+    crossfadeFrames = current.crossfadeFrames;
+    serial = current.serial;
+
+    updateSoloState();
+}
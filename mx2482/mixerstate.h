@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MIXERSTATE_H
+#define MIXERSTATE_H
+
+// Qt includes
+#include <QtGlobal>
+#include <QJsonObject>
+#include <QVector>
+
+// Own includes
+#include "biquadequalizer.h"
+
+/**
+ * Plain data snapshot of all parameters of a single channel strip, as they
+ * are needed by the audio processing. Gains are stored as linear factors.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct ChannelState
+{
+    /** Q of the low shelf. */
+    static const double LowShelfQ;
+    /** Bandwidth of the mid band in Hz. */
+    static const double MidBandwidth;
+    /** Frequency of the high shelf in Hz. */
+    static const double HighShelfFrequency;
+    /** Q of the high shelf. */
+    static const double HighShelfQ;
+
+    ChannelState();
+
+    /**
+     * Derives the channel parameters from a JSON object as written by
+     * ChannelWidget::stateToJson().
+     * @param sampleRate Sample rate the equalizer coefficients are computed for.
+     */
+    static ChannelState fromJson(const QJsonObject& jsonObject, double sampleRate);
+
+    /** Computes the biquad coefficients from the equalizer parameters. */
+    void updateEqualizerBands(double sampleRate);
+    /** Computes the biquad coefficients of a single band, see BiquadEqualizerBank. */
+    void updateEqualizerBand(int band, double sampleRate);
+
+    /**
+     * Takes over each parameter that differs between previous and current,
+     * keeping all others. Does not allocate. The coefficients of a band
+     * that ends up with the parameters of current are copied from current,
+     * so they are only computed here if a band combines a change of current
+     * with one made in the meantime.
+     * @param resampled Whether sampleRate differs from the one the coefficients have been computed for.
+     */
+    void mergeChanges(const ChannelState& previous, const ChannelState& current, double sampleRate, bool resampled);
+
+    /** Input stage gain ("Gain"). */
+    float inputGain;
+    /** Attenuation before sending the signal to aux. */
+    float auxSendGain;
+    /** Attenuation after receiving the signal from aux. */
+    float auxReturnGain;
+    /** Fader stage gain ("Volume"). */
+    float faderGain;
+    /** Panorama, 0.0 means left-most, 1.0 indicates right-most position. */
+    float panorama;
+
+    /** Low shelf frequency in Hz, for the FFT equalizer. */
+    int lowFrequency;
+    /** Low shelf amount, for the FFT equalizer. */
+    int lowAmount;
+    /** Band frequency in Hz, for the FFT equalizer. */
+    int midFrequency;
+    /** Band amount, for the FFT equalizer. */
+    int midAmount;
+    /** High shelf amount, for the FFT equalizer. */
+    int highAmount;
+
+    /** Coefficients for the biquad equalizer: low shelf, band and high shelf. */
+    BiquadCoefficients equalizerBands[BiquadEqualizerBank::BandCount];
+
+    /** Whether the equalizer is switched on. */
+    bool equalizerOn;
+    /** Whether aux send/return is switched on. */
+    bool auxOn;
+    /** Whether the insert effect runs, if the channel has one. */
+    bool insertOn;
+
+    /** Whether the gate is switched on. */
+    bool gateOn;
+    /** Level below which the gate closes, linear. */
+    float gateThreshold;
+    /** Whether the compressor is switched on. */
+    bool compressorOn;
+    /** Level above which the compressor reduces the gain, linear. */
+    float compressorThreshold;
+    /** Ratio of the compressor, 1.0 leaves the signal unaltered. */
+    float compressorRatio;
+
+    /** Whether this channel has been muted. */
+    bool muted;
+    /** Whether this channel has been soloed. */
+    bool soloed;
+    /** Whether this channel is routed on main. */
+    bool onMain;
+    /** Subgroup pairs this channel is routed to, bit p stands for subgroups 2p + 1 and 2p + 2. */
+    quint64 subgroupPairs;
+};
+
+/**
+ * Plain data snapshot of all parameters of a single subgroup. The gain is
+ * stored as linear factor.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct SubgroupState
+{
+    SubgroupState();
+
+    /** Takes over each parameter that differs between previous and current. */
+    void mergeChanges(const SubgroupState& previous, const SubgroupState& current);
+
+    /** Fader gain. */
+    float gain;
+    /** Whether this subgroup has been muted. */
+    bool muted;
+    /** Whether this subgroup has been soloed. */
+    bool soloed;
+    /** Whether this subgroup is routed on main. */
+    bool onMain;
+};
+
+/**
+ * Plain data snapshot of the complete mixer, published by the GUI thread and
+ * read by the JACK realtime thread. The number of channels and subgroups is
+ * chosen at startup. The realtime thread must only read a snapshot through
+ * a const reference, so the vectors are never detached there.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct MixerState
+{
+    enum {
+        /** Default number of channels, as on the front panel. */
+        DefaultChannelCount = 24,
+        /** Default number of subgroups, as on the front panel. */
+        DefaultSubgroupCount = 8,
+        /** Subgroups come in pairs, each pair is a bit in ChannelState::subgroupPairs. */
+        MaximumSubgroupCount = 128,
+        /** Main left and right. */
+        MainCount = 2
+    };
+
+    /** Creates a snapshot with default parameters for the given topology. */
+    MixerState(int channelCount = 0, int subgroupCount = 0);
+
+    /**
+     * Derives the mixer parameters from a JSON object as written by
+     * MainMixerWidget::stateToJson(), so a saved state can be processed
+     * with or without any widgets.
+     * @param sampleRate Sample rate the equalizer coefficients are computed for.
+     */
+    static MixerState fromJson(const QJsonObject& jsonObject, int channelCount, int subgroupCount, double sampleRate);
+
+    /** Changes the topology, keeping the parameters of all remaining channels and subgroups. */
+    void resize(int channelCount, int subgroupCount);
+
+    /** Recounts soloed channels and subgroups. Must be called after changing any solo switch. */
+    void updateSoloState();
+
+    /**
+     * Copies all parameters of a snapshot of the same topology into this
+     * one. Unlike assigning, this never shares or allocates, so the
+     * realtime thread may keep a modifiable snapshot of its own.
+     */
+    void copyFrom(const MixerState& other);
+
+    /**
+     * Takes over each parameter that differs between the snapshots
+     * previous and current, which must have the same topology as this
+     * one. Parameters that have been changed on this snapshot in the
+     * meantime stay as they are. Does not allocate.
+     */
+    void mergeChanges(const MixerState& previous, const MixerState& current);
+
+    /** @returns the number of channels. */
+    int channelCount() const { return channels.size(); }
+    /** @returns the number of subgroups. */
+    int subgroupCount() const { return subgroups.size(); }
+    /** @returns the number of subgroup pairs. */
+    int subgroupPairCount() const { return subgroups.size() / 2; }
+
+    /** Per channel parameters, index i holds channel i + 1. */
+    QVector<ChannelState> channels;
+    /** Per subgroup parameters, index i holds subgroup i + 1. */
+    QVector<SubgroupState> subgroups;
+
+    /** Main fader gains, index 0 is left, index 1 is right. */
+    float mainGains[MainCount];
+    /** Muted main outputs, index 0 is left, index 1 is right. */
+    bool mainMuted[MainCount];
+
+    /** Sample rate the equalizer coefficients have been computed for. */
+    double sampleRate;
+
+    /** Number of soloed channels, kept by updateSoloState(). */
+    int soloedChannelCount;
+    /** Number of soloed subgroups, kept by updateSoloState(). */
+    int soloedSubgroupCount;
+
+    /**
+     * Number of frames over which the gains move from the previous
+     * snapshot to this one. 0 switches over at the next period boundary.
+     */
+    int crossfadeFrames;
+    /** Sequence number, assigned by MixerEngine::publishState(). */
+    quint32 serial;
+
+    /** @returns true, if channel i (starting at 0) is audible on the buses, taking mute and solo into account. */
+    bool isChannelAudible(int i) const {
+        const ChannelState& channelState = channels.at(i);
+        return !channelState.muted && (!soloedChannelCount || channelState.soloed);
+    }
+
+    /** @returns true, if subgroup i (starting at 0) is audible on main, taking mute, solo and routing into account. */
+    bool isSubgroupOnMain(int i) const {
+        const SubgroupState& subgroupState = subgroups.at(i);
+        return subgroupState.onMain && !subgroupState.muted
+            && (!soloedSubgroupCount || subgroupState.soloed);
+    }
+};
+
+#endif // MIXERSTATE_H
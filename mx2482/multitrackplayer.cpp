@@ -0,0 +1,205 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "multitrackplayer.h"
+
+// Qt includes
+#include <QDir>
+#include <QThread>
+
+// Standard includes
+#include <cstring>
+
+MultitrackPlayer::MultitrackPlayer(int channelCount) :
+    _channelCount(channelCount),
+    _readBuffer(ChunkFrames),
+    _missedFrames(0),
+    _playing(false),
+    _quit(0)
+{
+}
+
+MultitrackPlayer::~MultitrackPlayer()
+{
+    stop();
+}
+
+bool MultitrackPlayer::start(const QString& directory, int sampleRate, const QList<int>& channels)
+{
+    stop();
+    _missedFrames = 0;
+    _errorString.clear();
+
+    // Rings are a whole number of chunks, like the ones of the recorder
+    int ringFrames = 2 * ChunkFrames;
+    while(ringFrames < sampleRate * RingSeconds) {
+        ringFrames *= 2;
+    }
+
+    QDir playbackDirectory(directory);
+    _sampleRings.fill(0, _channelCount);
+    _wavReaders.fill(0, _channelCount);
+    int trackCount = 0;
+    for(int i = 0; i < _channelCount; i++) {
+        if(!channels.isEmpty() && !channels.contains(i)) {
+            continue;
+        }
+
+        QString fileName = playbackDirectory.filePath(QString("ch%1_in.w64").arg(i + 1));
+        if(!QFile::exists(fileName)) {
+            fileName = playbackDirectory.filePath(QString("ch%1_in.wav").arg(i + 1));
+            if(!QFile::exists(fileName)) {
+                continue;
+            }
+        }
+
+        WavReader *wavReader = new WavReader();
+        _wavReaders[i] = wavReader;
+        if(!wavReader->open(fileName)) {
+            _errorString = wavReader->errorString();
+            clear();
+            return false;
+        }
+        if(wavReader->sampleRate() != sampleRate) {
+            _errorString = QString("Sample rate of %1 differs from the one of the mixer.").arg(fileName);
+            clear();
+            return false;
+        }
+        wavReader->readAhead(ReadAheadChunks * ChunkFrames);
+        _sampleRings[i] = new SampleRing(ringFrames);
+        trackCount++;
+    }
+    if(trackCount == 0) {
+        _errorString = QString("No channel tracks found in: %1").arg(directory);
+        clear();
+        return false;
+    }
+
+    // Start out with full rings, which gives a cold cache as much time as possible
+    _quit.storeRelease(0);
+    readChunks();
+
+    if(pthread_create(&_thread, 0, &MultitrackPlayer::threadEntry, this) != 0) {
+        _errorString = "Could not create disk reader thread.";
+        clear();
+        return false;
+    }
+    _playing = true;
+    return true;
+}
+
+void MultitrackPlayer::stop()
+{
+    if(!_playing) {
+        return;
+    }
+
+    _quit.storeRelease(1);
+    pthread_join(_thread, 0);
+    _playing = false;
+    _missedFrames = missedFrames();
+    clear();
+}
+
+bool MultitrackPlayer::isPlaying() const
+{
+    return _playing;
+}
+
+SampleRing *MultitrackPlayer::channelRing(int i)
+{
+    return _sampleRings.value(i, 0);
+}
+
+qint64 MultitrackPlayer::missedFrames() const
+{
+    qint64 missedFrames = _missedFrames;
+    foreach(const SampleRing *sampleRing, _sampleRings) {
+        if(sampleRing) {
+            missedFrames += sampleRing->missedFrames();
+        }
+    }
+    return missedFrames;
+}
+
+QString MultitrackPlayer::errorString() const
+{
+    return _errorString;
+}
+
+void *MultitrackPlayer::threadEntry(void *argument)
+{
+    MultitrackPlayer *multitrackPlayer = static_cast<MultitrackPlayer*>(argument);
+    while(!multitrackPlayer->_quit.loadAcquire()) {
+        multitrackPlayer->readChunks();
+        QThread::msleep(ReadInterval);
+    }
+    return 0;
+}
+
+void MultitrackPlayer::readChunks()
+{
+    // One chunk of each track in turn, so a slow file does not starve the others
+    float *readBuffer = _readBuffer.data();
+    bool read;
+    do {
+        read = false;
+        for(int i = 0; i < _channelCount; i++) {
+            SampleRing *sampleRing = _sampleRings.at(i);
+            if(!sampleRing || sampleRing->writeAvailable() < ChunkFrames) {
+                continue;
+            }
+
+            // Loop at the end of the track. A track that cannot be read any further is silent.
+            WavReader *wavReader = _wavReaders.at(i);
+            int frames = 0;
+            bool rewound = false;
+            while(frames < ChunkFrames) {
+                int framesRead = wavReader->read(readBuffer + frames, ChunkFrames - frames);
+                if(framesRead > 0) {
+                    frames += framesRead;
+                    rewound = false;
+                } else if(!rewound) {
+                    wavReader->rewind();
+                    rewound = true;
+                } else {
+                    memset(readBuffer + frames, 0, (ChunkFrames - frames) * sizeof(float));
+                    frames = ChunkFrames;
+                }
+            }
+            wavReader->readAhead(ReadAheadChunks * ChunkFrames);
+
+            sampleRing->write(readBuffer, ChunkFrames);
+            read = true;
+        }
+    } while(read && !_quit.loadAcquire());
+}
+
+void MultitrackPlayer::clear()
+{
+    qDeleteAll(_wavReaders);
+    _wavReaders.clear();
+    qDeleteAll(_sampleRings);
+    _sampleRings.clear();
+}
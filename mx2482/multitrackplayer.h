@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MULTITRACKPLAYER_H
+#define MULTITRACKPLAYER_H
+
+// Qt includes
+#include <QVector>
+#include <QList>
+#include <QString>
+#include <QAtomicInt>
+
+// Own includes
+#include "samplering.h"
+#include "wavreader.h"
+
+// Standard includes
+#include <pthread.h>
+
+/**
+ * Plays back the channel inputs of a multitrack recording, for a virtual
+ * soundcheck. A disk reader thread streams each track into a sample ring
+ * in large blocks and asks the operating system to read further ahead in
+ * the background. The realtime thread only copies out of the rings. The
+ * rings are filled completely before playback starts, so even a cold
+ * page cache has seconds to catch up. The tracks loop at their end; the
+ * tracks of one recording have the same length and stay in sync.
+ *
+ * The rings may only be read while playing, between start() and stop(),
+ * and only by one thread in a period.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class MultitrackPlayer
+{
+public:
+    /**
+     * Constructor.
+     * @param channelCount Number of channels.
+     */
+    explicit MultitrackPlayer(int channelCount);
+    /** Destructor, stops playback. */
+    ~MultitrackPlayer();
+
+    /**
+     * Opens the channel input tracks of a recording made by
+     * MultitrackRecorder, fills the rings and starts the disk reader
+     * thread. Channels without a track keep their live input.
+     * @param channels Channels to play back, starting at 0. Empty for all.
+     * @returns true on success, otherwise errorString() tells why.
+     */
+    bool start(const QString& directory, int sampleRate, const QList<int>& channels);
+
+    /** Terminates the disk reader thread and closes all files. The rings must not be read anymore. */
+    void stop();
+
+    /** @returns true, if playback has been started. */
+    bool isPlaying() const;
+
+    /** @returns the ring of the track of channel i (starting at 0), 0 if it has none. Valid while playing. */
+    SampleRing *channelRing(int i);
+
+    /**
+     * @returns the number of frames that have been replaced by silence on
+     * any track of the current or last playback, because the disk could
+     * not keep up.
+     */
+    qint64 missedFrames() const;
+
+    /** @returns a description of the last error. */
+    QString errorString() const;
+
+private:
+    enum {
+        /** Seconds of audio each ring holds. */
+        RingSeconds = 4,
+        /** Frames read from a file at once. */
+        ChunkFrames = 32768,
+        /** Chunks the operating system is asked to read ahead. */
+        ReadAheadChunks = 8,
+        /** Time the disk reader waits when all rings are full, in milliseconds. */
+        ReadInterval = 20
+    };
+
+    static void *threadEntry(void *argument);
+
+    /**
+     * Reads one chunk of each track in turn, until all rings are full or
+     * the thread is asked to quit.
+     */
+    void readChunks();
+
+    /** Closes and deletes all files and rings. */
+    void clear();
+
+    int _channelCount;
+
+    /** Ring of each channel, 0 for channels without a track. */
+    QVector<SampleRing*> _sampleRings;
+    /** File of each channel, 0 for channels without a track. */
+    QVector<WavReader*> _wavReaders;
+    /** Block read from a file before it goes into a ring. */
+    QVector<float> _readBuffer;
+
+    /** Missed frames of the rings that have been deleted. */
+    qint64 _missedFrames;
+
+    /** Disk reader thread, if playing. */
+    pthread_t _thread;
+    bool _playing;
+    /** Set to terminate the disk reader thread. */
+    QAtomicInt _quit;
+    QString _errorString;
+};
+
+#endif // MULTITRACKPLAYER_H
@@ -0,0 +1,214 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "multitrackrecorder.h"
+#include "mixerstate.h"
+
+// Qt includes
+#include <QDir>
+#include <QThread>
+
+MultitrackRecorder::MultitrackRecorder(int channelCount, int subgroupCount) :
+    _channelCount(channelCount),
+    _subgroupCount(subgroupCount),
+    _reserveFrames(0),
+    _droppedFrames(0),
+    _recording(false),
+    _quit(0),
+    _failed(0)
+{
+}
+
+MultitrackRecorder::~MultitrackRecorder()
+{
+    stop();
+}
+
+bool MultitrackRecorder::start(const QString& directory, int sampleRate, WavWriter::Format format)
+{
+    stop();
+    _failed.storeRelease(0);
+    _droppedFrames = 0;
+    _errorString.clear();
+
+    QDir recordDirectory(directory);
+    if(!recordDirectory.mkpath(".")) {
+        _errorString = QString("Could not create directory: %1").arg(directory);
+        return false;
+    }
+
+    QStringList fileNames;
+    for(int i = 0; i < _channelCount; i++) {
+        fileNames.append(QString("ch%1_in").arg(i + 1));
+    }
+    for(int i = 0; i < _subgroupCount; i++) {
+        fileNames.append(QString("subgroup%1_out").arg(i + 1));
+    }
+    for(int i = 0; i < MixerState::MainCount; i++) {
+        fileNames.append(QString("main_out_%1").arg(i + 1));
+    }
+
+    // Rings are a whole number of chunks, so a full chunk never wraps around
+    int ringFrames = 2 * ChunkFrames;
+    while(ringFrames < sampleRate * RingSeconds) {
+        ringFrames *= 2;
+    }
+    _reserveFrames = (qint64)sampleRate * ReserveSeconds;
+
+    QString suffix = format == WavWriter::Wave64 ? ".w64" : ".wav";
+    foreach(QString fileName, fileNames) {
+        WavWriter *wavWriter = new WavWriter();
+        _wavWriters.append(wavWriter);
+        if(!wavWriter->open(recordDirectory.filePath(fileName + suffix), sampleRate, format, DataAlignment)) {
+            _errorString = wavWriter->errorString();
+            clear();
+            return false;
+        }
+        wavWriter->reserve(_reserveFrames);
+        _sampleRings.append(new SampleRing(ringFrames));
+    }
+
+    _quit.storeRelease(0);
+    if(pthread_create(&_thread, 0, &MultitrackRecorder::threadEntry, this) != 0) {
+        _errorString = "Could not create disk writer thread.";
+        clear();
+        return false;
+    }
+    _recording = true;
+    return true;
+}
+
+void MultitrackRecorder::stop()
+{
+    if(!_recording) {
+        return;
+    }
+
+    _quit.storeRelease(1);
+    pthread_join(_thread, 0);
+    _recording = false;
+
+    // Nothing is written to the rings anymore, so they can be emptied from here. Silence still
+    // owed for dropped periods is made up for, so all tracks end up with the same length.
+    writeChunks(true);
+    foreach(SampleRing *sampleRing, _sampleRings) {
+        while(!sampleRing->write(0, 0)) {
+            writeChunks(true);
+        }
+    }
+    writeChunks(true);
+    _droppedFrames = droppedFrames();
+    clear();
+}
+
+bool MultitrackRecorder::isRecording() const
+{
+    return _recording;
+}
+
+SampleRing *MultitrackRecorder::channelRing(int i)
+{
+    return _sampleRings.at(i);
+}
+
+SampleRing *MultitrackRecorder::subgroupRing(int i)
+{
+    return _sampleRings.at(_channelCount + i);
+}
+
+SampleRing *MultitrackRecorder::mainRing(int i)
+{
+    return _sampleRings.at(_channelCount + _subgroupCount + i);
+}
+
+qint64 MultitrackRecorder::droppedFrames() const
+{
+    qint64 droppedFrames = _droppedFrames;
+    foreach(const SampleRing *sampleRing, _sampleRings) {
+        droppedFrames += sampleRing->droppedFrames();
+    }
+    return droppedFrames;
+}
+
+bool MultitrackRecorder::hasFailed() const
+{
+    return _failed.loadAcquire() != 0;
+}
+
+QString MultitrackRecorder::errorString() const
+{
+    return _errorString;
+}
+
+void *MultitrackRecorder::threadEntry(void *argument)
+{
+    MultitrackRecorder *multitrackRecorder = static_cast<MultitrackRecorder*>(argument);
+    while(!multitrackRecorder->_quit.loadAcquire()) {
+        multitrackRecorder->writeChunks(false);
+        QThread::msleep(WriteInterval);
+    }
+    return 0;
+}
+
+void MultitrackRecorder::writeChunks(bool flush)
+{
+    // One chunk of each track in turn, so a backlog on one track does not starve the others
+    bool written;
+    do {
+        written = false;
+        for(int track = 0; track < _sampleRings.size(); track++) {
+            SampleRing *sampleRing = _sampleRings.at(track);
+            int available = sampleRing->readAvailable();
+            if(available == 0 || (available < ChunkFrames && !flush)) {
+                continue;
+            }
+
+            int frames;
+            const float *samples = sampleRing->peek(frames);
+            frames = qMin(frames, (int)ChunkFrames);
+
+            // After a failure the rings are still drained, but nothing is written anymore
+            WavWriter *wavWriter = _wavWriters.at(track);
+            if(!_failed.loadAcquire()) {
+                if(wavWriter->write(samples, frames)) {
+                    // Stay at least one step ahead with the allocated disk space
+                    wavWriter->reserve((wavWriter->frameCount() / _reserveFrames + 2) * _reserveFrames);
+                } else {
+                    _errorString = wavWriter->errorString();
+                    _failed.storeRelease(1);
+                }
+            }
+            sampleRing->release(frames);
+            written = true;
+        }
+    } while(written && (flush || !_quit.loadAcquire()));
+}
+
+void MultitrackRecorder::clear()
+{
+    qDeleteAll(_wavWriters);
+    _wavWriters.clear();
+    qDeleteAll(_sampleRings);
+    _sampleRings.clear();
+}
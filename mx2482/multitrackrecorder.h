@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MULTITRACKRECORDER_H
+#define MULTITRACKRECORDER_H
+
+// Qt includes
+#include <QVector>
+#include <QString>
+#include <QAtomicInt>
+
+// Own includes
+#include "samplering.h"
+#include "wavwriter.h"
+
+// Standard includes
+#include <pthread.h>
+
+/**
+ * Records every channel input, subgroup and main left and right into a
+ * file of its own. The realtime thread appends each period to a sample
+ * ring per track and never waits for the disk. A disk writer thread
+ * drains the rings in large chunks that start at aligned file offsets,
+ * with disk space allocated well ahead of the writes. The rings hold a
+ * few seconds of audio to ride out slow disks; what still does not fit is
+ * recorded as silence, so all tracks stay in sync.
+ *
+ * The rings may only be written while recording, between start() and
+ * stop(), and only by one thread in a period.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class MultitrackRecorder
+{
+public:
+    /**
+     * Constructor.
+     * @param channelCount Number of channels.
+     * @param subgroupCount Number of subgroups.
+     */
+    MultitrackRecorder(int channelCount, int subgroupCount);
+    /** Destructor, stops recording. */
+    ~MultitrackRecorder();
+
+    /**
+     * Creates the files in directory, allocates the rings and starts the
+     * disk writer thread. The files are named like the outputs of an
+     * offline render, with the channel inputs as "ch1_in.wav" and so on.
+     * @returns true on success, otherwise errorString() tells why.
+     */
+    bool start(const QString& directory, int sampleRate, WavWriter::Format format);
+
+    /**
+     * Writes out what is left in the rings, finishes the files and
+     * terminates the disk writer thread. The rings must not be written
+     * anymore.
+     */
+    void stop();
+
+    /** @returns true, if recording has been started. */
+    bool isRecording() const;
+
+    /** @returns the ring of the input of channel i (starting at 0). Valid while recording. */
+    SampleRing *channelRing(int i);
+    /** @returns the ring of subgroup i (starting at 0). Valid while recording. */
+    SampleRing *subgroupRing(int i);
+    /** @returns the ring of main i (0 is left, 1 is right). Valid while recording. */
+    SampleRing *mainRing(int i);
+
+    /**
+     * @returns the number of frames that have been replaced by silence
+     * on any track of the current or last recording, because the disk
+     * could not keep up.
+     */
+    qint64 droppedFrames() const;
+
+    /**
+     * @returns true, if writing to a file has failed. The recording goes
+     * on without touching the disk then, until it is stopped.
+     */
+    bool hasFailed() const;
+
+    /**
+     * @returns a description of the last error. Valid after start() has
+     * failed or after stop().
+     */
+    QString errorString() const;
+
+private:
+    enum {
+        /** Seconds of audio each ring holds. */
+        RingSeconds = 4,
+        /** Frames written to a file at once, a multiple of DataAlignment in bytes. */
+        ChunkFrames = 32768,
+        /** Seconds of audio disk space is allocated for ahead of the writes. */
+        ReserveSeconds = 60,
+        /** Alignment of the samples in the files, in bytes. */
+        DataAlignment = 4096,
+        /** Time the disk writer waits when there is nothing to write, in milliseconds. */
+        WriteInterval = 20
+    };
+
+    static void *threadEntry(void *argument);
+
+    /**
+     * Writes one full chunk of each track in turn, until there are none
+     * left or the thread is asked to quit.
+     * @param flush Also writes out partial chunks, until the rings are empty.
+     */
+    void writeChunks(bool flush);
+
+    /** Closes and deletes all files and rings. */
+    void clear();
+
+    int _channelCount;
+    int _subgroupCount;
+
+    /** Ring of each track: the channels, followed by the subgroups and main left and right. */
+    QVector<SampleRing*> _sampleRings;
+    /** File of each track, in the same order. */
+    QVector<WavWriter*> _wavWriters;
+
+    /** Frames disk space is allocated in steps of. */
+    qint64 _reserveFrames;
+    /** Dropped frames of the rings that have been deleted. */
+    qint64 _droppedFrames;
+
+    /** Disk writer thread, if recording. */
+    pthread_t _thread;
+    bool _recording;
+    /** Set to terminate the disk writer thread. */
+    QAtomicInt _quit;
+    /** Set once writing to a file has failed. */
+    QAtomicInt _failed;
+    QString _errorString;
+};
+
+#endif // MULTITRACKRECORDER_H
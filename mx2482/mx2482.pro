@@ -1,4 +1,4 @@
-QT += core gui widgets
+QT += core gui widgets network
 OBJECTS_DIR = obj
 MOC_DIR = moc
 DESTDIR = bin
@@ -6,28 +6,43 @@ TARGET = mx2482
 TEMPLATE = app
 QMAKE_CXXFLAGS -= -O2
 QMAKE_CXXFLAGS += -O3
+# Never fuse multiplies and adds, so all routing kernel variants produce the same buses
+QMAKE_CXXFLAGS += -ffp-contract=off
 CONFIG -= console
 CONFIG += flat
 
-INCLUDEPATH += ../libqjackaudio
+# Sum the subgroups and main in double precision: qmake CONFIG+=double_buses
+double_buses: DEFINES += MX2482_DOUBLE_BUSES
 
-LIBS += -L../libqjackaudio/lib \
+INCLUDEPATH += ../libqjackaudio \
+               /usr/include/lilv-0
+
+# The engine comes from libmx2482engine, only the widgets are built here
+LIBS += -L../libmx2482engine/lib \
+                -lmx2482engine \
+                -L../libqjackaudio/lib \
                 -lqjackaudio \
                 -ljack \
-                -lfftw3
+                -lfftw3 \
+                -llilv-0 \
+                -lpthread
+
+PRE_TARGETDEPS += ../libmx2482engine/lib/libmx2482engine.a
 
 SOURCES += \
     mainwindow.cpp \
     main.cpp \
     channelwidget.cpp \
     mainmixerwidget.cpp \
-    aboutdialog.cpp
+    aboutdialog.cpp \
+    meterwidget.cpp
 
 HEADERS += \
     mainwindow.h \
     channelwidget.h \
     mainmixerwidget.h \
-    aboutdialog.h
+    aboutdialog.h \
+    meterwidget.h
 
 FORMS += \
     mainwindow.ui \
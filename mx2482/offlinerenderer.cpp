@@ -0,0 +1,275 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "offlinerenderer.h"
+#include "buffermixerports.h"
+#include "mixerengine.h"
+#include "sampleops.h"
+#include "automationrecorder.h"
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QThread>
+
+// Standard includes
+#include <cstring>
+
+OfflineRenderer::OfflineRenderer(const MixerOptions& mixerOptions) :
+    _mixerOptions(mixerOptions),
+    _lv2Host(0)
+{
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    qDeleteAll(_channelReaders);
+    qDeleteAll(_channelWriters);
+    qDeleteAll(_subgroupWriters);
+    qDeleteAll(_mainWriters);
+    delete _lv2Host;
+}
+
+WavWriter *OfflineRenderer::openOutput(const QString& fileName, int sampleRate)
+{
+    WavWriter *wavWriter = new WavWriter();
+    QString filePath = QDir(_mixerOptions.renderOutputDirectory).filePath(fileName);
+    if(!wavWriter->open(filePath, sampleRate)) {
+        qWarning("%s", qPrintable(wavWriter->errorString()));
+        delete wavWriter;
+        return 0;
+    }
+    return wavWriter;
+}
+
+bool OfflineRenderer::render()
+{
+    int channelCount = _mixerOptions.channelCount;
+    int subgroupCount = _mixerOptions.subgroupCount;
+
+    QFile stateFile(_mixerOptions.renderStateFile);
+    if(!stateFile.open(QIODevice::ReadOnly)) {
+        qWarning("Could not open file for read: %s", qPrintable(_mixerOptions.renderStateFile));
+        return false;
+    }
+    QJsonObject state = QJsonDocument::fromJson(stateFile.readAll()).object();
+    stateFile.close();
+
+    if(_mixerOptions.renderInputFiles.size() > channelCount) {
+        qWarning("Ignoring input files beyond channel %d.", channelCount);
+    }
+
+    // Open the inputs, all of them must share the same sample rate
+    int sampleRate = 0;
+    qint64 totalFrames = 0;
+    _channelReaders.fill(0, channelCount);
+    for(int i = 0; i < channelCount; i++) {
+        QString fileName = _mixerOptions.renderInputFiles.value(i, "-");
+        if(fileName == "-") {
+            continue;
+        }
+
+        WavReader *wavReader = new WavReader();
+        _channelReaders[i] = wavReader;
+        if(!wavReader->open(fileName)) {
+            qWarning("%s", qPrintable(wavReader->errorString()));
+            return false;
+        }
+        if(sampleRate && wavReader->sampleRate() != sampleRate) {
+            qWarning("Sample rate of %s differs from the other inputs.", qPrintable(fileName));
+            return false;
+        }
+        sampleRate = wavReader->sampleRate();
+        totalFrames = qMax(totalFrames, wavReader->frameCount());
+    }
+    if(!sampleRate) {
+        sampleRate = _mixerOptions.renderSampleRate;
+    }
+
+    // Open the outputs
+    if(!QDir(_mixerOptions.renderOutputDirectory).mkpath(".")) {
+        qWarning("Could not create directory: %s", qPrintable(_mixerOptions.renderOutputDirectory));
+        return false;
+    }
+    for(int i = 0; i < subgroupCount; i++) {
+        _subgroupWriters.append(openOutput(QString("subgroup%1_out.wav").arg(i + 1), sampleRate));
+    }
+    for(int i = 0; i < MixerState::MainCount; i++) {
+        _mainWriters.append(openOutput(QString("main_out_%1.wav").arg(i + 1), sampleRate));
+    }
+    for(int i = 0; i < channelCount; i++) {
+        _channelWriters.append(openOutput(QString("ch%1_out.wav").arg(i + 1), sampleRate));
+    }
+    if(_subgroupWriters.contains(0) || _mainWriters.contains(0) || _channelWriters.contains(0)) {
+        return false;
+    }
+
+    // Set up the same engine a live session uses
+    enableFlushToZero();
+    int blockSize = _mixerOptions.renderBlockSize;
+    BufferMixerPorts mixerPorts(channelCount, subgroupCount, blockSize);
+    MixerEngine mixerEngine(&mixerPorts, channelCount, subgroupCount);
+    if(!setupEngine(mixerEngine, _mixerOptions.workerPool, state, sampleRate)) {
+        return false;
+    }
+    if(!_mixerOptions.traceFile.isEmpty() && !mixerEngine.startTracing(_mixerOptions.traceFile)) {
+        qWarning("%s", qPrintable(mixerEngine.stageTracer().errorString()));
+        return false;
+    }
+
+    // The engine to verify against runs serially if the render uses workers, and the other way round
+    BufferMixerPorts verifyPorts(_mixerOptions.renderVerifyWorkers ? channelCount : 0,
+                                 _mixerOptions.renderVerifyWorkers ? subgroupCount : 0, blockSize);
+    MixerEngine *verifyEngine = 0;
+    if(_mixerOptions.renderVerifyWorkers) {
+        WorkerPool::Configuration verifyPool = _mixerOptions.workerPool;
+        verifyPool.threadCount = verifyPool.threadCount > 0 ? 0 : qMax(1, QThread::idealThreadCount() - 1);
+        verifyEngine = new MixerEngine(&verifyPorts, channelCount, subgroupCount);
+        if(!setupEngine(*verifyEngine, verifyPool, state, sampleRate)) {
+            delete verifyEngine;
+            return false;
+        }
+        if(verifyEngine->workerThreadCount() == mixerEngine.workerThreadCount()) {
+            qWarning("Could not start the worker threads to verify against.");
+            delete verifyEngine;
+            return false;
+        }
+    }
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    // The engine always processes full blocks, so the last block of each input is padded with silence
+    for(qint64 position = 0; position < totalFrames; position += blockSize) {
+        for(int i = 0; i < channelCount; i++) {
+            float *input = mixerPorts.channelInput(i);
+            int framesRead = _channelReaders.at(i) ? _channelReaders.at(i)->read(input, blockSize) : 0;
+            clearSamples(input + framesRead, blockSize - framesRead);
+            if(verifyEngine) {
+                memcpy(verifyPorts.channelInput(i), input, blockSize * sizeof(float));
+            }
+        }
+
+        mixerEngine.process(blockSize);
+        if(verifyEngine) {
+            verifyEngine->process(blockSize);
+            QString output = differingOutput(mixerPorts, verifyPorts);
+            if(!output.isEmpty()) {
+                qWarning("%s differs between %d and %d worker threads in the block at frame %lld.",
+                         qPrintable(output), mixerEngine.workerThreadCount(),
+                         verifyEngine->workerThreadCount(), position);
+                delete verifyEngine;
+                return false;
+            }
+        }
+
+        int frames = (int)qMin((qint64)blockSize, totalFrames - position);
+        bool written = true;
+        for(int i = 0; i < subgroupCount; i++) {
+            written &= _subgroupWriters.at(i)->write(mixerPorts.subgroupOutput(i), frames);
+        }
+        for(int i = 0; i < MixerState::MainCount; i++) {
+            written &= _mainWriters.at(i)->write(mixerPorts.mainOutput(i), frames);
+        }
+        for(int i = 0; i < channelCount; i++) {
+            written &= _channelWriters.at(i)->write(mixerPorts.channelOutput(i), frames);
+        }
+        if(!written) {
+            qWarning("Could not write output files in: %s", qPrintable(_mixerOptions.renderOutputDirectory));
+            delete verifyEngine;
+            return false;
+        }
+    }
+    if(verifyEngine) {
+        qDebug("All outputs are identical with %d and %d worker threads.",
+               mixerEngine.workerThreadCount(), verifyEngine->workerThreadCount());
+        delete verifyEngine;
+    }
+
+    qint64 elapsed = qMax((qint64)1, elapsedTimer.elapsed());
+    qDebug("Rendered %lld frames of %d channels at %d Hz in %lld ms (%.1fx realtime).",
+           totalFrames, channelCount, sampleRate, elapsed, (totalFrames * 1000.0 / sampleRate) / elapsed);
+    return true;
+}
+
+bool OfflineRenderer::setupEngine(MixerEngine& mixerEngine, const WorkerPool::Configuration& workerPool,
+                                  const QJsonObject& state, int sampleRate)
+{
+    int channelCount = _mixerOptions.channelCount;
+    int subgroupCount = _mixerOptions.subgroupCount;
+    int blockSize = _mixerOptions.renderBlockSize;
+    mixerEngine.resizeBuffers(blockSize);
+    mixerEngine.setEqualizerEngine(_mixerOptions.equalizerEngine);
+    mixerEngine.setSilenceDetection(_mixerOptions.silenceThreshold, _mixerOptions.silenceHoldPeriods);
+    mixerEngine.setDirectOutTap(_mixerOptions.directOutTap);
+    mixerEngine.startWorkerPool(workerPool);
+
+    // A render must not silently differ from the session, so any insert that fails to load is an error
+    if(!_mixerOptions.inserts.isEmpty() && !_lv2Host) {
+        _lv2Host = new Lv2Host();
+    }
+    QMap<int, QString>::const_iterator insert;
+    for(insert = _mixerOptions.inserts.constBegin(); insert != _mixerOptions.inserts.constEnd(); ++insert) {
+        QString errorString;
+        Lv2Insert *lv2Insert = _lv2Host->createInsert(insert.value(), sampleRate, blockSize, &errorString);
+        if(!lv2Insert) {
+            qWarning("%s", qPrintable(errorString));
+            return false;
+        }
+        mixerEngine.setInsertEffect(insert.key(), lv2Insert);
+    }
+
+    mixerEngine.publishState(MixerState::fromJson(state, channelCount, subgroupCount, sampleRate));
+
+    // Play back automation saved with the state from the first frame on
+    if(state.contains("automation")) {
+        mixerEngine.setAutomation(AutomationRecorder::fromJson(state.value("automation").toArray()));
+        mixerEngine.startAutomation();
+    }
+    return true;
+}
+
+QString OfflineRenderer::differingOutput(BufferMixerPorts& mixerPorts, BufferMixerPorts& verifyPorts) const
+{
+    size_t bytes = _mixerOptions.renderBlockSize * sizeof(float);
+    for(int i = 0; i < _mixerOptions.subgroupCount; i++) {
+        if(memcmp(mixerPorts.subgroupOutput(i), verifyPorts.subgroupOutput(i), bytes)) {
+            return QString("Subgroup %1").arg(i + 1);
+        }
+    }
+    for(int i = 0; i < MixerState::MainCount; i++) {
+        if(memcmp(mixerPorts.mainOutput(i), verifyPorts.mainOutput(i), bytes)) {
+            return QString("Main %1").arg(i + 1);
+        }
+    }
+    for(int i = 0; i < _mixerOptions.channelCount; i++) {
+        if(memcmp(mixerPorts.channelOutput(i), verifyPorts.channelOutput(i), bytes)) {
+            return QString("Channel %1").arg(i + 1);
+        }
+    }
+    return QString();
+}
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef OFFLINERENDERER_H
+#define OFFLINERENDERER_H
+
+// Qt includes
+#include <QVector>
+
+// Own includes
+#include "mixeroptions.h"
+#include "wavreader.h"
+#include "wavwriter.h"
+#include "lv2host.h"
+#include "mixerengine.h"
+
+/**
+ * Renders a saved mixer state with input files into output files, as fast
+ * as possible and without JACK or any widgets. Writes one file for each
+ * subgroup, main left and right and each channel direct out.
+ *
+ * To check that the worker pool mixes exactly like the serial path, a
+ * second engine can render the same inputs in lockstep, serially if the
+ * first one uses worker threads and with worker threads otherwise. All
+ * outputs of both must be bit-identical.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class OfflineRenderer
+{
+public:
+    /** Constructor */
+    explicit OfflineRenderer(const MixerOptions& mixerOptions);
+    /** Destructor, closes all files. */
+    ~OfflineRenderer();
+
+    /**
+     * Renders until the longest input file has ended.
+     * @returns true on success, failures are reported with qWarning().
+     */
+    bool render();
+
+private:
+    /** Creates a writer for an output file, or returns 0 on failure. */
+    WavWriter *openOutput(const QString& fileName, int sampleRate);
+
+    /**
+     * Sets up an engine the way a live session does and hands it the state.
+     * @returns false, if an insert effect could not be loaded.
+     */
+    bool setupEngine(MixerEngine& mixerEngine, const WorkerPool::Configuration& workerPool,
+                     const QJsonObject& state, int sampleRate);
+
+    /**
+     * @returns the name of the first output that differs between two
+     * engines in the last block, empty if they are all identical.
+     */
+    QString differingOutput(BufferMixerPorts& mixerPorts, BufferMixerPorts& verifyPorts) const;
+
+    MixerOptions _mixerOptions;
+
+    /** Readers for the channel inputs, 0 for silent channels. */
+    QVector<WavReader*> _channelReaders;
+    /** Writers for the channel direct outs. */
+    QVector<WavWriter*> _channelWriters;
+    /** Writers for the subgroup outputs. */
+    QVector<WavWriter*> _subgroupWriters;
+    /** Writers for main left and right. */
+    QVector<WavWriter*> _mainWriters;
+
+    /** Host for the insert effects, only created if there are any. */
+    Lv2Host *_lv2Host;
+};
+
+#endif // OFFLINERENDERER_H
@@ -0,0 +1,347 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "oscserver.h"
+
+// Qt includes
+#include <QtEndian>
+#include <QtNumeric>
+
+// Standard includes
+#include <cstring>
+
+/** Reads a padded OSC string at offset and moves offset past it. @returns false, if truncated. */
+static bool readString(const QByteArray& data, int *offset, QByteArray *string)
+{
+    int end = data.indexOf('\0', *offset);
+    if(end < 0) {
+        return false;
+    }
+    *string = data.mid(*offset, end - *offset);
+    *offset = (end + 4) & ~3;
+    return true;
+}
+
+/** Reads a big endian 32 bit word at offset and moves offset past it. @returns false, if truncated. */
+static bool readWord(const QByteArray& data, int *offset, quint32 *word)
+{
+    if(*offset + 4 > data.size()) {
+        return false;
+    }
+    *word = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(data.constData() + *offset));
+    *offset += 4;
+    return true;
+}
+
+/** Appends a padded OSC string. */
+static void appendString(QByteArray& data, const QByteArray& string)
+{
+    data.append(string);
+    data.append(4 - string.size() % 4, '\0');
+}
+
+/** Appends a big endian 32 bit float. */
+static void appendFloat(QByteArray& data, float value)
+{
+    quint32 word;
+    memcpy(&word, &value, sizeof(word));
+    uchar bytes[4];
+    qToBigEndian<quint32>(word, bytes);
+    data.append(reinterpret_cast<const char*>(bytes), 4);
+}
+
+OscServer::OscServer(MixerEngine *mixerEngine, const QHostAddress& address, quint16 port) :
+    QObject(),
+    _mixerEngine(mixerEngine),
+    _address(address),
+    _port(port),
+    _udpSocket(0),
+    _controlQueue(ControlQueueCapacity),
+    _meterBank(mixerEngine->remoteMeterRing().recordCount()),
+    _meterTimer(this)
+{
+    _channelCommands.insert("gain",           MixerCommand::ChannelInputGain);
+    _channelCommands.insert("auxsend",        MixerCommand::ChannelAuxSendGain);
+    _channelCommands.insert("auxreturn",      MixerCommand::ChannelAuxReturnGain);
+    _channelCommands.insert("fader",          MixerCommand::ChannelFaderGain);
+    _channelCommands.insert("pan",            MixerCommand::ChannelPanorama);
+    _channelCommands.insert("eq/lowfreq",     MixerCommand::ChannelLowFrequency);
+    _channelCommands.insert("eq/low",         MixerCommand::ChannelLowAmount);
+    _channelCommands.insert("eq/midfreq",     MixerCommand::ChannelMidFrequency);
+    _channelCommands.insert("eq/mid",         MixerCommand::ChannelMidAmount);
+    _channelCommands.insert("eq/high",        MixerCommand::ChannelHighAmount);
+    _channelCommands.insert("eq",             MixerCommand::ChannelEqualizerOn);
+    _channelCommands.insert("aux",            MixerCommand::ChannelAuxOn);
+    _channelCommands.insert("insert",         MixerCommand::ChannelInsertOn);
+    _channelCommands.insert("mute",           MixerCommand::ChannelMuted);
+    _channelCommands.insert("solo",           MixerCommand::ChannelSoloed);
+    _channelCommands.insert("main",           MixerCommand::ChannelOnMain);
+    _channelCommands.insert("gate",           MixerCommand::ChannelGateOn);
+    _channelCommands.insert("gate/threshold", MixerCommand::ChannelGateThreshold);
+    _channelCommands.insert("comp",           MixerCommand::ChannelCompressorOn);
+    _channelCommands.insert("comp/threshold", MixerCommand::ChannelCompressorThreshold);
+    _channelCommands.insert("comp/ratio",     MixerCommand::ChannelCompressorRatio);
+
+    connect(&_meterTimer, SIGNAL(timeout()), this, SLOT(sendMeters()));
+    _meterTimer.setInterval(MeterInterval);
+    _meterTimer.setSingleShot(false);
+}
+
+OscServer::~OscServer()
+{
+    // Nobody reads the ring anymore
+    _mixerEngine->setRemoteMeteringEnabled(false);
+}
+
+WaitFreeQueue<MixerCommand>& OscServer::controlQueue()
+{
+    return _controlQueue;
+}
+
+void OscServer::start()
+{
+    _udpSocket = new QUdpSocket(this);
+    if(!_udpSocket->bind(_address, _port)) {
+        qWarning("Could not bind OSC server to %s:%d: %s", qPrintable(_address.toString()), _port,
+                 qPrintable(_udpSocket->errorString()));
+        return;
+    }
+    connect(_udpSocket, SIGNAL(readyRead()), this, SLOT(readDatagrams()));
+
+    _mixerEngine->setRemoteMeteringEnabled(true);
+    _meterElapsedTimer.start();
+    _meterTimer.start();
+}
+
+void OscServer::readDatagrams()
+{
+    while(_udpSocket->hasPendingDatagrams()) {
+        QByteArray datagram;
+        datagram.resize(qMax((qint64)0, _udpSocket->pendingDatagramSize()));
+        Subscriber sender;
+        if(_udpSocket->readDatagram(datagram.data(), datagram.size(), &sender.address, &sender.port) >= 0) {
+            handlePacket(datagram, sender, 0);
+        }
+    }
+}
+
+void OscServer::handlePacket(const QByteArray& packet, const Subscriber& sender, int depth)
+{
+    if(!packet.startsWith("#bundle")) {
+        handleMessage(packet, sender);
+        return;
+    }
+
+    // Nested bundles are unusual, and a packet must not make us recurse without end
+    if(depth >= MaximumBundleDepth) {
+        return;
+    }
+
+    // Skip the name and the time tag, bundles are executed right away. Sizes come from
+    // the network, so any that is empty, unaligned or reaches past the packet ends it.
+    int offset = 16;
+    quint32 elementSize;
+    while(readWord(packet, &offset, &elementSize)) {
+        if(elementSize == 0 || elementSize % 4 != 0 || elementSize > (quint32)(packet.size() - offset)) {
+            return;
+        }
+        handlePacket(packet.mid(offset, elementSize), sender, depth + 1);
+        offset += elementSize;
+    }
+}
+
+void OscServer::handleMessage(const QByteArray& message, const Subscriber& sender)
+{
+    int offset = 0;
+    QByteArray address;
+    QByteArray typeTags;
+    if(!readString(message, &offset, &address) || !readString(message, &offset, &typeTags)) {
+        return;
+    }
+
+    if(address == "/meters/subscribe" || address == "/meters/unsubscribe") {
+        subscribe(sender, address == "/meters/subscribe");
+        return;
+    }
+
+    // All parameters take a single number or boolean
+    float value;
+    quint32 word;
+    switch(typeTags.size() == 2 && typeTags.at(0) == ',' ? typeTags.at(1) : '\0') {
+    case 'f':
+        if(!readWord(message, &offset, &word)) {
+            return;
+        }
+        memcpy(&value, &word, sizeof(value));
+        break;
+    case 'i':
+        if(!readWord(message, &offset, &word)) {
+            return;
+        }
+        value = (qint32)word;
+        break;
+    case 'T':
+        value = 1.0f;
+        break;
+    case 'F':
+        value = 0.0f;
+        break;
+    default:
+        return;
+    }
+
+    // Values from the network go into the realtime state, so they are held to what the controls allow
+    MixerCommand mixerCommand;
+    if(!qIsFinite(value) || !decodeCommand(address, value, &mixerCommand)) {
+        return;
+    }
+    mixerCommand.clampValue();
+
+    // The controls follow what the engine has taken over. If the user interface does not keep up,
+    // it misses the change, but the audio does not.
+    if(_mixerEngine->pushCommand(mixerCommand)) {
+        _controlQueue.push(mixerCommand);
+    }
+}
+
+bool OscServer::decodeCommand(const QByteArray& address, float value, MixerCommand *mixerCommand) const
+{
+    QList<QByteArray> parts = address.split('/');
+    if(parts.size() < 4 || !parts.at(0).isEmpty()) {
+        return false;
+    }
+
+    bool ok;
+    mixerCommand->index = parts.at(2).toInt(&ok) - 1;
+    mixerCommand->pair = 0;
+    mixerCommand->value = value;
+    if(!ok) {
+        return false;
+    }
+
+    const QByteArray& section = parts.at(1);
+    QByteArray parameter = address.mid(section.size() + parts.at(2).size() + 3);
+    if(section == "ch") {
+        if(parts.size() == 5 && parts.at(3) == "pair") {
+            mixerCommand->type = MixerCommand::ChannelInSubgroupPair;
+            mixerCommand->pair = parts.at(4).toInt(&ok) - 1;
+            return ok;
+        }
+        if(!_channelCommands.contains(parameter)) {
+            return false;
+        }
+        mixerCommand->type = _channelCommands.value(parameter);
+        return true;
+    }
+
+    if(section == "sg") {
+        if(parameter == "gain") {
+            mixerCommand->type = MixerCommand::SubgroupGain;
+        } else if(parameter == "mute") {
+            mixerCommand->type = MixerCommand::SubgroupMuted;
+        } else if(parameter == "solo") {
+            mixerCommand->type = MixerCommand::SubgroupSoloed;
+        } else if(parameter == "main") {
+            mixerCommand->type = MixerCommand::SubgroupOnMain;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    if(section == "main") {
+        if(parameter == "gain") {
+            mixerCommand->type = MixerCommand::MainGain;
+        } else if(parameter == "mute") {
+            mixerCommand->type = MixerCommand::MainMuted;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void OscServer::subscribe(const Subscriber& subscriber, bool subscribed)
+{
+    for(int i = 0; i < _subscribers.size(); i++) {
+        if(_subscribers.at(i).address == subscriber.address && _subscribers.at(i).port == subscriber.port) {
+            if(!subscribed) {
+                _subscribers.removeAt(i);
+            }
+            return;
+        }
+    }
+
+    if(subscribed && _subscribers.size() < MaximumSubscriberCount) {
+        _subscribers.append(subscriber);
+    }
+}
+
+void OscServer::sendMeters()
+{
+    // The ring has to be drained even without subscribers, or the engine stops publishing levels
+    MeterRing& meterRing = _mixerEngine->remoteMeterRing();
+    while(const MeterRecord *meterRecords = meterRing.peek()) {
+        _meterBank.accumulate(meterRecords);
+        meterRing.release();
+    }
+    _meterBank.update(_meterElapsedTimer.restart() / 1000.0);
+
+    if(_subscribers.isEmpty()) {
+        return;
+    }
+
+    QList<QByteArray> messages;
+    for(int i = 0; i < _mixerEngine->channelCount(); i++) {
+        messages.append(meterMessage(QString("/ch/%1/meter").arg(i + 1),
+                                     _meterBank.reading(_mixerEngine->channelMeterIndex(i))));
+    }
+    for(int i = 0; i < _mixerEngine->subgroupCount(); i++) {
+        messages.append(meterMessage(QString("/sg/%1/meter").arg(i + 1),
+                                     _meterBank.reading(_mixerEngine->subgroupMeterIndex(i))));
+    }
+    for(int i = 0; i < MixerState::MainCount; i++) {
+        messages.append(meterMessage(QString("/main/%1/meter").arg(i + 1),
+                                     _meterBank.reading(_mixerEngine->mainMeterIndex(i))));
+    }
+
+    foreach(Subscriber subscriber, _subscribers) {
+        foreach(QByteArray message, messages) {
+            _udpSocket->writeDatagram(message, subscriber.address, subscriber.port);
+        }
+    }
+}
+
+QByteArray OscServer::meterMessage(const QString& address, const MeterReading& meterReading) const
+{
+    QByteArray message;
+    appendString(message, address.toLatin1());
+    appendString(message, meterReading.clipped ? ",fffT" : ",fffF");
+    appendFloat(message, meterReading.peakDb);
+    appendFloat(message, meterReading.rmsDb);
+    appendFloat(message, meterReading.holdDb);
+    return message;
+}
@@ -0,0 +1,146 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef OSCSERVER_H
+#define OSCSERVER_H
+
+// Qt includes
+#include <QObject>
+#include <QHostAddress>
+#include <QUdpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QList>
+#include <QHash>
+
+// Own includes
+#include "mixerengine.h"
+#include "mixercommand.h"
+#include "waitfreequeue.h"
+#include "meterbank.h"
+
+/**
+ * Remote control of the mixer over OSC, on a thread of its own. Decoded
+ * commands go straight to the realtime thread through
+ * MixerEngine::pushCommand(), and to the user interface through
+ * controlQueue() so the controls can follow.
+ *
+ * Addresses, with channels, subgroups and mains counted from 1:
+ * /ch/N/gain, /ch/N/auxsend, /ch/N/auxreturn, /ch/N/fader (dB),
+ * /ch/N/pan (0 to 100), /ch/N/eq/lowfreq, /ch/N/eq/low, /ch/N/eq/midfreq,
+ * /ch/N/eq/mid, /ch/N/eq/high, /ch/N/eq, /ch/N/aux, /ch/N/insert,
+ * /ch/N/mute, /ch/N/solo, /ch/N/main, /ch/N/pair/P (subgroups 2P - 1 and 2P),
+ * /ch/N/gate, /ch/N/gate/threshold (dB), /ch/N/comp, /ch/N/comp/threshold (dB),
+ * /ch/N/comp/ratio,
+ * /sg/N/gain, /sg/N/mute, /sg/N/solo, /sg/N/main, /main/N/gain and
+ * /main/N/mute, each with one numeric or boolean argument. Arguments
+ * that are not finite are ignored, others are limited to the range of
+ * the control on the front panel.
+ *
+ * /meters/subscribe makes the server send /ch/N/meter, /sg/N/meter and
+ * /main/N/meter with peak, RMS and hold in dB and the clip indicator back
+ * to the sender, until it sends /meters/unsubscribe.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class OscServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum {
+        /** Commands that may be pending for the user interface. */
+        ControlQueueCapacity = 4096,
+        /** Interval of the meter messages in milliseconds. */
+        MeterInterval = 50,
+        /** Maximum number of meter subscribers. */
+        MaximumSubscriberCount = 16,
+        /** Bundles nested deeper than this are dropped. */
+        MaximumBundleDepth = 8
+    };
+
+    /**
+     * Constructor. The server is meant to be moved to a thread of its own
+     * and started there.
+     * @param mixerEngine Engine the commands are pushed to, not owned.
+     * @param address Local address to bind to.
+     * @param port UDP port to bind to.
+     */
+    OscServer(MixerEngine *mixerEngine, const QHostAddress& address, quint16 port);
+    /** Destructor */
+    ~OscServer();
+
+    /**
+     * @returns the commands that have been passed on to the engine, for
+     * the user interface thread to apply to the controls.
+     */
+    WaitFreeQueue<MixerCommand>& controlQueue();
+
+public slots:
+    /** Binds the socket and starts metering. Call from the thread of the server. */
+    void start();
+
+private slots:
+    /** Decodes all datagrams that have arrived. */
+    void readDatagrams();
+    /** Sends the current meter readings to all subscribers. */
+    void sendMeters();
+
+private:
+    /** A client meters are sent to. */
+    struct Subscriber {
+        QHostAddress address;
+        quint16 port;
+    };
+
+    /**
+     * Decodes a message or bundle.
+     * @param depth Number of bundles the packet is nested in.
+     */
+    void handlePacket(const QByteArray& packet, const Subscriber& sender, int depth);
+    /** Decodes a message and executes it. */
+    void handleMessage(const QByteArray& message, const Subscriber& sender);
+    /** Turns an address with a numeric argument into a command. @returns false, if unknown. */
+    bool decodeCommand(const QByteArray& address, float value, MixerCommand *mixerCommand) const;
+    /** Adds or removes a meter subscriber. */
+    void subscribe(const Subscriber& subscriber, bool subscribed);
+    /** Encodes a meter message. */
+    QByteArray meterMessage(const QString& address, const MeterReading& meterReading) const;
+
+    MixerEngine *_mixerEngine;
+    QHostAddress _address;
+    quint16 _port;
+    QUdpSocket *_udpSocket;
+
+    /** Channel parameters by the last part of their address. */
+    QHash<QByteArray, MixerCommand::Type> _channelCommands;
+
+    WaitFreeQueue<MixerCommand> _controlQueue;
+
+    /** Ballistics of the meters sent to the subscribers. */
+    MeterBank _meterBank;
+    QTimer _meterTimer;
+    QElapsedTimer _meterElapsedTimer;
+    QList<Subscriber> _subscribers;
+};
+
+#endif // OSCSERVER_H
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef REALTIMESWITCH_H
+#define REALTIMESWITCH_H
+
+// Qt includes
+#include <QAtomicInt>
+
+/**
+ * Switches a facility of the engine, like a recording, on and off from a
+ * control thread without holding off the realtime thread. Each time the
+ * facility is switched on, it gets a new session number, so the realtime
+ * thread tells a restart apart from a facility that has been on all along.
+ * The realtime thread picks up the session once at the start of each
+ * period. After switching off, the control thread must wait for the
+ * running period with ScratchArena::waitForCycle() before it releases what
+ * the session has been using.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class RealtimeSwitch
+{
+public:
+    RealtimeSwitch() :
+        _requestedSession(0),
+        _sessionCount(0),
+        _session(0) {
+    }
+
+    /** Starts a new session. Control thread only. */
+    void switchOn() {
+        if(++_sessionCount == 0) {
+            _sessionCount = 1;
+        }
+        _requestedSession.fetchAndStoreOrdered(_sessionCount);
+    }
+
+    /** Ends the running session, if any. Control thread only. */
+    void switchOff() {
+        _requestedSession.fetchAndStoreOrdered(0);
+    }
+
+    /** @returns true, if a session has been started and not ended yet. Control thread only. */
+    bool isRequested() const {
+        return _requestedSession.loadAcquire() != 0;
+    }
+
+    /**
+     * Takes over the most recently requested session. Realtime thread only.
+     * @returns true, if it differs from the one of the last period.
+     */
+    bool pickUp() {
+        int session = _requestedSession.loadAcquire();
+        if(session == _session) {
+            return false;
+        }
+        _session = session;
+        return true;
+    }
+
+    /** @returns true, if the realtime thread is in a session. Realtime thread only. */
+    bool isOn() const {
+        return _session != 0;
+    }
+
+private:
+    /** Session the control thread has asked for, 0 for off. */
+    QAtomicInt _requestedSession;
+    /** Number of sessions started so far. Owned by the control thread. */
+    int _sessionCount;
+    /** Session the realtime thread is in, 0 for off. Owned by the realtime thread. */
+    int _session;
+};
+
+#endif // REALTIMESWITCH_H
@@ -0,0 +1,439 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "routingkernel.h"
+
+// Standard includes
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ROUTINGKERNEL_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Scalar routing of the samples from begin to end, used by the generic
+ * kernel and for the remainder of the vectorized ones.
+ */
+template <typename Source, typename Accumulator>
+static Source routeRange(const Source *source, const RoutingTarget<Accumulator> *targets, int targetCount,
+                         int begin, int end, Source& energy, quint32& clips)
+{
+    Source peak = 0;
+    for(int i = begin; i < end; i++) {
+        Source sample = source[i];
+        for(int t = 0; t < targetCount; t++) {
+            targets[t].buffer[i] += (Accumulator)sample * (targets[t].gain + targets[t].gainStep * i);
+        }
+        Source magnitude = std::fabs(sample);
+        if(magnitude > peak) {
+            peak = magnitude;
+        }
+        if(magnitude >= 1) {
+            clips++;
+        }
+        energy += sample * sample;
+    }
+    return peak;
+}
+
+/** Accumulates the levels of one call into the meter record. */
+static inline void accumulate(MeterRecord *meterRecord, float peak, float energy, quint32 clips, int frames)
+{
+    if(peak > meterRecord->peak) {
+        meterRecord->peak = peak;
+    }
+    meterRecord->energy += energy;
+    meterRecord->frames += frames;
+    meterRecord->clips += clips;
+}
+
+template <typename Source, typename Accumulator>
+static float routeGeneric(const Source *source, const RoutingTarget<Accumulator> *targets, int targetCount, int frames,
+                          MeterRecord *meterRecord)
+{
+    Source energy = 0;
+    quint32 clips = 0;
+    float peak = routeRange(source, targets, targetCount, 0, frames, energy, clips);
+    accumulate(meterRecord, peak, energy, clips, frames);
+    return peak;
+}
+
+#ifdef ROUTINGKERNEL_X86
+
+/** @returns true, if any of the targets ramps its gain. */
+template <typename Accumulator>
+static inline bool hasGainSteps(const RoutingTarget<Accumulator> *targets, int targetCount)
+{
+    for(int t = 0; t < targetCount; t++) {
+        if(targets[t].gainStep != 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+__attribute__((target("sse2")))
+static float routeSSE2(const float *source, const RoutingTarget<float> *targets, int targetCount, int frames,
+                       MeterRecord *meterRecord)
+{
+    if(hasGainSteps(targets, targetCount)) {
+        return routeGeneric(source, targets, targetCount, frames, meterRecord);
+    }
+
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 fullScale = _mm_set1_ps(1.0f);
+    __m128 peaks = _mm_setzero_ps();
+    __m128 energies = _mm_setzero_ps();
+    quint32 clips = 0;
+
+    int i = 0;
+    for(; i + 4 <= frames; i += 4) {
+        __m128 samples = _mm_loadu_ps(source + i);
+        for(int t = 0; t < targetCount; t++) {
+            float *target = targets[t].buffer + i;
+            __m128 product = _mm_mul_ps(samples, _mm_set1_ps(targets[t].gain));
+            _mm_storeu_ps(target, _mm_add_ps(_mm_loadu_ps(target), product));
+        }
+        __m128 magnitudes = _mm_and_ps(samples, absMask);
+        peaks = _mm_max_ps(peaks, magnitudes);
+        energies = _mm_add_ps(energies, _mm_mul_ps(samples, samples));
+        clips += __builtin_popcount(_mm_movemask_ps(_mm_cmpge_ps(magnitudes, fullScale)));
+    }
+
+    float peakLanes[4];
+    float energyLanes[4];
+    _mm_storeu_ps(peakLanes, peaks);
+    _mm_storeu_ps(energyLanes, energies);
+    float energy = 0.0f;
+    float peak = routeRange(source, targets, targetCount, i, frames, energy, clips);
+    for(int lane = 0; lane < 4; lane++) {
+        peak = peakLanes[lane] > peak ? peakLanes[lane] : peak;
+        energy += energyLanes[lane];
+    }
+    accumulate(meterRecord, peak, energy, clips, frames);
+    return peak;
+}
+
+__attribute__((target("avx2")))
+static float routeAVX2(const float *source, const RoutingTarget<float> *targets, int targetCount, int frames,
+                       MeterRecord *meterRecord)
+{
+    if(hasGainSteps(targets, targetCount)) {
+        return routeGeneric(source, targets, targetCount, frames, meterRecord);
+    }
+
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 fullScale = _mm256_set1_ps(1.0f);
+    __m256 peaks = _mm256_setzero_ps();
+    __m256 energies = _mm256_setzero_ps();
+    quint32 clips = 0;
+
+    int i = 0;
+    for(; i + 8 <= frames; i += 8) {
+        __m256 samples = _mm256_loadu_ps(source + i);
+        for(int t = 0; t < targetCount; t++) {
+            float *target = targets[t].buffer + i;
+            __m256 product = _mm256_mul_ps(samples, _mm256_set1_ps(targets[t].gain));
+            _mm256_storeu_ps(target, _mm256_add_ps(_mm256_loadu_ps(target), product));
+        }
+        __m256 magnitudes = _mm256_and_ps(samples, absMask);
+        peaks = _mm256_max_ps(peaks, magnitudes);
+        energies = _mm256_add_ps(energies, _mm256_mul_ps(samples, samples));
+        clips += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(magnitudes, fullScale, _CMP_GE_OQ)));
+    }
+
+    float peakLanes[8];
+    float energyLanes[8];
+    _mm256_storeu_ps(peakLanes, peaks);
+    _mm256_storeu_ps(energyLanes, energies);
+    float energy = 0.0f;
+    float peak = routeRange(source, targets, targetCount, i, frames, energy, clips);
+    for(int lane = 0; lane < 8; lane++) {
+        peak = peakLanes[lane] > peak ? peakLanes[lane] : peak;
+        energy += energyLanes[lane];
+    }
+    accumulate(meterRecord, peak, energy, clips, frames);
+    return peak;
+}
+
+__attribute__((target("avx512f")))
+static float routeAVX512(const float *source, const RoutingTarget<float> *targets, int targetCount, int frames,
+                         MeterRecord *meterRecord)
+{
+    if(hasGainSteps(targets, targetCount)) {
+        return routeGeneric(source, targets, targetCount, frames, meterRecord);
+    }
+
+    const __m512 fullScale = _mm512_set1_ps(1.0f);
+    __m512 peaks = _mm512_setzero_ps();
+    __m512 energies = _mm512_setzero_ps();
+    quint32 clips = 0;
+
+    int i = 0;
+    for(; i + 16 <= frames; i += 16) {
+        __m512 samples = _mm512_loadu_ps(source + i);
+        for(int t = 0; t < targetCount; t++) {
+            float *target = targets[t].buffer + i;
+            __m512 product = _mm512_mul_ps(samples, _mm512_set1_ps(targets[t].gain));
+            _mm512_storeu_ps(target, _mm512_add_ps(_mm512_loadu_ps(target), product));
+        }
+        __m512 magnitudes = _mm512_abs_ps(samples);
+        peaks = _mm512_max_ps(peaks, magnitudes);
+        energies = _mm512_add_ps(energies, _mm512_mul_ps(samples, samples));
+        clips += __builtin_popcount(_mm512_cmp_ps_mask(magnitudes, fullScale, _CMP_GE_OQ));
+    }
+
+    float energy = _mm512_reduce_add_ps(energies);
+    float peak = routeRange(source, targets, targetCount, i, frames, energy, clips);
+    float vectorPeak = _mm512_reduce_max_ps(peaks);
+    peak = vectorPeak > peak ? vectorPeak : peak;
+    accumulate(meterRecord, peak, energy, clips, frames);
+    return peak;
+}
+
+/** Loads four samples as two pairs of doubles. */
+__attribute__((target("sse2")))
+static inline void loadSSE2(const float *source, __m128d& low, __m128d& high)
+{
+    __m128 samples = _mm_loadu_ps(source);
+    low = _mm_cvtps_pd(samples);
+    high = _mm_cvtps_pd(_mm_movehl_ps(samples, samples));
+}
+
+__attribute__((target("sse2")))
+static inline void loadSSE2(const double *source, __m128d& low, __m128d& high)
+{
+    low = _mm_loadu_pd(source);
+    high = _mm_loadu_pd(source + 2);
+}
+
+/** Accumulates a pair of samples into a double bus and meters them. */
+__attribute__((target("sse2")))
+static inline void routeSSE2Pair(__m128d samples, const RoutingTarget<double> *targets, int targetCount, int i,
+                                 __m128d& peaks, __m128d& energies, quint32& clips)
+{
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    for(int t = 0; t < targetCount; t++) {
+        double *target = targets[t].buffer + i;
+        __m128d product = _mm_mul_pd(samples, _mm_set1_pd(targets[t].gain));
+        _mm_storeu_pd(target, _mm_add_pd(_mm_loadu_pd(target), product));
+    }
+    __m128d magnitudes = _mm_andnot_pd(signMask, samples);
+    peaks = _mm_max_pd(peaks, magnitudes);
+    energies = _mm_add_pd(energies, _mm_mul_pd(samples, samples));
+    clips += __builtin_popcount(_mm_movemask_pd(_mm_cmpge_pd(magnitudes, _mm_set1_pd(1.0))));
+}
+
+template <typename Source>
+__attribute__((target("sse2")))
+static float routeSSE2Double(const Source *source, const RoutingTarget<double> *targets, int targetCount, int frames,
+                             MeterRecord *meterRecord)
+{
+    if(hasGainSteps(targets, targetCount)) {
+        return routeGeneric(source, targets, targetCount, frames, meterRecord);
+    }
+
+    __m128d peaks = _mm_setzero_pd();
+    __m128d energies = _mm_setzero_pd();
+    quint32 clips = 0;
+
+    int i = 0;
+    for(; i + 4 <= frames; i += 4) {
+        __m128d low;
+        __m128d high;
+        loadSSE2(source + i, low, high);
+        routeSSE2Pair(low, targets, targetCount, i, peaks, energies, clips);
+        routeSSE2Pair(high, targets, targetCount, i + 2, peaks, energies, clips);
+    }
+
+    double peakLanes[2];
+    double energyLanes[2];
+    _mm_storeu_pd(peakLanes, peaks);
+    _mm_storeu_pd(energyLanes, energies);
+    Source energy = 0;
+    Source peak = routeRange(source, targets, targetCount, i, frames, energy, clips);
+    for(int lane = 0; lane < 2; lane++) {
+        peak = peakLanes[lane] > peak ? peakLanes[lane] : peak;
+        energy += energyLanes[lane];
+    }
+    accumulate(meterRecord, peak, energy, clips, frames);
+    return peak;
+}
+
+/** Loads eight samples as two quadruples of doubles. */
+__attribute__((target("avx2")))
+static inline void loadAVX2(const float *source, __m256d& low, __m256d& high)
+{
+    low = _mm256_cvtps_pd(_mm_loadu_ps(source));
+    high = _mm256_cvtps_pd(_mm_loadu_ps(source + 4));
+}
+
+__attribute__((target("avx2")))
+static inline void loadAVX2(const double *source, __m256d& low, __m256d& high)
+{
+    low = _mm256_loadu_pd(source);
+    high = _mm256_loadu_pd(source + 4);
+}
+
+/** Accumulates four samples into a double bus and meters them. */
+__attribute__((target("avx2")))
+static inline void routeAVX2Quad(__m256d samples, const RoutingTarget<double> *targets, int targetCount, int i,
+                                 __m256d& peaks, __m256d& energies, quint32& clips)
+{
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    for(int t = 0; t < targetCount; t++) {
+        double *target = targets[t].buffer + i;
+        __m256d product = _mm256_mul_pd(samples, _mm256_set1_pd(targets[t].gain));
+        _mm256_storeu_pd(target, _mm256_add_pd(_mm256_loadu_pd(target), product));
+    }
+    __m256d magnitudes = _mm256_andnot_pd(signMask, samples);
+    peaks = _mm256_max_pd(peaks, magnitudes);
+    energies = _mm256_add_pd(energies, _mm256_mul_pd(samples, samples));
+    clips += __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(magnitudes, _mm256_set1_pd(1.0), _CMP_GE_OQ)));
+}
+
+template <typename Source>
+__attribute__((target("avx2")))
+static float routeAVX2Double(const Source *source, const RoutingTarget<double> *targets, int targetCount, int frames,
+                             MeterRecord *meterRecord)
+{
+    if(hasGainSteps(targets, targetCount)) {
+        return routeGeneric(source, targets, targetCount, frames, meterRecord);
+    }
+
+    __m256d peaks = _mm256_setzero_pd();
+    __m256d energies = _mm256_setzero_pd();
+    quint32 clips = 0;
+
+    int i = 0;
+    for(; i + 8 <= frames; i += 8) {
+        __m256d low;
+        __m256d high;
+        loadAVX2(source + i, low, high);
+        routeAVX2Quad(low, targets, targetCount, i, peaks, energies, clips);
+        routeAVX2Quad(high, targets, targetCount, i + 4, peaks, energies, clips);
+    }
+
+    double peakLanes[4];
+    double energyLanes[4];
+    _mm256_storeu_pd(peakLanes, peaks);
+    _mm256_storeu_pd(energyLanes, energies);
+    Source energy = 0;
+    Source peak = routeRange(source, targets, targetCount, i, frames, energy, clips);
+    for(int lane = 0; lane < 4; lane++) {
+        peak = peakLanes[lane] > peak ? peakLanes[lane] : peak;
+        energy += energyLanes[lane];
+    }
+    accumulate(meterRecord, peak, energy, clips, frames);
+    return peak;
+}
+
+#endif // ROUTINGKERNEL_X86
+
+/** Selects the float bus kernels. */
+static RoutingKernel<float, float>::Function selectFunction(RoutingKernelBase::InstructionSet instructionSet,
+                                                            const float*, float*)
+{
+#ifdef ROUTINGKERNEL_X86
+    switch(instructionSet) {
+    case RoutingKernelBase::Generic:
+        return &routeGeneric<float, float>;
+    case RoutingKernelBase::SSE2:
+        return __builtin_cpu_supports("sse2") ? &routeSSE2 : 0;
+    case RoutingKernelBase::AVX2:
+        return __builtin_cpu_supports("avx2") ? &routeAVX2 : 0;
+    case RoutingKernelBase::AVX512:
+        return __builtin_cpu_supports("avx512f") ? &routeAVX512 : 0;
+    }
+    return 0;
+#else
+    return instructionSet == RoutingKernelBase::Generic ? &routeGeneric<float, float> : 0;
+#endif
+}
+
+/** Selects the double bus kernels, for float channels as well as double buses as the source. */
+template <typename Source>
+static typename RoutingKernel<Source, double>::Function selectFunction(RoutingKernelBase::InstructionSet instructionSet,
+                                                                       const Source*, double*)
+{
+#ifdef ROUTINGKERNEL_X86
+    switch(instructionSet) {
+    case RoutingKernelBase::Generic:
+        return &routeGeneric<Source, double>;
+    case RoutingKernelBase::SSE2:
+        return __builtin_cpu_supports("sse2") ? &routeSSE2Double<Source> : 0;
+    case RoutingKernelBase::AVX2:
+        return __builtin_cpu_supports("avx2") ? &routeAVX2Double<Source> : 0;
+    case RoutingKernelBase::AVX512:
+        return 0;
+    }
+    return 0;
+#else
+    return instructionSet == RoutingKernelBase::Generic ? &routeGeneric<Source, double> : 0;
+#endif
+}
+
+template <typename Source, typename Accumulator>
+typename RoutingKernel<Source, Accumulator>::Function RoutingKernel<Source, Accumulator>::function()
+{
+    static Function bestFunction = function(bestInstructionSet());
+    return bestFunction;
+}
+
+template <typename Source, typename Accumulator>
+typename RoutingKernel<Source, Accumulator>::Function RoutingKernel<Source, Accumulator>::function(InstructionSet instructionSet)
+{
+    return selectFunction(instructionSet, (const Source*)0, (Accumulator*)0);
+}
+
+template <typename Source, typename Accumulator>
+RoutingKernelBase::InstructionSet RoutingKernel<Source, Accumulator>::bestInstructionSet()
+{
+    if(function(AVX512)) {
+        return AVX512;
+    }
+    if(function(AVX2)) {
+        return AVX2;
+    }
+    if(function(SSE2)) {
+        return SSE2;
+    }
+    return Generic;
+}
+
+template class RoutingKernel<float, float>;
+template class RoutingKernel<float, double>;
+template class RoutingKernel<double, double>;
+
+const char *RoutingKernelBase::name(InstructionSet instructionSet)
+{
+    switch(instructionSet) {
+    case Generic:   return "Generic";
+    case SSE2:      return "SSE2";
+    case AVX2:      return "AVX2";
+    case AVX512:    return "AVX-512";
+    }
+    return "Unknown";
+}
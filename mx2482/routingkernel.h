@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ROUTINGKERNEL_H
+#define ROUTINGKERNEL_H
+
+// Own includes
+#include "meterring.h"
+
+/** A bus a signal is accumulated into, with the gain to apply. */
+template <typename Accumulator>
+struct RoutingTarget
+{
+    Accumulator *buffer;
+    /** Gain at the first frame. */
+    float gain;
+    /** Change of the gain per frame, for crossfades. Usually 0. */
+    float gainStep;
+};
+
+/**
+ * Instruction sets the routing kernels are available for, shared by all
+ * sample types.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class RoutingKernelBase
+{
+public:
+    enum InstructionSet {
+        Generic,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    /** @returns a readable name for the instruction set. */
+    static const char *name(InstructionSet instructionSet);
+};
+
+/**
+ * Fused routing kernel: reads a source buffer once and accumulates it into
+ * any number of target buses, each with its own gain, while metering peak,
+ * energy and clipping of the source in the same pass. Variants for SSE2,
+ * AVX2 and AVX-512 are selected at runtime depending on the CPU. Targets
+ * with a gain step are rare and always routed by the generic variant.
+ *
+ * Source is the sample type of the routed signal, Accumulator the one of
+ * the buses. Kernels exist for float into float, float into double and
+ * double into double. Accumulating in double keeps the rounding error of
+ * large sums below the resolution of the float output. There is no AVX-512
+ * variant for double buses.
+ *
+ * All variants use separate multiplies and adds instead of fused
+ * multiply-add, so they produce bit-identical bus signals. This relies on
+ * building with -ffp-contract=off, otherwise the compiler fuses them in
+ * the variants for CPUs with FMA. The energy may differ in the last bits,
+ * since it is summed in a different order.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+template <typename Source, typename Accumulator>
+class RoutingKernel : public RoutingKernelBase
+{
+public:
+    /**
+     * Kernel function type.
+     * @param source Buffer to be routed, it will not be altered.
+     * @param targets Buses to accumulate into.
+     * @param targetCount Number of targets, may be zero to only determine the peak.
+     * @param frames Number of samples in all buffers.
+     * @param meterRecord Record the levels of source are accumulated into.
+     * @returns the absolute peak value of source.
+     */
+    typedef float (*Function)(const Source *source, const RoutingTarget<Accumulator> *targets, int targetCount,
+                              int frames, MeterRecord *meterRecord);
+
+    /** @returns the fastest kernel supported by this CPU. */
+    static Function function();
+
+    /** @returns the kernel for the given instruction set, or 0 if this CPU does not support it. */
+    static Function function(InstructionSet instructionSet);
+
+    /** @returns the fastest instruction set supported by this CPU. */
+    static InstructionSet bestInstructionSet();
+};
+
+#endif // ROUTINGKERNEL_H
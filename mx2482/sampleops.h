@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SAMPLEOPS_H
+#define SAMPLEOPS_H
+
+// QJackAudio includes
+#include <QSampleBuffer>
+
+// Standard includes
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#endif
+
+/**
+ * Sample type the subgroup and main buses are summed in. Channel strips
+ * always process in float. Building with CONFIG+=double_buses defines
+ * MX2482_DOUBLE_BUSES and sums in double, so adding many hot channels does
+ * not build up rounding error.
+ */
+#ifdef MX2482_DOUBLE_BUSES
+typedef double BusSample;
+#else
+typedef float BusSample;
+#endif
+
+/**
+ * Makes the calling thread flush denormal numbers to zero. Decaying filter
+ * states would otherwise slow down the processing considerably.
+ */
+inline void enableFlushToZero()
+{
+#if defined(__SSE__) || defined(__x86_64__)
+    // Flush to zero (bit 15) and denormals are zero (bit 6)
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+#endif
+}
+
+/** Copies frames samples from a JACK sample buffer into memory. */
+inline void readSamples(QSampleBuffer source, float *target, int frames)
+{
+    for(int i = 0; i < frames; i++) {
+        target[i] = source.readAudio(i);
+    }
+}
+
+/** Copies frames samples from memory into a JACK sample buffer. */
+inline void writeSamples(const float *source, QSampleBuffer target, int frames)
+{
+    for(int i = 0; i < frames; i++) {
+        target.writeAudio(i, source[i]);
+    }
+}
+
+/**
+ * @returns frames samples as float. Float samples are returned as they
+ * are, anything else is converted into scratch.
+ */
+inline const float *floatSamples(const float *samples, float *scratch, int frames)
+{
+    Q_UNUSED(scratch);
+    Q_UNUSED(frames);
+    return samples;
+}
+
+inline const float *floatSamples(const double *samples, float *scratch, int frames)
+{
+    for(int i = 0; i < frames; i++) {
+        scratch[i] = (float)samples[i];
+    }
+    return scratch;
+}
+
+/** Sets frames samples to zero. */
+template <typename Sample>
+inline void clearSamples(Sample *samples, int frames)
+{
+    memset(samples, 0, frames * sizeof(Sample));
+}
+
+/** Multiplies frames samples by the linear factor gain. */
+template <typename Sample>
+inline void applyGain(Sample *samples, int frames, float gain)
+{
+    for(int i = 0; i < frames; i++) {
+        samples[i] *= gain;
+    }
+}
+
+/**
+ * Multiplies frames samples by a gain that moves linearly from
+ * previousGain to gain over the first rampFrames samples and stays at gain
+ * for the rest.
+ */
+template <typename Sample>
+inline void applyGainRamp(Sample *samples, int frames, float previousGain, float gain, int rampFrames)
+{
+    if(rampFrames <= 0 || previousGain == gain) {
+        applyGain(samples, frames, gain);
+        return;
+    }
+
+    float gainStep = (gain - previousGain) / rampFrames;
+    for(int i = 0; i < rampFrames; i++) {
+        samples[i] *= previousGain + gainStep * i;
+    }
+    applyGain(samples + rampFrames, frames - rampFrames, gain);
+}
+
+/**
+ * Progress of a crossfade between two mixer state snapshots within one
+ * period. Each parameter moves linearly from where it is towards its new
+ * value and arrives there when the crossfade ends, no matter in which
+ * period that happens.
+ */
+struct CrossfadeStep
+{
+    CrossfadeStep() : frames(0), remainingFrames(0) { }
+
+    /** Number of frames at the start of this period that are part of the crossfade. */
+    int frames;
+    /** Number of frames left in the crossfade at the start of this period. */
+    int remainingFrames;
+
+    /** @returns the value a parameter reaches at the end of the crossfade frames of this period. */
+    float advance(float value, float target) const {
+        if(remainingFrames <= frames) {
+            return target;
+        }
+        return value + (target - value) * frames / remainingFrames;
+    }
+
+    /**
+     * Multiplies sampleCount samples by a gain that follows the crossfade from
+     * gain towards target, and updates gain to where it has arrived.
+     */
+    template <typename Sample>
+    void applyGain(Sample *samples, int sampleCount, float& gain, float target) const {
+        float nextGain = advance(gain, target);
+        applyGainRamp(samples, sampleCount, gain, nextGain, frames);
+        gain = nextGain;
+    }
+};
+
+/** Adds frames samples from source, multiplied by gain, to target. */
+inline void addSamples(const float *source, float *target, int frames, float gain = 1.0f)
+{
+    for(int i = 0; i < frames; i++) {
+        target[i] += source[i] * gain;
+    }
+}
+
+/**
+ * @returns true, if no sample exceeds threshold in magnitude. With a
+ * threshold of 0, this checks for digital silence.
+ */
+inline bool isSilent(const float *samples, int frames, float threshold)
+{
+    for(int i = 0; i < frames; i++) {
+        if(std::fabs(samples[i]) > threshold) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // SAMPLEOPS_H
@@ -0,0 +1,192 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SAMPLERING_H
+#define SAMPLERING_H
+
+// Qt includes
+#include <QAtomicInteger>
+
+// Own includes
+#include "waitfreering.h"
+
+// Standard includes
+#include <cstring>
+
+/**
+ * Wait-free single producer, single consumer ring of mono samples, to
+ * stream audio between the realtime thread and a disk thread in either
+ * direction. When the ring is full, the writer drops what it appends and
+ * replaces it by silence as soon as there is space again, so the ring
+ * keeps its timeline and stays in sync with rings written in the same
+ * periods. When the ring runs empty, the reader gets silence.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class SampleRing
+{
+public:
+    /**
+     * Constructor.
+     * @param capacity Number of samples, must be a power of two.
+     */
+    explicit SampleRing(int capacity) :
+        _ring(capacity),
+        _pendingSilence(0),
+        _droppedFrames(0),
+        _missedFrames(0) {
+    }
+
+    /** @returns the number of samples the ring holds at most. */
+    int capacity() const {
+        return _ring.capacity();
+    }
+
+    /**
+     * Writer only. Appends frames samples, or silence if samples is 0.
+     * @returns false, if they did not fit. They have been counted as
+     * dropped then and will be replaced by silence.
+     */
+    bool write(const float *samples, int frames) {
+        int space = _ring.writeAvailable();
+
+        // Make up for dropped periods first, so everything after them stays in place
+        if(_pendingSilence > 0) {
+            int silentFrames = qMin(_pendingSilence, space);
+            append(0, silentFrames);
+            space -= silentFrames;
+            _pendingSilence -= silentFrames;
+        }
+
+        bool fits = _pendingSilence == 0 && frames <= space;
+        if(fits) {
+            append(samples, frames);
+        } else {
+            _pendingSilence += frames;
+            _droppedFrames.storeRelease(_droppedFrames.loadAcquire() + frames);
+        }
+        return fits;
+    }
+
+    /** Writer only. @returns the number of samples that can be written without dropping any. */
+    int writeAvailable() const {
+        return _ring.writeAvailable() - _pendingSilence;
+    }
+
+    /** Reader only. @returns the number of samples that can be read. */
+    int readAvailable() const {
+        return _ring.readAvailable();
+    }
+
+    /**
+     * Reader only.
+     * @param frames Set to the number of contiguous samples at the returned
+     * address, which may be less than readAvailable() at the end of the ring.
+     * @returns the oldest unread samples. They stay valid until release() is called.
+     */
+    const float *peek(int& frames) const {
+        frames = qMin(_ring.readAvailable(), _ring.readContiguous());
+        return _ring.readSlot();
+    }
+
+    /** Reader only. Hands frames samples returned by peek() back to the writer. */
+    void release(int frames) {
+        _ring.commitRead(frames);
+    }
+
+    /**
+     * Reader only. Copies frames samples out of the ring. What is missing
+     * is filled with silence and counted as missed.
+     * @returns the number of samples that have actually been read.
+     */
+    int read(float *samples, int frames) {
+        int readFrames = 0;
+        while(readFrames < frames) {
+            int contiguousFrames;
+            const float *source = peek(contiguousFrames);
+            contiguousFrames = qMin(contiguousFrames, frames - readFrames);
+            if(contiguousFrames == 0) {
+                break;
+            }
+            memcpy(samples + readFrames, source, contiguousFrames * sizeof(float));
+            release(contiguousFrames);
+            readFrames += contiguousFrames;
+        }
+        if(readFrames < frames) {
+            memset(samples + readFrames, 0, (frames - readFrames) * sizeof(float));
+            _missedFrames.storeRelease(_missedFrames.loadAcquire() + frames - readFrames);
+        }
+        return readFrames;
+    }
+
+    /**
+     * @returns the number of frames that have been dropped, because the
+     * reader lagged behind. Safe to call from any thread.
+     */
+    qint64 droppedFrames() const {
+        return _droppedFrames.loadAcquire();
+    }
+
+    /**
+     * @returns the number of frames the reader has missed, because the
+     * writer lagged behind. Safe to call from any thread.
+     */
+    qint64 missedFrames() const {
+        return _missedFrames.loadAcquire();
+    }
+
+    /** Empties the ring. Neither reader nor writer may be active. */
+    void reset() {
+        _ring.reset();
+        _pendingSilence = 0;
+        _droppedFrames.storeRelease(0);
+        _missedFrames.storeRelease(0);
+    }
+
+private:
+    /** Appends frames samples, or silence if samples is 0, wrapping around the end. */
+    void append(const float *samples, int frames) {
+        int firstFrames = qMin(frames, _ring.writeContiguous());
+        float *first = _ring.writeSlot();
+        float *second = _ring.writeSlot(firstFrames);
+        if(samples) {
+            memcpy(first, samples, firstFrames * sizeof(float));
+            memcpy(second, samples + firstFrames, (frames - firstFrames) * sizeof(float));
+        } else {
+            memset(first, 0, firstFrames * sizeof(float));
+            memset(second, 0, (frames - firstFrames) * sizeof(float));
+        }
+        _ring.commitWrite(frames);
+    }
+
+    /** One sample in each slot. */
+    WaitFreeRing<float> _ring;
+
+    /** Writer only. Frames of silence still owed for dropped periods. */
+    int _pendingSilence;
+    /** Total number of frames dropped by the writer. */
+    QAtomicInteger<qint64> _droppedFrames;
+    /** Total number of frames missed by the reader. */
+    QAtomicInteger<qint64> _missedFrames;
+};
+
+#endif // SAMPLERING_H
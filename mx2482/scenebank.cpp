@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "scenebank.h"
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+
+SceneBank::SceneBank(int channelCount, int subgroupCount) :
+    _channelCount(channelCount),
+    _subgroupCount(subgroupCount)
+{
+}
+
+int SceneBank::addScene(const QString& name, const QJsonObject& jsonObject, double sampleRate)
+{
+    Scene scene;
+    scene.name = name;
+    scene.jsonObject = jsonObject;
+    scene.mixerState = MixerState::fromJson(jsonObject, _channelCount, _subgroupCount, sampleRate);
+    _scenes.append(scene);
+    return _scenes.size() - 1;
+}
+
+int SceneBank::loadDirectory(const QString& path, double sampleRate)
+{
+    QDir directory(path);
+    QFileInfoList fileInfos = directory.entryInfoList(QStringList() << "*.mx2482", QDir::Files, QDir::Name);
+
+    int sceneCount = 0;
+    foreach(QFileInfo fileInfo, fileInfos) {
+        QFile file(fileInfo.absoluteFilePath());
+        if(!file.open(QIODevice::ReadOnly)) {
+            qWarning("Could not open scene for read: %s", qPrintable(fileInfo.absoluteFilePath()));
+            continue;
+        }
+
+        QJsonDocument jsonDocument = QJsonDocument::fromJson(file.readAll());
+        file.close();
+        if(!jsonDocument.isObject()) {
+            qWarning("Not a valid scene: %s", qPrintable(fileInfo.absoluteFilePath()));
+            continue;
+        }
+
+        addScene(fileInfo.completeBaseName(), jsonDocument.object(), sampleRate);
+        sceneCount++;
+    }
+    return sceneCount;
+}
+
+void SceneBank::clear()
+{
+    _scenes.clear();
+}
+
+int SceneBank::sceneCount() const
+{
+    return _scenes.size();
+}
+
+const SceneBank::Scene& SceneBank::scene(int i) const
+{
+    return _scenes.at(i);
+}
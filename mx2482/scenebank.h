@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SCENEBANK_H
+#define SCENEBANK_H
+
+// Qt includes
+#include <QString>
+#include <QJsonObject>
+#include <QVector>
+
+// Own includes
+#include "mixerstate.h"
+
+/**
+ * A list of scenes that have been parsed in advance, so recalling one of
+ * them does not involve any file access or parsing. Each scene keeps its
+ * JSON state for the controls along with the mixer state snapshot that is
+ * handed over to the engine as is.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class SceneBank
+{
+public:
+    /** A parsed scene. */
+    struct Scene {
+        /** Name of the scene, the file name without extension. */
+        QString name;
+        /** State for the controls. */
+        QJsonObject jsonObject;
+        /** Snapshot for the engine. */
+        MixerState mixerState;
+    };
+
+    /**
+     * Constructor.
+     * @param channelCount Number of channels the snapshots are parsed for.
+     * @param subgroupCount Number of subgroups the snapshots are parsed for.
+     */
+    SceneBank(int channelCount, int subgroupCount);
+
+    /**
+     * Parses a scene and appends it to the bank.
+     * @returns the index of the scene.
+     */
+    int addScene(const QString& name, const QJsonObject& jsonObject, double sampleRate);
+
+    /**
+     * Parses all state files of a directory in the order of their names
+     * and appends them to the bank. Files that cannot be read are skipped.
+     * @returns the number of scenes that have been added.
+     */
+    int loadDirectory(const QString& path, double sampleRate);
+
+    /** Removes all scenes. */
+    void clear();
+
+    /** @returns the number of scenes. */
+    int sceneCount() const;
+
+    /** @returns scene i, starting at 0. */
+    const Scene& scene(int i) const;
+
+private:
+    int _channelCount;
+    int _subgroupCount;
+    QVector<Scene> _scenes;
+};
+
+#endif // SCENEBANK_H
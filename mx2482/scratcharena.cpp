@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "scratcharena.h"
+
+// Qt includes
+#include <QThread>
+
+// Standard includes
+#include <cstring>
+
+ScratchArena::ScratchArena(int bufferCount, int busBufferCount) :
+    _bufferCount(bufferCount),
+    _busBufferCount(busBufferCount),
+    _frames(0),
+    _stride(0),
+    _memory(0),
+    _busMemory(0),
+    _inCycle(0),
+    _suspended(0),
+    _finishedCycles(0)
+{
+}
+
+ScratchArena::~ScratchArena()
+{
+    qFreeAligned(_memory);
+}
+
+void ScratchArena::resize(int frames)
+{
+    Q_ASSERT(_suspended.loadAcquire());
+
+    const int samplesPerLine = Alignment / sizeof(float);
+    int stride = ((frames + samplesPerLine - 1) / samplesPerLine) * samplesPerLine;
+    // The float buffers span whole cache lines, so the bus buffers after them are aligned as well
+    size_t floatBytes = (size_t)stride * _bufferCount * sizeof(float);
+    size_t bytes = floatBytes + (size_t)stride * _busBufferCount * sizeof(BusSample);
+
+    float *memory = (float*)qMallocAligned(bytes, Alignment);
+    if(!memory) {
+        qWarning("Could not allocate %d scratch buffers of %d frames.", _bufferCount + _busBufferCount, frames);
+        return;
+    }
+
+    // Touch all pages now, so the realtime thread does not page fault on them
+    memset(memory, 0, bytes);
+
+    qFreeAligned(_memory);
+    _memory = memory;
+    _busMemory = (BusSample*)((char*)memory + floatBytes);
+    _stride = stride;
+    _frames = frames;
+}
+
+void ScratchArena::suspend()
+{
+    _suspended.fetchAndAddOrdered(1);
+    while(_inCycle.fetchAndAddOrdered(0)) {
+        QThread::yieldCurrentThread();
+    }
+}
+
+void ScratchArena::resume()
+{
+    int suspended = _suspended.fetchAndAddOrdered(-1);
+    Q_ASSERT(suspended > 0);
+    Q_UNUSED(suspended);
+}
+
+void ScratchArena::waitForCycle()
+{
+    // A cycle that begins after this has read whatever has been changed before
+    int finishedCycles = _finishedCycles.fetchAndAddOrdered(0);
+    while(_inCycle.fetchAndAddOrdered(0) && _finishedCycles.fetchAndAddOrdered(0) == finishedCycles) {
+        QThread::yieldCurrentThread();
+    }
+}
+
+bool ScratchArena::beginCycle(int frames)
+{
+    _inCycle.fetchAndStoreOrdered(1);
+    if(_suspended.fetchAndAddOrdered(0) || frames != _frames) {
+        _inCycle.fetchAndStoreOrdered(0);
+        return false;
+    }
+    return true;
+}
+
+void ScratchArena::endCycle()
+{
+    _finishedCycles.fetchAndAddOrdered(1);
+    _inCycle.fetchAndStoreOrdered(0);
+}
+
+int ScratchArena::frames() const
+{
+    return _frames;
+}
+
+int ScratchArena::bufferCount() const
+{
+    return _bufferCount;
+}
+
+int ScratchArena::busBufferCount() const
+{
+    return _busBufferCount;
+}
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+// Own includes
+#include "sampleops.h"
+
+// Qt includes
+#include <QAtomicInt>
+
+/**
+ * Preallocated, cache-aligned scratch memory for the audio processing. The
+ * arena holds a fixed number of sample buffers with the size of one JACK
+ * period each, so the realtime thread never has to allocate. Float buffers
+ * come first, followed by the bus buffers in the bus sample type.
+ *
+ * Resizing happens outside of the realtime thread only. The realtime thread
+ * brackets each cycle with beginCycle() and endCycle(), while suspend()
+ * waits for a running cycle to finish and lets all following cycles be
+ * skipped until resume() is called. Suspending is counted, so several
+ * threads may suspend at once and cycles only run again after the last
+ * of them has resumed.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class ScratchArena
+{
+public:
+    enum {
+        /** Alignment of each buffer in bytes, matches a cache line. */
+        Alignment = 64
+    };
+
+    /**
+     * Constructor.
+     * @param bufferCount Number of float sample buffers in this arena.
+     * @param busBufferCount Number of bus sample buffers in this arena.
+     */
+    explicit ScratchArena(int bufferCount, int busBufferCount = 0);
+    /** Destructor */
+    ~ScratchArena();
+
+    /**
+     * Reallocates all buffers to hold the given number of frames. Must not
+     * be called from the realtime thread and only while suspended.
+     */
+    void resize(int frames);
+
+    /**
+     * Blocks until the current cycle, if any, has finished. All cycles
+     * started afterwards will be rejected until resume() has been called
+     * as often as suspend().
+     */
+    void suspend();
+
+    /** Allows cycles to run again, once each suspend() has been matched. */
+    void resume();
+
+    /**
+     * Blocks until the cycle running at the time of the call, if any, has
+     * finished. Unlike suspend(), the following cycles run as usual, so
+     * this is used to release what the realtime thread has been told to
+     * stop using.
+     */
+    void waitForCycle();
+
+    /**
+     * Marks the beginning of a cycle. Realtime thread only.
+     * @param frames Number of frames to be processed in this cycle.
+     * @returns false, if the arena is suspended or has not been sized for
+     * the given number of frames. In that case no buffer may be accessed
+     * and endCycle() must not be called.
+     */
+    bool beginCycle(int frames);
+
+    /** Marks the end of a cycle. Realtime thread only. */
+    void endCycle();
+
+    /** @returns the sample buffer with the given index. */
+    inline float *buffer(int index) {
+        return _memory + index * _stride;
+    }
+
+    /** @returns the bus buffer with the given index. */
+    inline BusSample *busBuffer(int index) {
+        return _busMemory + index * _stride;
+    }
+
+    /** @returns the number of frames each buffer can hold. */
+    int frames() const;
+
+    /** @returns the number of float buffers in this arena. */
+    int bufferCount() const;
+
+    /** @returns the number of bus buffers in this arena. */
+    int busBufferCount() const;
+
+private:
+    int _bufferCount;
+    int _busBufferCount;
+    int _frames;
+    /** Distance between two buffers in samples, padded to the alignment. */
+    int _stride;
+    float *_memory;
+    /** Start of the bus buffers, within the same block as the float buffers. */
+    BusSample *_busMemory;
+
+    /** Set while the realtime thread is inside a cycle. */
+    QAtomicInt _inCycle;
+    /** Number of pending suspend() calls, cycles only run while it is 0. */
+    QAtomicInt _suspended;
+    /** Number of cycles that have finished, to tell one cycle from the next. */
+    QAtomicInt _finishedCycles;
+};
+
+#endif // SCRATCHARENA_H
@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "stagetracer.h"
+
+// Qt includes
+#include <QThread>
+
+/** Number of times any tracer has been started, so threads know when to pick a new ring. */
+static QAtomicInt traceGeneration(0);
+
+StageTracer::StageTracer(int channelCount) :
+    _channelCount(channelCount),
+    _threadCount(0),
+    _channelTimes(channelCount * StageCount),
+    _droppedEvents(0),
+    _epoch(0),
+    _generation(0),
+    _firstEvent(true),
+    _tracing(false),
+    _quit(0)
+{
+}
+
+StageTracer::~StageTracer()
+{
+    stop();
+}
+
+bool StageTracer::start(const QString& fileName)
+{
+    stop();
+    _errorString.clear();
+
+    _file.setFileName(fileName);
+    if(!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        _errorString = QString("Could not open file for write: %1").arg(fileName);
+        return false;
+    }
+    _file.write("{\"traceEvents\":[\n");
+    _firstEvent = true;
+
+    for(int i = 0; i < MaximumThreadCount; i++) {
+        _eventRings.append(new WaitFreeQueue<TraceEvent>(RingCapacity));
+        _threadNamed[i] = false;
+    }
+    for(int i = 0; i < _channelTimes.size(); i++) {
+        _channelTimes[i].storeRelease(0);
+    }
+    _droppedEvents.storeRelease(0);
+    _threadCount.storeRelease(0);
+    _generation.storeRelease(traceGeneration.fetchAndAddOrdered(1) + 1);
+    _epoch = timestamp();
+
+    _quit.storeRelease(0);
+    if(pthread_create(&_thread, 0, &StageTracer::threadEntry, this) != 0) {
+        _errorString = "Could not create trace dump thread.";
+        _file.close();
+        qDeleteAll(_eventRings);
+        _eventRings.clear();
+        return false;
+    }
+    _tracing = true;
+    return true;
+}
+
+void StageTracer::stop()
+{
+    if(!_tracing) {
+        return;
+    }
+
+    _quit.storeRelease(1);
+    pthread_join(_thread, 0);
+    _tracing = false;
+
+    dumpEvents();
+    _file.write("\n]}\n");
+    _file.close();
+    qDeleteAll(_eventRings);
+    _eventRings.clear();
+}
+
+bool StageTracer::isTracing() const
+{
+    return _tracing;
+}
+
+void StageTracer::record(Stage stage, int index, quint64 begin)
+{
+    quint64 end = timestamp();
+
+    // Each thread takes a ring of its own the first time it records
+    static thread_local int threadGeneration = 0;
+    static thread_local int threadIndex = 0;
+    int generation = _generation.loadAcquire();
+    if(threadGeneration != generation) {
+        threadGeneration = generation;
+        threadIndex = _threadCount.fetchAndAddOrdered(1);
+    }
+
+    bool channelStage = stage == ChannelRouting || (stage >= ChannelInput && stage <= ChannelFader);
+    if(channelStage && index >= 0 && index < _channelCount) {
+        _channelTimes[index * StageCount + stage].fetchAndAddRelaxed(end - begin);
+    }
+
+    TraceEvent event = { begin - _epoch, (quint32)(end - begin), (quint16)stage, (qint16)index };
+    if(threadIndex >= MaximumThreadCount || !_eventRings.at(threadIndex)->push(event)) {
+        _droppedEvents.fetchAndAddRelaxed(1);
+    }
+}
+
+quint64 StageTracer::channelTime(int i, Stage stage) const
+{
+    return _channelTimes.at(i * StageCount + stage).loadAcquire();
+}
+
+quint64 StageTracer::channelTime(int i) const
+{
+    quint64 time = 0;
+    for(int stage = 0; stage < StageCount; stage++) {
+        time += _channelTimes.at(i * StageCount + stage).loadAcquire();
+    }
+    return time;
+}
+
+qint64 StageTracer::droppedEvents() const
+{
+    return _droppedEvents.loadAcquire();
+}
+
+const char *StageTracer::stageName(Stage stage)
+{
+    switch(stage) {
+    case Cycle:             return "cycle";
+    case ChannelInput:      return "input";
+    case ChannelEqualizer:  return "fft equalizer";
+    case ChannelInsert:     return "insert";
+    case ChannelAux:        return "aux";
+    case ChannelFader:      return "fader";
+    case Dynamics:          return "dynamics";
+    case BiquadEqualizer:   return "biquad equalizer";
+    case ChannelRouting:    return "routing";
+    case SubgroupBus:       return "subgroup";
+    case MainBus:           return "main";
+    case StageCount:        break;
+    }
+    return "unknown";
+}
+
+QString StageTracer::errorString() const
+{
+    return _errorString;
+}
+
+void *StageTracer::threadEntry(void *argument)
+{
+    StageTracer *stageTracer = static_cast<StageTracer*>(argument);
+    while(!stageTracer->_quit.loadAcquire()) {
+        stageTracer->dumpEvents();
+        QThread::msleep(DumpInterval);
+    }
+    return 0;
+}
+
+void StageTracer::dumpEvents()
+{
+    _dumpBuffer.clear();
+    int threadCount = qMin(_threadCount.loadAcquire(), (int)MaximumThreadCount);
+    for(int thread = 0; thread < threadCount; thread++) {
+        TraceEvent event;
+        while(_eventRings.at(thread)->pop(event)) {
+            if(!_firstEvent) {
+                _dumpBuffer.append(",\n");
+            }
+            _firstEvent = false;
+
+            // Name the thread along with its first event, threads are numbered in the order they came up
+            if(!_threadNamed[thread]) {
+                _dumpBuffer.append(QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,"
+                                           "\"args\":{\"name\":\"Audio thread %2\"}},\n")
+                                   .arg(thread + 1).arg(thread + 1).toUtf8());
+                _threadNamed[thread] = true;
+            }
+
+            // Timestamps are in microseconds. Indexes are shown starting at 1, like on the front panel.
+            Stage stage = (Stage)event.stage;
+            const char *category = "engine";
+            if(stage == SubgroupBus || stage == MainBus) {
+                category = "bus";
+            } else if(stage != Cycle) {
+                category = stage == Dynamics || stage == BiquadEqualizer ? "lanes" : "channel";
+            }
+            _dumpBuffer.append(QString("{\"name\":\"%1\",\"cat\":\"%2\",\"ph\":\"X\",\"pid\":1,\"tid\":%3,"
+                                       "\"ts\":%4,\"dur\":%5")
+                               .arg(stageName(stage))
+                               .arg(category)
+                               .arg(thread + 1)
+                               .arg(event.begin / 1000.0, 0, 'f', 3)
+                               .arg(event.duration / 1000.0, 0, 'f', 3)
+                               .toUtf8());
+            if(event.index >= 0) {
+                _dumpBuffer.append(QString(",\"args\":{\"index\":%1}").arg(event.index + 1).toUtf8());
+            }
+            _dumpBuffer.append("}");
+        }
+    }
+    if(!_dumpBuffer.isEmpty()) {
+        _file.write(_dumpBuffer);
+    }
+}
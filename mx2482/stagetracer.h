@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef STAGETRACER_H
+#define STAGETRACER_H
+
+// Qt includes
+#include <QVector>
+#include <QString>
+#include <QFile>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+// Own includes
+#include "waitfreequeue.h"
+
+// Standard includes
+#include <pthread.h>
+#include <time.h>
+
+/**
+ * A stage that has been processed on the realtime thread or a worker.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+struct TraceEvent
+{
+    /** Start, in nanoseconds since tracing has been started. */
+    quint64 begin;
+    /** Duration in nanoseconds. */
+    quint32 duration;
+    /** Stage, see StageTracer::Stage. */
+    quint16 stage;
+    /** Channel, subgroup, main or lane group, -1 for the whole engine. */
+    qint16 index;
+};
+
+/**
+ * Low-overhead tracing of the processing stages. Each thread that
+ * processes audio records its stages into a preallocated wait-free ring
+ * of its own. A dump thread drains the rings into a trace file in the
+ * Chrome trace event format, which chrome://tracing and Perfetto open.
+ * The time spent in each channel is summed up on the fly, so the user
+ * interface can show what each channel costs.
+ *
+ * When a ring is full, events are dropped. record() may be called from
+ * any number of threads, all other methods only from one thread.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class StageTracer
+{
+public:
+    /** Stages that are traced. */
+    enum Stage {
+        /** Whole period of the engine. */
+        Cycle,
+        /** Reading the input and applying the input gain of a channel. */
+        ChannelInput,
+        /** FFT equalizer of a channel. */
+        ChannelEqualizer,
+        /** Insert effect of a channel. */
+        ChannelInsert,
+        /** Aux send and return of a channel. */
+        ChannelAux,
+        /** Fader of a channel, including a direct out before the fader. */
+        ChannelFader,
+        /** Gate and compressor of a group of channels. */
+        Dynamics,
+        /** Biquad equalizer of a group of channels. */
+        BiquadEqualizer,
+        /** Summing a channel into the subgroups and main. */
+        ChannelRouting,
+        /** Gain and routing of a subgroup. */
+        SubgroupBus,
+        /** Gain of main left or right. */
+        MainBus,
+        StageCount
+    };
+
+    enum {
+        /** Threads that can record events, further threads are not traced. */
+        MaximumThreadCount = 16,
+        /** Events each thread can have pending. */
+        RingCapacity = 32768,
+        /** Time the dump thread waits between draining the rings, in milliseconds. */
+        DumpInterval = 50
+    };
+
+    /**
+     * Constructor.
+     * @param channelCount Number of channels to sum up the time for.
+     */
+    explicit StageTracer(int channelCount);
+    /** Destructor, stops tracing. */
+    ~StageTracer();
+
+    /**
+     * Creates the trace file and starts the dump thread.
+     * @returns true on success, otherwise errorString() tells why.
+     */
+    bool start(const QString& fileName);
+
+    /** Writes out all pending events, finishes the file and terminates the dump thread. */
+    void stop();
+
+    /** @returns true, if tracing has been started. */
+    bool isTracing() const;
+
+    /** @returns a monotonic timestamp in nanoseconds, cheap enough for the realtime thread. */
+    static quint64 timestamp() {
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return (quint64)time.tv_sec * 1000000000ULL + time.tv_nsec;
+    }
+
+    /**
+     * Records a stage that has run from begin until now. Realtime safe.
+     * @param index Channel, subgroup, main or lane group, -1 for none.
+     * @param begin Timestamp the stage has started at.
+     */
+    void record(Stage stage, int index, quint64 begin);
+
+    /**
+     * @returns the nanoseconds spent in a stage of channel i (starting at
+     * 0) since tracing has been started. Safe to call from any thread.
+     */
+    quint64 channelTime(int i, Stage stage) const;
+
+    /** @returns the nanoseconds spent in all stages of channel i. Safe to call from any thread. */
+    quint64 channelTime(int i) const;
+
+    /** @returns the number of events that have been dropped, because a ring was full. */
+    qint64 droppedEvents() const;
+
+    /** @returns the name of a stage, as it appears in the trace. */
+    static const char *stageName(Stage stage);
+
+    /** @returns a description of the last error. */
+    QString errorString() const;
+
+private:
+    static void *threadEntry(void *argument);
+
+    /** Writes all pending events to the trace file. */
+    void dumpEvents();
+
+    int _channelCount;
+
+    /** Ring of each thread, the index of a thread is assigned when it first records. */
+    QVector<WaitFreeQueue<TraceEvent>*> _eventRings;
+    /** Number of threads that have got a ring. */
+    QAtomicInt _threadCount;
+    /** Whether the name of a thread has been written to the trace. */
+    bool _threadNamed[MaximumThreadCount];
+
+    /** Time spent in each stage of each channel, channel after channel. */
+    QVector<QAtomicInteger<quint64> > _channelTimes;
+    QAtomicInteger<qint64> _droppedEvents;
+
+    /** Timestamp tracing has started at. */
+    quint64 _epoch;
+    /** Incremented on each start, so threads pick a new ring. */
+    QAtomicInt _generation;
+
+    QFile _file;
+    /** Whether an event has been written to the trace file yet. */
+    bool _firstEvent;
+    /** Text written to the file, reused across dumps. */
+    QByteArray _dumpBuffer;
+
+    /** Dump thread, if tracing. */
+    pthread_t _thread;
+    bool _tracing;
+    /** Set to terminate the dump thread. */
+    QAtomicInt _quit;
+    QString _errorString;
+};
+
+/**
+ * Records the time from its construction to its destruction as a stage.
+ * Does nothing, if there is no tracer.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class StageScope
+{
+public:
+    StageScope(StageTracer *stageTracer, StageTracer::Stage stage, int index) :
+        _stageTracer(stageTracer),
+        _stage(stage),
+        _index(index),
+        _begin(stageTracer ? StageTracer::timestamp() : 0) {
+    }
+
+    ~StageScope() {
+        finish();
+    }
+
+    /** Records the stage before the scope ends. */
+    void finish() {
+        if(_stageTracer) {
+            _stageTracer->record(_stage, _index, _begin);
+            _stageTracer = 0;
+        }
+    }
+
+private:
+    StageTracer *_stageTracer;
+    StageTracer::Stage _stage;
+    int _index;
+    quint64 _begin;
+};
+
+#endif // STAGETRACER_H
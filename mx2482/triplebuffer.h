@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+// Qt includes
+#include <QAtomicInt>
+
+/**
+ * Lock-free triple buffer to hand over a value from one writer thread to
+ * one reader thread. The writer fills writeBuffer() and calls publish(), the
+ * reader calls read() and always obtains the most recently published value.
+ * Neither side ever blocks or allocates, so this is safe to be used from the
+ * JACK realtime thread.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() :
+        _writeIndex(0),
+        _shared(1),
+        _readIndex(2)
+    {
+    }
+
+    /**
+     * @returns the buffer the writer may fill. The contents are undefined
+     * and have to be written completely before calling publish().
+     */
+    T& writeBuffer()
+    {
+        return _buffers[_writeIndex];
+    }
+
+    /** Publishes the write buffer to the reader. Writer thread only. */
+    void publish()
+    {
+        int previous = _shared.fetchAndStoreOrdered(_writeIndex | DirtyFlag);
+        _writeIndex = previous & IndexMask;
+    }
+
+    /**
+     * @returns the most recently published value. If nothing new has been
+     * published since the last call, the same value is returned again.
+     * Reader thread only.
+     */
+    const T& read()
+    {
+        if(_shared.loadAcquire() & DirtyFlag) {
+            int previous = _shared.fetchAndStoreOrdered(_readIndex);
+            _readIndex = previous & IndexMask;
+        }
+        return _buffers[_readIndex];
+    }
+
+private:
+    enum {
+        IndexMask = 0x3,
+        DirtyFlag = 0x4
+    };
+
+    T _buffers[3];
+
+    /** Index of the buffer owned by the writer. */
+    int _writeIndex;
+    /** Index of the buffer in transit, plus a flag if it holds new data. */
+    QAtomicInt _shared;
+    /** Index of the buffer owned by the reader. */
+    int _readIndex;
+};
+
+#endif // TRIPLEBUFFER_H
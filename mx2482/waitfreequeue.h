@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WAITFREEQUEUE_H
+#define WAITFREEQUEUE_H
+
+// Own includes
+#include "waitfreering.h"
+
+/**
+ * Wait-free single producer, single consumer queue of fixed capacity.
+ * Neither side ever blocks or allocates, so either of them may be the
+ * JACK realtime thread. When the queue is full, push() fails and the
+ * producer has to decide what to drop.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+template <typename T>
+class WaitFreeQueue
+{
+public:
+    /**
+     * Constructor.
+     * @param capacity Number of elements, must be a power of two.
+     */
+    explicit WaitFreeQueue(int capacity) :
+        _ring(capacity)
+    {
+    }
+
+    /**
+     * Producer only. Appends a copy of element.
+     * @returns false, if the queue is full.
+     */
+    bool push(const T& element)
+    {
+        if(_ring.writeAvailable() == 0) {
+            return false;
+        }
+        *_ring.writeSlot() = element;
+        _ring.commitWrite(1);
+        return true;
+    }
+
+    /**
+     * Consumer only. Takes the oldest element out of the queue.
+     * @returns false, if the queue is empty. element is untouched then.
+     */
+    bool pop(T& element)
+    {
+        if(_ring.readAvailable() == 0) {
+            return false;
+        }
+        element = *_ring.readSlot();
+        _ring.commitRead(1);
+        return true;
+    }
+
+private:
+    WaitFreeRing<T> _ring;
+};
+
+#endif // WAITFREEQUEUE_H
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef WAITFREERING_H
+#define WAITFREERING_H
+
+// Qt includes
+#include <QAtomicInt>
+#include <QVector>
+
+/**
+ * Index arithmetic and storage shared by the wait-free single producer,
+ * single consumer rings. The ring holds a power of two of slots, each of
+ * slotSize elements. The producer fills slots at writeSlot() and publishes
+ * them with commitWrite(), the consumer reads them at readSlot() and hands
+ * them back with commitRead(). Neither side ever blocks or allocates.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+template <typename T>
+class WaitFreeRing
+{
+public:
+    /**
+     * Constructor.
+     * @param capacity Number of slots, must be a power of two.
+     * @param slotSize Number of elements in each slot.
+     */
+    explicit WaitFreeRing(int capacity, int slotSize = 1) :
+        _slotSize(slotSize),
+        _slotMask(capacity - 1),
+        _indexMask(2 * capacity - 1),
+        _elements(capacity * slotSize),
+        _writeIndex(0),
+        _readIndex(0) {
+    }
+
+    /** @returns the number of slots. */
+    int capacity() const {
+        return _slotMask + 1;
+    }
+
+    /** @returns the number of elements in each slot. */
+    int slotSize() const {
+        return _slotSize;
+    }
+
+    /** @returns the number of slots written and not read yet. */
+    int readAvailable() const {
+        return (_writeIndex.loadAcquire() - _readIndex.loadAcquire()) & _indexMask;
+    }
+
+    /** @returns the number of slots that can be written. */
+    int writeAvailable() const {
+        return capacity() - readAvailable();
+    }
+
+    /** Producer only. @returns the slot offset slots after the last written one, wrapping around. */
+    T *writeSlot(int offset = 0) {
+        return slot(_writeIndex.loadAcquire() + offset);
+    }
+
+    /** Producer only. @returns the number of slots from writeSlot() to the end of the storage. */
+    int writeContiguous() const {
+        return capacity() - (_writeIndex.loadAcquire() & _slotMask);
+    }
+
+    /** Producer only. Publishes count slots to the consumer. */
+    void commitWrite(int count) {
+        _writeIndex.storeRelease((_writeIndex.loadAcquire() + count) & _indexMask);
+    }
+
+    /** Consumer only. @returns the slot offset slots after the oldest unread one, wrapping around. */
+    const T *readSlot(int offset = 0) const {
+        return _elements.constData() + ((_readIndex.loadAcquire() + offset) & _slotMask) * _slotSize;
+    }
+
+    /** Consumer only. @returns the number of slots from readSlot() to the end of the storage. */
+    int readContiguous() const {
+        return capacity() - (_readIndex.loadAcquire() & _slotMask);
+    }
+
+    /** Consumer only. Hands count slots back to the producer. */
+    void commitRead(int count) {
+        _readIndex.storeRelease((_readIndex.loadAcquire() + count) & _indexMask);
+    }
+
+    /** Empties the ring. Neither producer nor consumer may be active. */
+    void reset() {
+        _writeIndex.storeRelease(0);
+        _readIndex.storeRelease(0);
+    }
+
+private:
+    T *slot(int index) {
+        return _elements.data() + (index & _slotMask) * _slotSize;
+    }
+
+    int _slotSize;
+    int _slotMask;
+    /** Indexes run over twice the capacity, so full and empty differ. */
+    int _indexMask;
+    QVector<T> _elements;
+
+    /** Number of slots written so far, modulo twice the capacity. */
+    QAtomicInt _writeIndex;
+    /** Number of slots read so far, modulo twice the capacity. */
+    QAtomicInt _readIndex;
+};
+
+#endif // WAITFREERING_H
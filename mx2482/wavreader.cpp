@@ -0,0 +1,248 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "wavreader.h"
+#include "wave64.h"
+
+// Qt includes
+#include <QtEndian>
+
+// Standard includes
+#include <cstring>
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+/** Format tag for integer PCM. */
+static const quint16 FormatPCM = 0x0001;
+/** Format tag for IEEE float. */
+static const quint16 FormatFloat = 0x0003;
+/** Format tag for WAVE_FORMAT_EXTENSIBLE, the actual format is in the sub format. */
+static const quint16 FormatExtensible = 0xFFFE;
+
+WavReader::WavReader() :
+    _sampleFormat(Integer16),
+    _sampleRate(0),
+    _blockAlign(0),
+    _frameCount(0),
+    _framesLeft(0),
+    _dataOffset(0)
+{
+}
+
+WavReader::~WavReader()
+{
+    close();
+}
+
+bool WavReader::open(const QString& fileName)
+{
+    close();
+    _file.setFileName(fileName);
+    if(!_file.open(QIODevice::ReadOnly)) {
+        _errorString = QString("Could not open file for read: %1").arg(fileName);
+        return false;
+    }
+
+    // Wave64 has GUIDs and 64 bit sizes in the chunk headers, otherwise it is laid out the same
+    QByteArray riffHeader = _file.read(40);
+    bool wave64 = riffHeader.size() == 40
+            && memcmp(riffHeader.constData(), Wave64RiffGuid, 16) == 0
+            && memcmp(riffHeader.constData() + 24, Wave64WaveGuid, 16) == 0;
+    if(!wave64 && (riffHeader.size() < 12 || !riffHeader.startsWith("RIFF") || riffHeader.mid(8, 4) != "WAVE")) {
+        _errorString = QString("Not a RIFF/WAVE or Wave64 file: %1").arg(fileName);
+        close();
+        return false;
+    }
+    int chunkHeaderSize = wave64 ? Wave64ChunkHeaderSize : 8;
+    int chunkAlignment = wave64 ? 8 : 2;
+    _file.seek(wave64 ? 40 : 12);
+
+    bool formatFound = false;
+    int channelCount = 0;
+
+    // Walk through the chunks until the data chunk has been found
+    forever {
+        QByteArray chunkHeader = _file.read(chunkHeaderSize);
+        if(chunkHeader.size() != chunkHeaderSize) {
+            _errorString = QString("No audio data found in: %1").arg(fileName);
+            close();
+            return false;
+        }
+
+        const uchar *header = (const uchar*)chunkHeader.constData();
+        bool formatChunk;
+        bool dataChunk;
+        qint64 chunkSize;
+        if(wave64) {
+            formatChunk = memcmp(header, Wave64FormatGuid, 16) == 0;
+            dataChunk = memcmp(header, Wave64DataGuid, 16) == 0;
+            chunkSize = (qint64)qFromLittleEndian<quint64>(header + 16) - Wave64ChunkHeaderSize;
+        } else {
+            formatChunk = memcmp(header, "fmt ", 4) == 0;
+            dataChunk = memcmp(header, "data", 4) == 0;
+            chunkSize = qFromLittleEndian<quint32>(header + 4);
+        }
+
+        if(formatChunk) {
+            QByteArray format = _file.read(chunkSize);
+            if(format.size() < 16) {
+                _errorString = QString("Invalid format chunk in: %1").arg(fileName);
+                close();
+                return false;
+            }
+
+            const uchar *data = (const uchar*)format.constData();
+            quint16 formatTag     = qFromLittleEndian<quint16>(data);
+            channelCount          = qFromLittleEndian<quint16>(data + 2);
+            _sampleRate           = qFromLittleEndian<quint32>(data + 4);
+            _blockAlign           = qFromLittleEndian<quint16>(data + 12);
+            quint16 bitsPerSample = qFromLittleEndian<quint16>(data + 14);
+
+            if(formatTag == FormatExtensible && format.size() >= 26) {
+                formatTag = qFromLittleEndian<quint16>(data + 24);
+            }
+
+            if(formatTag == FormatPCM && bitsPerSample == 16) {
+                _sampleFormat = Integer16;
+            } else if(formatTag == FormatPCM && bitsPerSample == 24) {
+                _sampleFormat = Integer24;
+            } else if(formatTag == FormatPCM && bitsPerSample == 32) {
+                _sampleFormat = Integer32;
+            } else if(formatTag == FormatFloat && bitsPerSample == 32) {
+                _sampleFormat = Float32;
+            } else {
+                _errorString = QString("Unsupported sample format (tag %1, %2 bits) in: %3")
+                        .arg(formatTag).arg(bitsPerSample).arg(fileName);
+                close();
+                return false;
+            }
+
+            if(channelCount < 1 || _blockAlign < channelCount * bitsPerSample / 8) {
+                _errorString = QString("Invalid format chunk in: %1").arg(fileName);
+                close();
+                return false;
+            }
+            formatFound = true;
+            _file.seek(_file.pos() + (chunkAlignment - chunkSize % chunkAlignment) % chunkAlignment);
+        } else if(dataChunk) {
+            if(!formatFound) {
+                _errorString = QString("Data chunk before format chunk in: %1").arg(fileName);
+                close();
+                return false;
+            }
+
+            // The data goes on up to the end of the file if the size has been saturated, or never
+            // been filled in by a writer that did not get to finish
+            _dataOffset = _file.pos();
+            if(chunkSize <= 0 || (!wave64 && chunkSize == 0xFFFFFFFF)) {
+                chunkSize = _file.size() - _dataOffset;
+            }
+            _frameCount = qMin(chunkSize, _file.size() - _dataOffset) / _blockAlign;
+            _framesLeft = _frameCount;
+            return true;
+        } else {
+            // Skip unknown chunks, including their padding
+            _file.seek(_file.pos() + chunkSize + (chunkAlignment - chunkSize % chunkAlignment) % chunkAlignment);
+        }
+    }
+}
+
+void WavReader::close()
+{
+    _file.close();
+    _frameCount = 0;
+    _framesLeft = 0;
+}
+
+int WavReader::read(float *target, int frames)
+{
+    frames = (int)qMin((qint64)frames, _framesLeft);
+    if(frames <= 0) {
+        return 0;
+    }
+
+    _readBuffer.resize(frames * _blockAlign);
+    qint64 bytesRead = _file.read(_readBuffer.data(), _readBuffer.size());
+    frames = bytesRead > 0 ? (int)(bytesRead / _blockAlign) : 0;
+    _framesLeft = frames > 0 ? _framesLeft - frames : 0;
+
+    const uchar *data = (const uchar*)_readBuffer.constData();
+    for(int i = 0; i < frames; i++, data += _blockAlign) {
+        switch(_sampleFormat) {
+        case Integer16:
+            target[i] = qFromLittleEndian<qint16>(data) / 32768.0f;
+            break;
+        case Integer24:
+            // Place the 24 bits in the upper bytes to get the sign right
+            target[i] = (qint32)(((quint32)data[0] << 8) | ((quint32)data[1] << 16) | ((quint32)data[2] << 24))
+                    / 2147483648.0f;
+            break;
+        case Integer32:
+            target[i] = qFromLittleEndian<qint32>(data) / 2147483648.0f;
+            break;
+        case Float32: {
+            quint32 bits = qFromLittleEndian<quint32>(data);
+            memcpy(&target[i], &bits, sizeof(float));
+            break;
+        }
+        }
+    }
+    return frames;
+}
+
+void WavReader::rewind()
+{
+    if(_file.isOpen()) {
+        _file.seek(_dataOffset);
+        _framesLeft = _frameCount;
+    }
+}
+
+void WavReader::readAhead(int frames)
+{
+#ifdef Q_OS_LINUX
+    // Only a hint, the page cache fills in the background while the current block is processed
+    if(_file.isOpen()) {
+        posix_fadvise(_file.handle(), _file.pos(), (qint64)frames * _blockAlign, POSIX_FADV_WILLNEED);
+    }
+#else
+    Q_UNUSED(frames);
+#endif
+}
+
+int WavReader::sampleRate() const
+{
+    return _sampleRate;
+}
+
+qint64 WavReader::frameCount() const
+{
+    return _frameCount;
+}
+
+QString WavReader::errorString() const
+{
+    return _errorString;
+}
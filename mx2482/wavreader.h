@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WAVREADER_H
+#define WAVREADER_H
+
+// Qt includes
+#include <QFile>
+#include <QByteArray>
+
+/**
+ * Streaming reader for RIFF/WAVE and Sony Wave64 files. Supports 16, 24
+ * and 32 bit integer PCM as well as 32 bit float samples. Only the first
+ * channel of the file is read.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class WavReader
+{
+public:
+    /** Constructor */
+    WavReader();
+    /** Destructor */
+    ~WavReader();
+
+    /**
+     * Opens a file and parses its header.
+     * @returns true on success, otherwise errorString() tells why.
+     */
+    bool open(const QString& fileName);
+
+    /** Closes the file. */
+    void close();
+
+    /**
+     * Reads up to frames samples of the first channel, converted to float.
+     * @returns the number of frames read, 0 at the end of the file.
+     */
+    int read(float *target, int frames);
+
+    /** Goes back to the first frame. */
+    void rewind();
+
+    /**
+     * Asks the operating system to start loading the next frames into the
+     * page cache, so later reads do not have to wait for the disk.
+     */
+    void readAhead(int frames);
+
+    /** @returns the sample rate of the file. */
+    int sampleRate() const;
+
+    /** @returns the total number of frames in the file. */
+    qint64 frameCount() const;
+
+    /** @returns a description of the last error. */
+    QString errorString() const;
+
+private:
+    /** Sample formats that can be read. */
+    enum SampleFormat {
+        Integer16,
+        Integer24,
+        Integer32,
+        Float32
+    };
+
+    QFile _file;
+    QString _errorString;
+
+    SampleFormat _sampleFormat;
+    int _sampleRate;
+    /** Size of one frame (all channels) in bytes. */
+    int _blockAlign;
+    qint64 _frameCount;
+    qint64 _framesLeft;
+    /** Position of the first frame in the file. */
+    qint64 _dataOffset;
+
+    /** Raw data read from the file, reused across reads. */
+    QByteArray _readBuffer;
+};
+
+#endif // WAVREADER_H
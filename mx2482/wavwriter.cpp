@@ -0,0 +1,199 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "wavwriter.h"
+#include "wave64.h"
+
+// Qt includes
+#include <QtEndian>
+
+// Standard includes
+#include <cstring>
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+/** Size of the format chunk contents. */
+static const int FormatSize = 16;
+
+WavWriter::WavWriter() :
+    _format(Wave),
+    _frameCount(0),
+    _reservedFrames(0),
+    _dataOffset(0)
+{
+}
+
+WavWriter::~WavWriter()
+{
+    close();
+}
+
+bool WavWriter::open(const QString& fileName, int sampleRate, Format format, int dataAlignment)
+{
+    close();
+    _file.setFileName(fileName);
+    if(!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        _errorString = QString("Could not open file for write: %1").arg(fileName);
+        return false;
+    }
+
+    // Wave64 has GUIDs and 64 bit sizes in the chunk headers, the format chunk is the same
+    bool wave64 = format == Wave64;
+    int chunkHeaderSize = wave64 ? Wave64ChunkHeaderSize : 8;
+    int formatOffset = wave64 ? 40 : 12;
+    int headerSize = formatOffset + chunkHeaderSize + FormatSize + chunkHeaderSize;
+
+    // Pad with a junk chunk up to the alignment, readers skip it
+    int junkSize = 0;
+    if(dataAlignment > 0) {
+        junkSize = (dataAlignment - headerSize % dataAlignment) % dataAlignment;
+        if(junkSize > 0 && junkSize < chunkHeaderSize) {
+            junkSize += dataAlignment;
+        }
+    }
+
+    QByteArray header(headerSize + junkSize, 0);
+    uchar *data = (uchar*)header.data();
+    if(wave64) {
+        memcpy(data, Wave64RiffGuid, 16);
+        memcpy(data + 24, Wave64WaveGuid, 16);
+        memcpy(data + formatOffset, Wave64FormatGuid, 16);
+        qToLittleEndian<quint64>(chunkHeaderSize + FormatSize, data + formatOffset + 16);
+    } else {
+        memcpy(data, "RIFF", 4);
+        memcpy(data + 8, "WAVEfmt ", 8);
+        qToLittleEndian<quint32>(FormatSize, data + formatOffset + 4);
+    }
+
+    uchar *chunk = data + formatOffset + chunkHeaderSize;
+    qToLittleEndian<quint16>(3, chunk);                                 // IEEE float
+    qToLittleEndian<quint16>(1, chunk + 2);                             // Channels
+    qToLittleEndian<quint32>(sampleRate, chunk + 4);
+    qToLittleEndian<quint32>(sampleRate * sizeof(float), chunk + 8);    // Bytes per second
+    qToLittleEndian<quint16>(sizeof(float), chunk + 12);                // Block align
+    qToLittleEndian<quint16>(32, chunk + 14);                           // Bits per sample
+    chunk += FormatSize;
+
+    if(junkSize > 0) {
+        if(wave64) {
+            memcpy(chunk, Wave64JunkGuid, 16);
+            qToLittleEndian<quint64>(junkSize, chunk + 16);
+        } else {
+            memcpy(chunk, "JUNK", 4);
+            qToLittleEndian<quint32>(junkSize - chunkHeaderSize, chunk + 4);
+        }
+        chunk += junkSize;
+    }
+    memcpy(chunk, wave64 ? Wave64DataGuid : (const uchar*)"data", wave64 ? 16 : 4);
+
+    _format = format;
+    _frameCount = 0;
+    _reservedFrames = 0;
+    _dataOffset = header.size();
+    if(_file.write(header) != header.size()) {
+        _errorString = QString("Could not write to file: %1").arg(fileName);
+        _file.close();
+        return false;
+    }
+    return true;
+}
+
+void WavWriter::close()
+{
+    if(!_file.isOpen()) {
+        return;
+    }
+
+    // Fill in the sizes now that they are known
+    qint64 dataSize = _frameCount * sizeof(float);
+    if(_format == Wave64) {
+        // Chunks are aligned to 8 bytes, the last one included. Sizes include the chunk headers.
+        qint64 padding = (8 - dataSize % 8) % 8;
+        _file.write(QByteArray((int)padding, 0));
+        uchar size[8];
+        qToLittleEndian<quint64>(_dataOffset + dataSize + padding, size);
+        _file.seek(16);
+        _file.write((const char*)size, 8);
+        qToLittleEndian<quint64>(Wave64ChunkHeaderSize + dataSize, size);
+        _file.seek(_dataOffset - 8);
+        _file.write((const char*)size, 8);
+    } else {
+        // Sizes that do not fit are saturated, readers then take everything up to the end of the file
+        uchar size[4];
+        qToLittleEndian<quint32>(qMin(_dataOffset - 8 + dataSize, (qint64)0xFFFFFFFF), size);
+        _file.seek(4);
+        _file.write((const char*)size, 4);
+        qToLittleEndian<quint32>(qMin(dataSize, (qint64)0xFFFFFFFF), size);
+        _file.seek(_dataOffset - 4);
+        _file.write((const char*)size, 4);
+    }
+
+    // Give back the disk space that has been allocated beyond the end
+    if(_reservedFrames > 0) {
+        _file.resize(_file.size());
+    }
+    _file.close();
+}
+
+bool WavWriter::write(const float *source, int frames)
+{
+    _writeBuffer.resize(frames * sizeof(float));
+    uchar *data = (uchar*)_writeBuffer.data();
+    for(int i = 0; i < frames; i++) {
+        quint32 bits;
+        memcpy(&bits, &source[i], sizeof(float));
+        qToLittleEndian<quint32>(bits, data + i * sizeof(float));
+    }
+
+    if(_file.write(_writeBuffer) != _writeBuffer.size()) {
+        _errorString = QString("Could not write to file: %1").arg(_file.fileName());
+        return false;
+    }
+    _frameCount += frames;
+    return true;
+}
+
+void WavWriter::reserve(qint64 frames)
+{
+    if(!_file.isOpen() || frames <= _reservedFrames) {
+        return;
+    }
+
+#ifdef Q_OS_LINUX
+    // Without preallocation the file system allocates on each write, so failing here is harmless
+    fallocate(_file.handle(), FALLOC_FL_KEEP_SIZE, _dataOffset, frames * sizeof(float));
+#endif
+    _reservedFrames = frames;
+}
+
+qint64 WavWriter::frameCount() const
+{
+    return _frameCount;
+}
+
+QString WavWriter::errorString() const
+{
+    return _errorString;
+}
@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WAVWRITER_H
+#define WAVWRITER_H
+
+// Qt includes
+#include <QFile>
+#include <QByteArray>
+
+/**
+ * Streaming writer for mono RIFF/WAVE or Sony Wave64 files with 32 bit
+ * float samples. The sizes in the header are filled in when the file is
+ * closed.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class WavWriter
+{
+public:
+    /** File formats that can be written. */
+    enum Format {
+        /** RIFF/WAVE, limited to 4 GiB. */
+        Wave,
+        /** Sony Wave64, with 64 bit sizes for long recordings. */
+        Wave64
+    };
+
+    /** Constructor */
+    WavWriter();
+    /** Destructor, closes the file. */
+    ~WavWriter();
+
+    /**
+     * Creates a file and writes a preliminary header.
+     * @param dataAlignment If not 0, the header is padded so the samples
+     * start at a multiple of this many bytes in the file. Must be a
+     * multiple of 8 and large enough for the header.
+     * @returns true on success, otherwise errorString() tells why.
+     */
+    bool open(const QString& fileName, int sampleRate, Format format = Wave, int dataAlignment = 0);
+
+    /** Finalizes the header and closes the file. */
+    void close();
+
+    /**
+     * Appends frames samples to the file.
+     * @returns true on success, otherwise errorString() tells why.
+     */
+    bool write(const float *source, int frames);
+
+    /**
+     * Allocates disk space for the file to hold at least frames samples,
+     * so later writes do not have to allocate. The file size does not
+     * change. Does nothing where the file system does not support it.
+     */
+    void reserve(qint64 frames);
+
+    /** @returns the number of samples written so far. */
+    qint64 frameCount() const;
+
+    /** @returns a description of the last error. */
+    QString errorString() const;
+
+private:
+    QFile _file;
+    QString _errorString;
+    Format _format;
+    qint64 _frameCount;
+    /** Number of frames disk space has been allocated for. */
+    qint64 _reservedFrames;
+    /** Position of the first sample in the file. */
+    qint64 _dataOffset;
+
+    /** Raw data to be written to the file, reused across writes. */
+    QByteArray _writeBuffer;
+};
+
+#endif // WAVWRITER_H
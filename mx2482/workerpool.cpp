@@ -0,0 +1,224 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "workerpool.h"
+#include "sampleops.h"
+
+// Qt includes
+#include <QtGlobal>
+
+// POSIX includes
+#include <errno.h>
+#include <sched.h>
+
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#endif
+
+/**
+ * Tells the CPU that the calling thread is spinning, so it does not
+ * speculate ahead and leaves more resources to a sibling hyperthread.
+ */
+static inline void pauseSpinning()
+{
+#if defined(__SSE__) || defined(__x86_64__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+WorkerPool::Configuration::Configuration() :
+    threadCount(0),
+    priority(10)
+{
+}
+
+WorkerPool::WorkerPool() :
+    _quit(0),
+    _task(0),
+    _context(0),
+    _nextTask(0),
+    _finishedTasks(0),
+    _waiting(0)
+{
+    sem_init(&_wakeup, 0, 0);
+    sem_init(&_finished, 0, 0);
+}
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+    sem_destroy(&_wakeup);
+    sem_destroy(&_finished);
+}
+
+bool WorkerPool::start(const Configuration& configuration)
+{
+    stop();
+    _quit.fetchAndStoreOrdered(0);
+
+    for(int i = 0; i < configuration.threadCount; i++) {
+        pthread_attr_t attributes;
+        pthread_attr_init(&attributes);
+
+        if(configuration.priority > 0) {
+            sched_param parameters;
+            parameters.sched_priority = configuration.priority;
+            pthread_attr_setinheritsched(&attributes, PTHREAD_EXPLICIT_SCHED);
+            pthread_attr_setschedpolicy(&attributes, SCHED_FIFO);
+            pthread_attr_setschedparam(&attributes, &parameters);
+        }
+
+        pthread_t thread;
+        int result = pthread_create(&thread, &attributes, &WorkerPool::threadEntry, this);
+        if(result != 0 && configuration.priority > 0) {
+            qWarning("Could not create realtime worker thread with priority %d, falling back to default scheduling.",
+                     configuration.priority);
+            pthread_attr_setinheritsched(&attributes, PTHREAD_INHERIT_SCHED);
+            result = pthread_create(&thread, &attributes, &WorkerPool::threadEntry, this);
+        }
+        pthread_attr_destroy(&attributes);
+
+        if(result != 0) {
+            qWarning("Could not create worker thread %d.", i + 1);
+            break;
+        }
+
+#ifdef Q_OS_LINUX
+        if(!configuration.cpus.isEmpty()) {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(configuration.cpus.at(i % configuration.cpus.size()), &cpuSet);
+            if(pthread_setaffinity_np(thread, sizeof(cpuSet), &cpuSet) != 0) {
+                qWarning("Could not pin worker thread %d to CPU %d.",
+                         i + 1, configuration.cpus.at(i % configuration.cpus.size()));
+            }
+        }
+#endif
+
+        _threads.append(thread);
+    }
+
+    return configuration.threadCount == 0 || !_threads.isEmpty();
+}
+
+void WorkerPool::stop()
+{
+    if(_threads.isEmpty()) {
+        return;
+    }
+
+    _quit.fetchAndStoreOrdered(1);
+    for(int i = 0; i < _threads.size(); i++) {
+        sem_post(&_wakeup);
+    }
+    foreach(pthread_t thread, _threads) {
+        pthread_join(thread, 0);
+    }
+    _threads.clear();
+}
+
+int WorkerPool::threadCount() const
+{
+    return _threads.size();
+}
+
+void WorkerPool::run(Task task, void *context, int count)
+{
+    Q_ASSERT(count >= 0 && count <= 0xffff);
+
+    if(_threads.isEmpty()) {
+        for(int i = 0; i < count; i++) {
+            task(context, i);
+        }
+        return;
+    }
+
+    // Publish the batch: task and context become visible to any thread that
+    // acquires the new value of _nextTask.
+    _task = task;
+    _context = context;
+    _finishedTasks.fetchAndStoreOrdered(0);
+    _nextTask.fetchAndStoreRelease(count << 16);
+
+    for(int i = 0; i < _threads.size(); i++) {
+        sem_post(&_wakeup);
+    }
+
+    // Help out, then wait for tasks still running on other threads
+    executeTasks();
+    for(int spin = 0; spin < SpinCount; spin++) {
+        if(_finishedTasks.loadAcquire() >= count) {
+            return;
+        }
+        pauseSpinning();
+    }
+
+    // A worker may have been preempted in the middle of a task, so stop competing with it for
+    // the CPU. Either the last task is seen finished here, or its thread sees _waiting set.
+    _waiting.fetchAndStoreOrdered(1);
+    if(_finishedTasks.fetchAndAddOrdered(0) >= count && _waiting.fetchAndStoreOrdered(0)) {
+        return;
+    }
+    while(sem_wait(&_finished) != 0 && errno == EINTR) {
+    }
+}
+
+void *WorkerPool::threadEntry(void *argument)
+{
+    WorkerPool *workerPool = static_cast<WorkerPool*>(argument);
+    enableFlushToZero();
+    forever {
+        sem_wait(&workerPool->_wakeup);
+        if(workerPool->_quit.loadAcquire()) {
+            break;
+        }
+        workerPool->executeTasks();
+    }
+    return 0;
+}
+
+void WorkerPool::executeTasks()
+{
+    forever {
+        int nextTask = _nextTask.loadAcquire();
+        int count = (nextTask >> 16) & 0xffff;
+        int index = nextTask & 0xffff;
+        if(index >= count) {
+            return;
+        }
+
+        // Another thread may have taken this task in the meantime
+        if(!_nextTask.testAndSetAcquire(nextTask, nextTask + 1)) {
+            continue;
+        }
+
+        // The thread finishing the last task wakes up the calling thread, if it has stopped spinning
+        _task(_context, index);
+        if(_finishedTasks.fetchAndAddOrdered(1) + 1 == count && _waiting.fetchAndStoreOrdered(0)) {
+            sem_post(&_finished);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+// Qt includes
+#include <QAtomicInt>
+#include <QList>
+#include <QVector>
+
+// POSIX includes
+#include <pthread.h>
+#include <semaphore.h>
+
+/**
+ * Pool of realtime worker threads that a batch of independent tasks can be
+ * fanned out to from within the JACK callback. The calling thread takes part
+ * in the work and returns once all tasks have finished. Distributing and
+ * waiting for tasks never blocks on a lock and never allocates. The calling
+ * thread spins for a bounded time only, then it blocks until the last task
+ * has finished, so a worker that has been preempted can run again.
+ *
+ * Without any worker threads all tasks are simply run one after another on
+ * the calling thread.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class WorkerPool
+{
+public:
+    /** Settings for the worker threads. */
+    struct Configuration
+    {
+        Configuration();
+
+        /** Number of worker threads in addition to the calling thread, 0 disables the pool. */
+        int threadCount;
+        /** SCHED_FIFO priority of the workers, 0 keeps the default scheduling. */
+        int priority;
+        /** CPUs the workers are pinned to, one per worker, repeated if shorter. Empty for no affinity. */
+        QList<int> cpus;
+    };
+
+    /** Function to be called for each task index. */
+    typedef void (*Task)(void *context, int index);
+
+    /** Constructor */
+    WorkerPool();
+    /** Destructor */
+    ~WorkerPool();
+
+    /**
+     * Creates the worker threads. Must not be called while run() is active.
+     * @returns false, if no worker thread could be created.
+     */
+    bool start(const Configuration& configuration);
+
+    /** Terminates all worker threads. Must not be called while run() is active. */
+    void stop();
+
+    /** @returns the number of running worker threads. */
+    int threadCount() const;
+
+    /**
+     * Calls task for every index from 0 to count - 1, spread across the
+     * calling thread and all workers. Returns after all calls have finished.
+     * Only one thread may call run() at a time. At most 65535 tasks.
+     */
+    void run(Task task, void *context, int count);
+
+private:
+    enum {
+        /**
+         * Times the calling thread checks for the tasks of other threads,
+         * pausing the CPU in between, before it blocks until they finish.
+         */
+        SpinCount = 2048
+    };
+
+    static void *threadEntry(void *argument);
+
+    /** Takes tasks from the current batch until it is exhausted. */
+    void executeTasks();
+
+    /** Worker threads. */
+    QVector<pthread_t> _threads;
+    /** Posted once per worker for each new batch. */
+    sem_t _wakeup;
+    /** Set to terminate the worker threads. */
+    QAtomicInt _quit;
+
+    /** Task of the current batch, published through _nextTask. */
+    Task _task;
+    /** Context of the current batch, published through _nextTask. */
+    void *_context;
+    /** Task count in the upper and next task index in the lower 16 bits. */
+    QAtomicInt _nextTask;
+    /** Number of finished tasks of the current batch. */
+    QAtomicInt _finishedTasks;
+    /** Set while the calling thread blocks on _finished, see run(). */
+    QAtomicInt _waiting;
+    /** Posted by the thread that finishes the last task, if the calling thread blocks. */
+    sem_t _finished;
+};
+
+#endif // WORKERPOOL_H
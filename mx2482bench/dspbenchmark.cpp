@@ -0,0 +1,296 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "dspbenchmark.h"
+#include "mixerstate.h"
+#include "sampleops.h"
+
+// QJackAudio includes
+#include <QUnits>
+
+// Qt includes
+#include <QElapsedTimer>
+
+// Standard includes
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/** Number of buses each channel is summed into: a subgroup pair and main. */
+static const int BusCount = MixerState::DefaultSubgroupCount + 2;
+
+/** @returns the CPU cycle counter, or 0 if there is none. */
+static inline quint64 readCycleCounter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+DspBenchmark::DspBenchmark() :
+    _channels(0),
+    _frames(0),
+    _buffers(0),
+    _mixerPorts(0),
+    _biquadEqualizer(0),
+    _dynamics(0),
+    _routingKernel(RoutingKernel<float, float>::function()),
+    _doubleRoutingKernel(RoutingKernel<float, double>::function()),
+    _peaksDb(0.0)
+{
+    _channelState.inputGain = 1.2f;
+    _channelState.auxSendGain = 0.9f;
+    _channelState.auxReturnGain = 1.1f;
+    _channelState.faderGain = 0.8f;
+    _channelState.panorama = 0.3f;
+    _channelState.auxOn = true;
+    _channelState.equalizerOn = true;
+    _channelState.lowAmount = 6;
+    _channelState.midAmount = -4;
+    _channelState.highAmount = 3;
+    _channelState.gateOn = true;
+    _channelState.gateThreshold = QUnits::dbToLinear(-60.0);
+    _channelState.compressorOn = true;
+    _channelState.compressorThreshold = QUnits::dbToLinear(-20.0);
+    _channelState.compressorRatio = 4.0f;
+    _channelState.equalizerBands[BiquadEqualizerBank::LowShelf] =
+        BiquadCoefficients::lowShelf(48000.0, _channelState.lowFrequency, ChannelState::LowShelfQ, _channelState.lowAmount);
+    _channelState.equalizerBands[BiquadEqualizerBank::Band] =
+        BiquadCoefficients::band(48000.0, _channelState.midFrequency, ChannelState::MidBandwidth, _channelState.midAmount);
+    _channelState.equalizerBands[BiquadEqualizerBank::HighShelf] =
+        BiquadCoefficients::highShelf(48000.0, ChannelState::HighShelfFrequency, ChannelState::HighShelfQ, _channelState.highAmount);
+}
+
+DspBenchmark::~DspBenchmark()
+{
+    release();
+}
+
+DspBenchmark::Result DspBenchmark::measure(Stage stage, int channels, int frames, qint64 minimumSamples)
+{
+    prepare(stage, channels, frames);
+
+    qint64 samplesPerPeriod = (qint64)channels * frames;
+    qint64 periods = qMax((qint64)16, minimumSamples / samplesPerPeriod);
+
+    // Warm up caches and branch predictors
+    for(int i = 0; i < 8; i++) {
+        runPeriod(stage);
+    }
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    quint64 cyclesStart = readCycleCounter();
+    for(qint64 i = 0; i < periods; i++) {
+        runPeriod(stage);
+    }
+    quint64 cycles = readCycleCounter() - cyclesStart;
+    qint64 nanoseconds = elapsedTimer.nsecsElapsed();
+
+    release();
+
+    Result result;
+    result.nanosecondsPerSample = (double)nanoseconds / (periods * samplesPerPeriod);
+    result.cyclesPerPeriod = (double)cycles / periods;
+    return result;
+}
+
+const char *DspBenchmark::name(Stage stage)
+{
+    switch(stage) {
+    case ChannelStripStage:     return "strip";
+    case BiquadStripStage:      return "strip-biquad";
+    case FFTStripStage:         return "strip-fft";
+    case DynamicsStage:         return "dynamics";
+    case BusSummingStage:       return "bus-summing";
+    case DoubleBusSummingStage: return "bus-summing-double";
+    case PeakDetectionStage:    return "peak";
+    case LinearToDbStage:       return "linear-to-db";
+    default:                    return "unknown";
+    }
+}
+
+void DspBenchmark::prepare(Stage stage, int channels, int frames)
+{
+    release();
+    _channels = channels;
+    _frames = frames;
+
+    _buffers = new ScratchArena(channels + BusCount);
+    _buffers->suspend();
+    _buffers->resize(frames);
+    _buffers->resume();
+
+    _mixerPorts = new BufferMixerPorts(channels, MixerState::DefaultSubgroupCount, frames);
+
+    // Fill all inputs and working buffers with noise
+    srand(2482);
+    for(int i = 0; i < channels; i++) {
+        float *input = _mixerPorts->channelInput(i);
+        float *buffer = _buffers->buffer(i);
+        for(int j = 0; j < frames; j++) {
+            input[j] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+            buffer[j] = input[j];
+        }
+    }
+
+    if(stage == ChannelStripStage || stage == BiquadStripStage || stage == FFTStripStage) {
+        for(int i = 0; i < channels; i++) {
+            ChannelStrip *channelStrip = new ChannelStrip(i, _mixerPorts);
+            channelStrip->setFFTEqualizerEnabled(stage == FFTStripStage, frames);
+            _channelStrips.append(channelStrip);
+        }
+    }
+
+    if(stage == DoubleBusSummingStage) {
+        _doubleBuses.fill(0.0, BusCount * frames);
+    }
+
+    if(stage == BiquadStripStage) {
+        _biquadEqualizer = new BiquadEqualizerBank(channels);
+        _laneBuffers.resize(channels);
+        for(int i = 0; i < channels; i++) {
+            for(int band = 0; band < BiquadEqualizerBank::BandCount; band++) {
+                _biquadEqualizer->setCoefficients(i, band, _channelState.equalizerBands[band]);
+            }
+            _biquadEqualizer->setEnabled(i, true);
+            _laneBuffers[i] = _buffers->buffer(i);
+        }
+    }
+
+    if(stage == DynamicsStage) {
+        _dynamics = new DynamicsBank(channels);
+        _laneBuffers.resize(channels);
+        for(int i = 0; i < channels; i++) {
+            _dynamics->setGate(i, _channelState.gateOn, _channelState.gateThreshold);
+            _dynamics->setCompressor(i, _channelState.compressorOn, _channelState.compressorThreshold,
+                                     _channelState.compressorRatio);
+            _laneBuffers[i] = _buffers->buffer(i);
+        }
+    }
+
+    _peaks.fill(0.0f, channels);
+    _meterRecords.resize(channels);
+    for(int i = 0; i < channels; i++) {
+        _meterRecords[i].clear();
+    }
+}
+
+void DspBenchmark::release()
+{
+    qDeleteAll(_channelStrips);
+    _channelStrips.clear();
+    delete _biquadEqualizer;
+    _biquadEqualizer = 0;
+    delete _dynamics;
+    _dynamics = 0;
+    _laneBuffers.clear();
+    _doubleBuses.clear();
+    delete _mixerPorts;
+    _mixerPorts = 0;
+    delete _buffers;
+    _buffers = 0;
+}
+
+void DspBenchmark::runPeriod(Stage stage)
+{
+    switch(stage) {
+    case ChannelStripStage:
+        for(int i = 0; i < _channels; i++) {
+            _channelStrips.at(i)->processInput(_buffers->buffer(i), _frames, _channelState, CrossfadeStep());
+            _channelStrips.at(i)->processOutput(_frames, _channelState, CrossfadeStep());
+        }
+        break;
+    case BiquadStripStage:
+        for(int i = 0; i < _channels; i++) {
+            _channelStrips.at(i)->processInput(_buffers->buffer(i), _frames, _channelState, CrossfadeStep());
+            _laneBuffers[i] = _channelStrips.at(i)->buffer();
+        }
+        for(int lane = 0; lane < _channels; lane += BiquadEqualizerBank::LaneGroupSize) {
+            _biquadEqualizer->process(_laneBuffers.data(), _frames, lane,
+                                      qMin((int)BiquadEqualizerBank::LaneGroupSize, _channels - lane));
+        }
+        for(int i = 0; i < _channels; i++) {
+            _channelStrips.at(i)->processOutput(_frames, _channelState, CrossfadeStep());
+        }
+        break;
+    case FFTStripStage:
+        for(int i = 0; i < _channels; i++) {
+            _channelStrips.at(i)->process(_buffers->buffer(i), _frames, _channelState, CrossfadeStep());
+        }
+        break;
+    case DynamicsStage:
+        for(int lane = 0; lane < _channels; lane += DynamicsBank::LaneGroupSize) {
+            _dynamics->process(_laneBuffers.data(), _frames, lane,
+                               qMin((int)DynamicsBank::LaneGroupSize, _channels - lane));
+        }
+        break;
+    case BusSummingStage:
+        for(int i = 0; i < BusCount; i++) {
+            clearSamples(_buffers->buffer(_channels + i), _frames);
+        }
+        for(int i = 0; i < _channels; i++) {
+            // Spread the channels across the subgroup pairs, each one also goes to main
+            int pair = i % (MixerState::DefaultSubgroupCount / 2);
+            RoutingTarget<float> targets[4] = {
+                { _buffers->buffer(_channels + 2 * pair),                   1.0f - _channelState.panorama },
+                { _buffers->buffer(_channels + 2 * pair + 1),                      _channelState.panorama },
+                { _buffers->buffer(_channels + MixerState::DefaultSubgroupCount),     1.0f - _channelState.panorama },
+                { _buffers->buffer(_channels + MixerState::DefaultSubgroupCount + 1),        _channelState.panorama }
+            };
+            _peaks[i] = _routingKernel(_buffers->buffer(i), targets, 4, _frames, &_meterRecords[i]);
+        }
+        break;
+    case DoubleBusSummingStage:
+        clearSamples(_doubleBuses.data(), BusCount * _frames);
+        for(int i = 0; i < _channels; i++) {
+            int pair = i % (MixerState::DefaultSubgroupCount / 2);
+            double *buses = _doubleBuses.data();
+            RoutingTarget<double> targets[4] = {
+                { buses + 2 * pair * _frames,                                   1.0f - _channelState.panorama },
+                { buses + (2 * pair + 1) * _frames,                                    _channelState.panorama },
+                { buses + MixerState::DefaultSubgroupCount * _frames,         1.0f - _channelState.panorama },
+                { buses + (MixerState::DefaultSubgroupCount + 1) * _frames,          _channelState.panorama }
+            };
+            _peaks[i] = _doubleRoutingKernel(_buffers->buffer(i), targets, 4, _frames, &_meterRecords[i]);
+        }
+        break;
+    case PeakDetectionStage:
+        for(int i = 0; i < _channels; i++) {
+            _peaks[i] = _routingKernel(_buffers->buffer(i), 0, 0, _frames, &_meterRecords[i]);
+        }
+        break;
+    case LinearToDbStage:
+        for(int i = 0; i < _channels; i++) {
+            _peaksDb += QUnits::linearToDb(_peaks.at(i) + 0.5f);
+        }
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSPBENCHMARK_H
+#define DSPBENCHMARK_H
+
+// Qt includes
+#include <QVector>
+#include <QString>
+
+// Own includes
+#include "buffermixerports.h"
+#include "channelstrip.h"
+#include "biquadequalizer.h"
+#include "dynamicsbank.h"
+#include "routingkernel.h"
+#include "scratcharena.h"
+
+/**
+ * Times the single stages of the mixer processing for a given number of
+ * channels and frames per period, without JACK.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class DspBenchmark
+{
+public:
+    /** Stages that can be measured. */
+    enum Stage {
+        /** Channel strip with input gain, aux loopback and fader. */
+        ChannelStripStage,
+        /** Channel strip with the biquad equalizer in between. */
+        BiquadStripStage,
+        /** Channel strip with the FFT equalizer in between. */
+        FFTStripStage,
+        /** Gate and compressor of all channels at once. */
+        DynamicsStage,
+        /** Summing each channel into a subgroup pair and main. */
+        BusSummingStage,
+        /** Same as BusSummingStage, with the buses in double precision. */
+        DoubleBusSummingStage,
+        /** Metering of each channel: peak, energy and clipping. */
+        PeakDetectionStage,
+        /** Conversion of each channel peak to dB. */
+        LinearToDbStage,
+        StageCount
+    };
+
+    /** Result of one measurement. */
+    struct Result {
+        /** Wall clock time per processed sample. */
+        double nanosecondsPerSample;
+        /** CPU cycles per period over all channels, 0 if there is no cycle counter. */
+        double cyclesPerPeriod;
+    };
+
+    /** Constructor */
+    DspBenchmark();
+    /** Destructor */
+    ~DspBenchmark();
+
+    /**
+     * Measures a stage. The stage is run repeatedly until at least
+     * minimumSamples samples have been processed.
+     */
+    Result measure(Stage stage, int channels, int frames, qint64 minimumSamples);
+
+    /** @returns the name of a stage, as used on the command line. */
+    static const char *name(Stage stage);
+
+private:
+    /** Allocates and initializes everything needed for the given dimensions. */
+    void prepare(Stage stage, int channels, int frames);
+    /** Frees everything allocated by prepare(). */
+    void release();
+    /** Runs one period of the given stage. */
+    void runPeriod(Stage stage);
+
+    int _channels;
+    int _frames;
+
+    /** Working buffers: one for each channel followed by the buses. */
+    ScratchArena *_buffers;
+    BufferMixerPorts *_mixerPorts;
+    QVector<ChannelStrip*> _channelStrips;
+    BiquadEqualizerBank *_biquadEqualizer;
+    DynamicsBank *_dynamics;
+    QVector<float*> _laneBuffers;
+    RoutingKernel<float, float>::Function _routingKernel;
+    RoutingKernel<float, double>::Function _doubleRoutingKernel;
+    /** Buses for DoubleBusSummingStage, frames samples each. */
+    QVector<double> _doubleBuses;
+
+    /** Parameters used for all channel strips. */
+    ChannelState _channelState;
+    /** Peaks found in the last period, kept so the work cannot be optimized away. */
+    QVector<float> _peaks;
+    /** Levels accumulated by the routing kernel. */
+    QVector<MeterRecord> _meterRecords;
+    /** Sum of all converted peaks, kept so the work cannot be optimized away. */
+    double _peaksDb;
+};
+
+#endif // DSPBENCHMARK_H
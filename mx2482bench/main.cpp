@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Own includes
+#include "dspbenchmark.h"
+#include "routingkernel.h"
+#include "sampleops.h"
+
+// Qt includes
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QStringList>
+
+// Standard includes
+#include <cstdio>
+
+/** Parses a comma separated list of positive numbers. */
+static QList<int> parseNumbers(const QString& text)
+{
+    QList<int> numbers;
+    foreach(QString number, text.split(',', QString::SkipEmptyParts)) {
+        int value = number.trimmed().toInt();
+        if(value > 0) {
+            numbers.append(value);
+        }
+    }
+    return numbers;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MX2482 DSP benchmark - times each processing stage without JACK");
+    parser.addHelpOption();
+
+    QCommandLineOption stagesOption("stages",
+        "Comma separated <stages> to measure: strip, strip-biquad, strip-fft, dynamics, bus-summing, bus-summing-double, peak, linear-to-db.",
+        "stages", "strip,strip-biquad,strip-fft,dynamics,bus-summing,bus-summing-double,peak,linear-to-db");
+    QCommandLineOption framesOption("frames",
+        "Comma separated buffer sizes in <frames>.",
+        "frames", "16,32,64,128,256,512,1024,2048,4096");
+    QCommandLineOption channelsOption("channels",
+        "Comma separated <channels> counts.",
+        "channels", "8,16,24,32,64,128,256");
+    QCommandLineOption samplesOption("samples",
+        "Process at least <samples> samples for each measurement.",
+        "samples", "4194304");
+    QCommandLineOption csvOption("csv",
+        "Print comma separated values instead of a table.");
+
+    parser.addOption(stagesOption);
+    parser.addOption(framesOption);
+    parser.addOption(channelsOption);
+    parser.addOption(samplesOption);
+    parser.addOption(csvOption);
+    parser.process(a);
+
+    QList<DspBenchmark::Stage> stages;
+    foreach(QString stageName, parser.value(stagesOption).split(',', QString::SkipEmptyParts)) {
+        bool found = false;
+        for(int stage = 0; stage < DspBenchmark::StageCount; stage++) {
+            if(stageName.trimmed() == DspBenchmark::name((DspBenchmark::Stage)stage)) {
+                stages.append((DspBenchmark::Stage)stage);
+                found = true;
+            }
+        }
+        if(!found) {
+            qWarning("Unknown stage \"%s\".", qPrintable(stageName));
+            return 1;
+        }
+    }
+
+    QList<int> frameSizes = parseNumbers(parser.value(framesOption));
+    QList<int> channelCounts = parseNumbers(parser.value(channelsOption));
+    qint64 minimumSamples = qMax(1LL, parser.value(samplesOption).toLongLong());
+    bool csv = parser.isSet(csvOption);
+
+    // Measure under the same conditions as the realtime thread
+    enableFlushToZero();
+
+    if(csv) {
+        printf("stage,channels,frames,ns_per_sample,cycles_per_period\n");
+    } else {
+        printf("Routing kernel: %s, double buses: %s\n\n",
+               RoutingKernelBase::name(RoutingKernel<float, float>::bestInstructionSet()),
+               RoutingKernelBase::name(RoutingKernel<float, double>::bestInstructionSet()));
+        printf("%-18s %8s %8s %14s %18s\n", "stage", "channels", "frames", "ns/sample", "cycles/period");
+    }
+
+    DspBenchmark dspBenchmark;
+    foreach(DspBenchmark::Stage stage, stages) {
+        foreach(int channels, channelCounts) {
+            foreach(int frames, frameSizes) {
+                DspBenchmark::Result result = dspBenchmark.measure(stage, channels, frames, minimumSamples);
+                if(csv) {
+                    printf("%s,%d,%d,%.4f,%.0f\n", DspBenchmark::name(stage), channels, frames,
+                           result.nanosecondsPerSample, result.cyclesPerPeriod);
+                } else {
+                    printf("%-18s %8d %8d %14.4f %18.0f\n", DspBenchmark::name(stage), channels, frames,
+                           result.nanosecondsPerSample, result.cyclesPerPeriod);
+                }
+                fflush(stdout);
+            }
+        }
+    }
+
+    return 0;
+}
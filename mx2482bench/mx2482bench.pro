@@ -0,0 +1,43 @@
+QT += core
+QT -= gui
+OBJECTS_DIR = obj
+MOC_DIR = moc
+DESTDIR = bin
+TARGET = mx2482bench
+TEMPLATE = app
+QMAKE_CXXFLAGS -= -O2
+QMAKE_CXXFLAGS += -O3
+# Never fuse multiplies and adds, so all routing kernel variants produce the same buses
+QMAKE_CXXFLAGS += -ffp-contract=off
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += flat
+
+# Sum the subgroups and main in double precision: qmake CONFIG+=double_buses
+double_buses: DEFINES += MX2482_DOUBLE_BUSES
+
+INCLUDEPATH += ../libqjackaudio \
+               ../mx2482
+
+LIBS += -L../libqjackaudio/lib \
+                -lqjackaudio \
+                -ljack \
+                -lfftw3 \
+                -lpthread
+
+SOURCES += \
+    main.cpp \
+    dspbenchmark.cpp \
+    ../mx2482/mixerstate.cpp \
+    ../mx2482/channelstrip.cpp \
+    ../mx2482/buffermixerports.cpp \
+    ../mx2482/scratcharena.cpp \
+    ../mx2482/routingkernel.cpp \
+    ../mx2482/biquadequalizer.cpp \
+    ../mx2482/dynamicsbank.cpp \
+    ../mx2482/automationplayer.cpp \
+    ../mx2482/mixercommand.cpp \
+    ../mx2482/stagetracer.cpp
+
+HEADERS += \
+    dspbenchmark.h
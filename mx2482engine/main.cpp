@@ -0,0 +1,44 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+#include <QCoreApplication>
+#include "mixeroptions.h"
+#include "offlinerenderer.h"
+#include "enginehost.h"
+
+int main(int argc, char *argv[])
+{
+    // Neither mode needs a display, so this runs on machines without any
+    QCoreApplication a(argc, argv);
+    MixerOptions mixerOptions = MixerOptions::fromArguments(a.arguments());
+    if(!mixerOptions.renderStateFile.isEmpty()) {
+        OfflineRenderer offlineRenderer(mixerOptions);
+        return offlineRenderer.render() ? 0 : 1;
+    }
+
+    // Without --render this is what mx2482 --headless runs
+    EngineHost engineHost(mixerOptions);
+    if(!engineHost.start()) {
+        return 1;
+    }
+    return a.exec();
+}
@@ -0,0 +1,28 @@
+QT += core network
+QT -= gui
+OBJECTS_DIR = obj
+MOC_DIR = moc
+DESTDIR = bin
+TARGET = mx2482engine
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += flat
+
+INCLUDEPATH += ../libqjackaudio \
+               ../mx2482 \
+               /usr/include/lilv-0
+
+LIBS += -L../libmx2482engine/lib \
+                -lmx2482engine \
+                -L../libqjackaudio/lib \
+                -lqjackaudio \
+                -ljack \
+                -lfftw3 \
+                -llilv-0 \
+                -lpthread
+
+PRE_TARGETDEPS += ../libmx2482engine/lib/libmx2482engine.a
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,239 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Own includes
+#include "enginetest.h"
+#include "wavreader.h"
+
+// QJackAudio includes
+#include <QUnits>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStringList>
+#include <QVector>
+#include <QtTest>
+
+EngineTest::EngineTest() :
+    _temporaryDirectory(0),
+    _mixerPorts(0),
+    _mixerEngine(0),
+    _engineSegment(0),
+    _userInterfaceSegment(0),
+    _engineController(0)
+{
+}
+
+void EngineTest::init()
+{
+    _temporaryDirectory = new QTemporaryDir();
+    QVERIFY(_temporaryDirectory->isValid());
+
+    _mixerOptions = MixerOptions();
+    _mixerOptions.channelCount = ChannelCount;
+    _mixerOptions.subgroupCount = SubgroupCount;
+    _mixerOptions.recordDirectory = QDir(_temporaryDirectory->path()).filePath("recordings");
+    _mixerOptions.recordFormat = WavWriter::Wave;
+    _mixerOptions.segmentName = QString("mx2482test-%1").arg(QCoreApplication::applicationPid());
+
+    _mixerPorts = new BufferMixerPorts(ChannelCount, SubgroupCount, Frames);
+    _mixerEngine = new MixerEngine(_mixerPorts, ChannelCount, SubgroupCount);
+    // Periods are not paced like with JACK, so the cycle monitor is not told the sample rate
+    // and does not look for xruns
+    _mixerEngine->resizeBuffers(Frames);
+
+    _engineSegment = new EngineSegment(_mixerOptions.segmentName);
+    QVERIFY2(_engineSegment->create(ChannelCount, SubgroupCount), qPrintable(_engineSegment->errorString()));
+    _userInterfaceSegment = new EngineSegment(_mixerOptions.segmentName);
+    QVERIFY2(_userInterfaceSegment->attach(), qPrintable(_userInterfaceSegment->errorString()));
+
+    _engineController = new EngineController(_mixerOptions, _mixerEngine, _engineSegment, SampleRate);
+    _engineController->publishState();
+}
+
+void EngineTest::cleanup()
+{
+    delete _engineController;
+    delete _userInterfaceSegment;
+    delete _engineSegment;
+    delete _mixerEngine;
+    delete _mixerPorts;
+    delete _temporaryDirectory;
+    _engineController = 0;
+    _userInterfaceSegment = 0;
+    _engineSegment = 0;
+    _mixerEngine = 0;
+    _mixerPorts = 0;
+    _temporaryDirectory = 0;
+}
+
+void EngineTest::recording()
+{
+    QString directory = recordTake(0.5f);
+    QVERIFY(!directory.isEmpty());
+
+    // The take starts with the period after the request, and ends with the one before the next
+    WavReader wavReader;
+    QVERIFY2(wavReader.open(QDir(directory).filePath("ch1_in.wav")), qPrintable(wavReader.errorString()));
+    QCOMPARE(wavReader.sampleRate(), (int)SampleRate);
+    QCOMPARE(wavReader.frameCount(), (qint64)RecordedPeriods * Frames);
+    QVector<float> samples(Frames);
+    QCOMPARE(wavReader.read(samples.data(), Frames), (int)Frames);
+    QVERIFY(qAbs(samples.first() - 0.5f) < 0.0001f);
+
+    foreach(QString fileName, QStringList() << "ch2_in.wav" << "subgroup1_out.wav" << "main_out_1.wav") {
+        QVERIFY2(QFile::exists(QDir(directory).filePath(fileName)), qPrintable(fileName));
+    }
+}
+
+void EngineTest::soundcheck()
+{
+    QVERIFY(!recordTake(0.5f).isEmpty());
+
+    // Without a soundcheck directory, the latest recording is played back instead of the silent input
+    request(EngineRequest::ToggleSoundcheck);
+    processPeriods(2, 0.0f);
+    QVERIFY(_userInterfaceSegment->status().soundcheck);
+    QVERIFY(qAbs(directOut() - 0.5f) < 0.0001f);
+    QCOMPARE(_userInterfaceSegment->status().soundcheckMissedFrames, (qint64)0);
+
+    request(EngineRequest::ToggleSoundcheck);
+    processPeriods(2, 0.25f);
+    QVERIFY(!_userInterfaceSegment->status().soundcheck);
+    QVERIFY(qAbs(directOut() - 0.25f) < 0.0001f);
+}
+
+void EngineTest::automation()
+{
+    float faderGain = QUnits::dbToLinear(-6.0);
+    QJsonObject channelObject;
+    channelObject.insert("faderGain", -6.0);
+    QJsonObject pulledDownState;
+    pulledDownState.insert("channel1", channelObject);
+
+    // Pull the fader of the first channel down while recording automation
+    request(EngineRequest::ToggleAutomationRecording);
+    processPeriods(1, 0.5f);
+    QVERIFY(_userInterfaceSegment->status().automationRecording);
+    QVERIFY(_userInterfaceSegment->publishState(pulledDownState, 0));
+    processPeriods(2, 0.5f);
+    QVERIFY(qAbs(directOut() - 0.5f * faderGain) < 0.0001f);
+    request(EngineRequest::ToggleAutomationRecording);
+    processPeriods(1, 0.5f);
+    QVERIFY(!_userInterfaceSegment->status().automationRecording);
+
+    // With the fader back up, the automation pulls it down again. Whatever is taken from the
+    // segment after a period is heard in the next one.
+    QVERIFY(_userInterfaceSegment->publishState(QJsonObject(), 0));
+    processPeriods(2, 0.5f);
+    QVERIFY(qAbs(directOut() - 0.5f) < 0.0001f);
+    request(EngineRequest::ToggleAutomationPlayback);
+    processPeriods(4, 0.5f);
+    QVERIFY(_userInterfaceSegment->status().automationPlaying);
+    QVERIFY(qAbs(directOut() - 0.5f * faderGain) < 0.0001f);
+
+    // Saved automation can be loaded again, which stops playback
+    QString fileName = QDir(_temporaryDirectory->path()).filePath("state.json");
+    request(EngineRequest::SaveState, fileName);
+    processPeriods(1, 0.5f);
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonObject jsonObject = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+    QVERIFY(!jsonObject.value("automation").toArray().isEmpty());
+
+    request(EngineRequest::LoadAutomation, fileName);
+    processPeriods(2, 0.5f);
+    QVERIFY(!_userInterfaceSegment->status().automationPlaying);
+    QVERIFY(qAbs(directOut() - 0.5f) < 0.0001f);
+    request(EngineRequest::ToggleAutomationPlayback);
+    processPeriods(4, 0.5f);
+    QVERIFY(qAbs(directOut() - 0.5f * faderGain) < 0.0001f);
+}
+
+void EngineTest::cycleStatistics()
+{
+    processPeriods(10, 0.5f);
+    QCOMPARE(_userInterfaceSegment->status().cycleStatistics.cycleCount, (qint64)10);
+
+    QString fileName = QDir(_temporaryDirectory->path()).filePath("statistics.json");
+    request(EngineRequest::ExportCycleStatistics, fileName);
+    processPeriods(1, 0.5f);
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonObject jsonObject = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+    QVERIFY(jsonObject.value("histogram").isObject());
+    QVERIFY(jsonObject.value("xruns").isArray());
+}
+
+void EngineTest::processPeriods(int count, float input)
+{
+    for(int period = 0; period < count; period++) {
+        for(int channel = 0; channel < ChannelCount; channel++) {
+            float *channelInput = _mixerPorts->channelInput(channel);
+            for(int i = 0; i < Frames; i++) {
+                channelInput[i] = channel == 0 ? input : 0.0f;
+            }
+        }
+        _mixerEngine->process(Frames);
+
+        EngineStatus engineStatus;
+        engineStatus.realtime = false;
+        engineStatus.bufferSize = Frames;
+        engineStatus.cpuLoad = 0.0f;
+        engineStatus.sampleRate = SampleRate;
+        _engineController->update(engineStatus);
+    }
+}
+
+void EngineTest::request(EngineRequest::Type type, const QString& fileName)
+{
+    QVERIFY(_userInterfaceSegment->addRequest(type, fileName));
+}
+
+QString EngineTest::recordTake(float input)
+{
+    request(EngineRequest::ToggleRecording);
+    processPeriods(RecordedPeriods, input);
+    if(!_userInterfaceSegment->status().recording) {
+        return QString();
+    }
+    request(EngineRequest::ToggleRecording);
+    processPeriods(1, input);
+    if(_userInterfaceSegment->status().recording) {
+        return QString();
+    }
+
+    QDir recordDirectory(_mixerOptions.recordDirectory);
+    QStringList recordings = recordDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    return recordings.size() == 1 ? recordDirectory.filePath(recordings.first()) : QString();
+}
+
+float EngineTest::directOut()
+{
+    return _mixerPorts->channelOutput(0)[Frames - 1];
+}
@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+//    This file is part of QJackAudio.                                       //
+//    Copyright (C) 2014 Jacob Dawid, jacob@omg-it.works                     //
+//                                                                           //
+//    QJackAudio is free software: you can redistribute it and/or modify     //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    QJackAudio is distributed in the hope that it will be useful,          //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with QJackAudio. If not, see <http://www.gnu.org/licenses/>.     //
+//                                                                           //
+//    It is possible to obtain a closed-source license of QJackAudio.        //
+//    If you're interested, contact me at: jacob@omg-it.works                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef ENGINETEST_H
+#define ENGINETEST_H
+
+// Qt includes
+#include <QObject>
+#include <QString>
+#include <QTemporaryDir>
+
+// Own includes
+#include "mixeroptions.h"
+#include "mixerengine.h"
+#include "buffermixerports.h"
+#include "enginesegment.h"
+#include "enginecontroller.h"
+
+/**
+ * Runs a headless engine on BufferMixerPorts, without JACK, and asks it
+ * for recording, the virtual soundcheck, automation and the period
+ * statistics through its segment, just like an attached user interface.
+ * @author Jacob Dawid ( jacob.dawid@omg-it.works )
+ */
+class EngineTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum {
+        ChannelCount = 4,
+        SubgroupCount = 2,
+        Frames = 256,
+        SampleRate = 48000,
+        /** Periods recorded for the soundcheck. */
+        RecordedPeriods = 40
+    };
+
+    /** Constructor */
+    EngineTest();
+
+private slots:
+    void init();
+    void cleanup();
+
+    void recording();
+    void soundcheck();
+    void automation();
+    void cycleStatistics();
+
+private:
+    /**
+     * Processes periods with the input of the first channel at a constant
+     * level, and updates the segment after each of them, as often as a
+     * headless engine would.
+     */
+    void processPeriods(int count, float input);
+
+    /** Asks the engine for something, as the user interface does. */
+    void request(EngineRequest::Type type, const QString& fileName = QString());
+
+    /** Records RecordedPeriods periods with the first channel at input. @returns the directory. */
+    QString recordTake(float input);
+
+    /** @returns the level of the direct out of the first channel at the end of the last period. */
+    float directOut();
+
+    QTemporaryDir *_temporaryDirectory;
+    MixerOptions _mixerOptions;
+    BufferMixerPorts *_mixerPorts;
+    MixerEngine *_mixerEngine;
+    /** Side of the engine. */
+    EngineSegment *_engineSegment;
+    /** Side of the user interface. */
+    EngineSegment *_userInterfaceSegment;
+    EngineController *_engineController;
+};
+
+#endif // ENGINETEST_H
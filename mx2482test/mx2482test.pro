@@ -0,0 +1,32 @@
+QT += core network testlib
+QT -= gui
+OBJECTS_DIR = obj
+MOC_DIR = moc
+DESTDIR = bin
+TARGET = mx2482test
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+CONFIG += flat
+
+INCLUDEPATH += ../libqjackaudio \
+               ../mx2482 \
+               /usr/include/lilv-0
+
+LIBS += -L../libmx2482engine/lib \
+                -lmx2482engine \
+                -L../libqjackaudio/lib \
+                -lqjackaudio \
+                -ljack \
+                -lfftw3 \
+                -llilv-0 \
+                -lpthread
+
+PRE_TARGETDEPS += ../libmx2482engine/lib/libmx2482engine.a
+
+SOURCES += \
+    main.cpp \
+    enginetest.cpp
+
+HEADERS += \
+    enginetest.h